@@ -165,6 +165,14 @@ index_opts_decode(struct index_opts *opts, const char *map,
 	if (opts->run_size_ratio <= 1)
 		tnt_raise(ClientError, ER_WRONG_SPACE_OPTIONS,
 			  BOX_INDEX_FIELD_OPTS, "run_size_ratio must be > 1");
+	if (opts->compaction_policy == compaction_policy_MAX) {
+		tnt_raise(ClientError, ER_WRONG_INDEX_OPTIONS,
+			  BOX_INDEX_FIELD_OPTS, "compaction_policy must be "\
+			  "either 'tiered' or 'leveled'");
+	}
+	if (opts->read_ahead < 0 || opts->read_ahead > UINT32_MAX)
+		tnt_raise(ClientError, ER_WRONG_INDEX_OPTIONS,
+			  BOX_INDEX_FIELD_OPTS, "read_ahead must be >= 0");
 }
 
 /**
@@ -464,6 +472,12 @@ public:
 	AlterSpaceOp(struct alter_space *alter);
 	struct rlist link;
 	virtual void alter_def(struct alter_space * /* alter */) {}
+	/**
+	 * Build data structures of the new space that can be
+	 * built from the old space while it's still in use.
+	 * May yield.
+	 */
+	virtual void prepare(struct alter_space * /* alter */) {}
 	virtual void alter(struct alter_space * /* alter */) {}
 	virtual void commit(struct alter_space * /* alter */,
 			    int64_t /* signature */) {}
@@ -515,6 +529,9 @@ struct alter_space {
 static struct alter_space *
 alter_space_new(struct space *old_space)
 {
+	if (old_space->is_being_altered)
+		tnt_raise(ClientError, ER_ALTER_SPACE, space_name(old_space),
+			  "the space is being altered");
 	struct alter_space *alter =
 		region_calloc_object_xc(&fiber()->gc, struct alter_space);
 	rlist_create(&alter->ops);
@@ -629,6 +646,11 @@ alter_space_rollback(struct trigger *trigger, void * /* event */)
  *   definition of a new space
  * - an instance of the new space is created, according to the new
  *   definition; the space is so far empty
+ * - new indexes are built from the old space; this may yield,
+ *   and the old space keeps serving requests meanwhile: changes
+ *   done to it are caught up by the engine before the build
+ *   returns, so that everything from here on is done without
+ *   yielding and the switch to the new space is atomic
  * - data structures of the new space are built; sometimes, it
  *   doesn't need to happen, e.g. when alter only changes the name
  *   of a space or an index, or other accidental property.
@@ -664,6 +686,20 @@ alter_space_do(struct txn *txn, struct alter_space *alter)
 	 */
 	space_prepare_alter_xc(alter->old_space, alter->new_space);
 
+	/*
+	 * Build new indexes. Since this may yield, other DDL
+	 * on the space is prohibited meanwhile.
+	 */
+	alter->old_space->is_being_altered = true;
+	try {
+		rlist_foreach_entry(op, &alter->ops, link)
+			op->prepare(alter);
+	} catch (Exception *e) {
+		alter->old_space->is_being_altered = false;
+		throw;
+	}
+	alter->old_space->is_being_altered = false;
+
 	alter->new_space->sequence = alter->old_space->sequence;
 	alter->new_space->truncate_count = alter->old_space->truncate_count;
 	memcpy(alter->new_space->access, alter->old_space->access,
@@ -962,6 +998,7 @@ public:
 	/** New index index_def. */
 	struct index_def *new_index_def;
 	virtual void alter_def(struct alter_space *alter);
+	virtual void prepare(struct alter_space *alter);
 	virtual void alter(struct alter_space *alter);
 	virtual void commit(struct alter_space *alter, int64_t lsn);
 	virtual ~CreateIndex();
@@ -975,7 +1012,7 @@ CreateIndex::alter_def(struct alter_space *alter)
 }
 
 /**
- * Optionally build the new index.
+ * Optionally build the new secondary index.
  *
  * During recovery the space is often not fully constructed yet
  * anyway, so there is no need to fully populate index with data,
@@ -983,7 +1020,22 @@ CreateIndex::alter_def(struct alter_space *alter)
  *
  * Note, that system spaces are exception to this, since
  * they are fully enabled at all times.
+ *
+ * The index is built from the primary key of the old space,
+ * which is still in use, so the engine may build it in the
+ * background.
  */
+void
+CreateIndex::prepare(struct alter_space *alter)
+{
+	if (new_index_def->iid == 0)
+		return;
+	struct index *new_index = index_find_xc(alter->new_space,
+						new_index_def->iid);
+	space_build_secondary_key_xc(alter->old_space,
+				     alter->new_space, new_index);
+}
+
 void
 CreateIndex::alter(struct alter_space *alter)
 {
@@ -999,15 +1051,7 @@ CreateIndex::alter(struct alter_space *alter)
 		 * all keys.
 		 */
 		space_add_primary_key_xc(alter->new_space);
-		return;
 	}
-	/**
-	 * Get the new index and build it.
-	 */
-	struct index *new_index = index_find_xc(alter->new_space,
-						new_index_def->iid);
-	space_build_secondary_key_xc(alter->new_space,
-				     alter->new_space, new_index);
 }
 
 void
@@ -1047,9 +1091,19 @@ public:
 	/** Old index index_def. */
 	struct index_def *old_index_def;
 	virtual void alter_def(struct alter_space *alter);
+	virtual void prepare(struct alter_space *alter);
 	virtual void alter(struct alter_space *alter);
 	virtual void commit(struct alter_space *alter, int64_t signature);
 	virtual ~RebuildIndex();
+private:
+	/**
+	 * A secondary index can be built from the old space
+	 * unless the primary key is rebuilt by the same alter.
+	 */
+	bool is_built_from_old_space(struct alter_space *alter)
+	{
+		return new_index_def->iid != 0 && alter->pk_def == NULL;
+	}
 };
 
 /** Add definition of the new key to the new space def. */
@@ -1060,9 +1114,23 @@ RebuildIndex::alter_def(struct alter_space *alter)
 	index_def_list_add(&alter->key_list, new_index_def);
 }
 
+void
+RebuildIndex::prepare(struct alter_space *alter)
+{
+	if (!is_built_from_old_space(alter))
+		return;
+	struct index *new_index = space_index(alter->new_space,
+					      new_index_def->iid);
+	assert(new_index != NULL);
+	space_build_secondary_key_xc(alter->old_space,
+				     alter->new_space, new_index);
+}
+
 void
 RebuildIndex::alter(struct alter_space *alter)
 {
+	if (is_built_from_old_space(alter))
+		return;
 	/* Get the new index and build it.  */
 	struct index *new_index = space_index(alter->new_space,
 					      new_index_def->iid);
@@ -1568,6 +1636,9 @@ on_replace_dd_truncate(struct trigger * /* trigger */, void *event)
 	uint64_t truncate_count =
 		tuple_field_u64_xc(new_tuple, BOX_TRUNCATE_FIELD_COUNT);
 	struct space *old_space = space_cache_find_xc(space_id);
+	if (old_space->is_being_altered)
+		tnt_raise(ClientError, ER_ALTER_SPACE, space_name(old_space),
+			  "the space is being altered");
 
 	if (stmt->row->type == IPROTO_INSERT) {
 		/*
@@ -47,8 +47,12 @@
 #include "xrow_io.h"
 #include "error.h"
 #include "session.h"
+#include "space.h"
+#include "schema.h"
+#include "txn.h"
 
 double applier_timeout = 1;
+int applier_batch_size = 1;
 
 STRS(applier_state, applier_STATE);
 
@@ -337,6 +341,168 @@ applier_join(struct applier *applier)
 	applier_set_state(applier, APPLIER_READY);
 }
 
+/**
+ * Decode the next row from the input buffer if it has been
+ * read in full, without reading from the socket.
+ * Return false if there's no complete row in the buffer.
+ */
+static bool
+applier_read_buffered_xrow(struct ibuf *in, struct xrow_header *row)
+{
+	const char *pos = in->rpos;
+	if (pos == in->wpos || mp_typeof(*pos) != MP_UINT ||
+	    mp_check_uint(pos, in->wpos) > 0)
+		return false;
+	uint32_t len = mp_decode_uint(&pos);
+	if ((size_t)(in->wpos - pos) < len)
+		return false;
+	in->rpos = (char *)pos;
+	xrow_header_decode_xc(row, (const char **) &in->rpos,
+			      in->rpos + len);
+	return true;
+}
+
+/**
+ * Check a row received from the master and update
+ * the replication lag.
+ */
+static void
+applier_check_row(struct applier *applier, struct xrow_header *row)
+{
+	if (iproto_type_is_error(row->type))
+		xrow_decode_error_xc(row);  /* error */
+	/* Replication request. */
+	if (row->replica_id == REPLICA_ID_NIL ||
+	    row->replica_id >= VCLOCK_MAX) {
+		/*
+		 * A safety net, this can only occur
+		 * if we're fed a strangely broken xlog.
+		 */
+		tnt_raise(ClientError, ER_UNKNOWN_REPLICA,
+			  int2str(row->replica_id),
+			  tt_uuid_str(&REPLICASET_UUID));
+	}
+
+	applier->lag = ev_now(loop()) - row->tm;
+	applier->last_row_time = ev_monotonic_now(loop());
+}
+
+/** Apply a row received from the master in its own transaction. */
+static void
+applier_apply_row(struct applier *applier, struct xrow_header *row)
+{
+	if (vclock_get(&replicaset_vclock, row->replica_id) < row->lsn) {
+		/**
+		 * Promote the replica set vclock before
+		 * applying the row. If there is an
+		 * exception (conflict) applying the row,
+		 * the row is skipped when the replication
+		 * is resumed.
+		 */
+		vclock_follow(&replicaset_vclock, row->replica_id,
+			      row->lsn);
+		xstream_write_xc(applier->subscribe_stream, row);
+	}
+}
+
+/**
+ * Return the engine of the space a row modifies or NULL
+ * if the row can't be applied in a batch: DDL can't be
+ * done in a multi-statement transaction, so rows of system
+ * spaces are applied one by one.
+ */
+static struct engine *
+applier_batch_engine(struct xrow_header *row)
+{
+	if (!iproto_type_is_dml(row->type))
+		return NULL;
+	struct request request;
+	if (xrow_decode_dml(row, &request,
+			    dml_request_key_map(row->type)) != 0) {
+		/* Let the error be raised when the row is applied. */
+		diag_clear(diag_get());
+		return NULL;
+	}
+	if (request.space_id < BOX_SYSTEM_ID_MAX)
+		return NULL;
+	struct space *space = space_by_id(request.space_id);
+	return space != NULL ? space->engine : NULL;
+}
+
+/**
+ * Apply rows received from the master in a single transaction,
+ * so that they are written to WAL together. All rows must
+ * belong to the same engine, see applier_batch_engine().
+ *
+ * As in the row by row mode, the replica set vclock is promoted
+ * right before applying a row, and the row is skipped if it has
+ * already been applied, e.g. received from another master.
+ * If a row fails, the transaction is rolled back to the savepoint
+ * taken before the row, the rows preceding it are committed and
+ * the error is raised, just like the rows would be applied one
+ * by one. Rows are never applied twice, so on_replace triggers
+ * fire once per row. If the commit fails, none of the rows is
+ * applied, so the vclock is rolled back to make the master send
+ * them again when the applier reconnects.
+ */
+static void
+applier_apply_batch(struct applier *applier, struct xrow_header *rows,
+		    int count)
+{
+	struct xstream *stream = applier->subscribe_stream;
+	struct vclock prev_vclock;
+	vclock_copy(&prev_vclock, &replicaset_vclock);
+	if (box_txn_begin() != 0)
+		diag_raise();
+	/* Error of the row that failed to apply. */
+	struct diag row_diag;
+	diag_create(&row_diag);
+	auto diag_guard = make_scoped_guard([&]{ diag_destroy(&row_diag); });
+	int rc = 0;
+	for (int i = 0; i < count; i++) {
+		struct xrow_header *row = &rows[i];
+		if (vclock_get(&replicaset_vclock,
+			       row->replica_id) >= row->lsn)
+			continue;
+		box_txn_savepoint_t *svp = box_txn_savepoint();
+		if (svp == NULL) {
+			rc = -1;
+			break;
+		}
+		vclock_follow(&replicaset_vclock, row->replica_id, row->lsn);
+		if (xstream_write(stream, row) == 0)
+			continue;
+		diag_move(diag_get(), &row_diag);
+		rc = box_txn_rollback_to_savepoint(svp);
+		break;
+	}
+	if (rc == 0)
+		rc = box_txn_commit();
+	if (rc != 0) {
+		box_txn_rollback();
+		/*
+		 * Leave alone components promoted further by
+		 * other appliers while the commit was waiting
+		 * for WAL.
+		 */
+		for (int i = 0; i < count; i++) {
+			uint32_t replica_id = rows[i].replica_id;
+			int64_t prev_lsn = vclock_get(&prev_vclock,
+						      replica_id);
+			if (vclock_get(&replicaset_vclock,
+				       replica_id) == rows[i].lsn &&
+			    rows[i].lsn > prev_lsn)
+				vclock_reset(&replicaset_vclock, replica_id,
+					     prev_lsn);
+		}
+		diag_raise();
+	}
+	if (!diag_is_empty(&row_diag)) {
+		diag_move(&row_diag, diag_get());
+		diag_raise();
+	}
+}
+
 /**
  * Execute and process SUBSCRIBE request (follow updates from a master).
  */
@@ -411,6 +577,9 @@ applier_subscribe(struct applier *applier)
 	/*
 	 * Process a stream of rows from the binary log.
 	 */
+	struct xrow_header *batch = NULL;
+	int batch_alloc = 0;
+	auto batch_guard = make_scoped_guard([&]{ free(batch); });
 	while (true) {
 		if (applier->state == APPLIER_FINAL_JOIN &&
 		    instance_id != REPLICA_ID_NIL) {
@@ -420,37 +589,62 @@ applier_subscribe(struct applier *applier)
 			applier_set_state(applier, APPLIER_FOLLOW);
 		}
 
-		coio_read_xrow(coio, &iobuf->in, &row);
-
-		if (iproto_type_is_error(row.type))
-			xrow_decode_error_xc(&row);  /* error */
-		/* Replication request. */
-		if (row.replica_id == REPLICA_ID_NIL ||
-		    row.replica_id >= VCLOCK_MAX) {
-			/*
-			 * A safety net, this can only occur
-			 * if we're fed a strangely broken xlog.
-			 */
-			tnt_raise(ClientError, ER_UNKNOWN_REPLICA,
-				  int2str(row.replica_id),
-				  tt_uuid_str(&REPLICASET_UUID));
+		/*
+		 * Wait for a row, then add rows that have already
+		 * been read ahead to the batch, without waiting
+		 * for more data. Rows are only batched while
+		 * following the master.
+		 */
+		int batch_size = applier->state == APPLIER_FOLLOW ?
+				 applier_batch_size : 1;
+		if (batch_size > batch_alloc) {
+			struct xrow_header *new_batch = (struct xrow_header *)
+				realloc(batch, batch_size * sizeof(*batch));
+			if (new_batch == NULL) {
+				tnt_raise(OutOfMemory,
+					  batch_size * sizeof(*batch),
+					  "realloc", "applier batch");
+			}
+			batch = new_batch;
+			batch_alloc = batch_size;
 		}
-
-		applier->lag = ev_now(loop()) - row.tm;
-		applier->last_row_time = ev_monotonic_now(loop());
-
-		if (vclock_get(&replicaset_vclock, row.replica_id) < row.lsn) {
-			/**
-			 * Promote the replica set vclock before
-			 * applying the row. If there is an
-			 * exception (conflict) applying the row,
-			 * the row is skipped when the replication
-			 * is resumed.
-			 */
-			vclock_follow(&replicaset_vclock, row.replica_id,
-				      row.lsn);
-			xstream_write_xc(applier->subscribe_stream, &row);
+		int count = 0;
+		struct engine *engine = NULL;
+		struct xrow_header *row = &batch[0];
+		coio_read_xrow(coio, &iobuf->in, row);
+		while (true) {
+			applier_check_row(applier, row);
+			if (batch_size == 1) {
+				applier_apply_row(applier, row);
+				break;
+			}
+			if (vclock_get(&replicaset_vclock,
+				       row->replica_id) < row->lsn) {
+				struct engine *row_engine =
+					applier_batch_engine(row);
+				if (count > 0 && row_engine != engine) {
+					applier_apply_batch(applier, batch,
+							    count);
+					count = 0;
+				}
+				if (row_engine == NULL) {
+					/* Can't be batched. */
+					applier_apply_row(applier, row);
+				} else {
+					if (row != &batch[count])
+						batch[count] = *row;
+					count++;
+					engine = row_engine;
+				}
+			}
+			if (count == batch_size)
+				break;
+			row = &batch[count];
+			if (!applier_read_buffered_xrow(&iobuf->in, row))
+				break;
 		}
+		if (count > 0)
+			applier_apply_batch(applier, batch, count);
 		if (applier->state == APPLIER_FOLLOW)
 			fiber_cond_signal(&applier->writer_cond);
 		iobuf_reset(iobuf);
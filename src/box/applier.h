@@ -46,6 +46,11 @@
 
 /** Network timeout */
 extern double applier_timeout;
+/**
+ * Max number of rows received from a master applied in
+ * a single transaction, see replication_apply_batch_size.
+ */
+extern int applier_batch_size;
 
 struct xstream;
 
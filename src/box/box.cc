@@ -31,6 +31,7 @@
 #include "box/box.h"
 
 #include "trivia/config.h"
+#include <fcntl.h> /* O_DIRECT */
 
 #include "lua/utils.h" /* lua_hash() */
 #include "fiber_pool.h"
@@ -69,6 +70,7 @@
 #include "gc.h"
 #include "checkpoint.h"
 #include "sql.h"
+#include "sql_stmt_cache.h"
 #include "systemd.h"
 #include "call.h"
 #include "func.h"
@@ -158,6 +160,16 @@ box_check_memtx_min_tuple_size(ssize_t memtx_min_tuple_size)
 		  "specified value is out of bounds");
 }
 
+static int
+box_check_memtx_snapshot_threads(int threads)
+{
+	if (threads < 1 || threads > MEMTX_SNAPSHOT_THREADS_MAX)
+		tnt_raise(ClientError, ER_CFG, "memtx_snapshot_threads",
+			  tt_sprintf("must be in range [1, %d]",
+				     MEMTX_SNAPSHOT_THREADS_MAX));
+	return threads;
+}
+
 static int
 process_rw(struct request *request, struct space *space, struct tuple **result)
 {
@@ -336,6 +348,16 @@ box_check_log_format(const char *log_format)
 	return format;
 }
 
+static enum say_overflow
+box_check_log_async_overflow(const char *log_async_overflow)
+{
+	enum say_overflow overflow = say_overflow_by_name(log_async_overflow);
+	if (overflow == say_overflow_MAX)
+		tnt_raise(ClientError, ER_CFG, "log_async_overflow",
+			  "expected 'drop' or 'block'");
+	return overflow;
+}
+
 static void
 box_check_uri(const char *source, const char *option_name)
 {
@@ -371,6 +393,28 @@ box_check_replication_timeout(void)
 	return timeout;
 }
 
+static int
+box_check_replication_apply_batch_size(void)
+{
+	int size = cfg_geti("replication_apply_batch_size");
+	if (size <= 0) {
+		tnt_raise(ClientError, ER_CFG, "replication_apply_batch_size",
+			  "the value must be greater than 0");
+	}
+	return size;
+}
+
+static int
+box_check_sql_stmt_cache_size(void)
+{
+	int size = cfg_geti("sql_stmt_cache_size");
+	if (size <= 0) {
+		tnt_raise(ClientError, ER_CFG, "sql_stmt_cache_size",
+			  "the value must be greater than 0");
+	}
+	return size;
+}
+
 static enum wal_mode
 box_check_wal_mode(const char *mode_name)
 {
@@ -423,20 +467,81 @@ box_check_wal_max_size(int64_t wal_max_size)
 	return wal_max_size;
 }
 
+static int
+box_check_wal_compress_level(int level)
+{
+	if (level < 0 || level > ZSTD_maxCLevel()) {
+		tnt_raise(ClientError, ER_CFG, "wal_compress_level",
+			  tt_sprintf("must be in range [0, %d]",
+				     ZSTD_maxCLevel()));
+	}
+	return level;
+}
+
+static int64_t
+box_check_wal_compress_threshold(int64_t threshold)
+{
+	if (threshold < 0) {
+		tnt_raise(ClientError, ER_CFG, "wal_compress_threshold",
+			  "the value must not be negative");
+	}
+	return threshold;
+}
+
+static double
+box_check_wal_group_commit_window(double window)
+{
+	if (window < 0) {
+		tnt_raise(ClientError, ER_CFG, "wal_group_commit_window",
+			  "the value must not be negative");
+	}
+	return window;
+}
+
+static int64_t
+box_check_wal_group_commit_max_size(int64_t max_size)
+{
+	if (max_size <= 0) {
+		tnt_raise(ClientError, ER_CFG, "wal_group_commit_max_size",
+			  "the value must be greater than zero");
+	}
+	return max_size;
+}
+
+static int64_t
+box_check_wal_ring_size(int64_t size)
+{
+	if (size < 0) {
+		tnt_raise(ClientError, ER_CFG, "wal_ring_size",
+			  "the value must not be negative");
+	}
+	return size;
+}
+
 void
 box_check_config()
 {
 	box_check_log(cfg_gets("log"));
 	box_check_log_format(cfg_gets("log_format"));
+	box_check_log_async_overflow(cfg_gets("log_async_overflow"));
 	box_check_uri(cfg_gets("listen"), "listen");
 	box_check_replication();
 	box_check_replication_timeout();
+	box_check_replication_apply_batch_size();
+	box_check_sql_stmt_cache_size();
 	box_check_readahead(cfg_geti("readahead"));
 	box_check_checkpoint_count(cfg_geti("checkpoint_count"));
 	box_check_wal_max_rows(cfg_geti64("rows_per_wal"));
 	box_check_wal_max_size(cfg_geti64("wal_max_size"));
 	box_check_wal_mode(cfg_gets("wal_mode"));
+	box_check_wal_compress_level(cfg_geti("wal_compress_level"));
+	box_check_wal_compress_threshold(cfg_geti64("wal_compress_threshold"));
+	box_check_wal_group_commit_window(cfg_getd("wal_group_commit_window"));
+	box_check_wal_group_commit_max_size(
+		cfg_geti64("wal_group_commit_max_size"));
+	box_check_wal_ring_size(cfg_geti64("wal_ring_size"));
 	box_check_memtx_min_tuple_size(cfg_geti64("memtx_min_tuple_size"));
+	box_check_memtx_snapshot_threads(cfg_geti("memtx_snapshot_threads"));
 	if (cfg_geti64("vinyl_page_size") > cfg_geti64("vinyl_range_size"))
 		tnt_raise(ClientError, ER_CFG, "vinyl_page_size",
 			  "can't be greater than vinyl_range_size");
@@ -446,6 +551,16 @@ box_check_config()
 	if (cfg_geti("vinyl_write_threads") < 2)
 		tnt_raise(ClientError, ER_CFG,
 			  "vinyl_write_threads", "must be >= 2");
+#ifndef O_DIRECT
+	if (cfg_geti("vinyl_direct_io"))
+		tnt_raise(ClientError, ER_CFG, "vinyl_direct_io",
+			  "is not supported on this platform");
+#endif
+	if (cfg_geti("iproto_threads") < 1 ||
+	    cfg_geti("iproto_threads") > IPROTO_THREADS_MAX)
+		tnt_raise(ClientError, ER_CFG, "iproto_threads",
+			  tt_sprintf("must be in range [1, %d]",
+				     IPROTO_THREADS_MAX));
 }
 
 /*
@@ -534,6 +649,18 @@ box_set_replication_timeout(void)
 	replication_cfg_timeout = relay_timeout = applier_timeout = timeout;
 }
 
+void
+box_set_replication_apply_batch_size(void)
+{
+	applier_batch_size = box_check_replication_apply_batch_size();
+}
+
+void
+box_set_sql_stmt_cache_size(void)
+{
+	sql_stmt_cache_set_size(box_check_sql_stmt_cache_size());
+}
+
 void
 box_bind(void)
 {
@@ -577,6 +704,17 @@ box_set_snap_io_rate_limit(void)
 			cfg_getd("snap_io_rate_limit"));
 }
 
+void
+box_set_memtx_snapshot_threads(void)
+{
+	struct memtx_engine *memtx;
+	memtx = (struct memtx_engine *)engine_by_name("memtx");
+	assert(memtx != NULL);
+	memtx_engine_set_snapshot_threads(memtx,
+		box_check_memtx_snapshot_threads(
+			cfg_geti("memtx_snapshot_threads")));
+}
+
 void
 box_set_memtx_max_tuple_size(void)
 {
@@ -633,6 +771,19 @@ box_set_vinyl_timeout(void)
 	vinyl_engine_set_timeout(vinyl,	cfg_getd("vinyl_timeout"));
 }
 
+void
+box_set_vinyl_page_cache(void)
+{
+	struct vinyl_engine *vinyl;
+	vinyl = (struct vinyl_engine *)engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	int64_t quota = cfg_geti64("vinyl_page_cache");
+	if (quota < 0)
+		tnt_raise(ClientError, ER_CFG, "vinyl_page_cache",
+			  "must be >= 0");
+	vinyl_engine_set_page_cache(vinyl, quota);
+}
+
 /* }}} configuration bindings */
 
 /**
@@ -821,14 +972,12 @@ box_select(struct port *port, uint32_t space_id, uint32_t index_id,
 	int rc = 0;
 	uint32_t found = 0;
 	struct tuple *tuple;
-	while (found < limit) {
+	if (limit > 0)
+		rc = iterator_skip(it, offset);
+	while (rc == 0 && found < limit) {
 		rc = iterator_next(it, &tuple);
 		if (rc != 0 || tuple == NULL)
 			break;
-		if (offset > 0) {
-			offset--;
-			continue;
-		}
 		rc = port_add_tuple(port, tuple);
 		if (rc != 0)
 			break;
@@ -844,6 +993,101 @@ box_select(struct port *port, uint32_t space_id, uint32_t index_id,
 	return 0;
 }
 
+int
+box_select_multi(struct port *port, uint32_t *counts, uint32_t space_id,
+		 uint32_t index_id, int iterator, uint32_t offset,
+		 uint32_t limit, const char *keys, uint32_t key_count)
+{
+	rmean_collect(rmean_box, IPROTO_SELECT, key_count);
+
+	if (iterator < 0 || iterator >= iterator_type_MAX) {
+		diag_set(ClientError, ER_ILLEGAL_PARAMS,
+			 "Invalid iterator type");
+		diag_log();
+		return -1;
+	}
+
+	struct space *space = space_cache_find(space_id);
+	if (space == NULL)
+		return -1;
+	if (access_check_space(space, PRIV_R) != 0)
+		return -1;
+	struct index *index = index_find(space, index_id);
+	if (index == NULL)
+		return -1;
+
+	/* Validate all keys before doing any lookups. */
+	enum iterator_type type = (enum iterator_type) iterator;
+	const char *key = keys;
+	for (uint32_t i = 0; i < key_count; i++) {
+		uint32_t part_count = mp_decode_array(&key);
+		if (key_validate(index->def, type, key, part_count))
+			return -1;
+		const char *key_end = key;
+		for (uint32_t j = 0; j < part_count; j++)
+			mp_next(&key_end);
+		key = key_end;
+	}
+
+	struct txn *txn;
+	if (txn_begin_ro_stmt(space, &txn) != 0)
+		return -1;
+
+	/*
+	 * An equality lookup by a full key in a unique index
+	 * yields at most one tuple, so there's no need to
+	 * create an iterator for it.
+	 */
+	bool use_get = (type == ITER_EQ || type == ITER_REQ) &&
+		       index->def->opts.is_unique;
+	int rc = 0;
+	key = keys;
+	for (uint32_t i = 0; i < key_count && rc == 0; i++) {
+		uint32_t part_count = mp_decode_array(&key);
+		const char *key_data = key;
+		for (uint32_t j = 0; j < part_count; j++)
+			mp_next(&key);
+		counts[i] = 0;
+		struct tuple *tuple;
+		if (use_get && part_count == index->def->key_def->part_count) {
+			if (offset > 0 || limit == 0)
+				continue;
+			rc = index_get(index, key_data, part_count, &tuple);
+			if (rc == 0 && tuple != NULL) {
+				rc = port_add_tuple(port, tuple);
+				counts[i] = 1;
+			}
+			continue;
+		}
+		struct iterator *it = index_create_iterator(index, type,
+							    key_data,
+							    part_count);
+		if (it == NULL) {
+			rc = -1;
+			break;
+		}
+		if (limit > 0)
+			rc = iterator_skip(it, offset);
+		while (rc == 0 && counts[i] < limit) {
+			rc = iterator_next(it, &tuple);
+			if (rc != 0 || tuple == NULL)
+				break;
+			rc = port_add_tuple(port, tuple);
+			if (rc != 0)
+				break;
+			counts[i]++;
+		}
+		iterator_delete(it);
+	}
+
+	if (rc != 0) {
+		txn_rollback_stmt();
+		return -1;
+	}
+	txn_commit_ro_stmt(txn);
+	return 0;
+}
+
 int
 box_insert(uint32_t space_id, const char *tuple, const char *tuple_end,
 	   box_tuple_t **result)
@@ -1405,6 +1649,7 @@ engine_init()
 				    cfg_getd("slab_alloc_factor"));
 	engine_register((struct engine *)memtx);
 	box_set_memtx_max_tuple_size();
+	box_set_memtx_snapshot_threads();
 
 	struct sysview_engine *sysview = sysview_engine_new_xc();
 	engine_register((struct engine *)sysview);
@@ -1415,10 +1660,12 @@ engine_init()
 				    cfg_geti64("vinyl_cache"),
 				    cfg_geti("vinyl_read_threads"),
 				    cfg_geti("vinyl_write_threads"),
+				    cfg_geti("vinyl_direct_io"),
 				    cfg_geti("force_recovery"));
 	engine_register((struct engine *)vinyl);
 	box_set_vinyl_max_tuple_size();
 	box_set_vinyl_timeout();
+	box_set_vinyl_page_cache();
 }
 
 /**
@@ -1554,6 +1801,9 @@ box_init(void)
 		diag_raise();
 
 	sequence_init();
+
+	if (sql_stmt_cache_init() != 0)
+		diag_raise();
 }
 
 bool
@@ -1581,7 +1831,7 @@ box_cfg_xc(void)
 	schema_init();
 	replication_init();
 	port_init();
-	iproto_init();
+	iproto_init(cfg_geti("iproto_threads"));
 	wal_thread_start();
 
 	title("loading");
@@ -1589,6 +1839,8 @@ box_cfg_xc(void)
 	box_set_checkpoint_count();
 	box_set_too_long_threshold();
 	box_set_replication_timeout();
+	box_set_replication_apply_batch_size();
+	box_set_sql_stmt_cache_size();
 	xstream_create(&join_stream, apply_initial_join_row);
 	xstream_create(&subscribe_stream, apply_row);
 
@@ -1726,8 +1978,22 @@ box_cfg_xc(void)
 	int64_t wal_max_rows = box_check_wal_max_rows(cfg_geti64("rows_per_wal"));
 	int64_t wal_max_size = box_check_wal_max_size(cfg_geti64("wal_max_size"));
 	enum wal_mode wal_mode = box_check_wal_mode(cfg_gets("wal_mode"));
+	int wal_compress_level =
+		box_check_wal_compress_level(cfg_geti("wal_compress_level"));
+	int64_t wal_compress_threshold = box_check_wal_compress_threshold(
+			cfg_geti64("wal_compress_threshold"));
+	double wal_group_commit_window = box_check_wal_group_commit_window(
+			cfg_getd("wal_group_commit_window"));
+	int64_t wal_group_commit_max_size =
+		box_check_wal_group_commit_max_size(
+			cfg_geti64("wal_group_commit_max_size"));
+	int64_t wal_ring_size =
+		box_check_wal_ring_size(cfg_geti64("wal_ring_size"));
 	wal_init(wal_mode, cfg_gets("wal_dir"), &INSTANCE_UUID,
-		 &replicaset_vclock, wal_max_rows, wal_max_size);
+		 &replicaset_vclock, wal_max_rows, wal_max_size,
+		 wal_compress_level, wal_compress_threshold,
+		 wal_group_commit_window, wal_group_commit_max_size,
+		 wal_ring_size);
 
 	rmean_cleanup(rmean_box);
 
@@ -152,9 +152,13 @@ void box_set_too_long_threshold(void);
 void box_set_readahead(void);
 void box_set_checkpoint_count(void);
 void box_set_memtx_max_tuple_size(void);
+void box_set_memtx_snapshot_threads(void);
 void box_set_vinyl_max_tuple_size(void);
 void box_set_vinyl_timeout(void);
+void box_set_vinyl_page_cache(void);
 void box_set_replication_timeout(void);
+void box_set_replication_apply_batch_size(void);
+void box_set_sql_stmt_cache_size(void);
 
 extern "C" {
 #endif /* defined(__cplusplus) */
@@ -167,6 +171,19 @@ box_select(struct port *port, uint32_t space_id, uint32_t index_id,
 	   int iterator, uint32_t offset, uint32_t limit,
 	   const char *key, const char *key_end);
 
+/**
+ * Select tuples matching each of @a key_count keys stored
+ * one after another in @a keys, using one transaction
+ * statement for all of them. Tuples found for all keys are
+ * added to @a port in the order of keys, the number of tuples
+ * found for key i is stored in @a counts[i]. @a offset and
+ * @a limit are applied to each key separately.
+ */
+int
+box_select_multi(struct port *port, uint32_t *counts, uint32_t space_id,
+		 uint32_t index_id, int iterator, uint32_t offset,
+		 uint32_t limit, const char *keys, uint32_t key_count);
+
 /** \cond public */
 
 /*
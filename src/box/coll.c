@@ -92,7 +92,34 @@ coll_icu_hash(const char *s, size_t s_len, uint32_t *ph, uint32_t *pcarry,
 }
 
 /**
- * Set up ICU collator and init cmp and hash members of collation.
+ * Get the first 8 bytes of an ICU sort key of a string packed
+ * into a big-endian integer. Sort keys are compared bytewise and
+ * never contain zero bytes, so zero padding of a short key keeps
+ * the order.
+ */
+static uint64_t
+coll_icu_hint(const char *s, size_t s_len, struct coll *coll)
+{
+	UCharIterator itr;
+	uiter_setUTF8(&itr, s, s_len);
+	uint8_t buf[sizeof(uint64_t)];
+	uint32_t state[2] = {0, 0};
+	UErrorCode status = U_ZERO_ERROR;
+	int32_t got = ucol_nextSortKeyPart(coll->icu.collator, &itr, state,
+					   buf, sizeof(buf), &status);
+	assert(!U_FAILURE(status));
+	uint64_t result = 0;
+	for (int32_t i = 0; i < (int32_t)sizeof(buf); i++) {
+		result <<= 8;
+		if (i < got)
+			result |= buf[i];
+	}
+	return result;
+}
+
+/**
+ * Set up ICU collator and init cmp, hash and hint members of
+ * collation.
  * @param coll - collation to set up.
  * @param def - collation definition.
  * @return 0 on success, -1 on error.
@@ -220,6 +247,7 @@ coll_icu_init_cmp(struct coll *coll, const struct coll_def *def)
 
 	coll->cmp = coll_icu_cmp;
 	coll->hash = coll_icu_hash;
+	coll->hint = coll_icu_hint;
 	return 0;
 }
 
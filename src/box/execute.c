@@ -42,6 +42,7 @@
 #include "schema.h"
 #include "port.h"
 #include "memtx_tuple.h"
+#include "sql_stmt_cache.h"
 
 const char *sql_type_strs[] = {
 	NULL,
@@ -262,12 +263,14 @@ error:
 
 	uint32_t map_size = mp_decode_map(&data);
 	request->sql_text = NULL;
+	request->stmt_id = 0;
 	request->bind = NULL;
 	request->bind_count = 0;
 	request->sync = row->sync;
 	for (uint32_t i = 0; i < map_size; ++i) {
 		uint8_t key = *data;
-		if (key != IPROTO_SQL_BIND && key != IPROTO_SQL_TEXT) {
+		if (key != IPROTO_SQL_BIND && key != IPROTO_SQL_TEXT &&
+		    key != IPROTO_STMT_ID) {
 			mp_check(&data, end);   /* skip the key */
 			mp_check(&data, end);   /* skip the value */
 			continue;
@@ -278,11 +281,23 @@ error:
 		if (key == IPROTO_SQL_BIND) {
 			if (sql_bind_list_decode(request, value, region) != 0)
 				return -1;
+		} else if (key == IPROTO_STMT_ID) {
+			if (mp_typeof(*value) != MP_UINT)
+				goto error;
+			uint64_t id = mp_decode_uint(&value);
+			if (id == 0 || id > UINT32_MAX)
+				goto error;
+			request->stmt_id = id;
 		} else {
+			if (mp_typeof(*value) != MP_STR)
+				goto error;
 			request->sql_text = value;
 		}
 	}
-	if (request->sql_text == NULL) {
+	if (request->sql_text != NULL && request->stmt_id != 0)
+		goto error;
+	if (request->sql_text == NULL &&
+	    (row->type == IPROTO_PREPARE || request->stmt_id == 0)) {
 		diag_set(ClientError, ER_MISSING_REQUEST_FIELD,
 			 iproto_key_name(IPROTO_SQL_TEXT));
 		return -1;
@@ -639,32 +654,76 @@ err_execute:
 	return -1;
 }
 
-int
-sql_prepare_and_execute(const struct sql_request *request, struct obuf *out,
-			struct region *region)
+/**
+ * Get the statement of the request from the prepared statement
+ * cache, by text or by id.
+ * @retval NULL Client or memory error.
+ */
+static struct sql_stmt *
+sql_request_stmt(sqlite3 *db, const struct sql_request *request)
 {
+	if (request->sql_text == NULL)
+		return sql_stmt_cache_acquire_by_id(db, request->stmt_id);
 	const char *sql = request->sql_text;
 	uint32_t len;
 	sql = mp_decode_str(&sql, &len);
-	struct sqlite3_stmt *stmt;
+	return sql_stmt_cache_acquire(db, sql, len);
+}
+
+int
+sql_prepare_and_execute(const struct sql_request *request, struct obuf *out,
+			struct region *region)
+{
 	sqlite3 *db = sql_get();
 	if (db == NULL) {
 		diag_set(ClientError, ER_LOADING);
 		return -1;
 	}
-	if (sqlite3_prepare_v2(db, sql, len, &stmt, NULL) != SQLITE_OK) {
-		diag_set(ClientError, ER_SQL_EXECUTE, sqlite3_errmsg(db));
+	struct sql_stmt *stmt = sql_request_stmt(db, request);
+	if (stmt == NULL)
 		return -1;
-	}
-	assert(stmt != NULL);
-	if (sql_bind(request, stmt) != 0)
+	if (sql_bind(request, stmt->vdbe) != 0)
 		goto err_stmt;
-	if (sql_execute_and_encode(db, stmt, out, request->sync,
+	if (sql_execute_and_encode(db, stmt->vdbe, out, request->sync,
 				   region) != 0)
 		goto err_stmt;
-	sqlite3_finalize(stmt);
+	sql_stmt_cache_release(stmt);
 	return 0;
 err_stmt:
-	sqlite3_finalize(stmt);
+	sql_stmt_cache_release(stmt);
+	return -1;
+}
+
+int
+sql_prepare(const struct sql_request *request, struct obuf *out)
+{
+	sqlite3 *db = sql_get();
+	if (db == NULL) {
+		diag_set(ClientError, ER_LOADING);
+		return -1;
+	}
+	struct sql_stmt *stmt = sql_request_stmt(db, request);
+	if (stmt == NULL)
+		return -1;
+	uint32_t id = stmt->id;
+	sql_stmt_cache_release(stmt);
+
+	struct obuf_svp header_svp;
+	if (iproto_prepare_header(out, &header_svp, IPROTO_SQL_HEADER_LEN) != 0)
+		return -1;
+	if (iproto_reply_map_key(out, 1, IPROTO_SQL_INFO) != 0)
+		goto err_body;
+	int size = mp_sizeof_uint(IPROTO_STMT_ID) + mp_sizeof_uint(id);
+	char *buf = obuf_alloc(out, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "obuf_alloc", "buf");
+		goto err_body;
+	}
+	buf = mp_encode_uint(buf, IPROTO_STMT_ID);
+	buf = mp_encode_uint(buf, id);
+	iproto_reply_sql(out, &header_svp, request->sync, schema_version, 1);
+	return 0;
+err_body:
+	obuf_rollback_to_svp(out, &header_svp);
 	return -1;
 }
@@ -43,11 +43,13 @@ struct region;
 struct sql_bind;
 struct xrow_header;
 
-/** EXECUTE request. */
+/** EXECUTE or PREPARE request. */
 struct sql_request {
 	uint64_t sync;
-	/** SQL statement text. */
+	/** SQL statement text. NULL if @stmt_id is set. */
 	const char *sql_text;
+	/** Id of a prepared statement, 0 if @sql_text is set. */
+	uint32_t stmt_id;
 	/** Array of parameters. */
 	struct sql_bind *bind;
 	/** Length of the @bind. */
@@ -55,7 +57,8 @@ struct sql_request {
 };
 
 /**
- * Parse the EXECUTE request.
+ * Parse the EXECUTE or PREPARE request. EXECUTE has either
+ * IPROTO_SQL_TEXT or IPROTO_STMT_ID, PREPARE has the text.
  * @param row Encoded data.
  * @param[out] request Request to decode to.
  * @param region Allocator.
@@ -69,7 +72,8 @@ xrow_decode_sql(const struct xrow_header *row, struct sql_request *request,
 
 /**
  * Prepare and execute an SQL statement and encode the response in
- * an iproto message.
+ * an iproto message. The statement is taken from the prepared
+ * statement cache, by its text or by id.
  * Response structure:
  * +----------------------------------------------+
  * | IPROTO_OK, sync, schema_version   ...        | iproto_header
@@ -107,6 +111,32 @@ int
 sql_prepare_and_execute(const struct sql_request *request, struct obuf *out,
 			struct region *region);
 
+/**
+ * Prepare an SQL statement, put it in the prepared statement
+ * cache and encode its id in an iproto message. The statement
+ * can be executed by the id until it is evicted from the cache,
+ * then EXECUTE fails with ER_SQL_STMT_NOT_FOUND and the statement
+ * must be prepared again.
+ * Response structure:
+ * +----------------------------------------------+
+ * | IPROTO_OK, sync, schema_version   ...        | iproto_header
+ * +----------------------------------------------+---------------
+ * | IPROTO_BODY: {                               |
+ * |     IPROTO_SQL_INFO: {                       | iproto_body
+ * |         IPROTO_STMT_ID: number               |
+ * |     }                                        |
+ * | }                                            |
+ * +----------------------------------------------+
+ *
+ * @param request IProto request.
+ * @param out Out buffer of the iproto message.
+ *
+ * @retval  0 Success.
+ * @retval -1 Client or memory error.
+ */
+int
+sql_prepare(const struct sql_request *request, struct obuf *out);
+
 #if defined(__cplusplus)
 } /* extern "C" { */
 #include "diag.h"
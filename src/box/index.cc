@@ -438,6 +438,7 @@ void
 iterator_create(struct iterator *it, struct index *index)
 {
 	it->next = NULL;
+	it->skip = NULL;
 	it->free = NULL;
 	it->schema_version = schema_version;
 	it->space_id = index->def->space_id;
@@ -466,6 +467,26 @@ invalidate:
 	return 0;
 }
 
+int
+iterator_skip(struct iterator *it, uint32_t count)
+{
+	struct tuple *tuple;
+	while (count > 0) {
+		/*
+		 * Let iterator_next() revalidate the iterator
+		 * if the schema has changed.
+		 */
+		if (it->skip != NULL && it->schema_version == schema_version)
+			return it->skip(it, count);
+		if (iterator_next(it, &tuple) != 0)
+			return -1;
+		if (tuple == NULL)
+			break;
+		count--;
+	}
+	return 0;
+}
+
 void
 iterator_delete(struct iterator *it)
 {
@@ -533,8 +554,7 @@ index_build(struct index *index, struct index *pk)
 	if (rc != 0)
 		return -1;
 
-	index_end_build(index);
-	return 0;
+	return index_end_build(index);
 }
 
 /* }}} */
@@ -669,9 +689,10 @@ generic_index_build_next(struct index *index, struct tuple *tuple)
 	return index_replace(index, NULL, tuple, DUP_INSERT, &unused);
 }
 
-void
+int
 generic_index_end_build(struct index *)
 {
+	return 0;
 }
 
 /* }}} */
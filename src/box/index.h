@@ -223,6 +223,12 @@ struct iterator {
 	 * Returns 0 on success, -1 on error.
 	 */
 	int (*next)(struct iterator *it, struct tuple **ret);
+	/**
+	 * Skip @count tuples. Optional: if not set, tuples
+	 * are skipped one by one with next().
+	 * Returns 0 on success, -1 on error.
+	 */
+	int (*skip)(struct iterator *it, uint32_t count);
 	/** Destroy the iterator. */
 	void (*free)(struct iterator *);
 	/** Schema version at the time of the last index lookup. */
@@ -258,6 +264,14 @@ iterator_create(struct iterator *it, struct index *index);
 int
 iterator_next(struct iterator *it, struct tuple **ret);
 
+/**
+ * Skip @count tuples, e.g. to apply an offset of a select.
+ * Skipping stops at EOF.
+ * Returns 0 on success, -1 on error.
+ */
+int
+iterator_skip(struct iterator *it, uint32_t count);
+
 /**
  * Destroy an iterator instance and free associated memory.
  */
@@ -385,7 +399,7 @@ struct index_vtab {
 	 */
 	int (*reserve)(struct index *index, uint32_t size_hint);
 	int (*build_next)(struct index *index, struct tuple *tuple);
-	void (*end_build)(struct index *index);
+	int (*end_build)(struct index *index);
 };
 
 struct index {
@@ -550,10 +564,10 @@ index_build_next(struct index *index, struct tuple *tuple)
 	return index->vtab->build_next(index, tuple);
 }
 
-static inline void
+static inline int
 index_end_build(struct index *index)
 {
-	index->vtab->end_build(index);
+	return index->vtab->end_build(index);
 }
 
 /*
@@ -575,7 +589,7 @@ void generic_index_info(struct index *, struct info_handler *);
 void generic_index_begin_build(struct index *);
 int generic_index_reserve(struct index *, uint32_t);
 int generic_index_build_next(struct index *, struct tuple *);
-void generic_index_end_build(struct index *);
+int generic_index_end_build(struct index *);
 
 #if defined(__cplusplus)
 } /* extern "C" */
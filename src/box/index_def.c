@@ -30,11 +30,14 @@
  */
 #include "index_def.h"
 #include "schema_def.h"
+#include "tuple_compare.h"
 
 const char *index_type_strs[] = { "HASH", "TREE", "BITSET", "RTREE" };
 
 const char *rtree_index_distance_type_strs[] = { "EUCLID", "MANHATTAN" };
 
+const char *compaction_policy_strs[] = { "tiered", "leveled" };
+
 const struct index_opts index_opts_default = {
 	/* .unique              = */ true,
 	/* .dimension           = */ 2,
@@ -43,7 +46,10 @@ const struct index_opts index_opts_default = {
 	/* .page_size           = */ 0,
 	/* .run_count_per_level = */ 2,
 	/* .run_size_ratio      = */ 3.5,
+	/* .compaction_policy   = */ COMPACTION_POLICY_TIERED,
 	/* .bloom_fpr           = */ 0.05,
+	/* .bloom_prefixes      = */ false,
+	/* .read_ahead          = */ 0,
 	/* .lsn                 = */ 0,
 	/* .sql                 = */ NULL,
 };
@@ -57,7 +63,11 @@ const struct opt_def index_opts_reg[] = {
 	OPT_DEF("page_size", OPT_INT64, struct index_opts, page_size),
 	OPT_DEF("run_count_per_level", OPT_INT64, struct index_opts, run_count_per_level),
 	OPT_DEF("run_size_ratio", OPT_FLOAT, struct index_opts, run_size_ratio),
+	OPT_DEF_ENUM("compaction_policy", compaction_policy, struct index_opts,
+		     compaction_policy, NULL),
 	OPT_DEF("bloom_fpr", OPT_FLOAT, struct index_opts, bloom_fpr),
+	OPT_DEF("bloom_prefixes", OPT_BOOL, struct index_opts, bloom_prefixes),
+	OPT_DEF("read_ahead", OPT_INT64, struct index_opts, read_ahead),
 	OPT_DEF("lsn", OPT_INT64, struct index_opts, lsn),
 	OPT_DEF("sql", OPT_STRPTR, struct index_opts, sql),
 	OPT_END,
@@ -207,6 +217,20 @@ index_def_change_requires_rebuild(const struct index_def *old_index_def,
 					  new_index_def->key_def->part_count)) {
 		return true;
 	}
+	/*
+	 * A tree index stores a hint calculated from the first
+	 * key part along with each tuple, see tuple_hint(). The
+	 * hint depends on the part type, so even a compatible
+	 * type change of the first part needs the index to be
+	 * rebuilt, otherwise old hints would be compared with
+	 * hints of the new type.
+	 */
+	if (old_index_def->type == TREE &&
+	    old_index_def->key_def->parts[0].type !=
+	    new_index_def->key_def->parts[0].type &&
+	    (key_def_has_hint(old_index_def->key_def) ||
+	     key_def_has_hint(new_index_def->key_def)))
+		return true;
 	if (old_index_def->type == RTREE) {
 		if (old_index_def->opts.dimension != new_index_def->opts.dimension
 		    || old_index_def->opts.distance != new_index_def->opts.distance)
@@ -58,6 +58,16 @@ enum rtree_index_distance_type {
 };
 extern const char *rtree_index_distance_type_strs[];
 
+/** Vinyl compaction policy, see vy_range_update_compact_priority(). */
+enum compaction_policy {
+	/* Up to run_count_per_level runs per level */
+	COMPACTION_POLICY_TIERED,
+	/* A single run per level */
+	COMPACTION_POLICY_LEVELED,
+	compaction_policy_MAX
+};
+extern const char *compaction_policy_strs[];
+
 /** Index options */
 struct index_opts {
 	/**
@@ -89,8 +99,24 @@ struct index_opts {
 	 * previous one.
 	 */
 	double run_size_ratio;
+	/**
+	 * The way runs are grouped into levels and picked
+	 * for compaction.
+	 */
+	enum compaction_policy compaction_policy;
 	/* Bloom filter false positive rate. */
 	double bloom_fpr;
+	/**
+	 * Build bloom filters for all key prefixes in addition
+	 * to full keys, so that EQ lookups by a partial key can
+	 * skip runs too.
+	 */
+	bool bloom_prefixes;
+	/**
+	 * Max number of pages a vinyl run iterator reads ahead
+	 * on a sequential scan, 0 disables read-ahead.
+	 */
+	int64_t read_ahead;
 	/**
 	 * LSN from the time of index creation.
 	 */
@@ -141,8 +167,14 @@ index_opts_cmp(const struct index_opts *o1, const struct index_opts *o2)
 		       -1 : 1;
 	if (o1->run_size_ratio != o2->run_size_ratio)
 		return o1->run_size_ratio < o2->run_size_ratio ? -1 : 1;
+	if (o1->compaction_policy != o2->compaction_policy)
+		return o1->compaction_policy < o2->compaction_policy ? -1 : 1;
 	if (o1->bloom_fpr != o2->bloom_fpr)
 		return o1->bloom_fpr < o2->bloom_fpr ? -1 : 1;
+	if (o1->bloom_prefixes != o2->bloom_prefixes)
+		return o1->bloom_prefixes < o2->bloom_prefixes ? -1 : 1;
+	if (o1->read_ahead != o2->read_ahead)
+		return o1->read_ahead < o2->read_ahead ? -1 : 1;
 	return 0;
 }
 
@@ -212,7 +244,8 @@ index_def_list_add(struct rlist *index_def_list, struct index_def *index_def)
  * metadata, so do not require a rebuild either.
  *
  * Finally, changing index type or number of parts always requires
- * a rebuild.
+ * a rebuild, as does changing the type of the first part of a
+ * tree index, which tuple hints are calculated from.
  */
 bool
 index_def_change_requires_rebuild(const struct index_def *old_index_def,
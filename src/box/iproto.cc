@@ -100,7 +100,7 @@ struct iproto_msg: public cmsg
 		struct call_request call;
 		/* Authentication request. */
 		struct auth_request auth;
-		/* SQL request, if this is the EXECUTE request. */
+		/* SQL request, if this is EXECUTE or PREPARE. */
 		struct sql_request sql;
 	};
 	/** Output buffer to write response and flush. */
@@ -123,52 +123,9 @@ struct iproto_msg: public cmsg
 	bool close_connection;
 };
 
-static struct mempool iproto_msg_pool;
-
-static struct iproto_msg *
-iproto_msg_new(struct iproto_connection *con)
-{
-	struct iproto_msg *msg =
-		(struct iproto_msg *) mempool_alloc_xc(&iproto_msg_pool);
-	msg->connection = con;
-	return msg;
-}
-
-/**
- * Resume stopped connections, if any.
- */
-static void
-iproto_resume();
-
-static void
-iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
-		  bool *stop_input);
-
-static inline void
-iproto_msg_delete(struct cmsg *msg)
-{
-	mempool_free(&iproto_msg_pool, msg);
-	iproto_resume();
-}
-
-/**
- * A single global queue for all requests in all connections. All
- * requests from all connections are processed concurrently.
- * Is also used as a queue for just established connections and to
- * execute disconnect triggers. A few notes about these triggers:
- * - they need to be run in a fiber
- * - unlike an ordinary request failure, on_connect trigger
- *   failure must lead to connection close.
- * - on_connect trigger must be processed before any other
- *   request on this connection.
- */
-static struct cpipe tx_pipe;
-static struct cpipe net_pipe;
 /* A pointer to the transaction processor cord. */
 struct cord *tx_cord;
 
-struct rmean *rmean_net;
-
 enum rmean_net_name {
 	IPROTO_SENT,
 	IPROTO_RECEIVED,
@@ -177,16 +134,86 @@ enum rmean_net_name {
 
 const char *rmean_net_strings[IPROTO_LAST] = { "SENT", "RECEIVED" };
 
+/**
+ * A network thread. Connections are accepted and served by
+ * all threads in parallel: each thread listens on its own
+ * socket bound to the same address with SO_REUSEPORT, so the
+ * kernel distributes incoming connections among them, see
+ * evio_service_attach(). Once accepted, a connection
+ * stays in its thread until it is closed, and all its
+ * messages travel between this thread and tx only.
+ */
+struct iproto_thread {
+	/** Thread number, from 0 to iproto_threads_count - 1. */
+	int id;
+	/** The cord running the thread event loop. */
+	struct cord net_cord;
+	/**
+	 * A single queue for all requests in all connections
+	 * of the thread. All requests from all connections are
+	 * processed concurrently.
+	 * Is also used as a queue for just established
+	 * connections and to execute disconnect triggers. A few
+	 * notes about these triggers:
+	 * - they need to be run in a fiber
+	 * - unlike an ordinary request failure, on_connect trigger
+	 *   failure must lead to connection close.
+	 * - on_connect trigger must be processed before any other
+	 *   request on this connection.
+	 */
+	struct cpipe tx_pipe;
+	/** A pipe from tx back to this thread. */
+	struct cpipe net_pipe;
+	/** Thread-local pools of messages and connections. */
+	struct mempool msg_pool;
+	struct mempool connection_pool;
+	/** Connections with input stopped by throttling. */
+	struct rlist stopped_connections;
+	/** Binary protocol listener. */
+	struct evio_service binary;
+	/** Network statistics of this thread. */
+	struct rmean *rmean;
+	/**
+	 * Message routes. Each route returns messages to the
+	 * thread they came from, so they are thread-specific.
+	 */
+	struct cmsg_hop disconnect_route[2];
+	struct cmsg_hop misc_route[2];
+	struct cmsg_hop select_route[2];
+	struct cmsg_hop select_multi_route[2];
+	struct cmsg_hop process1_route[2];
+	struct cmsg_hop sql_route[2];
+	const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX];
+	struct cmsg_hop join_route[2];
+	struct cmsg_hop subscribe_route[2];
+	struct cmsg_hop connect_route[2];
+};
+
+/** All network threads, allocated by iproto_init(). */
+static struct iproto_thread *iproto_threads;
+static int iproto_threads_count;
+
+/**
+ * The limit of requests in flight per thread, to keep the
+ * total limit for all threads at IPROTO_MSG_MAX.
+ */
+static int iproto_msg_max = IPROTO_MSG_MAX;
+
+static struct iproto_msg *
+iproto_msg_new(struct iproto_connection *con);
+
+/**
+ * Resume stopped connections, if any.
+ */
 static void
-tx_process_disconnect(struct cmsg *m);
+iproto_resume(struct iproto_thread *iproto_thread);
 
 static void
-net_finish_disconnect(struct cmsg *m);
+iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
+		  bool *stop_input);
 
-static const struct cmsg_hop disconnect_route[] = {
-	{ tx_process_disconnect, &net_pipe },
-	{ net_finish_disconnect, NULL },
-};
+static inline void
+iproto_msg_delete(struct cmsg *msg);
 
 /* }}} */
 
@@ -263,10 +290,28 @@ struct iproto_connection
 	/* Pre-allocated disconnect msg. */
 	struct iproto_msg *disconnect;
 	struct rlist in_stop_list;
+	/** The network thread serving the connection. */
+	struct iproto_thread *iproto_thread;
 };
 
-static struct mempool iproto_connection_pool;
-static RLIST_HEAD(stopped_connections);
+static struct iproto_msg *
+iproto_msg_new(struct iproto_connection *con)
+{
+	struct mempool *pool = &con->iproto_thread->msg_pool;
+	struct iproto_msg *msg =
+		(struct iproto_msg *) mempool_alloc_xc(pool);
+	msg->connection = con;
+	return msg;
+}
+
+static inline void
+iproto_msg_delete(struct cmsg *m)
+{
+	struct iproto_msg *msg = (struct iproto_msg *) m;
+	struct iproto_thread *iproto_thread = msg->connection->iproto_thread;
+	mempool_free(&iproto_thread->msg_pool, msg);
+	iproto_resume(iproto_thread);
+}
 
 /**
  * Return true if we have not enough spare messages
@@ -274,11 +319,12 @@ static RLIST_HEAD(stopped_connections);
  * discounted: they are mostly reserved and idle.
  */
 static inline bool
-iproto_must_stop_input()
+iproto_must_stop_input(struct iproto_thread *iproto_thread)
 {
-	size_t connection_count = mempool_count(&iproto_connection_pool);
-	size_t request_count = mempool_count(&iproto_msg_pool);
-	return request_count > connection_count + IPROTO_MSG_MAX;
+	size_t connection_count =
+		mempool_count(&iproto_thread->connection_pool);
+	size_t request_count = mempool_count(&iproto_thread->msg_pool);
+	return request_count > connection_count + iproto_msg_max;
 }
 
 /**
@@ -288,20 +334,20 @@ iproto_must_stop_input()
  * object in the message pool.
  */
 static void
-iproto_resume()
+iproto_resume(struct iproto_thread *iproto_thread)
 {
 	/*
 	 * Most of the time we have nothing to do here: throttling
 	 * is not active.
 	 */
-	if (rlist_empty(&stopped_connections))
+	if (rlist_empty(&iproto_thread->stopped_connections))
 		return;
-	if (iproto_must_stop_input())
+	if (iproto_must_stop_input(iproto_thread))
 		return;
 
 	struct iproto_connection *con;
-	con = rlist_first_entry(&stopped_connections, struct iproto_connection,
-				in_stop_list);
+	con = rlist_first_entry(&iproto_thread->stopped_connections,
+				struct iproto_connection, in_stop_list);
 	ev_feed_event(con->loop, &con->input, EV_READ);
 }
 
@@ -334,7 +380,8 @@ iproto_connection_stop(struct iproto_connection *con)
 		 sio_socketname(con->input.fd));
 	assert(rlist_empty(&con->in_stop_list));
 	ev_io_stop(con->loop, &con->input);
-	rlist_add_tail(&stopped_connections, &con->in_stop_list);
+	rlist_add_tail(&con->iproto_thread->stopped_connections,
+		       &con->in_stop_list);
 }
 
 /**
@@ -399,7 +446,7 @@ iproto_connection_close(struct iproto_connection *con)
 		assert(con->disconnect != NULL);
 		struct iproto_msg *msg = con->disconnect;
 		con->disconnect = NULL;
-		cpipe_push(&tx_pipe, msg);
+		cpipe_push(&con->iproto_thread->tx_pipe, msg);
 	}
 	rlist_del(&con->in_stop_list);
 }
@@ -526,6 +573,7 @@ static inline void
 iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 {
 	struct obuf *p_obuf = iproto_connection_output_by_input(con, con->p_ibuf);
+	struct cpipe *tx_pipe = &con->iproto_thread->tx_pipe;
 	int n_requests = 0;
 	bool stop_input = false;
 	while (con->parse_size && stop_input == false) {
@@ -555,7 +603,7 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 			 * This can't throw, but should not be
 			 * done in case of exception.
 			 */
-			cpipe_push_input(&tx_pipe, msg);
+			cpipe_push_input(tx_pipe, msg);
 			guard.is_active = false;
 			n_requests++;
 		} catch (Exception *e) {
@@ -621,7 +669,7 @@ iproto_enqueue_batch(struct iproto_connection *con, struct ibuf *in)
 		 */
 		ev_feed_event(con->loop, &con->input, EV_READ);
 	}
-	cpipe_flush_input(&tx_pipe);
+	cpipe_flush_input(tx_pipe);
 }
 
 static void
@@ -640,7 +688,7 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 		 * resume one more connection which might have
 		 * input.
 		 */
-		iproto_resume();
+		iproto_resume(con->iproto_thread);
 	}
 	/*
 	 * Throttle if there are too many pending requests,
@@ -649,7 +697,7 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 	 * another fiber waiting for write to complete).
 	 * Ignore iproto_connection->disconnect messages.
 	 */
-	if (iproto_must_stop_input()) {
+	if (iproto_must_stop_input(con->iproto_thread)) {
 		iproto_connection_stop(con);
 		return;
 	}
@@ -672,7 +720,7 @@ iproto_connection_on_input(ev_loop *loop, struct ev_io *watcher,
 			return;
 		}
 		/* Count statistics */
-		rmean_collect(rmean_net, IPROTO_RECEIVED, nrd);
+		rmean_collect(con->iproto_thread->rmean, IPROTO_RECEIVED, nrd);
 
 		/* Update the read position and connection state. */
 		in->wpos += nrd;
@@ -727,7 +775,7 @@ iproto_flush(struct iproto_connection *con)
 	ssize_t nwr = sio_writev(fd, iov, iovcnt);
 
 	/* Count statistics */
-	rmean_collect(rmean_net, IPROTO_SENT, nwr);
+	rmean_collect(con->iproto_thread->rmean, IPROTO_SENT, nwr);
 	if (nwr > 0) {
 		if (begin->used + nwr == end->used) {
 			if (ibuf_used(ibuf) == 0) {
@@ -780,10 +828,11 @@ iproto_connection_on_output(ev_loop *loop, struct ev_io *watcher,
 }
 
 static struct iproto_connection *
-iproto_connection_new(int fd)
+iproto_connection_new(struct iproto_thread *iproto_thread, int fd)
 {
 	struct iproto_connection *con = (struct iproto_connection *)
-		mempool_alloc_xc(&iproto_connection_pool);
+		mempool_alloc_xc(&iproto_thread->connection_pool);
+	con->iproto_thread = iproto_thread;
 	con->input.data = con->output.data = con;
 	con->loop = loop();
 	ev_io_init(&con->input, iproto_connection_on_input, fd, EV_READ);
@@ -798,7 +847,7 @@ iproto_connection_new(int fd)
 	rlist_create(&con->in_stop_list);
 	/* It may be very awkward to allocate at close. */
 	con->disconnect = iproto_msg_new(con);
-	cmsg_init(con->disconnect, disconnect_route);
+	cmsg_init(con->disconnect, iproto_thread->disconnect_route);
 	return con;
 }
 
@@ -822,7 +871,7 @@ iproto_connection_delete(struct iproto_connection *con)
 	       con->obuf[1].iov[0].iov_base == NULL);
 	if (con->disconnect)
 		iproto_msg_delete(con->disconnect);
-	mempool_free(&iproto_connection_pool, con);
+	mempool_free(&con->iproto_thread->connection_pool, con);
 }
 
 /* }}} iproto_connection */
@@ -838,6 +887,9 @@ tx_process1(struct cmsg *msg);
 static void
 tx_process_select(struct cmsg *msg);
 
+static void
+tx_process_select_multi(struct cmsg *msg);
+
 static void
 tx_process_sql(struct cmsg *msg);
 
@@ -856,51 +908,6 @@ net_end_join(struct cmsg *msg);
 static void
 net_end_subscribe(struct cmsg *msg);
 
-static const struct cmsg_hop misc_route[] = {
-	{ tx_process_misc, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop select_route[] = {
-	{ tx_process_select, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop process1_route[] = {
-	{ tx_process1, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop sql_route[] = {
-	{ tx_process_sql, &net_pipe },
-	{ net_send_msg, NULL },
-};
-
-static const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX] = {
-	NULL,                                   /* IPROTO_OK */
-	select_route,                           /* IPROTO_SELECT */
-	process1_route,                         /* IPROTO_INSERT */
-	process1_route,                         /* IPROTO_REPLACE */
-	process1_route,                         /* IPROTO_UPDATE */
-	process1_route,                         /* IPROTO_DELETE */
-	misc_route,                             /* IPROTO_CALL_16 */
-	misc_route,                             /* IPROTO_AUTH */
-	misc_route,                             /* IPROTO_EVAL */
-	process1_route,                         /* IPROTO_UPSERT */
-	misc_route,                             /* IPROTO_CALL */
-	sql_route,                              /* IPROTO_EXECUTE */
-};
-
-static const struct cmsg_hop join_route[] = {
-	{ tx_process_join_subscribe, &net_pipe },
-	{ net_end_join, NULL },
-};
-
-static const struct cmsg_hop subscribe_route[] = {
-	{ tx_process_join_subscribe, &net_pipe },
-	{ net_end_subscribe, NULL },
-};
-
 static void
 iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 		  bool *stop_input)
@@ -908,6 +915,7 @@ iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 	xrow_header_decode_xc(&msg->header, pos, reqend);
 	assert(*pos == reqend);
 	uint8_t type = msg->header.type;
+	struct iproto_thread *iproto_thread = msg->connection->iproto_thread;
 
 	/*
 	 * Parse request before putting it into the queue
@@ -923,33 +931,40 @@ iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 	case IPROTO_UPSERT:
 		xrow_decode_dml_xc(&msg->header, &msg->dml,
 				   dml_request_key_map(type));
-		assert(type < sizeof(dml_route)/sizeof(*dml_route));
-		cmsg_init(msg, dml_route[type]);
+		assert(type < IPROTO_TYPE_STAT_MAX);
+		cmsg_init(msg, iproto_thread->dml_route[type]);
+		break;
+	case IPROTO_SELECT_MULTI:
+		/* The same body as SELECT, but with many keys. */
+		xrow_decode_dml_xc(&msg->header, &msg->dml,
+				   dml_request_key_map(IPROTO_SELECT));
+		cmsg_init(msg, iproto_thread->dml_route[type]);
 		break;
 	case IPROTO_CALL_16:
 	case IPROTO_CALL:
 	case IPROTO_EVAL:
 		xrow_decode_call_xc(&msg->header, &msg->call);
-		cmsg_init(msg, misc_route);
+		cmsg_init(msg, iproto_thread->misc_route);
 		break;
 	case IPROTO_PING:
-		cmsg_init(msg, misc_route);
+		cmsg_init(msg, iproto_thread->misc_route);
 		break;
 	case IPROTO_JOIN:
-		cmsg_init(msg, join_route);
+		cmsg_init(msg, iproto_thread->join_route);
 		*stop_input = true;
 		break;
 	case IPROTO_SUBSCRIBE:
-		cmsg_init(msg, subscribe_route);
+		cmsg_init(msg, iproto_thread->subscribe_route);
 		*stop_input = true;
 		break;
 	case IPROTO_EXECUTE:
+	case IPROTO_PREPARE:
 		xrow_decode_sql_xc(&msg->header, &msg->sql, &fiber()->gc);
-		cmsg_init(msg, sql_route);
+		cmsg_init(msg, iproto_thread->sql_route);
 		break;
 	case IPROTO_AUTH:
 		xrow_decode_auth_xc(&msg->header, &msg->auth);
-		cmsg_init(msg, misc_route);
+		cmsg_init(msg, iproto_thread->misc_route);
 		break;
 	default:
 		tnt_raise(ClientError, ER_UNKNOWN_REQUEST_TYPE,
@@ -1010,9 +1025,14 @@ static void
 net_finish_disconnect(struct cmsg *m)
 {
 	struct iproto_msg *msg = (struct iproto_msg *) m;
-	/* Runs the trigger, which may yield. */
-	iproto_connection_delete(msg->connection);
+	struct iproto_connection *con = msg->connection;
+	/*
+	 * The message refers to the connection to find its
+	 * thread, so it must be deleted first.
+	 */
 	iproto_msg_delete(msg);
+	/* Runs the trigger, which may yield. */
+	iproto_connection_delete(con);
 }
 
 
@@ -1101,6 +1121,65 @@ error:
 	tx_reply_error(msg);
 }
 
+static void
+tx_process_select_multi(struct cmsg *m)
+{
+	struct iproto_msg *msg = (struct iproto_msg *) m;
+	struct obuf *out = msg->p_obuf;
+	struct obuf_svp svp;
+	struct port port;
+	struct request *req = &msg->dml;
+	const char *keys = req->key;
+	uint32_t key_count;
+	uint32_t *counts;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+
+	tx_fiber_init(msg->connection->session, msg->header.sync);
+
+	port_create(&port);
+	auto port_guard = make_scoped_guard([&](){
+		port_destroy(&port);
+		region_truncate(region, region_svp);
+	});
+
+	if (tx_check_schema(msg->header.schema_version))
+		goto error;
+
+	key_count = mp_decode_array(&keys);
+	/* Each key must be an array, like in SELECT. */
+	for (const char *key = keys; key < req->key_end; mp_next(&key)) {
+		if (mp_typeof(*key) != MP_ARRAY) {
+			diag_set(ClientError, ER_INVALID_MSGPACK,
+				 "SELECT_MULTI keys must be arrays");
+			goto error;
+		}
+	}
+	counts = (uint32_t *) region_alloc(region,
+					   key_count * sizeof(*counts));
+	if (counts == NULL) {
+		diag_set(OutOfMemory, key_count * sizeof(*counts),
+			 "region", "counts");
+		goto error;
+	}
+	if (box_select_multi(&port, counts, req->space_id, req->index_id,
+			     req->iterator, req->offset, req->limit,
+			     keys, key_count) != 0 ||
+	    iproto_prepare_select(out, &svp) != 0)
+		goto error;
+	if (port_dump_groups(&port, counts, key_count, out) != 0) {
+		/* Discard the prepared select. */
+		obuf_rollback_to_svp(out, &svp);
+		goto error;
+	}
+	iproto_reply_select(out, &svp, msg->header.sync, ::schema_version,
+			    key_count);
+	msg->write_end = obuf_create_svp(out);
+	return;
+error:
+	tx_reply_error(msg);
+}
+
 static void
 tx_process_misc(struct cmsg *m)
 {
@@ -1153,8 +1232,14 @@ tx_process_sql(struct cmsg *m)
 
 	if (tx_check_schema(msg->header.schema_version))
 		goto error;
-	assert(msg->header.type == IPROTO_EXECUTE);
-	if (sql_prepare_and_execute(&msg->sql, out, &fiber()->gc) == 0) {
+	int rc;
+	if (msg->header.type == IPROTO_PREPARE) {
+		rc = sql_prepare(&msg->sql, out);
+	} else {
+		assert(msg->header.type == IPROTO_EXECUTE);
+		rc = sql_prepare_and_execute(&msg->sql, out, &fiber()->gc);
+	}
+	if (rc == 0) {
 		msg->write_end = obuf_create_svp(out);
 		return;
 	}
@@ -1299,7 +1384,8 @@ net_send_greeting(struct cmsg *m)
 						 obuf_iovcnt(out));
 
 			/* Count statistics */
-			rmean_collect(rmean_net, IPROTO_SENT, nwr);
+			rmean_collect(con->iproto_thread->rmean,
+				      IPROTO_SENT, nwr);
 		} catch (Exception *e) {
 			e->log();
 		}
@@ -1320,101 +1406,184 @@ net_send_greeting(struct cmsg *m)
 	iproto_msg_delete(msg);
 }
 
-static const struct cmsg_hop connect_route[] = {
-	{ tx_process_connect, &net_pipe },
-	{ net_send_greeting, NULL },
-};
-
 /** }}} */
 
 /**
  * Create a connection and start input.
  */
 static void
-iproto_on_accept(struct evio_service * /* service */, int fd,
+iproto_on_accept(struct evio_service *service, int fd,
 		 struct sockaddr *addr, socklen_t addrlen)
 {
 	(void) addr;
 	(void) addrlen;
+	struct iproto_thread *iproto_thread =
+		(struct iproto_thread *) service->on_accept_param;
 	struct iproto_connection *con;
 
-	con = iproto_connection_new(fd);
+	con = iproto_connection_new(iproto_thread, fd);
 	/*
 	 * Ignore msg allocation failure - the queue size is
 	 * fixed so there is a limited number of msgs in
 	 * use, all stored in just a few blocks of the memory pool.
 	 */
 	struct iproto_msg *msg = iproto_msg_new(con);
-	cmsg_init(msg, connect_route);
+	cmsg_init(msg, iproto_thread->connect_route);
 	msg->p_ibuf = con->p_ibuf;
 	msg->p_obuf = iproto_connection_output_by_input(con, con->p_ibuf);
 	msg->close_connection = false;
-	cpipe_push(&tx_pipe, msg);
+	cpipe_push(&iproto_thread->tx_pipe, msg);
 }
 
-static struct evio_service binary; /* iproto binary listener */
+static void
+iproto_thread_init_routes(struct iproto_thread *iproto_thread)
+{
+	struct cpipe *net_pipe = &iproto_thread->net_pipe;
+
+	iproto_thread->disconnect_route[0] = { tx_process_disconnect, net_pipe };
+	iproto_thread->disconnect_route[1] = { net_finish_disconnect, NULL };
+	iproto_thread->misc_route[0] = { tx_process_misc, net_pipe };
+	iproto_thread->misc_route[1] = { net_send_msg, NULL };
+	iproto_thread->select_route[0] = { tx_process_select, net_pipe };
+	iproto_thread->select_route[1] = { net_send_msg, NULL };
+	iproto_thread->select_multi_route[0] =
+		{ tx_process_select_multi, net_pipe };
+	iproto_thread->select_multi_route[1] = { net_send_msg, NULL };
+	iproto_thread->process1_route[0] = { tx_process1, net_pipe };
+	iproto_thread->process1_route[1] = { net_send_msg, NULL };
+	iproto_thread->sql_route[0] = { tx_process_sql, net_pipe };
+	iproto_thread->sql_route[1] = { net_send_msg, NULL };
+	iproto_thread->join_route[0] = { tx_process_join_subscribe, net_pipe };
+	iproto_thread->join_route[1] = { net_end_join, NULL };
+	iproto_thread->subscribe_route[0] =
+		{ tx_process_join_subscribe, net_pipe };
+	iproto_thread->subscribe_route[1] = { net_end_subscribe, NULL };
+	iproto_thread->connect_route[0] = { tx_process_connect, net_pipe };
+	iproto_thread->connect_route[1] = { net_send_greeting, NULL };
+
+	const struct cmsg_hop **dml_route = iproto_thread->dml_route;
+	memset(dml_route, 0, sizeof(iproto_thread->dml_route));
+	dml_route[IPROTO_SELECT] = iproto_thread->select_route;
+	dml_route[IPROTO_INSERT] = iproto_thread->process1_route;
+	dml_route[IPROTO_REPLACE] = iproto_thread->process1_route;
+	dml_route[IPROTO_UPDATE] = iproto_thread->process1_route;
+	dml_route[IPROTO_DELETE] = iproto_thread->process1_route;
+	dml_route[IPROTO_CALL_16] = iproto_thread->misc_route;
+	dml_route[IPROTO_AUTH] = iproto_thread->misc_route;
+	dml_route[IPROTO_EVAL] = iproto_thread->misc_route;
+	dml_route[IPROTO_UPSERT] = iproto_thread->process1_route;
+	dml_route[IPROTO_CALL] = iproto_thread->misc_route;
+	dml_route[IPROTO_EXECUTE] = iproto_thread->sql_route;
+	dml_route[IPROTO_PREPARE] = iproto_thread->sql_route;
+	dml_route[IPROTO_SELECT_MULTI] = iproto_thread->select_multi_route;
+}
+
+/**
+ * Format the cbus endpoint name of a network thread.
+ * The first thread keeps the historical name "net".
+ */
+static void
+iproto_thread_endpoint_name(struct iproto_thread *iproto_thread,
+			    char *buf, size_t size)
+{
+	if (iproto_thread->id == 0)
+		snprintf(buf, size, "net");
+	else
+		snprintf(buf, size, "net%d", iproto_thread->id);
+}
 
 /**
  * The network io thread main function:
  * begin serving the message bus.
  */
 static int
-net_cord_f(va_list /* ap */)
+net_cord_f(va_list ap)
 {
+	struct iproto_thread *iproto_thread =
+		va_arg(ap, struct iproto_thread *);
 	/* Got to be called in every thread using iobuf */
 	iobuf_init();
-	mempool_create(&iproto_msg_pool, &cord()->slabc,
+	mempool_create(&iproto_thread->msg_pool, &cord()->slabc,
 		       sizeof(struct iproto_msg));
-	mempool_create(&iproto_connection_pool, &cord()->slabc,
+	mempool_create(&iproto_thread->connection_pool, &cord()->slabc,
 		       sizeof(struct iproto_connection));
+	rlist_create(&iproto_thread->stopped_connections);
 
-	evio_service_init(loop(), &binary, "binary",
-			  iproto_on_accept, NULL);
+	evio_service_init(loop(), &iproto_thread->binary, "binary",
+			  iproto_on_accept, iproto_thread);
 
 
 	/* Init statistics counter */
-	rmean_net = rmean_new(rmean_net_strings, IPROTO_LAST);
+	iproto_thread->rmean = rmean_new(rmean_net_strings, IPROTO_LAST);
 
-	if (rmean_net == NULL) {
+	if (iproto_thread->rmean == NULL) {
 		tnt_raise(OutOfMemory, sizeof(struct rmean),
 			  "rmean", "struct rmean");
 	}
 
+	char name[FIBER_NAME_MAX];
+	iproto_thread_endpoint_name(iproto_thread, name, sizeof(name));
 	struct cbus_endpoint endpoint;
 	/* Create "net" endpoint. */
-	cbus_endpoint_create(&endpoint, "net", fiber_schedule_cb, fiber());
+	cbus_endpoint_create(&endpoint, name, fiber_schedule_cb, fiber());
 	/* Create a pipe to "tx" thread. */
-	cpipe_create(&tx_pipe, "tx");
-	cpipe_set_max_input(&tx_pipe, IPROTO_MSG_MAX/2);
+	cpipe_create(&iproto_thread->tx_pipe, "tx");
+	cpipe_set_max_input(&iproto_thread->tx_pipe, iproto_msg_max / 2);
 	/* Process incomming messages. */
 	cbus_loop(&endpoint);
 
-	cpipe_destroy(&tx_pipe);
+	cpipe_destroy(&iproto_thread->tx_pipe);
 	/*
 	 * Nothing to do in the fiber so far, the service
 	 * will take care of creating events for incoming
 	 * connections.
 	 */
-	if (evio_service_is_active(&binary))
-		evio_service_stop(&binary);
+	if (evio_service_is_active(&iproto_thread->binary))
+		evio_service_stop(&iproto_thread->binary);
 
-	rmean_delete(rmean_net);
+	rmean_delete(iproto_thread->rmean);
 	return 0;
 }
 
-/** Initialize the iproto subsystem and start network io thread */
+/** Initialize the iproto subsystem and start network io threads */
 void
-iproto_init()
+iproto_init(int threads_count)
 {
+	assert(threads_count > 0 && threads_count <= IPROTO_THREADS_MAX);
 	tx_cord = cord();
 
-	static struct cord net_cord;
-	if (cord_costart(&net_cord, "iproto", net_cord_f, NULL))
-		panic("failed to initialize iproto thread");
-
-	/* Create a pipe to "net" thread. */
-	cpipe_create(&net_pipe, "net");
-	cpipe_set_max_input(&net_pipe, IPROTO_MSG_MAX/2);
+	iproto_threads = (struct iproto_thread *)
+		calloc(threads_count, sizeof(*iproto_threads));
+	if (iproto_threads == NULL)
+		panic("failed to allocate iproto threads");
+	iproto_threads_count = threads_count;
+	/*
+	 * Split the limit of messages in flight among threads
+	 * to keep the tx fiber pool from being depleted
+	 * regardless of the number of threads.
+	 */
+	iproto_msg_max = MAX(IPROTO_MSG_MAX / threads_count, 2);
+
+	for (int i = 0; i < threads_count; i++) {
+		struct iproto_thread *iproto_thread = &iproto_threads[i];
+		iproto_thread->id = i;
+		iproto_thread_init_routes(iproto_thread);
+
+		char name[FIBER_NAME_MAX];
+		if (threads_count == 1)
+			snprintf(name, sizeof(name), "iproto");
+		else
+			snprintf(name, sizeof(name), "iproto%d", i);
+		if (cord_costart(&iproto_thread->net_cord, name,
+				 net_cord_f, iproto_thread))
+			panic("failed to initialize iproto thread");
+
+		/* Create a pipe to "net" thread. */
+		iproto_thread_endpoint_name(iproto_thread, name, sizeof(name));
+		cpipe_create(&iproto_thread->net_pipe, name);
+		cpipe_set_max_input(&iproto_thread->net_pipe,
+				    iproto_msg_max / 2);
+	}
 }
 
 /**
@@ -1426,17 +1595,30 @@ iproto_init()
 struct iproto_bind_msg: public cbus_call_msg
 {
 	const char *uri;
+	struct iproto_thread *iproto_thread;
 };
 
+/**
+ * Stop the listener of a thread and, unless the new uri is
+ * NULL, bind it again. The first thread resolves and binds the
+ * uri, the rest bind to the address it got bound to.
+ */
 static int
 iproto_do_bind(struct cbus_call_msg *m)
 {
-	const char *uri  = ((struct iproto_bind_msg *) m)->uri;
+	struct iproto_bind_msg *msg = (struct iproto_bind_msg *) m;
+	struct iproto_thread *iproto_thread = msg->iproto_thread;
+	struct evio_service *binary = &iproto_thread->binary;
 	try {
-		if (evio_service_is_active(&binary))
-			evio_service_stop(&binary);
-		if (uri != NULL)
-			evio_service_bind(&binary, uri);
+		if (evio_service_is_active(binary))
+			evio_service_stop(binary);
+		if (msg->uri == NULL)
+			return 0;
+		if (iproto_thread->id == 0) {
+			binary->reuseport = iproto_threads_count > 1;
+			evio_service_bind(binary, msg->uri);
+		} else
+			evio_service_attach(binary, &iproto_threads[0].binary);
 	} catch (Exception *e) {
 		return -1;
 	}
@@ -1446,34 +1628,72 @@ iproto_do_bind(struct cbus_call_msg *m)
 static int
 iproto_do_listen(struct cbus_call_msg *m)
 {
-	(void) m;
+	struct iproto_bind_msg *msg = (struct iproto_bind_msg *) m;
+	struct evio_service *binary = &msg->iproto_thread->binary;
 	try {
-		if (evio_service_is_active(&binary))
-			evio_service_listen(&binary);
+		if (evio_service_is_active(binary))
+			evio_service_listen(binary);
 	} catch (Exception *e) {
 		return -1;
 	}
 	return 0;
 }
 
+/** Invoke a function in each network thread, in order. */
+static void
+iproto_send_to_all(struct iproto_bind_msg *msg, cbus_call_f func)
+{
+	for (int i = 0; i < iproto_threads_count; i++) {
+		struct iproto_thread *iproto_thread = &iproto_threads[i];
+		msg->iproto_thread = iproto_thread;
+		if (cbus_call(&iproto_thread->net_pipe,
+			      &iproto_thread->tx_pipe, msg, func,
+			      NULL, TIMEOUT_INFINITY))
+			diag_raise();
+	}
+}
+
 void
 iproto_bind(const char *uri)
 {
+	/* Declare static to avoid stack corruption on fiber cancel. */
 	static struct iproto_bind_msg m;
+	/*
+	 * Stop all listeners before binding the new address, so
+	 * that stopping a shared UNIX socket doesn't unlink the
+	 * freshly bound one.
+	 */
+	m.uri = NULL;
+	iproto_send_to_all(&m, iproto_do_bind);
+	if (uri == NULL)
+		return;
 	m.uri = uri;
-	if (cbus_call(&net_pipe, &tx_pipe, &m, iproto_do_bind,
-		      NULL, TIMEOUT_INFINITY))
-		diag_raise();
+	iproto_send_to_all(&m, iproto_do_bind);
 }
 
 void
 iproto_listen()
 {
 	/* Declare static to avoid stack corruption on fiber cancel. */
-	static struct cbus_call_msg m;
-	if (cbus_call(&net_pipe, &tx_pipe, &m, iproto_do_listen,
-		      NULL, TIMEOUT_INFINITY))
-		diag_raise();
+	static struct iproto_bind_msg m;
+	iproto_send_to_all(&m, iproto_do_listen);
+}
+
+int
+iproto_rmean_foreach(rmean_cb cb, void *cb_ctx)
+{
+	for (size_t i = 0; i < IPROTO_LAST; i++) {
+		int64_t rps = 0, total = 0;
+		for (int j = 0; j < iproto_threads_count; j++) {
+			struct rmean *rmean = iproto_threads[j].rmean;
+			rps += rmean_mean(rmean, i);
+			total += rmean_total(rmean, i);
+		}
+		int rc = cb(rmean_net_strings[i], rps, total, cb_ctx);
+		if (rc != 0)
+			return rc;
+	}
+	return 0;
 }
 
 /* vim: set foldmethod=marker */
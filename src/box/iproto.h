@@ -30,8 +30,23 @@
  * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
+#include "rmean.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+enum {
+	/** The maximal number of network threads. */
+	IPROTO_THREADS_MAX = 64,
+};
+
+/**
+ * Initialize the iproto subsystem and start the given
+ * number of network threads.
+ */
 void
-iproto_init();
+iproto_init(int threads_count);
 
 void
 iproto_bind(const char *uri);
@@ -39,4 +54,15 @@ iproto_bind(const char *uri);
 void
 iproto_listen();
 
+/**
+ * Iterate over network statistics (see rmean_foreach()),
+ * summed over all network threads.
+ */
+int
+iproto_rmean_foreach(rmean_cb cb, void *cb_ctx);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
 #endif
@@ -104,6 +104,8 @@ const char *iproto_type_strs[] =
 	"UPSERT",
 	"CALL",
 	"EXECUTE",
+	NULL, /* SELECT_MULTI, accounted as SELECT per key */
+	NULL, /* PREPARE */
 };
 
 #define bit(c) (1ULL<<IPROTO_##c)
@@ -191,6 +193,7 @@ const char *iproto_key_strs[IPROTO_KEY_MAX] = {
 	"SQL options",      /* 0x42 */
 	"SQL info",         /* 0x43 */
 	"SQL row count",    /* 0x44 */
+	"statement id",     /* 0x45 */
 };
 
 const char *vy_page_info_key_strs[VY_PAGE_INFO_KEY_MAX] = {
@@ -210,7 +213,8 @@ const char *vy_run_info_key_strs[VY_RUN_INFO_KEY_MAX] = {
 	"min lsn",
 	"max lsn",
 	"page count",
-	"bloom filter"
+	"bloom filter",
+	"prefix bloom filters"
 };
 
 const char *vy_row_index_key_strs[VY_ROW_INDEX_KEY_MAX] = {
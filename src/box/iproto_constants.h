@@ -112,6 +112,8 @@ enum iproto_key {
 	 */
 	IPROTO_SQL_INFO = 0x43,
 	IPROTO_SQL_ROW_COUNT = 0x44,
+	/** Id of a prepared SQL statement. */
+	IPROTO_STMT_ID = 0x45,
 	IPROTO_KEY_MAX
 };
 
@@ -176,6 +178,17 @@ enum iproto_type {
 	IPROTO_CALL = 10,
 	/** Execute an SQL statement. */
 	IPROTO_EXECUTE = 11,
+	/**
+	 * SELECT request with an array of keys in IPROTO_KEY,
+	 * returns an array of tuple arrays, one per key.
+	 */
+	IPROTO_SELECT_MULTI = 12,
+	/**
+	 * Prepare an SQL statement and put it in the statement
+	 * cache. Returns IPROTO_STMT_ID, which can be passed to
+	 * EXECUTE instead of IPROTO_SQL_TEXT.
+	 */
+	IPROTO_PREPARE = 13,
 	/** The maximum typecode used for box.stat() */
 	IPROTO_TYPE_STAT_MAX,
 
@@ -320,6 +333,8 @@ enum vy_run_info_key {
 	VY_RUN_INFO_PAGE_COUNT = 5,
 	/** Bloom filter for keys. */
 	VY_RUN_INFO_BLOOM = 6,
+	/** Bloom filters for key prefixes, shortest first. */
+	VY_RUN_INFO_PREFIX_BLOOM = 7,
 	/** The last key in this enum + 1 */
 	VY_RUN_INFO_KEY_MAX
 };
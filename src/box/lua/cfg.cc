@@ -154,6 +154,17 @@ lbox_cfg_set_snap_io_rate_limit(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_memtx_snapshot_threads(struct lua_State *L)
+{
+	try {
+		box_set_memtx_snapshot_threads();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_checkpoint_count(struct lua_State *L)
 {
@@ -209,6 +220,17 @@ lbox_cfg_set_vinyl_timeout(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_vinyl_page_cache(struct lua_State *L)
+{
+	try {
+		box_set_vinyl_page_cache();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_worker_pool_threads(struct lua_State *L)
 {
@@ -229,6 +251,28 @@ lbox_cfg_set_replication_timeout(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_replication_apply_batch_size(struct lua_State *L)
+{
+	try {
+		box_set_replication_apply_batch_size();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_sql_stmt_cache_size(struct lua_State *L)
+{
+	try {
+		box_set_sql_stmt_cache_size();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 void
 box_lua_cfg_init(struct lua_State *L)
 {
@@ -247,9 +291,14 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_checkpoint_count", lbox_cfg_set_checkpoint_count},
 		{"cfg_set_read_only", lbox_cfg_set_read_only},
 		{"cfg_set_memtx_max_tuple_size", lbox_cfg_set_memtx_max_tuple_size},
+		{"cfg_set_memtx_snapshot_threads", lbox_cfg_set_memtx_snapshot_threads},
 		{"cfg_set_vinyl_max_tuple_size", lbox_cfg_set_vinyl_max_tuple_size},
 		{"cfg_set_vinyl_timeout", lbox_cfg_set_vinyl_timeout},
+		{"cfg_set_vinyl_page_cache", lbox_cfg_set_vinyl_page_cache},
 		{"cfg_set_replication_timeout", lbox_cfg_set_replication_timeout},
+		{"cfg_set_replication_apply_batch_size",
+			lbox_cfg_set_replication_apply_batch_size},
+		{"cfg_set_sql_stmt_cache_size", lbox_cfg_set_sql_stmt_cache_size},
 		{NULL, NULL}
 	};
 
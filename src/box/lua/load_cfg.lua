@@ -12,6 +12,7 @@ local default_cfg = {
     memtx_memory        = 256 * 1024 *1024,
     memtx_min_tuple_size = 16,
     memtx_max_tuple_size = 1024 * 1024,
+    memtx_snapshot_threads = 1,
     slab_alloc_factor   = 1.05,
     work_dir            = nil,
     memtx_dir           = ".",
@@ -20,9 +21,11 @@ local default_cfg = {
     vinyl_dir           = '.',
     vinyl_memory        = 128 * 1024 * 1024,
     vinyl_cache         = 128 * 1024 * 1024,
+    vinyl_page_cache    = 0,
     vinyl_max_tuple_size = 1024 * 1024,
     vinyl_read_threads  = 1,
     vinyl_write_threads = 2,
+    vinyl_direct_io     = false,
     vinyl_timeout       = 60,
     vinyl_run_count_per_level = 2,
     vinyl_run_size_ratio      = 3.5,
@@ -31,6 +34,8 @@ local default_cfg = {
     vinyl_bloom_fpr           = 0.05,
     log                 = nil,
     log_nonblock        = true,
+    log_async           = false,
+    log_async_overflow  = "drop",
     log_level           = 5,
     log_format          = "plain",
     io_collect_interval = nil,
@@ -40,6 +45,11 @@ local default_cfg = {
     wal_mode            = "write",
     rows_per_wal        = 500000,
     wal_max_size        = 256 * 1024 * 1024,
+    wal_compress_level  = 3,
+    wal_compress_threshold = 2 * 1024,
+    wal_group_commit_window = 0,
+    wal_group_commit_max_size = 1024 * 1024,
+    wal_ring_size       = 16 * 1024 * 1024,
     wal_dir_rescan_delay= 2,
     force_recovery      = false,
     replication         = nil,
@@ -53,7 +63,10 @@ local default_cfg = {
     checkpoint_interval = 3600,
     checkpoint_count    = 2,
     worker_pool_threads = 4,
+    iproto_threads      = 1,
     replication_timeout = 1,
+    replication_apply_batch_size = 1,
+    sql_stmt_cache_size = 512,
 }
 
 -- types of available options
@@ -63,6 +76,7 @@ local template_cfg = {
     memtx_memory        = 'number',
     memtx_min_tuple_size  = 'number',
     memtx_max_tuple_size  = 'number',
+    memtx_snapshot_threads = 'number',
     slab_alloc_factor   = 'number',
     work_dir            = 'string',
     memtx_dir            = 'string',
@@ -70,9 +84,11 @@ local template_cfg = {
     vinyl_dir           = 'string',
     vinyl_memory        = 'number',
     vinyl_cache               = 'number',
+    vinyl_page_cache          = 'number',
     vinyl_max_tuple_size      = 'number',
     vinyl_read_threads        = 'number',
     vinyl_write_threads       = 'number',
+    vinyl_direct_io           = 'boolean',
     vinyl_timeout             = 'number',
     vinyl_run_count_per_level = 'number',
     vinyl_run_size_ratio      = 'number',
@@ -82,6 +98,8 @@ local template_cfg = {
 
     log              = 'string',
     log_nonblock     = 'boolean',
+    log_async        = 'boolean',
+    log_async_overflow  = 'string',
     log_level           = 'number',
     log_format          = 'string',
     io_collect_interval = 'number',
@@ -91,6 +109,11 @@ local template_cfg = {
     wal_mode            = 'string',
     rows_per_wal        = 'number',
     wal_max_size        = 'number',
+    wal_compress_level  = 'number',
+    wal_compress_threshold = 'number',
+    wal_group_commit_window = 'number',
+    wal_group_commit_max_size = 'number',
+    wal_ring_size       = 'number',
     wal_dir_rescan_delay= 'number',
     force_recovery      = 'boolean',
     replication         = 'string, number, table',
@@ -104,7 +127,10 @@ local template_cfg = {
     read_only           = 'boolean',
     hot_standby         = 'boolean',
     worker_pool_threads = 'number',
+    iproto_threads      = 'number',
     replication_timeout = 'number',
+    replication_apply_batch_size = 'number',
+    sql_stmt_cache_size = 'number',
 }
 
 local function normalize_uri(port)
@@ -159,8 +185,10 @@ local dynamic_cfg = {
     snap_io_rate_limit      = private.cfg_set_snap_io_rate_limit,
     read_only               = private.cfg_set_read_only,
     memtx_max_tuple_size    = private.cfg_set_memtx_max_tuple_size,
+    memtx_snapshot_threads  = private.cfg_set_memtx_snapshot_threads,
     vinyl_max_tuple_size    = private.cfg_set_vinyl_max_tuple_size,
     vinyl_timeout           = private.cfg_set_vinyl_timeout,
+    vinyl_page_cache        = private.cfg_set_vinyl_page_cache,
     checkpoint_count        = private.cfg_set_checkpoint_count,
     checkpoint_interval     = private.checkpoint_daemon.set_checkpoint_interval,
     worker_pool_threads     = private.cfg_set_worker_pool_threads,
@@ -171,6 +199,9 @@ local dynamic_cfg = {
     end,
     force_recovery          = function() end,
     replication_timeout     = private.cfg_set_replication_timeout,
+    replication_apply_batch_size =
+        private.cfg_set_replication_apply_batch_size,
+    sql_stmt_cache_size     = private.cfg_set_sql_stmt_cache_size,
 }
 
 local dynamic_cfg_skip_at_load = {
@@ -178,6 +209,8 @@ local dynamic_cfg_skip_at_load = {
     listen                  = true,
     replication             = true,
     replication_timeout     = true,
+    replication_apply_batch_size = true,
+    sql_stmt_cache_size     = true,
     wal_dir_rescan_delay    = true,
     custom_proc_title       = true,
     force_recovery          = true,
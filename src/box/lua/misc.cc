@@ -111,6 +111,66 @@ lbox_select(lua_State *L)
 	return 1; /* lua table with tuples */
 }
 
+static int
+lbox_select_multi(lua_State *L)
+{
+	if (lua_gettop(L) != 6 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2) ||
+	    !lua_isnumber(L, 3) || !lua_isnumber(L, 4) || !lua_isnumber(L, 5) ||
+	    !lua_istable(L, 6)) {
+		return luaL_error(L, "Usage index:select_multi(iterator, "
+				  "offset, limit, keys)");
+	}
+
+	uint32_t space_id = lua_tonumber(L, 1);
+	uint32_t index_id = lua_tonumber(L, 2);
+	int iterator = lua_tonumber(L, 3);
+	uint32_t offset = lua_tonumber(L, 4);
+	uint32_t limit = lua_tonumber(L, 5);
+	uint32_t key_count = lua_objlen(L, 6);
+
+	struct region *gc = &fiber()->gc;
+	size_t region_svp = region_used(gc);
+	struct mpstream stream;
+	mpstream_init(&stream, gc, region_reserve_cb, region_alloc_cb,
+		      luamp_error, L);
+	for (uint32_t i = 0; i < key_count; i++) {
+		lua_rawgeti(L, 6, i + 1);
+		luamp_convert_key(L, luaL_msgpack_default, &stream,
+				  lua_gettop(L));
+		lua_pop(L, 1);
+	}
+	mpstream_flush(&stream);
+	size_t keys_len = region_used(gc) - region_svp;
+	const char *keys = (const char *) region_join_xc(gc, keys_len);
+	uint32_t *counts = (uint32_t *)
+		region_alloc_xc(gc, key_count * sizeof(*counts));
+
+	struct port port;
+	port_create(&port);
+	if (box_select_multi(&port, counts, space_id, index_id, iterator,
+			     offset, limit, keys, key_count) != 0) {
+		port_destroy(&port);
+		region_truncate(gc, region_svp);
+		return luaT_error(L);
+	}
+
+	/* See the comment in lbox_select() on the port leak. */
+	lua_createtable(L, key_count, 0);
+	struct port_entry *entry = port.first;
+	for (uint32_t i = 0; i < key_count; i++) {
+		lua_createtable(L, counts[i], 0);
+		for (uint32_t j = 0; j < counts[i]; j++) {
+			luaT_pushtuple(L, entry->tuple);
+			lua_rawseti(L, -2, j + 1);
+			entry = entry->next;
+		}
+		lua_rawseti(L, -2, i + 1);
+	}
+	port_destroy(&port);
+	region_truncate(gc, region_svp);
+	return 1; /* lua table with a table of tuples per key */
+}
+
 /* }}} */
 
 void
@@ -118,6 +178,7 @@ box_lua_misc_init(struct lua_State *L)
 {
 	static const struct luaL_Reg boxlib_internal[] = {
 		{"select", lbox_select},
+		{"select_multi", lbox_select_multi},
 		{NULL, NULL}
 	};
 
@@ -268,6 +268,50 @@ netbox_encode_select(lua_State *L)
 	return 0;
 }
 
+static int
+netbox_encode_select_multi(lua_State *L)
+{
+	if (lua_gettop(L) < 9 || !lua_istable(L, 9))
+		return luaL_error(L, "Usage netbox.encode_select_multi(ibuf, "
+				  "sync, schema_version, space_id, index_id, "
+				  "iterator, offset, limit, keys)");
+
+	struct mpstream stream;
+	size_t svp = netbox_prepare_request(L, &stream, IPROTO_SELECT_MULTI);
+
+	luamp_encode_map(cfg, &stream, 6);
+
+	uint32_t space_id = lua_tonumber(L, 4);
+	uint32_t index_id = lua_tonumber(L, 5);
+	int iterator = lua_tointeger(L, 6);
+	uint32_t offset = lua_tonumber(L, 7);
+	uint32_t limit = lua_tonumber(L, 8);
+
+	luamp_encode_uint(cfg, &stream, IPROTO_SPACE_ID);
+	luamp_encode_uint(cfg, &stream, space_id);
+	luamp_encode_uint(cfg, &stream, IPROTO_INDEX_ID);
+	luamp_encode_uint(cfg, &stream, index_id);
+	luamp_encode_uint(cfg, &stream, IPROTO_ITERATOR);
+	luamp_encode_uint(cfg, &stream, iterator);
+	luamp_encode_uint(cfg, &stream, IPROTO_OFFSET);
+	luamp_encode_uint(cfg, &stream, offset);
+	luamp_encode_uint(cfg, &stream, IPROTO_LIMIT);
+	luamp_encode_uint(cfg, &stream, limit);
+
+	/* encode keys: an array of keys */
+	uint32_t key_count = lua_objlen(L, 9);
+	luamp_encode_uint(cfg, &stream, IPROTO_KEY);
+	luamp_encode_array(cfg, &stream, key_count);
+	for (uint32_t i = 0; i < key_count; i++) {
+		lua_rawgeti(L, 9, i + 1);
+		luamp_convert_key(L, cfg, &stream, lua_gettop(L));
+		lua_pop(L, 1);
+	}
+
+	netbox_encode_request(&stream, svp);
+	return 0;
+}
+
 static inline int
 netbox_encode_insert_or_replace(lua_State *L, uint32_t reqtype)
 {
@@ -566,10 +610,16 @@ netbox_encode_execute(lua_State *L)
 
 	luamp_encode_map(cfg, &stream, 3);
 
-	size_t len;
-	const char *query = lua_tolstring(L, 4, &len);
-	luamp_encode_uint(cfg, &stream, IPROTO_SQL_TEXT);
-	luamp_encode_str(cfg, &stream, query, len);
+	if (lua_type(L, 4) == LUA_TNUMBER) {
+		/* Id of a prepared statement. */
+		luamp_encode_uint(cfg, &stream, IPROTO_STMT_ID);
+		luamp_encode_uint(cfg, &stream, lua_tointeger(L, 4));
+	} else {
+		size_t len;
+		const char *query = lua_tolstring(L, 4, &len);
+		luamp_encode_uint(cfg, &stream, IPROTO_SQL_TEXT);
+		luamp_encode_str(cfg, &stream, query, len);
+	}
 
 	luamp_encode_uint(cfg, &stream, IPROTO_SQL_BIND);
 	luamp_encode_tuple(L, cfg, &stream, 5);
@@ -581,6 +631,26 @@ netbox_encode_execute(lua_State *L)
 	return 0;
 }
 
+static int
+netbox_encode_prepare(lua_State *L)
+{
+	if (lua_gettop(L) < 4)
+		return luaL_error(L, "Usage: netbox.encode_prepare(ibuf, "\
+				  "sync, schema_version, query)");
+	struct mpstream stream;
+	size_t svp = netbox_prepare_request(L, &stream, IPROTO_PREPARE);
+
+	luamp_encode_map(cfg, &stream, 1);
+
+	size_t len;
+	const char *query = lua_tolstring(L, 4, &len);
+	luamp_encode_uint(cfg, &stream, IPROTO_SQL_TEXT);
+	luamp_encode_str(cfg, &stream, query, len);
+
+	netbox_encode_request(&stream, svp);
+	return 0;
+}
+
 int
 luaopen_net_box(struct lua_State *L)
 {
@@ -590,12 +660,14 @@ luaopen_net_box(struct lua_State *L)
 		{ "encode_call",    netbox_encode_call },
 		{ "encode_eval",    netbox_encode_eval },
 		{ "encode_select",  netbox_encode_select },
+		{ "encode_select_multi", netbox_encode_select_multi },
 		{ "encode_insert",  netbox_encode_insert },
 		{ "encode_replace", netbox_encode_replace },
 		{ "encode_delete",  netbox_encode_delete },
 		{ "encode_update",  netbox_encode_update },
 		{ "encode_upsert",  netbox_encode_upsert },
 		{ "encode_execute", netbox_encode_execute},
+		{ "encode_prepare", netbox_encode_prepare},
 		{ "encode_auth",    netbox_encode_auth },
 		{ "decode_greeting",netbox_decode_greeting },
 		{ "communicate",    netbox_communicate },
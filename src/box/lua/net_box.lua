@@ -39,6 +39,7 @@ local IPROTO_SCHEMA_VERSION_KEY = 0x05
 local IPROTO_METADATA_KEY = 0x32
 local IPROTO_SQL_INFO_KEY = 0x43
 local IPROTO_SQL_ROW_COUNT_KEY = 0x44
+local IPROTO_STMT_ID_KEY = 0x45
 local IPROTO_FIELD_NAME_KEY = 0x29
 local IPROTO_DATA_KEY      = 0x30
 local IPROTO_ERROR_KEY     = 0x31
@@ -64,7 +65,9 @@ local method_codec           = {
     update  = internal.encode_update,
     upsert  = internal.encode_upsert,
     select  = internal.encode_select,
+    select_multi = internal.encode_select_multi,
     execute = internal.encode_execute,
+    prepare = internal.encode_prepare,
     -- inject raw data into connection, used by console and tests
     inject = function(buf, id, schema_version, bytes)
         local ptr = buf:reserve(#bytes)
@@ -760,7 +763,16 @@ function remote_methods:_request(method, opts, ...)
         elseif not err then
             setmetatable(res, sequence_mt)
             local postproc = method ~= 'eval' and method ~= 'call_17'
-            if postproc then
+            if method == 'select_multi' then
+                -- an array of tuples per key
+                local tnew = box.tuple.new
+                for _, tuples in pairs(res) do
+                    setmetatable(tuples, sequence_mt)
+                    for i, v in pairs(tuples) do
+                        tuples[i] = tnew(v)
+                    end
+                end
+            elseif postproc then
                 local tnew = box.tuple.new
                 for i, v in pairs(res) do
                     res[i] = tnew(v)
@@ -855,6 +867,19 @@ function remote_methods:execute(query, parameters, sql_opts, netbox_opts)
     return {metadata = metadata, rows = res}
 end
 
+function remote_methods:prepare(query, netbox_opts)
+    check_remote_arg(self, "prepare")
+    local timeout = self:request_timeout(netbox_opts)
+    local err, res, metadata, info = self._transport.perform_request(timeout,
+                                    nil, 'prepare', self.schema_version,
+                                    query)
+    if err then
+        box.error({code = err, reason = res})
+    end
+    assert(info ~= nil and info[IPROTO_STMT_ID_KEY] ~= nil)
+    return info[IPROTO_STMT_ID_KEY]
+end
+
 function remote_methods:wait_state(state, timeout)
     check_remote_arg(self, 'wait_state')
     if timeout == nil then
@@ -1024,6 +1049,11 @@ space_metatable = function(remote)
         return check_primary_index(self):select(key, opts)
     end
 
+    function methods:select_multi(keys, opts)
+        check_space_arg(self, 'select_multi')
+        return check_primary_index(self):select_multi(keys, opts)
+    end
+
     function methods:delete(key, opts)
         check_space_arg(self, 'delete')
         return check_primary_index(self):delete(key, opts)
@@ -1070,6 +1100,19 @@ index_metatable = function(remote)
                                iterator, offset, limit, key)
     end
 
+    function methods:select_multi(keys, opts)
+        check_index_arg(self, 'select_multi')
+        if type(keys) ~= 'table' then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "Usage: index:select_multi({key, ...}, opts)")
+        end
+        local iterator = check_iterator_type(opts, false)
+        local offset = tonumber(opts and opts.offset) or 0
+        local limit = tonumber(opts and opts.limit) or 0xFFFFFFFF
+        return remote:_request('select_multi', opts, self.space.id, self.id,
+                               iterator, offset, limit, keys)
+    end
+
     function methods:get(key, opts)
         check_index_arg(self, 'get')
         if opts and opts.buffer then
@@ -607,9 +607,12 @@ local index_options = {
     distance = 'string',
     run_count_per_level = 'number',
     run_size_ratio = 'number',
+    compaction_policy = 'string',
     range_size = 'number',
     page_size = 'number',
     bloom_fpr = 'number',
+    bloom_prefixes = 'boolean',
+    read_ahead = 'number',
 }
 
 --
@@ -700,7 +703,10 @@ box.schema.index.create = function(space_id, name, options)
             range_size = options.range_size,
             run_count_per_level = options.run_count_per_level,
             run_size_ratio = options.run_size_ratio,
+            compaction_policy = options.compaction_policy,
             bloom_fpr = options.bloom_fpr,
+            bloom_prefixes = options.bloom_prefixes,
+            read_ahead = options.read_ahead,
     }
     local field_type_aliases = {
         num = 'unsigned'; -- Deprecated since 1.7.2
@@ -1232,6 +1238,17 @@ function box.schema.space.bless(space)
             offset, limit, key)
     end
 
+    index_mt.select_multi = function(index, keys, opts)
+        check_index_arg(index, 'select_multi')
+        if type(keys) ~= 'table' then
+            box.error(box.error.ILLEGAL_PARAMS,
+                      "Usage: index:select_multi({key, ...}, opts)")
+        end
+        local iterator, offset, limit = check_select_opts(opts, false)
+        return internal.select_multi(index.space_id, index.id, iterator,
+            offset, limit, keys)
+    end
+
     index_mt.update = function(index, key, ops)
         check_index_arg(index, 'update')
         return internal.update(index.space_id, index.id, keify(key), ops);
@@ -1311,6 +1328,10 @@ function box.schema.space.bless(space)
         check_space_arg(space, 'select')
         return check_primary_index(space):select(key, opts)
     end
+    space_mt.select_multi = function(space, keys, opts)
+        check_space_arg(space, 'select_multi')
+        return check_primary_index(space):select_multi(keys, opts)
+    end
     space_mt.insert = function(space, tuple)
         check_space_arg(space, 'insert')
         return internal.insert(space.id, tuple);
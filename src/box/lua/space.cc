@@ -237,9 +237,19 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 			lua_pushnumber(L, index_opts->run_size_ratio);
 			lua_setfield(L, -2, "run_size_ratio");
 
+			lua_pushstring(L, compaction_policy_strs[
+					index_opts->compaction_policy]);
+			lua_setfield(L, -2, "compaction_policy");
+
 			lua_pushnumber(L, index_opts->bloom_fpr);
 			lua_setfield(L, -2, "bloom_fpr");
 
+			lua_pushboolean(L, index_opts->bloom_prefixes);
+			lua_setfield(L, -2, "bloom_prefixes");
+
+			lua_pushnumber(L, index_opts->read_ahead);
+			lua_setfield(L, -2, "read_ahead");
+
 			lua_settable(L, -3);
 		}
 
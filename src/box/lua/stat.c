@@ -39,11 +39,15 @@
 #include <lualib.h>
 
 #include "lua/utils.h"
+#include "say.h"
+#include "box/iproto.h"
+#include "box/info.h"
+#include "box/wal.h"
+#include "box/sql_stmt_cache.h"
+#include "box/lua/info.h"
 
 extern struct rmean *rmean_box;
 extern struct rmean *rmean_error;
-/** network statistics (iproto & cbus) */
-extern struct rmean *rmean_net;
 extern struct rmean *rmean_tx_wal_bus;
 
 static void
@@ -113,14 +117,42 @@ static int
 lbox_stat_net_index(struct lua_State *L)
 {
 	luaL_checkstring(L, -1);
-	return rmean_foreach(rmean_net, seek_stat_item, L);
+	return iproto_rmean_foreach(seek_stat_item, L);
 }
 
 static int
 lbox_stat_net_call(struct lua_State *L)
 {
 	lua_newtable(L);
-	rmean_foreach(rmean_net, set_stat_item, L);
+	iproto_rmean_foreach(set_stat_item, L);
+	return 1;
+}
+
+static int
+lbox_stat_wal(struct lua_State *L)
+{
+	struct info_handler h;
+	luaT_info_handler_create(&h, L);
+	wal_stat(&h);
+	return 1;
+}
+
+static int
+lbox_stat_sql(struct lua_State *L)
+{
+	struct info_handler h;
+	luaT_info_handler_create(&h, L);
+	sql_stmt_cache_stat(&h);
+	return 1;
+}
+
+static int
+lbox_stat_log(struct lua_State *L)
+{
+	lua_newtable(L);
+	lua_pushstring(L, "dropped");
+	luaL_pushint64(L, say_logger_dropped());
+	lua_settable(L, -3);
 	return 1;
 }
 
@@ -143,8 +175,14 @@ box_lua_stat_init(struct lua_State *L)
 	static const struct luaL_Reg statlib [] = {
 		{NULL, NULL}
 	};
+	static const struct luaL_Reg lbox_stat_lib [] = {
+		{"wal", lbox_stat_wal},
+		{"sql", lbox_stat_sql},
+		{"log", lbox_stat_log},
+		{NULL, NULL}
+	};
 
-	luaL_register_module(L, "box.stat", statlib);
+	luaL_register_module(L, "box.stat", lbox_stat_lib);
 
 	lua_newtable(L);
 	luaL_register(L, NULL, lbox_stat_meta);
@@ -32,6 +32,8 @@
 #include "memtx_space.h"
 #include "memtx_tuple.h"
 
+#include <ctype.h>
+#include <dirent.h>
 #include <small/mempool.h>
 
 #include "coio_file.h"
@@ -45,6 +47,8 @@
 #include "replication.h"
 #include "schema.h"
 #include "gc.h"
+#include "cbus.h"
+#include "fiber_cond.h"
 
 /** For all memory used by all indexes.
  * If you decide to use memtx_index_arena or
@@ -83,11 +87,63 @@ memtx_end_build_primary_key(struct space *space, void *param)
 	    memtx_space->replace == memtx_space_replace_all_keys)
 		return 0;
 
-	index_end_build(space->index[0]);
+	if (index_end_build(space->index[0]) != 0)
+		return -1;
 	memtx_space->replace = memtx_space_replace_primary_key;
 	return 0;
 }
 
+static int
+memtx_build_secondary_key_f(va_list ap)
+{
+	struct index *index = va_arg(ap, struct index *);
+	struct index *pk = va_arg(ap, struct index *);
+	return index_build(index, pk);
+}
+
+/**
+ * Build all secondary indexes of a space, each in its own fiber.
+ * Filling a build array and building the tree happen in tx, but
+ * sorting, which takes most of the time, is done in a coio
+ * thread (see memtx_tree_index_end_build()), so while one index
+ * is being sorted, tx proceeds to the next one.
+ */
+static int
+memtx_build_secondary_keys_parallel(struct space *space)
+{
+	struct index *pk = space->index[0];
+	struct fiber *fibers[BOX_INDEX_MAX];
+	uint32_t fiber_count = 0;
+	/* The first error is reported, the rest are ignored. */
+	struct diag diag;
+	diag_create(&diag);
+	int rc = 0;
+	for (uint32_t j = 1; j < space->index_count; j++) {
+		struct fiber *f = fiber_new("memtx_build",
+					    memtx_build_secondary_key_f);
+		if (f == NULL) {
+			diag_move(diag_get(), &diag);
+			rc = -1;
+			break;
+		}
+		fiber_set_joinable(f, true);
+		fiber_start(f, space->index[j], pk);
+		fibers[fiber_count++] = f;
+	}
+	/* Join all started fibers, even if some of them failed. */
+	for (uint32_t i = 0; i < fiber_count; i++) {
+		if (fiber_join(fibers[i]) == 0)
+			continue;
+		if (rc == 0)
+			diag_move(diag_get(), &diag);
+		rc = -1;
+	}
+	if (rc != 0)
+		diag_move(&diag, diag_get());
+	diag_destroy(&diag);
+	return rc;
+}
+
 /**
  * Secondary indexes are built in bulk after all data is
  * recovered. This function enables secondary keys on a space.
@@ -112,10 +168,8 @@ memtx_build_secondary_keys(struct space *space, void *param)
 				 space_name(space));
 		}
 
-		for (uint32_t j = 1; j < space->index_count; j++) {
-			if (index_build(space->index[j], pk) < 0)
-				return -1;
-		}
+		if (memtx_build_secondary_keys_parallel(space) != 0)
+			return -1;
 
 		if (n_tuples > 0) {
 			say_info("Space '%s': done", space_name(space));
@@ -142,47 +196,442 @@ memtx_engine_shutdown(struct engine *engine)
 	memtx_tuple_free();
 }
 
+/* {{{ Snapshot reader */
+
+enum {
+	/** Max number of rows passed to tx in one batch. */
+	MEMTX_SNAP_BATCH_ROWS = 4096,
+	/** Initial size of the buffer for row bodies of a batch. */
+	MEMTX_SNAP_BATCH_DATA_SIZE = 4 * 1024 * 1024,
+	/** Number of batches circulating between tx and the reader. */
+	MEMTX_SNAP_BATCH_COUNT = 2,
+};
+
+/**
+ * Snapshot recovery is pipelined: a reader thread does file
+ * I/O, decompression and decoding of rows, while tx only
+ * allocates tuples and inserts them into the primary key.
+ * Rows are passed to tx in batches: while tx is applying one
+ * batch, the reader is filling the next one.
+ */
+struct memtx_snap_reader {
+	/** Thread that reads the snapshot. */
+	struct cord cord;
+	/** Pipe from tx to the reader thread. */
+	struct cpipe reader_pipe;
+	/** Pipe from the reader thread to tx. */
+	struct cpipe tx_pipe;
+	/** Route of a batch: fill in the reader, return to tx. */
+	struct cmsg_hop batch_route[2];
+	/** Signalled whenever a batch is returned to tx. */
+	struct fiber_cond batch_cond;
+	/** Snapshot file name. */
+	char filename[PATH_MAX];
+	/** Skip rows that can't be decoded. */
+	bool force_recovery;
+	/**
+	 * Snapshot cursor. It is opened on the first read and
+	 * closed on exit from the reader thread so that all its
+	 * buffers are allocated from the reader's slab cache.
+	 */
+	struct xlog_cursor cursor;
+	/** Set if the cursor has been opened. */
+	bool is_open;
+	/** Set once EOF is reached or a read error occurs. */
+	bool is_done;
+	/**
+	 * Set if the last row returned by the cursor didn't fit
+	 * in a batch. The row stays valid until the cursor is
+	 * advanced, so it goes first to the next batch.
+	 */
+	bool has_pending;
+	/** The row that didn't fit in a batch. */
+	struct xrow_header pending;
+};
+
+/** A decoded snapshot row. */
+struct memtx_snap_row {
+	struct xrow_header row;
+	struct request request;
+};
+
+/** A batch of decoded snapshot rows. */
+struct memtx_snap_batch {
+	struct cmsg base;
+	struct memtx_snap_reader *reader;
+	/** Set when the batch is back in tx. */
+	bool is_ready;
+	/** Set if there are no more rows to read. */
+	bool is_eof;
+	/** -1 if reading failed, see diag. */
+	int rc;
+	/** Read error. */
+	struct diag diag;
+	/** Buffer for row bodies, rows point into it. */
+	char *data;
+	size_t data_size;
+	size_t data_capacity;
+	/** Number of rows in the batch. */
+	int row_count;
+	struct memtx_snap_row rows[MEMTX_SNAP_BATCH_ROWS];
+};
+
 static int
-memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
-				  struct xrow_header *row);
+memtx_snap_row_decode(struct memtx_snap_row *r)
+{
+	assert(r->row.bodycnt == 1); /* always 1 for read */
+	if (r->row.type != IPROTO_INSERT) {
+		diag_set(ClientError, ER_UNKNOWN_REQUEST_TYPE,
+			 (uint32_t) r->row.type);
+		return -1;
+	}
+	if (xrow_decode_dml(&r->row, &r->request,
+			    dml_request_key_map(IPROTO_INSERT)) != 0)
+		return -1;
+	return 0;
+}
 
-int
-memtx_engine_recover_snapshot(struct memtx_engine *memtx,
-			      const struct vclock *vclock)
+/**
+ * Append the next row to a batch.
+ * @retval  0 the row was appended or skipped
+ * @retval  1 the batch is full or there are no more rows
+ * @retval -1 error, see diag
+ */
+static int
+memtx_snap_batch_append(struct memtx_snap_batch *batch)
 {
-	/* Process existing snapshot */
-	say_info("recovery start");
-	int64_t signature = vclock_sum(vclock);
-	const char *filename = xdir_format_filename(&memtx->snap_dir,
-						    signature, NONE);
+	struct memtx_snap_reader *reader = batch->reader;
+	if (batch->row_count == MEMTX_SNAP_BATCH_ROWS)
+		return 1;
+	struct xrow_header *row = &reader->pending;
+	if (!reader->has_pending) {
+		int rc = xlog_cursor_next(&reader->cursor, row,
+					  reader->force_recovery);
+		if (rc < 0)
+			return -1;
+		if (rc > 0) {
+			batch->is_eof = true;
+			return 1;
+		}
+		reader->has_pending = true;
+	}
+	assert(row->bodycnt == 1); /* always 1 for read */
+	size_t size = row->body[0].iov_len;
+	if (batch->data_size + size > batch->data_capacity) {
+		if (batch->row_count > 0)
+			return 1;
+		/* A huge row, rows don't point to the buffer yet. */
+		char *data = realloc(batch->data, size);
+		if (data == NULL) {
+			diag_set(OutOfMemory, size, "realloc", "snapshot row");
+			return -1;
+		}
+		batch->data = data;
+		batch->data_capacity = size;
+	}
+	struct memtx_snap_row *r = &batch->rows[batch->row_count];
+	r->row = *row;
+	r->row.body[0].iov_base = batch->data + batch->data_size;
+	memcpy(r->row.body[0].iov_base, row->body[0].iov_base, size);
+	batch->data_size += size;
+	reader->has_pending = false;
+	if (memtx_snap_row_decode(r) != 0) {
+		if (!reader->force_recovery)
+			return -1;
+		say_error("can't apply row: ");
+		diag_log();
+		return 0;
+	}
+	batch->row_count++;
+	return 0;
+}
 
+/** Fill a batch with rows. Called in the reader thread. */
+static void
+memtx_snap_batch_read(struct cmsg *msg)
+{
+	struct memtx_snap_batch *batch = (struct memtx_snap_batch *)msg;
+	struct memtx_snap_reader *reader = batch->reader;
+	batch->row_count = 0;
+	batch->data_size = 0;
+	if (reader->is_done) {
+		batch->is_eof = true;
+		return;
+	}
+	if (!reader->is_open) {
+		if (xlog_cursor_open(&reader->cursor, reader->filename) != 0)
+			goto fail;
+		reader->is_open = true;
+	}
+	int rc;
+	while ((rc = memtx_snap_batch_append(batch)) == 0)
+		;
+	if (rc < 0)
+		goto fail;
+	if (batch->is_eof)
+		reader->is_done = true;
+	return;
+fail:
+	batch->rc = -1;
+	diag_move(diag_get(), &batch->diag);
+	reader->is_done = true;
+}
+
+/** Return a batch to tx. */
+static void
+memtx_snap_batch_return(struct cmsg *msg)
+{
+	struct memtx_snap_batch *batch = (struct memtx_snap_batch *)msg;
+	batch->is_ready = true;
+	fiber_cond_signal(&batch->reader->batch_cond);
+}
+
+static struct memtx_snap_batch *
+memtx_snap_batch_new(struct memtx_snap_reader *reader)
+{
+	struct memtx_snap_batch *batch = malloc(sizeof(*batch));
+	if (batch == NULL) {
+		diag_set(OutOfMemory, sizeof(*batch), "malloc",
+			 "struct memtx_snap_batch");
+		return NULL;
+	}
+	batch->data = malloc(MEMTX_SNAP_BATCH_DATA_SIZE);
+	if (batch->data == NULL) {
+		diag_set(OutOfMemory, MEMTX_SNAP_BATCH_DATA_SIZE,
+			 "malloc", "snapshot batch");
+		free(batch);
+		return NULL;
+	}
+	batch->data_capacity = MEMTX_SNAP_BATCH_DATA_SIZE;
+	batch->data_size = 0;
+	batch->reader = reader;
+	batch->is_ready = true;
+	batch->is_eof = false;
+	batch->rc = 0;
+	batch->row_count = 0;
+	diag_create(&batch->diag);
+	return batch;
+}
+
+static void
+memtx_snap_batch_delete(struct memtx_snap_batch *batch)
+{
+	assert(batch->is_ready);
+	diag_destroy(&batch->diag);
+	free(batch->data);
+	free(batch);
+}
+
+/** Send a batch to the reader thread to be filled. */
+static void
+memtx_snap_batch_post(struct memtx_snap_batch *batch)
+{
+	assert(batch->is_ready);
+	batch->is_ready = false;
+	cmsg_init(&batch->base, batch->reader->batch_route);
+	cpipe_push(&batch->reader->reader_pipe, &batch->base);
+}
+
+/** Wait until a batch is returned to tx. */
+static void
+memtx_snap_batch_wait(struct memtx_snap_batch *batch)
+{
+	while (!batch->is_ready)
+		fiber_cond_wait(&batch->reader->batch_cond);
+}
+
+/** Snapshot reader thread function. */
+static int
+memtx_snap_reader_f(va_list ap)
+{
+	struct memtx_snap_reader *reader = va_arg(ap,
+					struct memtx_snap_reader *);
+	struct cbus_endpoint endpoint;
+
+	cpipe_create(&reader->tx_pipe, "tx_prio");
+	cbus_endpoint_create(&endpoint, cord_name(cord()),
+			     fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&reader->tx_pipe);
+	if (reader->is_open)
+		xlog_cursor_close(&reader->cursor, false);
+	return 0;
+}
+
+static int
+memtx_snap_reader_start(struct memtx_snap_reader *reader,
+			const char *filename, bool force_recovery)
+{
+	memset(reader, 0, sizeof(*reader));
+	snprintf(reader->filename, sizeof(reader->filename), "%s", filename);
+	reader->force_recovery = force_recovery;
+	reader->batch_route[0].f = memtx_snap_batch_read;
+	reader->batch_route[0].pipe = &reader->tx_pipe;
+	reader->batch_route[1].f = memtx_snap_batch_return;
+	reader->batch_route[1].pipe = NULL;
+	fiber_cond_create(&reader->batch_cond);
+	if (cord_costart(&reader->cord, "snap_reader",
+			 memtx_snap_reader_f, reader) != 0) {
+		fiber_cond_destroy(&reader->batch_cond);
+		return -1;
+	}
+	cpipe_create(&reader->reader_pipe, "snap_reader");
+	return 0;
+}
+
+static void
+memtx_snap_reader_stop(struct memtx_snap_reader *reader)
+{
+	cbus_stop_loop(&reader->reader_pipe);
+	cpipe_destroy(&reader->reader_pipe);
+	if (cord_join(&reader->cord) != 0)
+		panic("failed to join snapshot reader thread");
+	fiber_cond_destroy(&reader->batch_cond);
+}
+
+/* }}} */
+
+/**
+ * Format the name of segment @a no of the snapshot with the
+ * given signature. The first segment is the snapshot file
+ * itself, <signature>.snap, the rest are <signature>.snap.<no>.
+ * Segment files are not picked up by xdir_scan(), only the
+ * first one is listed in the snapshot directory index.
+ */
+static void
+memtx_snap_segment_filename(char *buf, size_t size, struct xdir *dir,
+			    int64_t signature, uint32_t no,
+			    enum log_suffix suffix)
+{
+	const char *filename = xdir_format_filename(dir, signature, NONE);
+	const char *suffix_str = suffix == INPROGRESS ? ".inprogress" : "";
+	if (no == 0)
+		snprintf(buf, size, "%s%s", filename, suffix_str);
+	else
+		snprintf(buf, size, "%s.%u%s", filename, (unsigned)no,
+			 suffix_str);
+}
+
+static int
+memtx_engine_apply_snapshot_request(struct memtx_engine *memtx,
+				    struct request *request);
+
+/**
+ * Check that a snapshot segment belongs to the same snapshot
+ * as the main file: every segment is written with the vclock
+ * and the segment count of the main file.
+ */
+static int
+memtx_snap_segment_check(const char *filename,
+			 const struct xlog_meta *main_meta,
+			 const struct xlog_meta *meta)
+{
+	if (meta->segment_count != main_meta->segment_count) {
+		diag_set(XlogError, "%s: segment count %u doesn't match "
+			 "the main snapshot file, expected %u", filename,
+			 (unsigned)meta->segment_count,
+			 (unsigned)main_meta->segment_count);
+		return -1;
+	}
+	if (vclock_compare(&meta->vclock, &main_meta->vclock) != 0) {
+		diag_set(XlogError, "%s: vclock doesn't match "
+			 "the main snapshot file", filename);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Load a single segment of a snapshot. On success, @a meta is
+ * set to the segment meta, which for the main snapshot file
+ * contains the total number of segments. The instance UUID
+ * is taken from the main file before any row is applied.
+ * @a main_meta is NULL for the main file, otherwise it is
+ * the meta of the main file, which the meta of the segment
+ * is checked against before any row is applied.
+ */
+static int
+memtx_engine_recover_snapshot_segment(struct memtx_engine *memtx,
+				      const char *filename,
+				      const struct xlog_meta *main_meta,
+				      int64_t signature, uint64_t *row_count,
+				      struct xlog_meta *meta)
+{
 	say_info("recovering from `%s'", filename);
-	struct xlog_cursor cursor;
-	if (xlog_cursor_open(&cursor, filename) < 0)
+	struct memtx_snap_reader reader;
+	if (memtx_snap_reader_start(&reader, filename,
+				    memtx->force_recovery) != 0)
 		return -1;
-	INSTANCE_UUID = cursor.meta.instance_uuid;
 
-	int rc;
-	struct xrow_header row;
-	uint64_t row_count = 0;
-	while ((rc = xlog_cursor_next(&cursor, &row,
-				      memtx->force_recovery)) == 0) {
-		row.lsn = signature;
-		rc = memtx_engine_recover_snapshot_row(memtx, &row);
-		if (rc < 0) {
-			if (!memtx->force_recovery)
-				break;
-			say_error("can't apply row: ");
-			diag_log();
+	int rc = 0;
+	bool is_first = true;
+	int batch_count = 0;
+	struct memtx_snap_batch *batches[MEMTX_SNAP_BATCH_COUNT];
+	for (; batch_count < MEMTX_SNAP_BATCH_COUNT; batch_count++) {
+		batches[batch_count] = memtx_snap_batch_new(&reader);
+		if (batches[batch_count] == NULL) {
+			rc = -1;
+			goto out;
+		}
+	}
+	for (int i = 0; i < batch_count; i++)
+		memtx_snap_batch_post(batches[i]);
+	/*
+	 * Batches are filled by the reader in the order they are
+	 * posted, and each of them is posted again right after
+	 * it is applied, so they come back in round-robin order.
+	 */
+	for (int i = 0; ; i = (i + 1) % batch_count) {
+		struct memtx_snap_batch *batch = batches[i];
+		memtx_snap_batch_wait(batch);
+		if (is_first && reader.is_open) {
+			is_first = false;
+			if (main_meta == NULL) {
+				INSTANCE_UUID =
+					reader.cursor.meta.instance_uuid;
+			} else if (memtx_snap_segment_check(filename,
+					main_meta, &reader.cursor.meta) != 0) {
+				rc = -1;
+				goto out;
+			}
 		}
-		++row_count;
-		if (row_count % 100000 == 0) {
-			say_info("%.1fM rows processed",
-				 row_count / 1000000.);
-			fiber_yield_timeout(0);
+		for (int j = 0; j < batch->row_count; j++) {
+			struct memtx_snap_row *r = &batch->rows[j];
+			r->row.lsn = signature;
+			rc = memtx_engine_apply_snapshot_request(memtx,
+								 &r->request);
+			if (rc < 0) {
+				if (!memtx->force_recovery)
+					break;
+				say_error("can't apply row: ");
+				diag_log();
+				rc = 0;
+			}
+			++*row_count;
+			if (*row_count % 100000 == 0) {
+				say_info("%.1fM rows processed",
+					 *row_count / 1000000.);
+				fiber_yield_timeout(0);
+			}
 		}
+		if (rc < 0)
+			break;
+		if (batch->rc < 0) {
+			diag_move(&batch->diag, diag_get());
+			rc = -1;
+			break;
+		}
+		if (batch->is_eof)
+			break;
+		memtx_snap_batch_post(batch);
 	}
-	xlog_cursor_close(&cursor, false);
+out:
+	for (int i = 0; i < batch_count; i++) {
+		memtx_snap_batch_wait(batches[i]);
+		memtx_snap_batch_delete(batches[i]);
+	}
+	memtx_snap_reader_stop(&reader);
 	if (rc < 0)
 		return -1;
 
@@ -191,26 +640,50 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 	 * marker - such snapshots are very likely corrupted and
 	 * should not be trusted.
 	 */
-	if (!xlog_cursor_is_eof(&cursor))
+	if (!xlog_cursor_is_eof(&reader.cursor))
 		panic("snapshot `%s' has no EOF marker", filename);
 
+	*meta = reader.cursor.meta;
 	return 0;
 }
 
-static int
-memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
-				  struct xrow_header *row)
+int
+memtx_engine_recover_snapshot(struct memtx_engine *memtx,
+			      const struct vclock *vclock)
 {
-	assert(row->bodycnt == 1); /* always 1 for read */
-	if (row->type != IPROTO_INSERT) {
-		diag_set(ClientError, ER_UNKNOWN_REQUEST_TYPE,
-			 (uint32_t) row->type);
-		return -1;
+	/* Process existing snapshot */
+	say_info("recovery start");
+	int64_t signature = vclock_sum(vclock);
+	uint64_t row_count = 0;
+	/*
+	 * The main file goes first: it contains system spaces,
+	 * which are needed to load the other segments, and
+	 * the number of segments the snapshot consists of.
+	 */
+	uint32_t segment_count = 1;
+	struct xlog_meta main_meta;
+	for (uint32_t i = 0; i < segment_count; i++) {
+		char filename[PATH_MAX];
+		memtx_snap_segment_filename(filename, sizeof(filename),
+					    &memtx->snap_dir, signature,
+					    i, NONE);
+		struct xlog_meta meta;
+		if (memtx_engine_recover_snapshot_segment(memtx, filename,
+				i == 0 ? NULL : &main_meta, signature,
+				&row_count, &meta) != 0)
+			return -1;
+		if (i == 0) {
+			main_meta = meta;
+			segment_count = MAX(meta.segment_count, 1);
+		}
 	}
+	return 0;
+}
 
-	struct request *request = xrow_decode_dml_gc(row);
-	if (request == NULL)
-		return -1;
+static int
+memtx_engine_apply_snapshot_request(struct memtx_engine *memtx,
+				    struct request *request)
+{
 	struct space *space = space_cache_find(request->space_id);
 	if (space == NULL)
 		return -1;
@@ -231,6 +704,23 @@ memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
 	return 0;
 }
 
+static int
+memtx_engine_recover_snapshot_row(struct memtx_engine *memtx,
+				  struct xrow_header *row)
+{
+	assert(row->bodycnt == 1); /* always 1 for read */
+	if (row->type != IPROTO_INSERT) {
+		diag_set(ClientError, ER_UNKNOWN_REQUEST_TYPE,
+			 (uint32_t) row->type);
+		return -1;
+	}
+
+	struct request *request = xrow_decode_dml_gc(row);
+	if (request == NULL)
+		return -1;
+	return memtx_engine_apply_snapshot_request(memtx, request);
+}
+
 /** Called at start to tell memtx to recover to a given LSN. */
 static int
 memtx_engine_begin_initial_recovery(struct engine *engine,
@@ -262,7 +752,8 @@ memtx_engine_begin_final_recovery(struct engine *engine)
 
 	assert(memtx->state == MEMTX_INITIAL_RECOVERY);
 	/* End of the fast path: loaded the primary key. */
-	space_foreach(memtx_end_build_primary_key, memtx);
+	if (space_foreach(memtx_end_build_primary_key, memtx) != 0)
+		return -1;
 
 	if (!memtx->force_recovery) {
 		/*
@@ -286,10 +777,81 @@ memtx_engine_begin_final_recovery(struct engine *engine)
 	return 0;
 }
 
+/**
+ * Remove snapshot files left by a checkpoint that didn't
+ * complete, e.g. because the instance crashed: .inprogress
+ * files and segments renamed before the main snapshot file.
+ * Such files don't belong to any snapshot in the directory
+ * index, so garbage collection would never remove them.
+ * Errors are logged and ignored.
+ */
+static void
+memtx_engine_remove_stray_segments(struct memtx_engine *memtx)
+{
+	struct xdir *dir = &memtx->snap_dir;
+	DIR *dh = opendir(dir->dirname);
+	if (dh == NULL) {
+		say_syserror("error reading directory '%s'", dir->dirname);
+		return;
+	}
+	struct dirent *dent;
+	while ((dent = readdir(dh)) != NULL) {
+		/* <signature>.snap[.<no>][.inprogress] */
+		char *ext = strchr(dent->d_name, '.');
+		if (ext == NULL || ext == dent->d_name ||
+		    strncmp(ext, ".snap", strlen(".snap")) != 0)
+			continue;
+		char *end;
+		long long signature = strtoll(dent->d_name, &end, 10);
+		if (end != ext)
+			continue;
+		const char *suffix = ext + strlen(".snap");
+		if (*suffix == '.' && isdigit(suffix[1])) {
+			/* A segment, skip its number. */
+			strtoul(suffix + 1, &end, 10);
+			suffix = end;
+		} else if (strcmp(suffix, ".inprogress") != 0) {
+			/* The main snapshot file or an unknown file. */
+			continue;
+		}
+		if (*suffix == '\0') {
+			/* A complete segment, is its snapshot there? */
+			bool is_stray = true;
+			struct vclock *vclock;
+			for (vclock = vclockset_first(&dir->index);
+			     vclock != NULL;
+			     vclock = vclockset_next(&dir->index, vclock)) {
+				if (vclock_sum(vclock) == signature) {
+					is_stray = false;
+					break;
+				}
+			}
+			if (!is_stray)
+				continue;
+		} else if (strcmp(suffix, ".inprogress") != 0) {
+			continue;
+		}
+		char filename[PATH_MAX];
+		snprintf(filename, sizeof(filename), "%s/%s",
+			 dir->dirname, dent->d_name);
+		if (unlink(filename) != 0) {
+			say_syserror("error while removing %s", filename);
+			continue;
+		}
+		say_info("removed stray snapshot file %s", filename);
+	}
+	closedir(dh);
+}
+
 static int
 memtx_engine_end_recovery(struct engine *engine)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
+	/*
+	 * The instance owns the snapshot directory now, even in
+	 * hot standby mode, so a checkpoint can't be in progress.
+	 */
+	memtx_engine_remove_stray_segments(memtx);
 	/*
 	 * Recovery is started with enabled keys when:
 	 * - either of force_recovery
@@ -397,6 +959,11 @@ memtx_engine_rollback_statement(struct engine *engine, struct txn *txn,
 			panic("failed to rollback change");
 		}
 	}
+	if (index_count > 0 && memtx_space->build != NULL) {
+		/* Undo the change in the index being built, too. */
+		memtx_build_log_change(memtx_space->build,
+				       stmt->new_tuple, stmt->old_tuple);
+	}
 	/** Reset to old bsize, if it was changed. */
 	if (stmt->engine_savepoint != NULL)
 		memtx_space_update_bsize(space, stmt->new_tuple,
@@ -459,7 +1026,8 @@ memtx_engine_bootstrap(struct engine *engine)
 static int
 checkpoint_write_row(struct xlog *l, struct xrow_header *row)
 {
-	static ev_tstamp last = 0;
+	/* Snapshot segments are written by different threads. */
+	static __thread ev_tstamp last = 0;
 	if (last == 0) {
 		ev_now_update(loop());
 		last = ev_now(loop());
@@ -517,12 +1085,35 @@ struct checkpoint_entry {
 	struct rlist link;
 };
 
+/**
+ * A snapshot is written in parallel by several threads, each
+ * writing a subset of spaces to its own file, a segment.
+ * The first segment is written by the checkpoint thread itself
+ * and contains all system spaces, so that when the snapshot is
+ * recovered segment by segment, space definitions are loaded
+ * before any user data.
+ */
+struct checkpoint_segment {
+	/** The checkpoint this segment belongs to. */
+	struct checkpoint *ckpt;
+	/** Segment number, 0 for the main snapshot file. */
+	uint32_t no;
+	/** Spaces to write to this segment. */
+	struct rlist entries;
+	/** Total size of the spaces, used to balance segments. */
+	size_t bsize;
+	/** Thread writing the segment, unless it's the first one. */
+	struct cord cord;
+};
+
 struct checkpoint {
 	/**
-	 * List of MemTX spaces to snapshot, with consistent
-	 * read view iterators.
+	 * Snapshot segments, each with a list of MemTX spaces
+	 * to write and their consistent read view iterators.
 	 */
-	struct rlist entries;
+	struct checkpoint_segment *segments;
+	/** Number of snapshot segments, at least 1. */
+	uint32_t segment_count;
 	uint64_t snap_io_rate_limit;
 	struct cord cord;
 	bool waiting_for_snap_thread;
@@ -538,9 +1129,24 @@ struct checkpoint {
 
 static int
 checkpoint_init(struct checkpoint *ckpt, const char *snap_dirname,
-		uint64_t snap_io_rate_limit)
+		uint64_t snap_io_rate_limit, uint32_t segment_count)
 {
-	rlist_create(&ckpt->entries);
+	assert(segment_count > 0);
+	ckpt->segments = region_alloc(&fiber()->gc, segment_count *
+				      sizeof(*ckpt->segments));
+	if (ckpt->segments == NULL) {
+		diag_set(OutOfMemory, segment_count * sizeof(*ckpt->segments),
+			 "region", "struct checkpoint_segment");
+		return -1;
+	}
+	ckpt->segment_count = segment_count;
+	for (uint32_t i = 0; i < segment_count; i++) {
+		struct checkpoint_segment *segment = &ckpt->segments[i];
+		segment->ckpt = ckpt;
+		segment->no = i;
+		rlist_create(&segment->entries);
+		segment->bsize = 0;
+	}
 	ckpt->waiting_for_snap_thread = false;
 	xdir_create(&ckpt->dir, snap_dirname, SNAP, &INSTANCE_UUID);
 	ckpt->snap_io_rate_limit = snap_io_rate_limit;
@@ -559,11 +1165,14 @@ checkpoint_init(struct checkpoint *ckpt, const char *snap_dirname,
 static void
 checkpoint_destroy(struct checkpoint *ckpt)
 {
-	struct checkpoint_entry *entry;
-	rlist_foreach_entry(entry, &ckpt->entries, link) {
-		entry->iterator->free(entry->iterator);
+	for (uint32_t i = 0; i < ckpt->segment_count; i++) {
+		struct checkpoint_segment *segment = &ckpt->segments[i];
+		struct checkpoint_entry *entry;
+		rlist_foreach_entry(entry, &segment->entries, link) {
+			entry->iterator->free(entry->iterator);
+		}
+		rlist_create(&segment->entries);
 	}
-	rlist_create(&ckpt->entries);
 	xdir_destroy(&ckpt->dir);
 	free(ckpt->vclock);
 }
@@ -580,6 +1189,17 @@ checkpoint_add_space(struct space *sp, void *data)
 	if (!pk)
 		return 0;
 	struct checkpoint *ckpt = (struct checkpoint *)data;
+	/*
+	 * System spaces always go to the first segment, user
+	 * spaces - to the segment with the least data so far.
+	 */
+	struct checkpoint_segment *segment = &ckpt->segments[0];
+	if (space_id(sp) >= BOX_SYSTEM_ID_MAX) {
+		for (uint32_t i = 1; i < ckpt->segment_count; i++) {
+			if (ckpt->segments[i].bsize < segment->bsize)
+				segment = &ckpt->segments[i];
+		}
+	}
 	struct checkpoint_entry *entry;
 	entry = region_alloc_object(&fiber()->gc, struct checkpoint_entry);
 	if (entry == NULL) {
@@ -587,7 +1207,8 @@ checkpoint_add_space(struct space *sp, void *data)
 			 "region", "struct checkpoint_entry");
 		return -1;
 	}
-	rlist_add_tail_entry(&ckpt->entries, entry, link);
+	rlist_add_tail_entry(&segment->entries, entry, link);
+	segment->bsize += space_bsize(sp);
 
 	entry->space = sp;
 	entry->iterator = index_create_snapshot_iterator(pk);
@@ -597,30 +1218,47 @@ checkpoint_add_space(struct space *sp, void *data)
 	return 0;
 };
 
+/**
+ * Create the file of a snapshot segment. Every segment has
+ * the same meta as the main snapshot file, including the
+ * total number of segments, and its own row numbering.
+ */
 static int
-checkpoint_f(va_list ap)
+checkpoint_create_segment(struct checkpoint_segment *segment,
+			  struct xlog *snap)
 {
-	struct checkpoint *ckpt = va_arg(ap, struct checkpoint *);
-
-	if (ckpt->touch) {
-		if (xdir_touch_xlog(&ckpt->dir, ckpt->vclock) == 0)
-			return 0;
-		/*
-		 * Failed to touch an existing snapshot, create
-		 * a new one.
-		 */
-		ckpt->touch = false;
-	}
+	struct checkpoint *ckpt = segment->ckpt;
+	struct xdir *dir = &ckpt->dir;
+	struct xlog_meta meta;
+	snprintf(meta.filetype, sizeof(meta.filetype), "%s", dir->filetype);
+	meta.instance_uuid = *dir->instance_uuid;
+	vclock_copy(&meta.vclock, ckpt->vclock);
+	meta.segment_count = ckpt->segment_count > 1 ?
+			     ckpt->segment_count : 0;
+
+	char filename[PATH_MAX];
+	memtx_snap_segment_filename(filename, sizeof(filename), dir,
+				    vclock_sum(ckpt->vclock), segment->no,
+				    NONE);
+	if (xlog_create(snap, filename, dir->open_wflags, &meta) != 0)
+		return -1;
+	snap->sync_interval = dir->sync_interval;
+	snap->free_cache = dir->sync_interval != 0 ? true : false;
+	/* Segments share the rate limit of the whole snapshot. */
+	snap->rate_limit = ckpt->snap_io_rate_limit / ckpt->segment_count;
+	return 0;
+}
 
+static int
+checkpoint_write_segment(struct checkpoint_segment *segment)
+{
 	struct xlog snap;
-	if (xdir_create_xlog(&ckpt->dir, &snap, ckpt->vclock) != 0)
+	if (checkpoint_create_segment(segment, &snap) != 0)
 		return -1;
 
-	snap.rate_limit = ckpt->snap_io_rate_limit;
-
 	say_info("saving snapshot `%s'", snap.filename);
 	struct checkpoint_entry *entry;
-	rlist_foreach_entry(entry, &ckpt->entries, link) {
+	rlist_foreach_entry(entry, &segment->entries, link) {
 		uint32_t size;
 		const char *data;
 		struct snapshot_iterator *it = entry->iterator;
@@ -639,6 +1277,55 @@ checkpoint_f(va_list ap)
 		return -1;
 	}
 	xlog_close(&snap, false);
+	return 0;
+}
+
+static int
+checkpoint_segment_f(va_list ap)
+{
+	struct checkpoint_segment *segment =
+		va_arg(ap, struct checkpoint_segment *);
+	return checkpoint_write_segment(segment);
+}
+
+static int
+checkpoint_f(va_list ap)
+{
+	struct checkpoint *ckpt = va_arg(ap, struct checkpoint *);
+
+	if (ckpt->touch) {
+		if (xdir_touch_xlog(&ckpt->dir, ckpt->vclock) == 0)
+			return 0;
+		/*
+		 * Failed to touch an existing snapshot, create
+		 * a new one.
+		 */
+		ckpt->touch = false;
+	}
+
+	/*
+	 * Start a thread per extra segment and write the first
+	 * one in this thread. Segment threads are joined even if
+	 * some of them fail, since they use the checkpoint.
+	 */
+	uint32_t started = 1;
+	int rc = 0;
+	for (; started < ckpt->segment_count; started++) {
+		struct checkpoint_segment *segment = &ckpt->segments[started];
+		if (cord_costart(&segment->cord, "snapshot",
+				 checkpoint_segment_f, segment) != 0) {
+			rc = -1;
+			break;
+		}
+	}
+	if (rc == 0)
+		rc = checkpoint_write_segment(&ckpt->segments[0]);
+	for (uint32_t i = 1; i < started; i++) {
+		if (cord_cojoin(&ckpt->segments[i].cord) != 0)
+			rc = -1;
+	}
+	if (rc != 0)
+		return -1;
 	say_info("done");
 	return 0;
 }
@@ -657,7 +1344,8 @@ memtx_engine_begin_checkpoint(struct engine *engine)
 	}
 
 	if (checkpoint_init(memtx->checkpoint, memtx->snap_dir.dirname,
-			    memtx->snap_io_rate_limit) != 0)
+			    memtx->snap_io_rate_limit,
+			    memtx->snapshot_threads) != 0)
 		return -1;
 
 	if (space_foreach(checkpoint_add_space, memtx->checkpoint) != 0) {
@@ -718,14 +1406,22 @@ memtx_engine_commit_checkpoint(struct engine *engine, struct vclock *vclock)
 	if (!memtx->checkpoint->touch) {
 		int64_t lsn = vclock_sum(memtx->checkpoint->vclock);
 		struct xdir *dir = &memtx->checkpoint->dir;
-		/* rename snapshot on completion */
-		char to[PATH_MAX];
-		snprintf(to, sizeof(to), "%s",
-			 xdir_format_filename(dir, lsn, NONE));
-		char *from = xdir_format_filename(dir, lsn, INPROGRESS);
-		int rc = coio_rename(from, to);
-		if (rc != 0)
-			panic("can't rename .snap.inprogress");
+		/*
+		 * Rename snapshot on completion. The main file
+		 * goes last so that a snapshot is never visible
+		 * in the directory until all its segments are.
+		 */
+		uint32_t i = memtx->checkpoint->segment_count;
+		while (i-- > 0) {
+			char from[PATH_MAX], to[PATH_MAX];
+			memtx_snap_segment_filename(from, sizeof(from), dir,
+						    lsn, i, INPROGRESS);
+			memtx_snap_segment_filename(to, sizeof(to), dir,
+						    lsn, i, NONE);
+			int rc = coio_rename(from, to);
+			if (rc != 0)
+				panic("can't rename .snap.inprogress");
+		}
 	}
 
 	struct vclock last;
@@ -758,21 +1454,66 @@ memtx_engine_abort_checkpoint(struct engine *engine)
 
 	memtx_tuple_end_snapshot();
 
-	/** Remove garbage .inprogress file. */
-	char *filename =
-		xdir_format_filename(&memtx->checkpoint->dir,
-				     vclock_sum(memtx->checkpoint->vclock),
-				     INPROGRESS);
-	(void) coio_unlink(filename);
+	/** Remove garbage .inprogress files. */
+	struct checkpoint *ckpt = memtx->checkpoint;
+	for (uint32_t i = 0; i < ckpt->segment_count; i++) {
+		char filename[PATH_MAX];
+		memtx_snap_segment_filename(filename, sizeof(filename),
+					    &ckpt->dir,
+					    vclock_sum(ckpt->vclock),
+					    i, INPROGRESS);
+		(void) coio_unlink(filename);
+	}
 
 	checkpoint_destroy(memtx->checkpoint);
 	memtx->checkpoint = NULL;
 }
 
+/**
+ * Remove extra segments of the snapshot with the given
+ * signature, if there are any. The main snapshot file is
+ * removed by xdir_collect_garbage().
+ */
+static int
+memtx_engine_remove_snap_segments(struct memtx_engine *memtx,
+				  int64_t signature)
+{
+	for (uint32_t i = 1; ; i++) {
+		char filename[PATH_MAX];
+		memtx_snap_segment_filename(filename, sizeof(filename),
+					    &memtx->snap_dir, signature,
+					    i, NONE);
+		if (coio_unlink(filename) != 0) {
+			if (errno == ENOENT)
+				break;
+			say_syserror("error while removing %s", filename);
+			diag_set(SystemError, "failed to unlink file '%s'",
+				 filename);
+			return -1;
+		}
+		say_info("removed %s", filename);
+	}
+	return 0;
+}
+
 static int
 memtx_engine_collect_garbage(struct engine *engine, int64_t lsn)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
+	/*
+	 * Segments go first: a snapshot with some of its
+	 * segments missing is rejected on recovery, while
+	 * a segment left without the main file would never
+	 * be removed.
+	 */
+	struct vclockset *index = &memtx->snap_dir.index;
+	for (struct vclock *vclock = vclockset_first(index);
+	     vclock != NULL && vclock_sum(vclock) < lsn;
+	     vclock = vclockset_next(index, vclock)) {
+		if (memtx_engine_remove_snap_segments(memtx,
+					vclock_sum(vclock)) != 0)
+			return -1;
+	}
 	/*
 	 * We recover the checkpoint list by scanning the snapshot
 	 * directory so deletion of an xlog file or a file that
@@ -792,9 +1533,19 @@ memtx_engine_backup(struct engine *engine, struct vclock *vclock,
 		    engine_backup_cb cb, void *cb_arg)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)engine;
-	char *filename = xdir_format_filename(&memtx->snap_dir,
-					      vclock_sum(vclock), NONE);
-	return cb(filename, cb_arg);
+	int64_t signature = vclock_sum(vclock);
+	for (uint32_t i = 0; ; i++) {
+		char filename[PATH_MAX];
+		memtx_snap_segment_filename(filename, sizeof(filename),
+					    &memtx->snap_dir, signature,
+					    i, NONE);
+		struct stat st;
+		if (i > 0 && coio_stat(filename, &st) != 0)
+			break;
+		if (cb(filename, cb_arg) != 0)
+			return -1;
+	}
+	return 0;
 }
 
 /** Used to pass arguments to memtx_initial_join_f */
@@ -823,29 +1574,51 @@ memtx_initial_join_f(va_list ap)
 	xdir_create(&dir, snap_dirname, SNAP, &INSTANCE_UUID);
 	struct xlog_cursor cursor;
 	int rc = xdir_open_cursor(&dir, checkpoint_lsn, &cursor);
-	xdir_destroy(&dir);
-	if (rc < 0)
+	if (rc < 0) {
+		xdir_destroy(&dir);
 		return -1;
-
-	struct xrow_header row;
-	while ((rc = xlog_cursor_next(&cursor, &row, true)) == 0) {
-		rc = xstream_write(stream, &row);
+	}
+	/* All segments are sent one by one, the main file first. */
+	struct xlog_meta main_meta = cursor.meta;
+	uint32_t segment_count = MAX(main_meta.segment_count, 1);
+	for (uint32_t i = 0; i < segment_count; i++) {
+		if (i > 0) {
+			char filename[PATH_MAX];
+			memtx_snap_segment_filename(filename, sizeof(filename),
+						    &dir, checkpoint_lsn,
+						    i, NONE);
+			if (xlog_cursor_open(&cursor, filename) < 0) {
+				rc = -1;
+				break;
+			}
+			if (memtx_snap_segment_check(filename, &main_meta,
+						     &cursor.meta) != 0) {
+				xlog_cursor_close(&cursor, false);
+				rc = -1;
+				break;
+			}
+		}
+		struct xrow_header row;
+		while ((rc = xlog_cursor_next(&cursor, &row, true)) == 0) {
+			rc = xstream_write(stream, &row);
+			if (rc < 0)
+				break;
+		}
+		xlog_cursor_close(&cursor, false);
 		if (rc < 0)
 			break;
-	}
-	xlog_cursor_close(&cursor, false);
-	if (rc < 0)
-		return -1;
 
-	/**
-	 * We should never try to read snapshots with no EOF
-	 * marker - such snapshots are very likely corrupted and
-	 * should not be trusted.
-	 */
-	/* TODO: replace panic with diag_set() */
-	if (!xlog_cursor_is_eof(&cursor))
-		panic("snapshot `%s' has no EOF marker", cursor.name);
-	return 0;
+		/**
+		 * We should never try to read snapshots with no EOF
+		 * marker - such snapshots are very likely corrupted and
+		 * should not be trusted.
+		 */
+		/* TODO: replace panic with diag_set() */
+		if (!xlog_cursor_is_eof(&cursor))
+			panic("snapshot `%s' has no EOF marker", cursor.name);
+	}
+	xdir_destroy(&dir);
+	return rc < 0 ? -1 : 0;
 }
 
 static int
@@ -924,6 +1697,7 @@ memtx_engine_new(const char *snap_dirname, bool force_recovery,
 
 	memtx->state = MEMTX_INITIALIZED;
 	memtx->force_recovery = force_recovery;
+	memtx->snapshot_threads = 1;
 
 	memtx->base.vtab = &memtx_engine_vtab;
 	memtx->base.name = "memtx";
@@ -936,6 +1710,14 @@ memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit)
 	memtx->snap_io_rate_limit = limit * 1024 * 1024;
 }
 
+void
+memtx_engine_set_snapshot_threads(struct memtx_engine *memtx,
+				  uint32_t threads)
+{
+	assert(threads > 0);
+	memtx->snapshot_threads = threads;
+}
+
 void
 memtx_engine_set_max_tuple_size(struct memtx_engine *memtx, size_t max_size)
 {
@@ -89,6 +89,11 @@ struct memtx_engine {
 	struct xdir snap_dir;
 	/** Limit disk usage of checkpointing (bytes per second). */
 	uint64_t snap_io_rate_limit;
+	/**
+	 * Number of threads writing a snapshot. Each of them
+	 * writes its own file, a snapshot segment.
+	 */
+	uint32_t snapshot_threads;
 	/** Skip invalid snapshot records if this flag is set. */
 	bool force_recovery;
 	/** Memory pool for tree index iterator. */
@@ -113,12 +118,18 @@ memtx_engine_recover_snapshot(struct memtx_engine *memtx,
 void
 memtx_engine_set_snap_io_rate_limit(struct memtx_engine *memtx, double limit);
 
+void
+memtx_engine_set_snapshot_threads(struct memtx_engine *memtx,
+				  uint32_t threads);
+
 void
 memtx_engine_set_max_tuple_size(struct memtx_engine *memtx, size_t max_size);
 
 enum {
 	MEMTX_EXTENT_SIZE = 16 * 1024,
-	MEMTX_SLAB_SIZE = 4 * 1024 * 1024
+	MEMTX_SLAB_SIZE = 4 * 1024 * 1024,
+	/** Max number of threads writing a snapshot. */
+	MEMTX_SNAPSHOT_THREADS_MAX = 64,
 };
 
 /**
@@ -42,6 +42,8 @@
 #include "memtx_tuple.h"
 #include "column_mask.h"
 #include "sequence.h"
+#include "fiber.h"
+#include <third_party/qsort_arg.h>
 
 static void
 memtx_space_destroy(struct space *space)
@@ -267,6 +269,10 @@ memtx_space_replace_all_keys(struct space *space, struct txn_stmt *stmt,
 	stmt->old_tuple = old_tuple;
 	stmt->engine_savepoint = stmt;
 	memtx_space_update_bsize(space, old_tuple, new_tuple);
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	if (memtx_space->build != NULL)
+		memtx_build_log_change(memtx_space->build,
+				       old_tuple, new_tuple);
 	return 0;
 
 rollback:
@@ -748,6 +754,267 @@ memtx_init_system_space(struct space *space)
 	memtx_space_do_add_primary_key(space, MEMTX_OK);
 }
 
+/**
+ * Number of tuples a background index build adds to the new
+ * index between yields.
+ */
+enum { MEMTX_BUILD_YIELD_LOOPS = 1000 };
+
+/** A change of a tuple made during a background index build. */
+struct memtx_build_change {
+	/** Tuple replaced or deleted by the change, referenced. */
+	struct tuple *old_tuple;
+	/** Tuple inserted by the change, referenced. */
+	struct tuple *new_tuple;
+	/** Ordinal number of the change in the log. */
+	uint32_t seq;
+};
+
+/**
+ * State of a secondary index build that doesn't block the
+ * tx thread, see memtx_space_build_index_online().
+ */
+struct memtx_build {
+	/** Primary key of the space being scanned. */
+	struct index *pk;
+	/**
+	 * The last tuple returned by the primary key scan or NULL
+	 * if the scan hasn't started yet. Changes of tuples that
+	 * are less than or equal to it are logged, the rest will
+	 * be picked up by the scan.
+	 */
+	struct tuple *cursor;
+	/** Set when the scan is over: all changes are logged. */
+	bool scan_done;
+	/** Log of changes to apply to the new index. */
+	struct memtx_build_change *log;
+	/** Number of entries in the log. */
+	uint32_t log_size;
+	/** Number of entries allocated for the log. */
+	uint32_t log_capacity;
+	/** Set if a change couldn't be logged. */
+	bool is_failed;
+	/** Error that made the build fail. */
+	struct diag diag;
+};
+
+void
+memtx_build_log_change(struct memtx_build *build,
+		       struct tuple *old_tuple, struct tuple *new_tuple)
+{
+	struct tuple *tuple = new_tuple != NULL ? new_tuple : old_tuple;
+	if (tuple == NULL || build->is_failed)
+		return;
+	if (!build->scan_done &&
+	    (build->cursor == NULL ||
+	     tuple_compare(tuple, build->cursor, build->pk->def->key_def) > 0))
+		return;
+	if (build->log_size == build->log_capacity) {
+		uint32_t capacity = MAX(build->log_capacity * 2, 64);
+		struct memtx_build_change *log =
+			realloc(build->log, capacity * sizeof(*log));
+		if (log == NULL) {
+			/*
+			 * The change was done by another fiber, which
+			 * shouldn't fail because of us. Fail the build.
+			 */
+			diag_set(OutOfMemory, capacity * sizeof(*log),
+				 "realloc", "memtx build log");
+			diag_move(diag_get(), &build->diag);
+			build->is_failed = true;
+			return;
+		}
+		build->log = log;
+		build->log_capacity = capacity;
+	}
+	struct memtx_build_change *change = &build->log[build->log_size];
+	change->old_tuple = old_tuple;
+	change->new_tuple = new_tuple;
+	change->seq = build->log_size++;
+	if (old_tuple != NULL)
+		tuple_ref(old_tuple);
+	if (new_tuple != NULL)
+		tuple_ref(new_tuple);
+}
+
+/** Return a tuple identifying the primary key of a change. */
+static inline struct tuple *
+memtx_build_change_tuple(const struct memtx_build_change *change)
+{
+	return change->new_tuple != NULL ? change->new_tuple :
+					   change->old_tuple;
+}
+
+/** Order logged changes by primary key, then by time. */
+static int
+memtx_build_change_cmp(const void *a_ptr, const void *b_ptr, void *arg)
+{
+	const struct memtx_build_change *a = a_ptr;
+	const struct memtx_build_change *b = b_ptr;
+	struct key_def *key_def = arg;
+	int rc = tuple_compare(memtx_build_change_tuple(a),
+			       memtx_build_change_tuple(b), key_def);
+	if (rc != 0)
+		return rc;
+	return a->seq < b->seq ? -1 : a->seq > b->seq;
+}
+
+/** Return true if two changes are for the same primary key. */
+static inline bool
+memtx_build_change_same_key(const struct memtx_build_change *a,
+			    const struct memtx_build_change *b,
+			    struct key_def *key_def)
+{
+	return tuple_compare(memtx_build_change_tuple(a),
+			     memtx_build_change_tuple(b), key_def) == 0;
+}
+
+/**
+ * Apply changes logged during a background build to the sorted
+ * build array of the new index. For each primary key, the first
+ * logged change replaced the version of the tuple seen by the
+ * scan while the last one installed the current version, so it's
+ * enough to delete the former and append the latter. Uniqueness
+ * is checked by index_end_build() on the resulting array, which
+ * matches the current contents of the space: checking it before
+ * the log is applied would fail on a key that moved from a
+ * scanned tuple to one the scan picked up later.
+ */
+static int
+memtx_build_apply_log(struct memtx_build *build, struct space *new_space,
+		      struct memtx_tree_index *new_index)
+{
+	struct key_def *key_def = build->pk->def->key_def;
+	struct memtx_build_change *log = build->log;
+	uint32_t size = build->log_size;
+	if (size == 0)
+		return 0;
+	qsort_arg(log, size, sizeof(*log), memtx_build_change_cmp, key_def);
+	struct tuple **deleted = malloc(size * sizeof(*deleted));
+	if (deleted == NULL) {
+		diag_set(OutOfMemory, size * sizeof(*deleted),
+			 "malloc", "memtx build log");
+		return -1;
+	}
+	uint32_t deleted_count = 0;
+	for (uint32_t i = 0; i < size; i++) {
+		/* The first change for a key. */
+		if (i > 0 &&
+		    memtx_build_change_same_key(&log[i - 1], &log[i], key_def))
+			continue;
+		if (log[i].old_tuple != NULL)
+			deleted[deleted_count++] = log[i].old_tuple;
+	}
+	int rc = memtx_tree_index_build_delete(new_index, deleted,
+					       deleted_count);
+	free(deleted);
+	if (rc != 0)
+		return -1;
+	for (uint32_t i = 0; i < size; i++) {
+		/* The last change for a key. */
+		if (i + 1 < size &&
+		    memtx_build_change_same_key(&log[i], &log[i + 1], key_def))
+			continue;
+		if (log[i].new_tuple == NULL)
+			continue;
+		if (tuple_validate(new_space->format, log[i].new_tuple) != 0 ||
+		    index_build_next(&new_index->base, log[i].new_tuple) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * Build a secondary tree index without blocking the tx thread.
+ *
+ * The primary key is scanned with periodic yields and tuples
+ * are appended to the new index build array, which is then
+ * sorted in a coio thread, see memtx_tree_index_sort_build_array().
+ * Meanwhile the space keeps serving requests: changes of tuples
+ * the scan has already passed are logged by
+ * memtx_space_replace_all_keys() and on statement rollback. Once
+ * the array is sorted, the log is applied to it and the array is
+ * bulk-loaded into the tree, without yielding, so the caller can
+ * make the index visible atomically.
+ */
+static int
+memtx_space_build_index_online(struct space *old_space,
+			       struct space *new_space,
+			       struct index *new_index)
+{
+	struct memtx_space *memtx_space = (struct memtx_space *)old_space;
+	assert(memtx_space->build == NULL);
+	struct index *pk = index_find(old_space, 0);
+	if (pk == NULL)
+		return -1;
+
+	struct memtx_build build;
+	memset(&build, 0, sizeof(build));
+	build.pk = pk;
+	diag_create(&build.diag);
+
+	struct iterator *it = index_create_iterator(pk, ITER_ALL, NULL, 0);
+	if (it == NULL)
+		return -1;
+	memtx_space->build = &build;
+
+	index_begin_build(new_index);
+	int rc;
+	uint32_t count = 0;
+	struct tuple *tuple;
+	while ((rc = iterator_next(it, &tuple)) == 0 && tuple != NULL) {
+		rc = tuple_validate(new_space->format, tuple);
+		if (rc != 0)
+			break;
+		rc = index_build_next(new_index, tuple);
+		if (rc != 0)
+			break;
+		if (build.cursor != NULL)
+			tuple_unref(build.cursor);
+		build.cursor = tuple;
+		tuple_ref(tuple);
+		if (++count % MEMTX_BUILD_YIELD_LOOPS != 0)
+			continue;
+		fiber_sleep(0);
+		if (fiber_is_cancelled()) {
+			diag_set(FiberIsCancelled);
+			rc = -1;
+			break;
+		}
+		if (build.is_failed)
+			break;
+	}
+	iterator_delete(it);
+	if (build.cursor != NULL)
+		tuple_unref(build.cursor);
+	build.cursor = NULL;
+	build.scan_done = true;
+
+	struct memtx_tree_index *tree = (struct memtx_tree_index *)new_index;
+	if (rc == 0 && !build.is_failed)
+		memtx_tree_index_sort_build_array(tree);
+	if (rc == 0 && build.is_failed) {
+		diag_move(&build.diag, diag_get());
+		rc = -1;
+	}
+	/* No yields from here on till the new index is visible. */
+	if (rc == 0)
+		rc = memtx_build_apply_log(&build, new_space, tree);
+	if (rc == 0)
+		rc = index_end_build(new_index);
+
+	memtx_space->build = NULL;
+	for (uint32_t i = 0; i < build.log_size; i++) {
+		if (build.log[i].old_tuple != NULL)
+			tuple_unref(build.log[i].old_tuple);
+		if (build.log[i].new_tuple != NULL)
+			tuple_unref(build.log[i].new_tuple);
+	}
+	free(build.log);
+	diag_destroy(&build.diag);
+	return rc;
+}
+
 static int
 memtx_space_build_secondary_key(struct space *old_space,
 				struct space *new_space,
@@ -773,6 +1040,18 @@ memtx_space_build_secondary_key(struct space *old_space,
 		return -1;
 	}
 
+	/*
+	 * A secondary tree index is built in the background
+	 * unless the source space is not live yet, i.e. the
+	 * primary key is being rebuilt by the same alter. The
+	 * primary key must be a tree: the scan goes in its
+	 * order, which is used to tell changes to log.
+	 */
+	if (old_space != new_space && new_index->def->iid != 0 &&
+	    new_index->def->type == TREE && pk->def->type == TREE)
+		return memtx_space_build_index_online(old_space, new_space,
+						      new_index);
+
 	/* Now deal with any kind of add index during normal operation. */
 	struct iterator *it = index_create_iterator(pk, ITER_ALL, NULL, 0);
 	if (it == NULL)
@@ -954,5 +1233,6 @@ memtx_space_new(struct memtx_engine *memtx,
 
 	memtx_space->bsize = 0;
 	memtx_space->replace = memtx_space_replace_no_keys;
+	memtx_space->build = NULL;
 	return (struct space *)memtx_space;
 }
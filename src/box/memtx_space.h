@@ -37,6 +37,7 @@ extern "C" {
 #endif /* defined(__cplusplus) */
 
 struct memtx_engine;
+struct memtx_build;
 
 struct memtx_space {
 	struct space base;
@@ -48,6 +49,14 @@ struct memtx_space {
 	 */
 	int (*replace)(struct space *, struct txn_stmt *,
 		       enum dup_replace_mode);
+	/**
+	 * State of a secondary index being built in the
+	 * background, NULL if there's none. Changes made to
+	 * the space while the index is being built are logged
+	 * in it so as to be applied to the new index before
+	 * it is made visible.
+	 */
+	struct memtx_build *build;
 };
 
 /**
@@ -77,6 +86,14 @@ int
 memtx_space_replace_all_keys(struct space *, struct txn_stmt *,
 			     enum dup_replace_mode);
 
+/**
+ * Account a change of a tuple in a space which has an index
+ * being built in the background, see memtx_space::build.
+ */
+void
+memtx_build_log_change(struct memtx_build *build,
+		       struct tuple *old_tuple, struct tuple *new_tuple);
+
 struct space *
 memtx_space_new(struct memtx_engine *memtx,
 		struct space_def *def, struct rlist *key_list);
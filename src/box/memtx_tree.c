@@ -35,6 +35,7 @@
 #include "errinj.h"
 #include "memory.h"
 #include "fiber.h"
+#include "coio_task.h"
 #include <third_party/qsort_arg.h>
 #include <small/mempool.h>
 
@@ -43,8 +44,9 @@
 static int
 memtx_tree_qcompare(const void* a, const void *b, void *c)
 {
-	return tuple_compare(*(struct tuple **)a,
-		*(struct tuple **)b, (struct key_def *)c);
+	return memtx_tree_compare((const struct memtx_tree_data *)a,
+				  (const struct memtx_tree_data *)b,
+				  (struct key_def *)c);
 }
 
 /* {{{ MemtxTree Iterators ****************************************/
@@ -55,7 +57,8 @@ struct tree_iterator {
 	struct memtx_tree_iterator tree_iterator;
 	enum iterator_type type;
 	struct memtx_tree_key_data key_data;
-	struct tuple *current_tuple;
+	/** Last returned tuple along with its hint. */
+	struct memtx_tree_data current;
 	/** Memory pool the iterator was allocated from. */
 	struct mempool *pool;
 };
@@ -74,8 +77,8 @@ static void
 tree_iterator_free(struct iterator *iterator)
 {
 	struct tree_iterator *it = tree_iterator(iterator);
-	if (it->current_tuple != NULL)
-		tuple_unref(it->current_tuple);
+	if (it->current.tuple != NULL)
+		tuple_unref(it->current.tuple);
 	mempool_free(it->pool, it);
 }
 
@@ -90,25 +93,26 @@ tree_iterator_dummie(struct iterator *iterator, struct tuple **ret)
 static int
 tree_iterator_next(struct iterator *iterator, struct tuple **ret)
 {
-	struct tuple **res;
+	struct memtx_tree_data *res;
 	struct tree_iterator *it = tree_iterator(iterator);
-	assert(it->current_tuple != NULL);
-	struct tuple **check = memtx_tree_iterator_get_elem(it->tree, &it->tree_iterator);
-	if (check == NULL || *check != it->current_tuple)
+	assert(it->current.tuple != NULL);
+	struct memtx_tree_data *check = memtx_tree_iterator_get_elem(it->tree, &it->tree_iterator);
+	if (check == NULL || check->tuple != it->current.tuple)
 		it->tree_iterator =
-			memtx_tree_upper_bound_elem(it->tree, it->current_tuple,
+			memtx_tree_upper_bound_elem(it->tree, it->current,
 						    NULL);
 	else
 		memtx_tree_iterator_next(it->tree, &it->tree_iterator);
-	tuple_unref(it->current_tuple);
-	it->current_tuple = NULL;
+	tuple_unref(it->current.tuple);
+	it->current.tuple = NULL;
 	res = memtx_tree_iterator_get_elem(it->tree, &it->tree_iterator);
 	if (res == NULL) {
 		iterator->next = tree_iterator_dummie;
 		*ret = NULL;
 	} else {
-		*ret = it->current_tuple = *res;
-		tuple_ref(it->current_tuple);
+		it->current = *res;
+		*ret = it->current.tuple;
+		tuple_ref(it->current.tuple);
 	}
 	return 0;
 }
@@ -117,22 +121,23 @@ static int
 tree_iterator_prev(struct iterator *iterator, struct tuple **ret)
 {
 	struct tree_iterator *it = tree_iterator(iterator);
-	assert(it->current_tuple != NULL);
-	struct tuple **check = memtx_tree_iterator_get_elem(it->tree, &it->tree_iterator);
-	if (check == NULL || *check != it->current_tuple)
+	assert(it->current.tuple != NULL);
+	struct memtx_tree_data *check = memtx_tree_iterator_get_elem(it->tree, &it->tree_iterator);
+	if (check == NULL || check->tuple != it->current.tuple)
 		it->tree_iterator =
-			memtx_tree_lower_bound_elem(it->tree, it->current_tuple,
+			memtx_tree_lower_bound_elem(it->tree, it->current,
 						    NULL);
 	memtx_tree_iterator_prev(it->tree, &it->tree_iterator);
-	tuple_unref(it->current_tuple);
-	it->current_tuple = NULL;
-	struct tuple **res = memtx_tree_iterator_get_elem(it->tree, &it->tree_iterator);
+	tuple_unref(it->current.tuple);
+	it->current.tuple = NULL;
+	struct memtx_tree_data *res = memtx_tree_iterator_get_elem(it->tree, &it->tree_iterator);
 	if (!res) {
 		iterator->next = tree_iterator_dummie;
 		*ret = NULL;
 	} else {
-		*ret = it->current_tuple = *res;
-		tuple_ref(it->current_tuple);
+		it->current = *res;
+		*ret = it->current.tuple;
+		tuple_ref(it->current.tuple);
 	}
 	return 0;
 }
@@ -141,27 +146,28 @@ static int
 tree_iterator_next_equal(struct iterator *iterator, struct tuple **ret)
 {
 	struct tree_iterator *it = tree_iterator(iterator);
-	assert(it->current_tuple != NULL);
-	struct tuple **check = memtx_tree_iterator_get_elem(it->tree,
+	assert(it->current.tuple != NULL);
+	struct memtx_tree_data *check = memtx_tree_iterator_get_elem(it->tree,
 						&it->tree_iterator);
-	if (check == NULL || *check != it->current_tuple)
+	if (check == NULL || check->tuple != it->current.tuple)
 		it->tree_iterator =
-			memtx_tree_upper_bound_elem(it->tree, it->current_tuple,
+			memtx_tree_upper_bound_elem(it->tree, it->current,
 						    NULL);
 	else
 		memtx_tree_iterator_next(it->tree, &it->tree_iterator);
-	tuple_unref(it->current_tuple);
-	it->current_tuple = NULL;
-	struct tuple **res = memtx_tree_iterator_get_elem(it->tree,
+	tuple_unref(it->current.tuple);
+	it->current.tuple = NULL;
+	struct memtx_tree_data *res = memtx_tree_iterator_get_elem(it->tree,
 						&it->tree_iterator);
 	/* Use user key def to save a few loops. */
-	if (!res || memtx_tree_compare_key(*res, &it->key_data,
+	if (!res || memtx_tree_compare_key(res, &it->key_data,
 					   it->index_def->key_def) != 0) {
 		iterator->next = tree_iterator_dummie;
 		*ret = NULL;
 	} else {
-		*ret = it->current_tuple = *res;
-		tuple_ref(it->current_tuple);
+		it->current = *res;
+		*ret = it->current.tuple;
+		tuple_ref(it->current.tuple);
 	}
 	return 0;
 }
@@ -170,26 +176,27 @@ static int
 tree_iterator_prev_equal(struct iterator *iterator, struct tuple **ret)
 {
 	struct tree_iterator *it = tree_iterator(iterator);
-	assert(it->current_tuple != NULL);
-	struct tuple **check = memtx_tree_iterator_get_elem(it->tree,
+	assert(it->current.tuple != NULL);
+	struct memtx_tree_data *check = memtx_tree_iterator_get_elem(it->tree,
 						&it->tree_iterator);
-	if (check == NULL || *check != it->current_tuple)
+	if (check == NULL || check->tuple != it->current.tuple)
 		it->tree_iterator =
-			memtx_tree_lower_bound_elem(it->tree, it->current_tuple,
+			memtx_tree_lower_bound_elem(it->tree, it->current,
 						    NULL);
 	memtx_tree_iterator_prev(it->tree, &it->tree_iterator);
-	tuple_unref(it->current_tuple);
-	it->current_tuple = NULL;
-	struct tuple **res = memtx_tree_iterator_get_elem(it->tree,
+	tuple_unref(it->current.tuple);
+	it->current.tuple = NULL;
+	struct memtx_tree_data *res = memtx_tree_iterator_get_elem(it->tree,
 						&it->tree_iterator);
 	/* Use user key def to save a few loops. */
-	if (!res || memtx_tree_compare_key(*res, &it->key_data,
+	if (!res || memtx_tree_compare_key(res, &it->key_data,
 					   it->index_def->key_def) != 0) {
 		iterator->next = tree_iterator_dummie;
 		*ret = NULL;
 	} else {
-		*ret = it->current_tuple = *res;
-		tuple_ref(it->current_tuple);
+		it->current = *res;
+		*ret = it->current.tuple;
+		tuple_ref(it->current.tuple);
 	}
 	return 0;
 }
@@ -197,7 +204,7 @@ tree_iterator_prev_equal(struct iterator *iterator, struct tuple **ret)
 static void
 tree_iterator_set_next_method(struct tree_iterator *it)
 {
-	assert(it->current_tuple != NULL);
+	assert(it->current.tuple != NULL);
 	switch (it->type) {
 	case ITER_EQ:
 		it->base.next = tree_iterator_next_equal;
@@ -231,7 +238,7 @@ tree_iterator_start(struct iterator *iterator, struct tuple **ret)
 	const struct memtx_tree *tree = it->tree;
 	enum iterator_type type = it->type;
 	bool exact = false;
-	assert(it->current_tuple == NULL);
+	assert(it->current.tuple == NULL);
 	if (it->key_data.key == 0) {
 		if (iterator_type_is_reverse(it->type))
 			it->tree_iterator = memtx_tree_iterator_last(tree);
@@ -268,12 +275,93 @@ tree_iterator_start(struct iterator *iterator, struct tuple **ret)
 		}
 	}
 
-	struct tuple **res = memtx_tree_iterator_get_elem(it->tree,
+	struct memtx_tree_data *res = memtx_tree_iterator_get_elem(it->tree,
 						&it->tree_iterator);
 	if (!res)
 		return 0;
-	*ret = it->current_tuple = *res;
-	tuple_ref(it->current_tuple);
+	it->current = *res;
+	*ret = it->current.tuple;
+	tuple_ref(it->current.tuple);
+	tree_iterator_set_next_method(it);
+	return 0;
+}
+
+/**
+ * Find offsets of the first tuple matching a search key and
+ * of the tuple following the last matching one in the tree.
+ */
+static void
+tree_iterator_range(const struct memtx_tree *tree, enum iterator_type type,
+		    struct memtx_tree_key_data *key_data,
+		    size_t *begin, size_t *end)
+{
+	*begin = 0;
+	*end = memtx_tree_size(tree);
+	if (key_data->key == NULL)
+		return;
+	switch (type) {
+	case ITER_EQ:
+	case ITER_REQ:
+		memtx_tree_lower_bound_get_offset(tree, key_data, NULL, begin);
+		memtx_tree_upper_bound_get_offset(tree, key_data, NULL, end);
+		break;
+	case ITER_ALL:
+	case ITER_GE:
+		memtx_tree_lower_bound_get_offset(tree, key_data, NULL, begin);
+		break;
+	case ITER_GT:
+		memtx_tree_upper_bound_get_offset(tree, key_data, NULL, begin);
+		break;
+	case ITER_LE:
+		memtx_tree_upper_bound_get_offset(tree, key_data, NULL, end);
+		break;
+	case ITER_LT:
+		memtx_tree_lower_bound_get_offset(tree, key_data, NULL, end);
+		break;
+	default:
+		/* The type was checked in initIterator */
+		assert(false);
+	}
+}
+
+/**
+ * Skip tuples of a not yet started iterator in logarithmic
+ * time using the numbers of elements stored in the tree.
+ */
+static int
+tree_iterator_skip(struct iterator *iterator, uint32_t count)
+{
+	struct tree_iterator *it = tree_iterator(iterator);
+	if (count == 0)
+		return 0;
+	if (iterator->next != tree_iterator_start) {
+		struct tuple *tuple;
+		for (; count > 0; count--) {
+			if (iterator->next(iterator, &tuple) != 0)
+				return -1;
+			if (tuple == NULL)
+				break;
+		}
+		return 0;
+	}
+	assert(it->current.tuple == NULL);
+	iterator->next = tree_iterator_dummie;
+	size_t begin, end;
+	tree_iterator_range(it->tree, it->type, &it->key_data, &begin, &end);
+	if (end - begin <= count)
+		return 0;
+	/*
+	 * Position the iterator at the last skipped tuple,
+	 * as if it has been returned by the previous next().
+	 */
+	size_t offset = iterator_type_is_reverse(it->type) ?
+			end - count : begin + count - 1;
+	it->tree_iterator = memtx_tree_iterator_at(it->tree, offset);
+	struct memtx_tree_data *res = memtx_tree_iterator_get_elem(it->tree,
+						&it->tree_iterator);
+	assert(res != NULL);
+	it->current = *res;
+	tuple_ref(it->current.tuple);
 	tree_iterator_set_next_method(it);
 	return 0;
 }
@@ -326,8 +414,8 @@ static int
 memtx_tree_index_random(struct index *base, uint32_t rnd, struct tuple **result)
 {
 	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
-	struct tuple **res = memtx_tree_random(&index->tree, rnd);
-	*result = res != NULL ? *res : NULL;
+	struct memtx_tree_data *res = memtx_tree_random(&index->tree, rnd);
+	*result = res != NULL ? res->tuple : NULL;
 	return 0;
 }
 
@@ -335,9 +423,18 @@ static ssize_t
 memtx_tree_index_count(struct index *base, enum iterator_type type,
 		       const char *key, uint32_t part_count)
 {
-	if (type == ITER_ALL)
+	if (type == ITER_ALL || part_count == 0)
 		return memtx_tree_index_size(base); /* optimization */
-	return generic_index_count(base, type, key, part_count);
+	if (type > ITER_GT)
+		return generic_index_count(base, type, key, part_count);
+	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
+	struct memtx_tree_key_data key_data;
+	key_data.key = key;
+	key_data.part_count = part_count;
+	key_data.hint = key_hint(key, part_count, base->def->key_def);
+	size_t begin, end;
+	tree_iterator_range(&index->tree, type, &key_data, &begin, &end);
+	return end - begin;
 }
 
 static int
@@ -350,8 +447,9 @@ memtx_tree_index_get(struct index *base, const char *key,
 	struct memtx_tree_key_data key_data;
 	key_data.key = key;
 	key_data.part_count = part_count;
-	struct tuple **res = memtx_tree_find(&index->tree, &key_data);
-	*result = res != NULL ? *res : NULL;
+	key_data.hint = key_hint(key, part_count, base->def->key_def);
+	struct memtx_tree_data *res = memtx_tree_find(&index->tree, &key_data);
+	*result = res != NULL ? res->tuple : NULL;
 	return 0;
 }
 
@@ -361,24 +459,30 @@ memtx_tree_index_replace(struct index *base, struct tuple *old_tuple,
 			 struct tuple **result)
 {
 	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
+	struct key_def *cmp_def = memtx_tree_index_cmp_def(index);
 	if (new_tuple) {
-		struct tuple *dup_tuple = NULL;
+		struct memtx_tree_data new_data;
+		new_data.tuple = new_tuple;
+		new_data.hint = tuple_hint(new_tuple, cmp_def);
+		struct memtx_tree_data dup_data;
+		dup_data.tuple = NULL;
 
 		/* Try to optimistically replace the new_tuple. */
 		int tree_res = memtx_tree_insert(&index->tree,
-						 new_tuple, &dup_tuple);
+						 new_data, &dup_data);
 		if (tree_res) {
 			diag_set(OutOfMemory, MEMTX_EXTENT_SIZE,
 				 "memtx_tree_index", "replace");
 			return -1;
 		}
 
+		struct tuple *dup_tuple = dup_data.tuple;
 		uint32_t errcode = replace_check_dup(old_tuple,
 						     dup_tuple, mode);
 		if (errcode) {
-			memtx_tree_delete(&index->tree, new_tuple);
+			memtx_tree_delete(&index->tree, new_data);
 			if (dup_tuple)
-				memtx_tree_insert(&index->tree, dup_tuple, 0);
+				memtx_tree_insert(&index->tree, dup_data, 0);
 			struct space *sp = space_cache_find(base->def->space_id);
 			if (sp != NULL)
 				diag_set(ClientError, errcode, base->def->name,
@@ -391,7 +495,10 @@ memtx_tree_index_replace(struct index *base, struct tuple *old_tuple,
 		}
 	}
 	if (old_tuple) {
-		memtx_tree_delete(&index->tree, old_tuple);
+		struct memtx_tree_data old_data;
+		old_data.tuple = old_tuple;
+		old_data.hint = tuple_hint(old_tuple, cmp_def);
+		memtx_tree_delete(&index->tree, old_data);
 	}
 	*result = old_tuple;
 	return 0;
@@ -429,14 +536,16 @@ memtx_tree_index_create_iterator(struct index *base, enum iterator_type type,
 	iterator_create(&it->base, base);
 	it->pool = &memtx->tree_iterator_pool;
 	it->base.next = tree_iterator_start;
+	it->base.skip = tree_iterator_skip;
 	it->base.free = tree_iterator_free;
 	it->type = type;
 	it->key_data.key = key;
 	it->key_data.part_count = part_count;
+	it->key_data.hint = key_hint(key, part_count, base->def->key_def);
 	it->index_def = base->def;
 	it->tree = &index->tree;
 	it->tree_iterator = memtx_tree_invalid_iterator();
-	it->current_tuple = NULL;
+	it->current.tuple = NULL;
 	return (struct iterator *)it;
 }
 
@@ -454,8 +563,8 @@ memtx_tree_index_reserve(struct index *base, uint32_t size_hint)
 	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
 	if (size_hint < index->build_array_alloc_size)
 		return 0;
-	struct tuple **tmp = (struct tuple **)realloc(index->build_array,
-						      size_hint * sizeof(*tmp));
+	struct memtx_tree_data *tmp = (struct memtx_tree_data *)
+		realloc(index->build_array, size_hint * sizeof(*tmp));
 	if (tmp == NULL) {
 		diag_set(OutOfMemory, size_hint * sizeof(*tmp),
 			 "memtx_tree_index", "reserve");
@@ -471,20 +580,21 @@ memtx_tree_index_build_next(struct index *base, struct tuple *tuple)
 {
 	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
 	if (index->build_array == NULL) {
-		index->build_array = (struct tuple **)malloc(MEMTX_EXTENT_SIZE);
+		index->build_array =
+			(struct memtx_tree_data *)malloc(MEMTX_EXTENT_SIZE);
 		if (index->build_array == NULL) {
 			diag_set(OutOfMemory, MEMTX_EXTENT_SIZE,
 				 "memtx_tree_index", "build_next");
 			return -1;
 		}
 		index->build_array_alloc_size =
-			MEMTX_EXTENT_SIZE / sizeof(struct tuple*);
+			MEMTX_EXTENT_SIZE / sizeof(struct memtx_tree_data);
 	}
 	assert(index->build_array_size <= index->build_array_alloc_size);
 	if (index->build_array_size == index->build_array_alloc_size) {
 		index->build_array_alloc_size = index->build_array_alloc_size +
 					index->build_array_alloc_size / 2;
-		struct tuple **tmp = (struct tuple **)
+		struct memtx_tree_data *tmp = (struct memtx_tree_data *)
 			realloc(index->build_array,
 				index->build_array_alloc_size * sizeof(*tmp));
 		if (tmp == NULL) {
@@ -494,25 +604,207 @@ memtx_tree_index_build_next(struct index *base, struct tuple *tuple)
 		}
 		index->build_array = tmp;
 	}
-	index->build_array[index->build_array_size++] = tuple;
+	struct memtx_tree_data *elem =
+		&index->build_array[index->build_array_size++];
+	elem->tuple = tuple;
+	elem->hint = tuple_hint(tuple, memtx_tree_index_cmp_def(index));
 	return 0;
 }
 
+/**
+ * Build arrays smaller than this are sorted right in tx, bigger
+ * ones are handed over to a coio thread.
+ */
+enum { MEMTX_TREE_BUILD_COIO_THRESHOLD = 64 * 1024 };
+
 static void
-memtx_tree_index_end_build(struct index *base)
+memtx_tree_index_sort(struct memtx_tree_index *index)
 {
-	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
 	struct key_def *cmp_def = memtx_tree_index_cmp_def(index);
 	qsort_arg(index->build_array, index->build_array_size,
-		  sizeof(struct tuple *),
+		  sizeof(struct memtx_tree_data),
 		  memtx_tree_qcompare, cmp_def);
-	memtx_tree_build(&index->tree, index->build_array,
-			 index->build_array_size);
+}
+
+static ssize_t
+memtx_tree_index_sort_f(va_list ap)
+{
+	struct memtx_tree_index *index = va_arg(ap, struct memtx_tree_index *);
+	memtx_tree_index_sort(index);
+	return 0;
+}
+
+void
+memtx_tree_index_sort_build_array(struct memtx_tree_index *index)
+{
+	assert(!index->build_array_is_sorted);
+	/*
+	 * Sorting a big array is done in a coio thread:
+	 * comparing tuples doesn't touch any tx state, and
+	 * while the calling fiber is waiting, tx is free to fill
+	 * build arrays of other indexes, so that several indexes
+	 * are sorted in parallel, see memtx_build_secondary_keys().
+	 * If the task can't be posted, fall back on sorting in tx.
+	 */
+	if (index->build_array_size < MEMTX_TREE_BUILD_COIO_THRESHOLD ||
+	    coio_call(memtx_tree_index_sort_f, index) != 0)
+		memtx_tree_index_sort(index);
+	index->build_array_is_sorted = true;
+	index->build_array_sorted_size = index->build_array_size;
+}
+
+static int
+memtx_tree_index_cmp_pos(const void *a_ptr, const void *b_ptr)
+{
+	size_t a = *(const size_t *)a_ptr;
+	size_t b = *(const size_t *)b_ptr;
+	return a < b ? -1 : a > b;
+}
+
+int
+memtx_tree_index_build_delete(struct memtx_tree_index *index,
+			      struct tuple **tuples, uint32_t count)
+{
+	assert(index->build_array_is_sorted);
+	assert(index->build_array_sorted_size == index->build_array_size);
+	if (count == 0)
+		return 0;
+	size_t *found = (size_t *)malloc(count * sizeof(*found));
+	if (found == NULL) {
+		diag_set(OutOfMemory, count * sizeof(*found),
+			 "memtx_tree_index", "build_delete");
+		return -1;
+	}
+	struct key_def *cmp_def = memtx_tree_index_cmp_def(index);
+	struct memtx_tree_data *array = index->build_array;
+	size_t size = index->build_array_size;
+	uint32_t found_count = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		struct memtx_tree_data data;
+		data.tuple = tuples[i];
+		data.hint = tuple_hint(tuples[i], cmp_def);
+		/*
+		 * Find the range of elements equal to the tuple:
+		 * a unique index may have several of them, since
+		 * the array may still contain stale tuples.
+		 */
+		size_t begin = 0, end = size;
+		while (begin < end) {
+			size_t mid = begin + (end - begin) / 2;
+			if (memtx_tree_compare(&array[mid], &data, cmp_def) < 0)
+				begin = mid + 1;
+			else
+				end = mid;
+		}
+		for (size_t j = begin; j < size &&
+		     memtx_tree_compare(&array[j], &data, cmp_def) == 0; j++) {
+			if (array[j].tuple == data.tuple) {
+				found[found_count++] = j;
+				break;
+			}
+		}
+	}
+	/* Squeeze the found elements out of the array. */
+	qsort(found, found_count, sizeof(*found), memtx_tree_index_cmp_pos);
+	size_t dst = 0;
+	for (uint32_t i = 0; i <= found_count; i++) {
+		size_t src = i > 0 ? found[i - 1] + 1 : 0;
+		size_t src_end = i < found_count ? found[i] : size;
+		memmove(&array[dst], &array[src],
+			(src_end - src) * sizeof(*array));
+		dst += src_end - src;
+	}
+	free(found);
+	index->build_array_size = dst;
+	index->build_array_sorted_size = dst;
+	return 0;
+}
+
+/**
+ * Merge elements appended to a sorted build array into it.
+ */
+static int
+memtx_tree_index_merge_build_array(struct memtx_tree_index *index)
+{
+	struct key_def *cmp_def = memtx_tree_index_cmp_def(index);
+	struct memtx_tree_data *array = index->build_array;
+	size_t sorted_size = index->build_array_sorted_size;
+	size_t tail_size = index->build_array_size - sorted_size;
+	if (tail_size == 0)
+		return 0;
+	qsort_arg(&array[sorted_size], tail_size,
+		  sizeof(struct memtx_tree_data),
+		  memtx_tree_qcompare, cmp_def);
+	struct memtx_tree_data *tail = (struct memtx_tree_data *)
+		malloc(tail_size * sizeof(*tail));
+	if (tail == NULL) {
+		diag_set(OutOfMemory, tail_size * sizeof(*tail),
+			 "memtx_tree_index", "end_build");
+		return -1;
+	}
+	memcpy(tail, &array[sorted_size], tail_size * sizeof(*tail));
+	/* Merge from the end so that the head stays in place. */
+	size_t i = sorted_size, j = tail_size;
+	size_t k = index->build_array_size;
+	while (j > 0) {
+		if (i > 0 &&
+		    memtx_tree_compare(&array[i - 1], &tail[j - 1],
+				       cmp_def) > 0)
+			array[--k] = array[--i];
+		else
+			array[--k] = tail[--j];
+	}
+	free(tail);
+	index->build_array_sorted_size = index->build_array_size;
+	return 0;
+}
+
+/**
+ * Check that a sorted build array of a unique index doesn't
+ * contain duplicates.
+ */
+static int
+memtx_tree_index_check_unique(struct memtx_tree_index *index)
+{
+	struct key_def *cmp_def = memtx_tree_index_cmp_def(index);
+	for (size_t i = 1; i < index->build_array_size; i++) {
+		if (memtx_tree_compare(&index->build_array[i - 1],
+				       &index->build_array[i], cmp_def) != 0)
+			continue;
+		struct space *sp = space_cache_find(index->base.def->space_id);
+		if (sp != NULL)
+			diag_set(ClientError, ER_TUPLE_FOUND,
+				 index->base.def->name, space_name(sp));
+		return -1;
+	}
+	return 0;
+}
+
+static int
+memtx_tree_index_end_build(struct index *base)
+{
+	struct memtx_tree_index *index = (struct memtx_tree_index *)base;
+	int rc = 0;
+	if (!index->build_array_is_sorted)
+		memtx_tree_index_sort_build_array(index);
+	else
+		rc = memtx_tree_index_merge_build_array(index);
+	if (rc == 0 && base->def->opts.is_unique)
+		rc = memtx_tree_index_check_unique(index);
+	if (rc == 0 && memtx_tree_build(&index->tree, index->build_array,
+					index->build_array_size) != 0) {
+		diag_set(OutOfMemory, MEMTX_EXTENT_SIZE,
+			 "memtx_tree_index", "end_build");
+		rc = -1;
+	}
 
 	free(index->build_array);
 	index->build_array = NULL;
 	index->build_array_size = 0;
 	index->build_array_alloc_size = 0;
+	index->build_array_is_sorted = false;
+	index->build_array_sorted_size = 0;
+	return rc;
 }
 
 struct tree_snapshot_iterator {
@@ -538,12 +830,12 @@ tree_snapshot_iterator_next(struct snapshot_iterator *iterator, uint32_t *size)
 	assert(iterator->free == tree_snapshot_iterator_free);
 	struct tree_snapshot_iterator *it =
 		(struct tree_snapshot_iterator *)iterator;
-	struct tuple **res = memtx_tree_iterator_get_elem(it->tree,
+	struct memtx_tree_data *res = memtx_tree_iterator_get_elem(it->tree,
 						&it->tree_iterator);
 	if (res == NULL)
 		return NULL;
 	memtx_tree_iterator_next(it->tree, &it->tree_iterator);
-	return tuple_data_range(*res, size);
+	return tuple_data_range(res->tuple, size);
 }
 
 /**
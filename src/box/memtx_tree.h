@@ -43,6 +43,20 @@ extern "C" {
 
 struct memtx_engine;
 
+/**
+ * Struct that is used as an element in BPS tree definition.
+ * Along with the tuple pointer it stores a hint of the tuple
+ * (see tuple_hint()), which allows to skip most of comparisons
+ * of tuple data on tree lookups.
+ */
+struct memtx_tree_data
+{
+	/** Indexed tuple */
+	struct tuple *tuple;
+	/** Hint of the tuple in terms of the tree key definition */
+	uint64_t hint;
+};
+
 /**
  * Struct that is used as a key in BPS tree definition.
  */
@@ -52,12 +66,33 @@ struct memtx_tree_key_data
 	const char *key;
 	/** Number of msgpacked search fields */
 	uint32_t part_count;
+	/** Hint of the key, see key_hint() */
+	uint64_t hint;
 };
 
+/**
+ * BPS tree element comparator.
+ * Defined in header in order to allow compiler to inline it.
+ * Tuple data is only compared if the hints are equal.
+ * @param a, b - tree elements to compare.
+ * @param def - key definition.
+ * @retval 0  if a == b in terms of def.
+ * @retval <0 if a < b in terms of def.
+ * @retval >0 if a > b in terms of def.
+ */
+static inline int
+memtx_tree_compare(const struct memtx_tree_data *a,
+		   const struct memtx_tree_data *b, struct key_def *def)
+{
+	if (a->hint != b->hint)
+		return a->hint < b->hint ? -1 : 1;
+	return tuple_compare(a->tuple, b->tuple, def);
+}
+
 /**
  * BPS tree element vs key comparator.
  * Defined in header in order to allow compiler to inline it.
- * @param tuple - tuple to compare.
+ * @param elem - tree element to compare.
  * @param key_data - key to compare with.
  * @param def - key definition.
  * @retval 0  if tuple == key in terms of def.
@@ -65,22 +100,26 @@ struct memtx_tree_key_data
  * @retval >0 if tuple > key in terms of def.
  */
 static inline int
-memtx_tree_compare_key(const struct tuple *tuple,
+memtx_tree_compare_key(const struct memtx_tree_data *elem,
 		       const struct memtx_tree_key_data *key_data,
 		       struct key_def *def)
 {
-	return tuple_compare_with_key(tuple, key_data->key,
+	if (key_data->part_count > 0 && elem->hint != key_data->hint)
+		return elem->hint < key_data->hint ? -1 : 1;
+	return tuple_compare_with_key(elem->tuple, key_data->key,
 				      key_data->part_count, def);
 }
 
 #define BPS_TREE_NAME memtx_tree
 #define BPS_TREE_BLOCK_SIZE (512)
 #define BPS_TREE_EXTENT_SIZE MEMTX_EXTENT_SIZE
-#define BPS_TREE_COMPARE(a, b, arg) tuple_compare(a, b, arg)
-#define BPS_TREE_COMPARE_KEY(a, b, arg) memtx_tree_compare_key(a, b, arg)
-#define bps_tree_elem_t struct tuple *
+#define BPS_TREE_COMPARE(a, b, arg) memtx_tree_compare(&(a), &(b), arg)
+#define BPS_TREE_COMPARE_KEY(a, b, arg) memtx_tree_compare_key(&(a), b, arg)
+#define bps_tree_elem_t struct memtx_tree_data
 #define bps_tree_key_t struct memtx_tree_key_data *
 #define bps_tree_arg_t struct key_def *
+/* Needed for logarithmic count() and select() offset. */
+#define BPS_TREE_CHILD_COUNTS
 
 #include "salad/bps_tree.h"
 
@@ -92,17 +131,49 @@ memtx_tree_compare_key(const struct tuple *tuple,
 #undef bps_tree_elem_t
 #undef bps_tree_key_t
 #undef bps_tree_arg_t
+#undef BPS_TREE_CHILD_COUNTS
 
 struct memtx_tree_index {
 	struct index base;
 	struct memtx_tree tree;
-	struct tuple **build_array;
+	struct memtx_tree_data *build_array;
 	size_t build_array_size, build_array_alloc_size;
+	/**
+	 * Set by memtx_tree_index_sort_build_array(): the first
+	 * build_array_sorted_size elements of the build array are
+	 * sorted and end_build() must not yield.
+	 */
+	bool build_array_is_sorted;
+	size_t build_array_sorted_size;
 };
 
 struct memtx_tree_index *
 memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def);
 
+/**
+ * Sort the build array of an index being built in the
+ * background, see memtx_space_build_index_online(), so that
+ * changes made to the space meanwhile can be applied to the
+ * array before it is loaded into the tree. Yields while a big
+ * array is sorted in a coio thread.
+ *
+ * After this call new elements may only be appended with
+ * index_build_next(), which doesn't yield, and index_end_build()
+ * merges them into the sorted array without yielding either.
+ */
+void
+memtx_tree_index_sort_build_array(struct memtx_tree_index *index);
+
+/**
+ * Remove tuples from the sorted build array of an index. Tuples
+ * that are not in the array are ignored.
+ * @retval  0 success
+ * @retval -1 out of memory, diag is set
+ */
+int
+memtx_tree_index_build_delete(struct memtx_tree_index *index,
+			      struct tuple **tuples, uint32_t count);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
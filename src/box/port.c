@@ -35,6 +35,7 @@
 #include <small/slab_cache.h>
 #include <small/mempool.h>
 #include <fiber.h>
+#include <msgpuck.h>
 #include "errinj.h"
 
 static struct mempool port_entry_pool;
@@ -108,6 +109,30 @@ port_dump(struct port *port, struct obuf *out)
 	return 0;
 }
 
+int
+port_dump_groups(struct port *port, const uint32_t *counts,
+		 uint32_t group_count, struct obuf *out)
+{
+	struct port_entry *pe = port->first;
+	for (uint32_t i = 0; i < group_count; i++) {
+		char *data = (char *)obuf_alloc(out, mp_sizeof_array(counts[i]));
+		if (data == NULL) {
+			diag_set(OutOfMemory, mp_sizeof_array(counts[i]),
+				 "obuf_alloc", "data");
+			return -1;
+		}
+		mp_encode_array(data, counts[i]);
+		for (uint32_t j = 0; j < counts[i]; j++) {
+			assert(pe != NULL);
+			if (tuple_to_obuf(pe->tuple, out) != 0)
+				return -1;
+			pe = pe->next;
+		}
+	}
+	assert(pe == NULL);
+	return 0;
+}
+
 void
 port_init(void)
 {
@@ -82,6 +82,14 @@ port_destroy(struct port *port);
 int
 port_dump(struct port *port, struct obuf *out);
 
+/**
+ * Dump tuples of the port split into @a group_count groups,
+ * each encoded as a MsgPack array of @a counts[i] tuples.
+ */
+int
+port_dump_groups(struct port *port, const uint32_t *counts,
+		 uint32_t group_count, struct obuf *out);
+
 int
 port_add_tuple(struct port *port, struct tuple *tuple);
 
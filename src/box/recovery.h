@@ -86,6 +86,15 @@ recovery_finalize(struct recovery *r, struct xstream *stream);
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
 
+/**
+ * Close the current WAL, if any, without reading it up and
+ * run on_close_log triggers. Used by replication relays once
+ * they have got all rows of the WAL from memory, see
+ * wal_ring_read().
+ */
+void
+recovery_skip_log(struct recovery *r);
+
 /**
  * Find out if there are new .xlog files since the current
  * vclock, and read them all up.
@@ -103,6 +103,8 @@ struct relay {
 	struct replica *replica;
 	/** WAL event watcher. */
 	struct wal_watcher wal_watcher;
+	/** Position in the ring of recently written WAL rows. */
+	struct wal_ring_cursor wal_ring_cursor;
 	/** Set before exiting the relay loop. */
 	bool exiting;
 	/** Relay reader cond. */
@@ -158,6 +160,7 @@ relay_create(struct relay *relay, int fd, uint64_t sync,
 	fiber_cond_create(&relay->reader_cond);
 	diag_create(&relay->diag);
 	stailq_create(&relay->pending_gc);
+	wal_ring_cursor_create(&relay->wal_ring_cursor);
 }
 
 static void
@@ -335,9 +338,31 @@ relay_process_wal_event(struct wal_watcher *watcher, unsigned events)
 		 */
 		return;
 	}
+	struct recovery *r = relay->r;
 	try {
-		recover_remaining_wals(relay->r, &relay->stream, NULL,
-				       (events & WAL_EVENT_ROTATE) != 0);
+		/*
+		 * Send new rows from memory if the relay keeps up
+		 * with the WAL, otherwise read them from xlog files.
+		 */
+		if (wal_ring_read(&relay->wal_ring_cursor, &r->vclock,
+				  &relay->stream) == 0) {
+			/*
+			 * All rows of the previous WAL have been
+			 * sent, close it as if it was read up so
+			 * that it can be garbage collected.
+			 */
+			if ((events & WAL_EVENT_ROTATE) != 0)
+				recovery_skip_log(r);
+			return;
+		}
+		/*
+		 * Rescan the WAL directory if the current WAL was
+		 * skipped, since new WALs may have been created
+		 * since the last scan.
+		 */
+		recover_remaining_wals(r, &relay->stream, NULL,
+				       (events & WAL_EVENT_ROTATE) != 0 ||
+				       !xlog_cursor_is_open(&r->cursor));
 	} catch (Exception *e) {
 		e->log();
 		diag_move(diag_get(), &relay->diag);
@@ -174,6 +174,12 @@ struct space {
 	uint64_t truncate_count;
 	/** Enable/disable triggers. */
 	bool run_triggers;
+	/**
+	 * Set while an alter of the space is building new
+	 * indexes, which may yield. Other DDL on the space is
+	 * not allowed until it's done, see alter_space_do().
+	 */
+	bool is_being_altered;
 	/**
 	 * Space format or NULL if space does not have format
 	 * (sysview engine, for example).
@@ -173,6 +173,12 @@ cursor_seek(BtCursor *pCur, int *pRes, enum iterator_type type,
 static int
 cursor_advance(BtCursor *pCur, int *pRes);
 
+static void
+ephemeral_space_delete(struct space *space);
+
+static int
+ephemeral_replace(BtCursor *pCur, const char *data, const char *end);
+
 const char *tarantoolErrorMessage()
 {
 	return box_error_message(box_error_last());
@@ -191,6 +197,10 @@ int tarantoolSqlite3CloseCursor(BtCursor *pCur)
 	if (c->tuple_last) box_tuple_unref(c->tuple_last);
 	    free(c);
 	}
+	if ((pCur->curFlags & BTCF_TEphemCursor) && pCur->pTaSpace != NULL) {
+		ephemeral_space_delete(pCur->pTaSpace);
+		pCur->pTaSpace = NULL;
+	}
 	return SQLITE_OK;
 }
 
@@ -215,8 +225,12 @@ tarantoolSqlite3TupleColumnFast(BtCursor *pCur, u32 fieldno, u32 *field_size)
 	assert(c != NULL);
 	assert(c->tuple_last != NULL);
 	struct tuple_format *format = tuple_format(c->tuple_last);
-	assert(fieldno < format->field_count);
-	if (format->fields[fieldno].offset_slot == TUPLE_OFFSET_SLOT_NIL)
+	/*
+	 * Ephemeral space formats describe key fields only, the
+	 * rest of a record is not in the format.
+	 */
+	if (fieldno >= format->field_count ||
+	    format->fields[fieldno].offset_slot == TUPLE_OFFSET_SLOT_NIL)
 		return NULL;
 	const char *field = tuple_field(c->tuple_last, fieldno);
 	const char *end = field;
@@ -339,6 +353,11 @@ int tarantoolSqlite3Count(BtCursor *pCur, i64 *pnEntry)
 {
 	assert(pCur->curFlags & BTCF_TaCursor);
 
+	if (pCur->curFlags & BTCF_TEphemCursor) {
+		*pnEntry = pCur->pTaSpace == NULL ? 0 :
+			   index_size(space_index(pCur->pTaSpace, 0));
+		return SQLITE_OK;
+	}
 	uint32_t space_id = SQLITE_PAGENO_TO_SPACEID(pCur->pgnoRoot);
 	uint32_t index_id = SQLITE_PAGENO_TO_INDEXID(pCur->pgnoRoot);
 	*pnEntry = box_index_len(space_id, index_id);
@@ -349,6 +368,12 @@ int tarantoolSqlite3Insert(BtCursor *pCur, const BtreePayload *pX)
 {
 	assert(pCur->curFlags & BTCF_TaCursor);
 
+	if (pCur->curFlags & BTCF_TEphemCursor) {
+		const char *data = (const char *)pX->pKey;
+		if (ephemeral_replace(pCur, data, data + pX->nKey) != 0)
+			return SQLITE_TARANTOOL_ERROR;
+		return SQLITE_OK;
+	}
 	char *buf = (char*)region_alloc(&fiber()->gc, pX->nKey);
 	if (buf == NULL) {
 		diag_set(OutOfMemory, pX->nKey, "malloc", "buf");
@@ -381,6 +406,16 @@ int tarantoolSqlite3Delete(BtCursor *pCur, u8 flags)
 	assert(c->iter);
 	assert(c->tuple_last);
 
+	if (pCur->curFlags & BTCF_TEphemCursor) {
+		struct tuple *old_tuple;
+		if (index_replace(space_index(pCur->pTaSpace, 0),
+				  c->tuple_last, NULL, DUP_REPLACE_OR_INSERT,
+				  &old_tuple) != 0)
+			return SQLITE_TARANTOOL_ERROR;
+		if (old_tuple != NULL)
+			tuple_unref(old_tuple);
+		return SQLITE_OK;
+	}
 	space_id = SQLITE_PAGENO_TO_SPACEID(pCur->pgnoRoot);
 	index_id = SQLITE_PAGENO_TO_INDEXID(pCur->pgnoRoot);
 	key = tuple_extract_key(c->tuple_last,
@@ -1026,7 +1061,26 @@ cursor_seek(BtCursor *pCur, int *pRes, enum iterator_type type,
 		k = c->key;
 	}
 
-	c->iter = box_index_iterator(space_id, index_id, type, k, ke);
+	if (pCur->curFlags & BTCF_TEphemCursor) {
+		if (pCur->pTaSpace == NULL) {
+			/* Nothing has been inserted yet. */
+			c->type = type;
+			pCur->eState = CURSOR_INVALID;
+			*pRes = 1;
+			return SQLITE_OK;
+		}
+		/*
+		 * Ephemeral spaces are not in the space cache and
+		 * keys come from the VDBE, so skip box_index_iterator()
+		 * checks and trim the key to the index part count.
+		 */
+		struct index *pk = space_index(pCur->pTaSpace, 0);
+		uint32_t part_count = mp_decode_array(&k);
+		part_count = MIN(part_count, pk->def->key_def->part_count);
+		c->iter = index_create_iterator(pk, type, k, part_count);
+	} else {
+		c->iter = box_index_iterator(space_id, index_id, type, k, ke);
+	}
 	if (c->iter == NULL) {
 		pCur->eState = CURSOR_INVALID;
 		return SQLITE_TARANTOOL_ERROR;
@@ -1065,6 +1119,183 @@ cursor_advance(BtCursor *pCur, int *pRes)
 	return SQLITE_OK;
 }
 
+/*********************************************************************
+ * Ephemeral tables.
+ *
+ * Transient indexes opened with OP_OpenEphemeral are backed by
+ * memtx spaces which are not registered in the space cache and
+ * bypass transactions and WAL: tuples are put into and removed
+ * from the primary index directly. A space is created on the
+ * first insert, when the number of fields in a record is known.
+ */
+
+/*
+ * Create a space for records of an ephemeral table. The primary
+ * key covers the first @part_count fields of a record, each
+ * compared as a nullable scalar with the collation taken from
+ * @key_info.
+ */
+static struct space *
+ephemeral_space_new(const KeyInfo *key_info, uint32_t part_count)
+{
+	static const char name[] = "ephemeral";
+	static const char engine[] = "memtx";
+	struct space_opts opts = space_opts_default;
+	opts.temporary = true;
+	struct space_def *def = space_def_new(0, 0, 0, name, strlen(name),
+					      engine, strlen(engine),
+					      &opts, NULL, 0);
+	if (def == NULL)
+		return NULL;
+	struct key_def *key_def = key_def_new(part_count);
+	if (key_def == NULL) {
+		space_def_delete(def);
+		return NULL;
+	}
+	for (uint32_t i = 0; i < part_count; i++) {
+		key_def_set_part(key_def, i, i, FIELD_TYPE_SCALAR, true,
+				 key_info->aColl[i]);
+	}
+	struct index_opts index_opts = index_opts_default;
+	index_opts.is_unique = true;
+	struct index_def *index_def = index_def_new(0, 0, name, strlen(name),
+						    TREE, &index_opts,
+						    key_def, NULL);
+	box_key_def_delete(key_def);
+	struct space *space = NULL;
+	if (index_def != NULL) {
+		struct rlist key_list;
+		rlist_create(&key_list);
+		rlist_add_entry(&key_list, index_def, link);
+		space = space_new(def, &key_list);
+		index_def_delete(index_def);
+	}
+	space_def_delete(def);
+	return space;
+}
+
+/* Release all tuples of an ephemeral space and delete it. */
+static void
+ephemeral_space_delete(struct space *space)
+{
+	struct index *pk = space_index(space, 0);
+	struct iterator *it = index_create_iterator(pk, ITER_ALL, NULL, 0);
+	if (it != NULL) {
+		struct tuple *tuple;
+		while (iterator_next(it, &tuple) == 0 && tuple != NULL)
+			tuple_unref(tuple);
+		iterator_delete(it);
+	} else {
+		/* Memtx iterators do not fail, but just in case. */
+		diag_log();
+	}
+	space_delete(space);
+}
+
+/*
+ * Put a record into an ephemeral table, replacing a record
+ * with the same key, as an insert into an SQLite index btree
+ * does.
+ */
+static int
+ephemeral_replace(BtCursor *pCur, const char *data, const char *end)
+{
+	assert(pCur->curFlags & BTCF_TEphemCursor);
+	const char *p = data;
+	uint32_t field_count = mp_decode_array(&p);
+	if (pCur->pTaSpace == NULL) {
+		/*
+		 * SQLite compares at most nField + 1 fields of
+		 * index records, do the same.
+		 */
+		const KeyInfo *key_info = pCur->pKeyInfo;
+		uint32_t part_count = key_info->nField +
+				      MIN(key_info->nXField, 1);
+		part_count = MIN(part_count, field_count);
+		assert(part_count > 0);
+		pCur->pTaSpace = ephemeral_space_new(key_info, part_count);
+		if (pCur->pTaSpace == NULL)
+			return -1;
+	}
+	struct index *pk = space_index(pCur->pTaSpace, 0);
+	uint32_t part_count = pk->def->key_def->part_count;
+	/* Nullable key fields must be present in a tuple. */
+	if (field_count < part_count) {
+		diag_set(ClientError, ER_INDEX_FIELD_COUNT, field_count,
+			 part_count);
+		return -1;
+	}
+	struct tuple *new_tuple = tuple_new(pCur->pTaSpace->format, data, end);
+	if (new_tuple == NULL)
+		return -1;
+	tuple_ref(new_tuple);
+	struct tuple *old_tuple;
+	if (index_replace(pk, NULL, new_tuple, DUP_REPLACE_OR_INSERT,
+			  &old_tuple) != 0) {
+		tuple_unref(new_tuple);
+		return -1;
+	}
+	if (old_tuple != NULL)
+		tuple_unref(old_tuple);
+	return 0;
+}
+
+int
+tarantoolSqlite3EphemeralIsSupported(const KeyInfo *pKeyInfo)
+{
+	/* Tarantool key parts have no sort order. */
+	u32 part_count = pKeyInfo->nField + MIN(pKeyInfo->nXField, 1);
+	for (u32 i = 0; i < part_count; i++) {
+		if (pKeyInfo->aSortOrder[i] != 0)
+			return 0;
+	}
+	return 1;
+}
+
+void
+tarantoolSqlite3EphemeralOpen(BtCursor *pCur, Btree *pBtree,
+			      KeyInfo *pKeyInfo)
+{
+	/*
+	 * The cursor is not linked into the btree cursor list,
+	 * pBtree is only set for the sake of btree.c assertions.
+	 */
+	pCur->pBtree = pBtree;
+	pCur->pBt = pBtree->pBt;
+	pCur->pKeyInfo = pKeyInfo;
+	pCur->curFlags = BTCF_WriteFlag | BTCF_TaCursor | BTCF_TEphemCursor;
+	pCur->eState = CURSOR_INVALID;
+	pCur->iPage = -1;
+	pCur->curIntKey = 0;
+	pCur->pTaCursor = NULL;
+	pCur->pTaSpace = NULL;
+}
+
+int
+tarantoolSqlite3EphemeralClear(BtCursor *pCur)
+{
+	assert(pCur->curFlags & BTCF_TEphemCursor);
+
+	struct ta_cursor *c = pCur->pTaCursor;
+
+	if (c != NULL) {
+		if (c->iter != NULL) {
+			box_iterator_free(c->iter);
+			c->iter = NULL;
+		}
+		if (c->tuple_last != NULL) {
+			box_tuple_unref(c->tuple_last);
+			c->tuple_last = NULL;
+		}
+	}
+	if (pCur->pTaSpace != NULL) {
+		ephemeral_space_delete(pCur->pTaSpace);
+		pCur->pTaSpace = NULL;
+	}
+	pCur->eState = CURSOR_INVALID;
+	return SQLITE_OK;
+}
+
 /*********************************************************************
  * Schema support.
  */
@@ -3617,6 +3617,10 @@ int
 sqlite3BtreeCloseCursor(BtCursor * pCur)
 {
 	Btree *pBtree = pCur->pBtree;
+	if (pCur->curFlags & BTCF_TEphemCursor) {
+		/* Not linked into the btree, see tarantoolSqlite3EphemeralOpen. */
+		return tarantoolSqlite3CloseCursor(pCur);
+	}
 	if (pBtree) {
 		int i;
 		BtShared *pBt = pCur->pBt;
@@ -535,6 +535,7 @@ struct BtCursor {
 	u8 curIntKey;		/* Value of apPage[0]->intKey */
 	struct KeyInfo *pKeyInfo;	/* Argument passed to comparison function */
 	void *pTaCursor;	/* Tarantool cursor */
+	struct space *pTaSpace;	/* Ephemeral space, if BTCF_TEphemCursor */
 	u16 aiIdx[BTCURSOR_MAX_DEPTH];	/* Current index in apPage[i] */
 	MemPage *apPage[BTCURSOR_MAX_DEPTH];	/* Pages from root to current page */
 };
@@ -548,6 +549,7 @@ struct BtCursor {
 #define BTCF_AtLast       0x08	/* Cursor is pointing ot the last entry */
 #define BTCF_Incrblob     0x10	/* True if an incremental I/O handle */
 #define BTCF_Multiple     0x20	/* Maybe another cursor on the same btree */
+#define BTCF_TEphemCursor 0x40	/* Tarantool ephemeral space cursor */
 #define BTCF_TaCursor     0x80	/* Tarantool cursor, pTaCursor valid */
 
 /*
@@ -53,122 +53,126 @@ const char *sqlite3OpcodeName(int i){
     /*  39 */ "Once"             OpHelp(""),
     /*  40 */ "If"               OpHelp(""),
     /*  41 */ "IfNot"            OpHelp(""),
-    /*  42 */ "SeekLT"           OpHelp("key=r[P3@P4]"),
-    /*  43 */ "SeekLE"           OpHelp("key=r[P3@P4]"),
-    /*  44 */ "SeekGE"           OpHelp("key=r[P3@P4]"),
-    /*  45 */ "SeekGT"           OpHelp("key=r[P3@P4]"),
-    /*  46 */ "NoConflict"       OpHelp("key=r[P3@P4]"),
-    /*  47 */ "NotFound"         OpHelp("key=r[P3@P4]"),
-    /*  48 */ "Found"            OpHelp("key=r[P3@P4]"),
-    /*  49 */ "SeekRowid"        OpHelp("intkey=r[P3]"),
-    /*  50 */ "NotExists"        OpHelp("intkey=r[P3]"),
-    /*  51 */ "Last"             OpHelp(""),
-    /*  52 */ "SorterSort"       OpHelp(""),
-    /*  53 */ "Sort"             OpHelp(""),
-    /*  54 */ "Rewind"           OpHelp(""),
-    /*  55 */ "IdxLE"            OpHelp("key=r[P3@P4]"),
-    /*  56 */ "IdxGT"            OpHelp("key=r[P3@P4]"),
-    /*  57 */ "IdxLT"            OpHelp("key=r[P3@P4]"),
-    /*  58 */ "IdxGE"            OpHelp("key=r[P3@P4]"),
-    /*  59 */ "RowSetRead"       OpHelp("r[P3]=rowset(P1)"),
-    /*  60 */ "RowSetTest"       OpHelp("if r[P3] in rowset(P1) goto P2"),
-    /*  61 */ "Program"          OpHelp(""),
-    /*  62 */ "FkIfZero"         OpHelp("if fkctr[P1]==0 goto P2"),
-    /*  63 */ "IfPos"            OpHelp("if r[P1]>0 then r[P1]-=P3, goto P2"),
-    /*  64 */ "IfNotZero"        OpHelp("if r[P1]!=0 then r[P1]--, goto P2"),
-    /*  65 */ "DecrJumpZero"     OpHelp("if (--r[P1])==0 goto P2"),
-    /*  66 */ "Init"             OpHelp("Start at P2"),
-    /*  67 */ "Return"           OpHelp(""),
-    /*  68 */ "EndCoroutine"     OpHelp(""),
-    /*  69 */ "HaltIfNull"       OpHelp("if r[P3]=null halt"),
-    /*  70 */ "Halt"             OpHelp(""),
-    /*  71 */ "Integer"          OpHelp("r[P2]=P1"),
-    /*  72 */ "Bool"             OpHelp("r[P2]=P1"),
-    /*  73 */ "Int64"            OpHelp("r[P2]=P4"),
-    /*  74 */ "String"           OpHelp("r[P2]='P4' (len=P1)"),
+    /*  42 */ "HashSeek"         OpHelp("key=r[P3@..]"),
+    /*  43 */ "HashNext"         OpHelp(""),
+    /*  44 */ "SeekLT"           OpHelp("key=r[P3@P4]"),
+    /*  45 */ "SeekLE"           OpHelp("key=r[P3@P4]"),
+    /*  46 */ "SeekGE"           OpHelp("key=r[P3@P4]"),
+    /*  47 */ "SeekGT"           OpHelp("key=r[P3@P4]"),
+    /*  48 */ "NoConflict"       OpHelp("key=r[P3@P4]"),
+    /*  49 */ "NotFound"         OpHelp("key=r[P3@P4]"),
+    /*  50 */ "Found"            OpHelp("key=r[P3@P4]"),
+    /*  51 */ "SeekRowid"        OpHelp("intkey=r[P3]"),
+    /*  52 */ "NotExists"        OpHelp("intkey=r[P3]"),
+    /*  53 */ "Last"             OpHelp(""),
+    /*  54 */ "SorterSort"       OpHelp(""),
+    /*  55 */ "Sort"             OpHelp(""),
+    /*  56 */ "Rewind"           OpHelp(""),
+    /*  57 */ "IdxLE"            OpHelp("key=r[P3@P4]"),
+    /*  58 */ "IdxGT"            OpHelp("key=r[P3@P4]"),
+    /*  59 */ "IdxLT"            OpHelp("key=r[P3@P4]"),
+    /*  60 */ "IdxGE"            OpHelp("key=r[P3@P4]"),
+    /*  61 */ "RowSetRead"       OpHelp("r[P3]=rowset(P1)"),
+    /*  62 */ "RowSetTest"       OpHelp("if r[P3] in rowset(P1) goto P2"),
+    /*  63 */ "Program"          OpHelp(""),
+    /*  64 */ "FkIfZero"         OpHelp("if fkctr[P1]==0 goto P2"),
+    /*  65 */ "IfPos"            OpHelp("if r[P1]>0 then r[P1]-=P3, goto P2"),
+    /*  66 */ "IfNotZero"        OpHelp("if r[P1]!=0 then r[P1]--, goto P2"),
+    /*  67 */ "DecrJumpZero"     OpHelp("if (--r[P1])==0 goto P2"),
+    /*  68 */ "Init"             OpHelp("Start at P2"),
+    /*  69 */ "Return"           OpHelp(""),
+    /*  70 */ "EndCoroutine"     OpHelp(""),
+    /*  71 */ "HaltIfNull"       OpHelp("if r[P3]=null halt"),
+    /*  72 */ "Halt"             OpHelp(""),
+    /*  73 */ "Integer"          OpHelp("r[P2]=P1"),
+    /*  74 */ "Bool"             OpHelp("r[P2]=P1"),
     /*  75 */ "String8"          OpHelp("r[P2]='P4'"),
-    /*  76 */ "Null"             OpHelp("r[P2..P3]=NULL"),
-    /*  77 */ "SoftNull"         OpHelp("r[P1]=NULL"),
-    /*  78 */ "Blob"             OpHelp("r[P2]=P4 (len=P1, subtype=P3)"),
-    /*  79 */ "Variable"         OpHelp("r[P2]=parameter(P1,P4)"),
-    /*  80 */ "Move"             OpHelp("r[P2@P3]=r[P1@P3]"),
-    /*  81 */ "Copy"             OpHelp("r[P2@P3+1]=r[P1@P3+1]"),
-    /*  82 */ "SCopy"            OpHelp("r[P2]=r[P1]"),
-    /*  83 */ "IntCopy"          OpHelp("r[P2]=r[P1]"),
-    /*  84 */ "ResultRow"        OpHelp("output=r[P1@P2]"),
-    /*  85 */ "CollSeq"          OpHelp(""),
-    /*  86 */ "Function0"        OpHelp("r[P3]=func(r[P2@P5])"),
-    /*  87 */ "Function"         OpHelp("r[P3]=func(r[P2@P5])"),
-    /*  88 */ "AddImm"           OpHelp("r[P1]=r[P1]+P2"),
-    /*  89 */ "RealAffinity"     OpHelp(""),
-    /*  90 */ "Cast"             OpHelp("affinity(r[P1])"),
-    /*  91 */ "Permutation"      OpHelp(""),
-    /*  92 */ "Compare"          OpHelp("r[P1@P3] <-> r[P2@P3]"),
-    /*  93 */ "Column"           OpHelp("r[P3]=PX"),
-    /*  94 */ "Affinity"         OpHelp("affinity(r[P1@P2])"),
-    /*  95 */ "MakeRecord"       OpHelp("r[P3]=mkrec(r[P1@P2])"),
-    /*  96 */ "Count"            OpHelp("r[P2]=count()"),
-    /*  97 */ "FkCheckCommit"    OpHelp(""),
-    /*  98 */ "TTransaction"     OpHelp(""),
-    /*  99 */ "ReadCookie"       OpHelp(""),
-    /* 100 */ "SetCookie"        OpHelp(""),
-    /* 101 */ "ReopenIdx"        OpHelp("root=P2"),
-    /* 102 */ "OpenRead"         OpHelp("root=P2"),
-    /* 103 */ "OpenWrite"        OpHelp("root=P2"),
-    /* 104 */ "OpenAutoindex"    OpHelp("nColumn=P2"),
-    /* 105 */ "OpenEphemeral"    OpHelp("nColumn=P2"),
-    /* 106 */ "SorterOpen"       OpHelp(""),
-    /* 107 */ "SequenceTest"     OpHelp("if (cursor[P1].ctr++) pc = P2"),
-    /* 108 */ "OpenPseudo"       OpHelp("P3 columns in r[P2]"),
-    /* 109 */ "Close"            OpHelp(""),
-    /* 110 */ "ColumnsUsed"      OpHelp(""),
-    /* 111 */ "Sequence"         OpHelp("r[P2]=cursor[P1].ctr++"),
-    /* 112 */ "NextId"           OpHelp("r[P3]=get_max(space_index[P1]{Column[P2]})"),
-    /* 113 */ "FCopy"            OpHelp("reg[P2@cur_frame]= reg[P1@root_frame(OPFLAG_SAME_FRAME)]"),
-    /* 114 */ "NewRowid"         OpHelp("r[P2]=rowid"),
+    /*  76 */ "Int64"            OpHelp("r[P2]=P4"),
+    /*  77 */ "String"           OpHelp("r[P2]='P4' (len=P1)"),
+    /*  78 */ "Null"             OpHelp("r[P2..P3]=NULL"),
+    /*  79 */ "SoftNull"         OpHelp("r[P1]=NULL"),
+    /*  80 */ "Blob"             OpHelp("r[P2]=P4 (len=P1, subtype=P3)"),
+    /*  81 */ "Variable"         OpHelp("r[P2]=parameter(P1,P4)"),
+    /*  82 */ "Move"             OpHelp("r[P2@P3]=r[P1@P3]"),
+    /*  83 */ "Copy"             OpHelp("r[P2@P3+1]=r[P1@P3+1]"),
+    /*  84 */ "SCopy"            OpHelp("r[P2]=r[P1]"),
+    /*  85 */ "IntCopy"          OpHelp("r[P2]=r[P1]"),
+    /*  86 */ "ResultRow"        OpHelp("output=r[P1@P2]"),
+    /*  87 */ "CollSeq"          OpHelp(""),
+    /*  88 */ "Function0"        OpHelp("r[P3]=func(r[P2@P5])"),
+    /*  89 */ "Function"         OpHelp("r[P3]=func(r[P2@P5])"),
+    /*  90 */ "AddImm"           OpHelp("r[P1]=r[P1]+P2"),
+    /*  91 */ "RealAffinity"     OpHelp(""),
+    /*  92 */ "Cast"             OpHelp("affinity(r[P1])"),
+    /*  93 */ "Permutation"      OpHelp(""),
+    /*  94 */ "Compare"          OpHelp("r[P1@P3] <-> r[P2@P3]"),
+    /*  95 */ "Column"           OpHelp("r[P3]=PX"),
+    /*  96 */ "Affinity"         OpHelp("affinity(r[P1@P2])"),
+    /*  97 */ "MakeRecord"       OpHelp("r[P3]=mkrec(r[P1@P2])"),
+    /*  98 */ "Count"            OpHelp("r[P2]=count()"),
+    /*  99 */ "FkCheckCommit"    OpHelp(""),
+    /* 100 */ "TTransaction"     OpHelp(""),
+    /* 101 */ "ReadCookie"       OpHelp(""),
+    /* 102 */ "SetCookie"        OpHelp(""),
+    /* 103 */ "ReopenIdx"        OpHelp("root=P2"),
+    /* 104 */ "OpenRead"         OpHelp("root=P2"),
+    /* 105 */ "OpenWrite"        OpHelp("root=P2"),
+    /* 106 */ "OpenAutoindex"    OpHelp("nColumn=P2"),
+    /* 107 */ "OpenEphemeral"    OpHelp("nColumn=P2"),
+    /* 108 */ "SorterOpen"       OpHelp(""),
+    /* 109 */ "SequenceTest"     OpHelp("if (cursor[P1].ctr++) pc = P2"),
+    /* 110 */ "OpenPseudo"       OpHelp("P3 columns in r[P2]"),
+    /* 111 */ "HashOpen"         OpHelp("P3 key columns, P2 columns"),
+    /* 112 */ "HashInsert"       OpHelp("key=r[P2@..] data=r[P3]"),
+    /* 113 */ "Close"            OpHelp(""),
+    /* 114 */ "ColumnsUsed"      OpHelp(""),
     /* 115 */ "Real"             OpHelp("r[P2]=P4"),
-    /* 116 */ "Insert"           OpHelp("intkey=r[P3] data=r[P2]"),
-    /* 117 */ "InsertInt"        OpHelp("intkey=P3 data=r[P2]"),
-    /* 118 */ "Delete"           OpHelp(""),
-    /* 119 */ "ResetCount"       OpHelp(""),
-    /* 120 */ "SorterCompare"    OpHelp("if key(P1)!=trim(r[P3],P4) goto P2"),
-    /* 121 */ "SorterData"       OpHelp("r[P2]=data"),
-    /* 122 */ "RowData"          OpHelp("r[P2]=data"),
-    /* 123 */ "Rowid"            OpHelp("r[P2]=rowid"),
-    /* 124 */ "NullRow"          OpHelp(""),
-    /* 125 */ "SorterInsert"     OpHelp("key=r[P2]"),
-    /* 126 */ "IdxInsert"        OpHelp("key=r[P2]"),
-    /* 127 */ "IdxDelete"        OpHelp("key=r[P2@P3]"),
-    /* 128 */ "Seek"             OpHelp("Move P3 to P1.rowid"),
-    /* 129 */ "IdxRowid"         OpHelp("r[P2]=rowid"),
-    /* 130 */ "Destroy"          OpHelp(""),
-    /* 131 */ "Clear"            OpHelp(""),
-    /* 132 */ "ResetSorter"      OpHelp(""),
-    /* 133 */ "CreateIndex"      OpHelp("r[P2]=root"),
-    /* 134 */ "CreateTable"      OpHelp("r[P2]=root"),
-    /* 135 */ "ParseSchema2"     OpHelp("rows=r[P1@P2]"),
-    /* 136 */ "ParseSchema3"     OpHelp("name=r[P1] sql=r[P1+1]"),
-    /* 137 */ "RenameTable"      OpHelp("P1 = root, P4 = name"),
-    /* 138 */ "LoadAnalysis"     OpHelp(""),
-    /* 139 */ "DropTable"        OpHelp(""),
-    /* 140 */ "DropIndex"        OpHelp(""),
-    /* 141 */ "DropTrigger"      OpHelp(""),
-    /* 142 */ "IntegrityCk"      OpHelp(""),
-    /* 143 */ "RowSetAdd"        OpHelp("rowset(P1)=r[P2]"),
-    /* 144 */ "Param"            OpHelp(""),
-    /* 145 */ "FkCounter"        OpHelp("fkctr[P1]+=P2"),
-    /* 146 */ "MemMax"           OpHelp("r[P1]=max(r[P1],r[P2])"),
-    /* 147 */ "OffsetLimit"      OpHelp("if r[P1]>0 then r[P2]=r[P1]+max(0,r[P3]) else r[P2]=(-1)"),
-    /* 148 */ "AggStep0"         OpHelp("accum=r[P3] step(r[P2@P5])"),
-    /* 149 */ "AggStep"          OpHelp("accum=r[P3] step(r[P2@P5])"),
-    /* 150 */ "AggFinal"         OpHelp("accum=r[P1] N=P2"),
-    /* 151 */ "Expire"           OpHelp(""),
-    /* 152 */ "Pagecount"        OpHelp(""),
-    /* 153 */ "MaxPgcnt"         OpHelp(""),
-    /* 154 */ "CursorHint"       OpHelp(""),
-    /* 155 */ "IncMaxid"         OpHelp(""),
-    /* 156 */ "Noop"             OpHelp(""),
-    /* 157 */ "Explain"          OpHelp(""),
+    /* 116 */ "Sequence"         OpHelp("r[P2]=cursor[P1].ctr++"),
+    /* 117 */ "NextId"           OpHelp("r[P3]=get_max(space_index[P1]{Column[P2]})"),
+    /* 118 */ "FCopy"            OpHelp("reg[P2@cur_frame]= reg[P1@root_frame(OPFLAG_SAME_FRAME)]"),
+    /* 119 */ "NewRowid"         OpHelp("r[P2]=rowid"),
+    /* 120 */ "Insert"           OpHelp("intkey=r[P3] data=r[P2]"),
+    /* 121 */ "InsertInt"        OpHelp("intkey=P3 data=r[P2]"),
+    /* 122 */ "Delete"           OpHelp(""),
+    /* 123 */ "ResetCount"       OpHelp(""),
+    /* 124 */ "SorterCompare"    OpHelp("if key(P1)!=trim(r[P3],P4) goto P2"),
+    /* 125 */ "SorterData"       OpHelp("r[P2]=data"),
+    /* 126 */ "RowData"          OpHelp("r[P2]=data"),
+    /* 127 */ "Rowid"            OpHelp("r[P2]=rowid"),
+    /* 128 */ "NullRow"          OpHelp(""),
+    /* 129 */ "SorterInsert"     OpHelp("key=r[P2]"),
+    /* 130 */ "IdxInsert"        OpHelp("key=r[P2]"),
+    /* 131 */ "IdxDelete"        OpHelp("key=r[P2@P3]"),
+    /* 132 */ "Seek"             OpHelp("Move P3 to P1.rowid"),
+    /* 133 */ "IdxRowid"         OpHelp("r[P2]=rowid"),
+    /* 134 */ "Destroy"          OpHelp(""),
+    /* 135 */ "Clear"            OpHelp(""),
+    /* 136 */ "ResetSorter"      OpHelp(""),
+    /* 137 */ "CreateIndex"      OpHelp("r[P2]=root"),
+    /* 138 */ "CreateTable"      OpHelp("r[P2]=root"),
+    /* 139 */ "ParseSchema2"     OpHelp("rows=r[P1@P2]"),
+    /* 140 */ "ParseSchema3"     OpHelp("name=r[P1] sql=r[P1+1]"),
+    /* 141 */ "RenameTable"      OpHelp("P1 = root, P4 = name"),
+    /* 142 */ "LoadAnalysis"     OpHelp(""),
+    /* 143 */ "DropTable"        OpHelp(""),
+    /* 144 */ "DropIndex"        OpHelp(""),
+    /* 145 */ "DropTrigger"      OpHelp(""),
+    /* 146 */ "IntegrityCk"      OpHelp(""),
+    /* 147 */ "RowSetAdd"        OpHelp("rowset(P1)=r[P2]"),
+    /* 148 */ "Param"            OpHelp(""),
+    /* 149 */ "FkCounter"        OpHelp("fkctr[P1]+=P2"),
+    /* 150 */ "MemMax"           OpHelp("r[P1]=max(r[P1],r[P2])"),
+    /* 151 */ "OffsetLimit"      OpHelp("if r[P1]>0 then r[P2]=r[P1]+max(0,r[P3]) else r[P2]=(-1)"),
+    /* 152 */ "AggStep0"         OpHelp("accum=r[P3] step(r[P2@P5])"),
+    /* 153 */ "AggStep"          OpHelp("accum=r[P3] step(r[P2@P5])"),
+    /* 154 */ "AggFinal"         OpHelp("accum=r[P1] N=P2"),
+    /* 155 */ "Expire"           OpHelp(""),
+    /* 156 */ "Pagecount"        OpHelp(""),
+    /* 157 */ "MaxPgcnt"         OpHelp(""),
+    /* 158 */ "CursorHint"       OpHelp(""),
+    /* 159 */ "IncMaxid"         OpHelp(""),
+    /* 160 */ "Noop"             OpHelp(""),
+    /* 161 */ "Explain"          OpHelp(""),
   };
   return azName[i];
 }
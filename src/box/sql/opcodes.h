@@ -42,122 +42,126 @@
 #define OP_Once           39
 #define OP_If             40
 #define OP_IfNot          41
-#define OP_SeekLT         42 /* synopsis: key=r[P3@P4]                     */
-#define OP_SeekLE         43 /* synopsis: key=r[P3@P4]                     */
-#define OP_SeekGE         44 /* synopsis: key=r[P3@P4]                     */
-#define OP_SeekGT         45 /* synopsis: key=r[P3@P4]                     */
-#define OP_NoConflict     46 /* synopsis: key=r[P3@P4]                     */
-#define OP_NotFound       47 /* synopsis: key=r[P3@P4]                     */
-#define OP_Found          48 /* synopsis: key=r[P3@P4]                     */
-#define OP_SeekRowid      49 /* synopsis: intkey=r[P3]                     */
-#define OP_NotExists      50 /* synopsis: intkey=r[P3]                     */
-#define OP_Last           51
-#define OP_SorterSort     52
-#define OP_Sort           53
-#define OP_Rewind         54
-#define OP_IdxLE          55 /* synopsis: key=r[P3@P4]                     */
-#define OP_IdxGT          56 /* synopsis: key=r[P3@P4]                     */
-#define OP_IdxLT          57 /* synopsis: key=r[P3@P4]                     */
-#define OP_IdxGE          58 /* synopsis: key=r[P3@P4]                     */
-#define OP_RowSetRead     59 /* synopsis: r[P3]=rowset(P1)                 */
-#define OP_RowSetTest     60 /* synopsis: if r[P3] in rowset(P1) goto P2   */
-#define OP_Program        61
-#define OP_FkIfZero       62 /* synopsis: if fkctr[P1]==0 goto P2          */
-#define OP_IfPos          63 /* synopsis: if r[P1]>0 then r[P1]-=P3, goto P2 */
-#define OP_IfNotZero      64 /* synopsis: if r[P1]!=0 then r[P1]--, goto P2 */
-#define OP_DecrJumpZero   65 /* synopsis: if (--r[P1])==0 goto P2          */
-#define OP_Init           66 /* synopsis: Start at P2                      */
-#define OP_Return         67
-#define OP_EndCoroutine   68
-#define OP_HaltIfNull     69 /* synopsis: if r[P3]=null halt               */
-#define OP_Halt           70
-#define OP_Integer        71 /* synopsis: r[P2]=P1                         */
-#define OP_Bool           72 /* synopsis: r[P2]=P1                         */
-#define OP_Int64          73 /* synopsis: r[P2]=P4                         */
-#define OP_String         74 /* synopsis: r[P2]='P4' (len=P1)              */
+#define OP_HashSeek       42 /* synopsis: key=r[P3@..]                     */
+#define OP_HashNext       43
+#define OP_SeekLT         44 /* synopsis: key=r[P3@P4]                     */
+#define OP_SeekLE         45 /* synopsis: key=r[P3@P4]                     */
+#define OP_SeekGE         46 /* synopsis: key=r[P3@P4]                     */
+#define OP_SeekGT         47 /* synopsis: key=r[P3@P4]                     */
+#define OP_NoConflict     48 /* synopsis: key=r[P3@P4]                     */
+#define OP_NotFound       49 /* synopsis: key=r[P3@P4]                     */
+#define OP_Found          50 /* synopsis: key=r[P3@P4]                     */
+#define OP_SeekRowid      51 /* synopsis: intkey=r[P3]                     */
+#define OP_NotExists      52 /* synopsis: intkey=r[P3]                     */
+#define OP_Last           53
+#define OP_SorterSort     54
+#define OP_Sort           55
+#define OP_Rewind         56
+#define OP_IdxLE          57 /* synopsis: key=r[P3@P4]                     */
+#define OP_IdxGT          58 /* synopsis: key=r[P3@P4]                     */
+#define OP_IdxLT          59 /* synopsis: key=r[P3@P4]                     */
+#define OP_IdxGE          60 /* synopsis: key=r[P3@P4]                     */
+#define OP_RowSetRead     61 /* synopsis: r[P3]=rowset(P1)                 */
+#define OP_RowSetTest     62 /* synopsis: if r[P3] in rowset(P1) goto P2   */
+#define OP_Program        63
+#define OP_FkIfZero       64 /* synopsis: if fkctr[P1]==0 goto P2          */
+#define OP_IfPos          65 /* synopsis: if r[P1]>0 then r[P1]-=P3, goto P2 */
+#define OP_IfNotZero      66 /* synopsis: if r[P1]!=0 then r[P1]--, goto P2 */
+#define OP_DecrJumpZero   67 /* synopsis: if (--r[P1])==0 goto P2          */
+#define OP_Init           68 /* synopsis: Start at P2                      */
+#define OP_Return         69
+#define OP_EndCoroutine   70
+#define OP_HaltIfNull     71 /* synopsis: if r[P3]=null halt               */
+#define OP_Halt           72
+#define OP_Integer        73 /* synopsis: r[P2]=P1                         */
+#define OP_Bool           74 /* synopsis: r[P2]=P1                         */
 #define OP_String8        75 /* same as TK_STRING, synopsis: r[P2]='P4'    */
-#define OP_Null           76 /* synopsis: r[P2..P3]=NULL                   */
-#define OP_SoftNull       77 /* synopsis: r[P1]=NULL                       */
-#define OP_Blob           78 /* synopsis: r[P2]=P4 (len=P1, subtype=P3)    */
-#define OP_Variable       79 /* synopsis: r[P2]=parameter(P1,P4)           */
-#define OP_Move           80 /* synopsis: r[P2@P3]=r[P1@P3]                */
-#define OP_Copy           81 /* synopsis: r[P2@P3+1]=r[P1@P3+1]            */
-#define OP_SCopy          82 /* synopsis: r[P2]=r[P1]                      */
-#define OP_IntCopy        83 /* synopsis: r[P2]=r[P1]                      */
-#define OP_ResultRow      84 /* synopsis: output=r[P1@P2]                  */
-#define OP_CollSeq        85
-#define OP_Function0      86 /* synopsis: r[P3]=func(r[P2@P5])             */
-#define OP_Function       87 /* synopsis: r[P3]=func(r[P2@P5])             */
-#define OP_AddImm         88 /* synopsis: r[P1]=r[P1]+P2                   */
-#define OP_RealAffinity   89
-#define OP_Cast           90 /* synopsis: affinity(r[P1])                  */
-#define OP_Permutation    91
-#define OP_Compare        92 /* synopsis: r[P1@P3] <-> r[P2@P3]            */
-#define OP_Column         93 /* synopsis: r[P3]=PX                         */
-#define OP_Affinity       94 /* synopsis: affinity(r[P1@P2])               */
-#define OP_MakeRecord     95 /* synopsis: r[P3]=mkrec(r[P1@P2])            */
-#define OP_Count          96 /* synopsis: r[P2]=count()                    */
-#define OP_FkCheckCommit  97
-#define OP_TTransaction   98
-#define OP_ReadCookie     99
-#define OP_SetCookie     100
-#define OP_ReopenIdx     101 /* synopsis: root=P2                          */
-#define OP_OpenRead      102 /* synopsis: root=P2                          */
-#define OP_OpenWrite     103 /* synopsis: root=P2                          */
-#define OP_OpenAutoindex 104 /* synopsis: nColumn=P2                       */
-#define OP_OpenEphemeral 105 /* synopsis: nColumn=P2                       */
-#define OP_SorterOpen    106
-#define OP_SequenceTest  107 /* synopsis: if (cursor[P1].ctr++) pc = P2    */
-#define OP_OpenPseudo    108 /* synopsis: P3 columns in r[P2]              */
-#define OP_Close         109
-#define OP_ColumnsUsed   110
-#define OP_Sequence      111 /* synopsis: r[P2]=cursor[P1].ctr++           */
-#define OP_NextId        112 /* synopsis: r[P3]=get_max(space_index[P1]{Column[P2]}) */
-#define OP_FCopy         113 /* synopsis: reg[P2@cur_frame]= reg[P1@root_frame(OPFLAG_SAME_FRAME)] */
-#define OP_NewRowid      114 /* synopsis: r[P2]=rowid                      */
+#define OP_Int64          76 /* synopsis: r[P2]=P4                         */
+#define OP_String         77 /* synopsis: r[P2]='P4' (len=P1)              */
+#define OP_Null           78 /* synopsis: r[P2..P3]=NULL                   */
+#define OP_SoftNull       79 /* synopsis: r[P1]=NULL                       */
+#define OP_Blob           80 /* synopsis: r[P2]=P4 (len=P1, subtype=P3)    */
+#define OP_Variable       81 /* synopsis: r[P2]=parameter(P1,P4)           */
+#define OP_Move           82 /* synopsis: r[P2@P3]=r[P1@P3]                */
+#define OP_Copy           83 /* synopsis: r[P2@P3+1]=r[P1@P3+1]            */
+#define OP_SCopy          84 /* synopsis: r[P2]=r[P1]                      */
+#define OP_IntCopy        85 /* synopsis: r[P2]=r[P1]                      */
+#define OP_ResultRow      86 /* synopsis: output=r[P1@P2]                  */
+#define OP_CollSeq        87
+#define OP_Function0      88 /* synopsis: r[P3]=func(r[P2@P5])             */
+#define OP_Function       89 /* synopsis: r[P3]=func(r[P2@P5])             */
+#define OP_AddImm         90 /* synopsis: r[P1]=r[P1]+P2                   */
+#define OP_RealAffinity   91
+#define OP_Cast           92 /* synopsis: affinity(r[P1])                  */
+#define OP_Permutation    93
+#define OP_Compare        94 /* synopsis: r[P1@P3] <-> r[P2@P3]            */
+#define OP_Column         95 /* synopsis: r[P3]=PX                         */
+#define OP_Affinity       96 /* synopsis: affinity(r[P1@P2])               */
+#define OP_MakeRecord     97 /* synopsis: r[P3]=mkrec(r[P1@P2])            */
+#define OP_Count          98 /* synopsis: r[P2]=count()                    */
+#define OP_FkCheckCommit  99
+#define OP_TTransaction  100
+#define OP_ReadCookie    101
+#define OP_SetCookie     102
+#define OP_ReopenIdx     103 /* synopsis: root=P2                          */
+#define OP_OpenRead      104 /* synopsis: root=P2                          */
+#define OP_OpenWrite     105 /* synopsis: root=P2                          */
+#define OP_OpenAutoindex 106 /* synopsis: nColumn=P2                       */
+#define OP_OpenEphemeral 107 /* synopsis: nColumn=P2                       */
+#define OP_SorterOpen    108
+#define OP_SequenceTest  109 /* synopsis: if (cursor[P1].ctr++) pc = P2    */
+#define OP_OpenPseudo    110 /* synopsis: P3 columns in r[P2]              */
+#define OP_HashOpen      111 /* synopsis: P3 key columns, P2 columns       */
+#define OP_HashInsert    112 /* synopsis: key=r[P2@..] data=r[P3]          */
+#define OP_Close         113
+#define OP_ColumnsUsed   114
 #define OP_Real          115 /* same as TK_FLOAT, synopsis: r[P2]=P4       */
-#define OP_Insert        116 /* synopsis: intkey=r[P3] data=r[P2]          */
-#define OP_InsertInt     117 /* synopsis: intkey=P3 data=r[P2]             */
-#define OP_Delete        118
-#define OP_ResetCount    119
-#define OP_SorterCompare 120 /* synopsis: if key(P1)!=trim(r[P3],P4) goto P2 */
-#define OP_SorterData    121 /* synopsis: r[P2]=data                       */
-#define OP_RowData       122 /* synopsis: r[P2]=data                       */
-#define OP_Rowid         123 /* synopsis: r[P2]=rowid                      */
-#define OP_NullRow       124
-#define OP_SorterInsert  125 /* synopsis: key=r[P2]                        */
-#define OP_IdxInsert     126 /* synopsis: key=r[P2]                        */
-#define OP_IdxDelete     127 /* synopsis: key=r[P2@P3]                     */
-#define OP_Seek          128 /* synopsis: Move P3 to P1.rowid              */
-#define OP_IdxRowid      129 /* synopsis: r[P2]=rowid                      */
-#define OP_Destroy       130
-#define OP_Clear         131
-#define OP_ResetSorter   132
-#define OP_CreateIndex   133 /* synopsis: r[P2]=root                       */
-#define OP_CreateTable   134 /* synopsis: r[P2]=root                       */
-#define OP_ParseSchema2  135 /* synopsis: rows=r[P1@P2]                    */
-#define OP_ParseSchema3  136 /* synopsis: name=r[P1] sql=r[P1+1]           */
-#define OP_RenameTable   137 /* synopsis: P1 = root, P4 = name             */
-#define OP_LoadAnalysis  138
-#define OP_DropTable     139
-#define OP_DropIndex     140
-#define OP_DropTrigger   141
-#define OP_IntegrityCk   142
-#define OP_RowSetAdd     143 /* synopsis: rowset(P1)=r[P2]                 */
-#define OP_Param         144
-#define OP_FkCounter     145 /* synopsis: fkctr[P1]+=P2                    */
-#define OP_MemMax        146 /* synopsis: r[P1]=max(r[P1],r[P2])           */
-#define OP_OffsetLimit   147 /* synopsis: if r[P1]>0 then r[P2]=r[P1]+max(0,r[P3]) else r[P2]=(-1) */
-#define OP_AggStep0      148 /* synopsis: accum=r[P3] step(r[P2@P5])       */
-#define OP_AggStep       149 /* synopsis: accum=r[P3] step(r[P2@P5])       */
-#define OP_AggFinal      150 /* synopsis: accum=r[P1] N=P2                 */
-#define OP_Expire        151
-#define OP_Pagecount     152
-#define OP_MaxPgcnt      153
-#define OP_CursorHint    154
-#define OP_IncMaxid      155
-#define OP_Noop          156
-#define OP_Explain       157
+#define OP_Sequence      116 /* synopsis: r[P2]=cursor[P1].ctr++           */
+#define OP_NextId        117 /* synopsis: r[P3]=get_max(space_index[P1]{Column[P2]}) */
+#define OP_FCopy         118 /* synopsis: reg[P2@cur_frame]= reg[P1@root_frame(OPFLAG_SAME_FRAME)] */
+#define OP_NewRowid      119 /* synopsis: r[P2]=rowid                      */
+#define OP_Insert        120 /* synopsis: intkey=r[P3] data=r[P2]          */
+#define OP_InsertInt     121 /* synopsis: intkey=P3 data=r[P2]             */
+#define OP_Delete        122
+#define OP_ResetCount    123
+#define OP_SorterCompare 124 /* synopsis: if key(P1)!=trim(r[P3],P4) goto P2 */
+#define OP_SorterData    125 /* synopsis: r[P2]=data                       */
+#define OP_RowData       126 /* synopsis: r[P2]=data                       */
+#define OP_Rowid         127 /* synopsis: r[P2]=rowid                      */
+#define OP_NullRow       128
+#define OP_SorterInsert  129 /* synopsis: key=r[P2]                        */
+#define OP_IdxInsert     130 /* synopsis: key=r[P2]                        */
+#define OP_IdxDelete     131 /* synopsis: key=r[P2@P3]                     */
+#define OP_Seek          132 /* synopsis: Move P3 to P1.rowid              */
+#define OP_IdxRowid      133 /* synopsis: r[P2]=rowid                      */
+#define OP_Destroy       134
+#define OP_Clear         135
+#define OP_ResetSorter   136
+#define OP_CreateIndex   137 /* synopsis: r[P2]=root                       */
+#define OP_CreateTable   138 /* synopsis: r[P2]=root                       */
+#define OP_ParseSchema2  139 /* synopsis: rows=r[P1@P2]                    */
+#define OP_ParseSchema3  140 /* synopsis: name=r[P1] sql=r[P1+1]           */
+#define OP_RenameTable   141 /* synopsis: P1 = root, P4 = name             */
+#define OP_LoadAnalysis  142
+#define OP_DropTable     143
+#define OP_DropIndex     144
+#define OP_DropTrigger   145
+#define OP_IntegrityCk   146
+#define OP_RowSetAdd     147 /* synopsis: rowset(P1)=r[P2]                 */
+#define OP_Param         148
+#define OP_FkCounter     149 /* synopsis: fkctr[P1]+=P2                    */
+#define OP_MemMax        150 /* synopsis: r[P1]=max(r[P1],r[P2])           */
+#define OP_OffsetLimit   151 /* synopsis: if r[P1]>0 then r[P2]=r[P1]+max(0,r[P3]) else r[P2]=(-1) */
+#define OP_AggStep0      152 /* synopsis: accum=r[P3] step(r[P2@P5])       */
+#define OP_AggStep       153 /* synopsis: accum=r[P3] step(r[P2@P5])       */
+#define OP_AggFinal      154 /* synopsis: accum=r[P1] N=P2                 */
+#define OP_Expire        155
+#define OP_Pagecount     156
+#define OP_MaxPgcnt      157
+#define OP_CursorHint    158
+#define OP_IncMaxid      159
+#define OP_Noop          160
+#define OP_Explain       161
 
 /* Properties such as "out2" or "jump" that are specified in
 ** comments following the "case" for each opcode in the vdbe.c
@@ -175,21 +179,22 @@
 /*  16 */ 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x01, 0x26, 0x26,\
 /*  24 */ 0x26, 0x26, 0x26, 0x26, 0x26, 0x26, 0x26, 0x26,\
 /*  32 */ 0x01, 0x12, 0x01, 0x01, 0x03, 0x03, 0x01, 0x01,\
-/*  40 */ 0x03, 0x03, 0x09, 0x09, 0x09, 0x09, 0x09, 0x09,\
-/*  48 */ 0x09, 0x09, 0x09, 0x01, 0x01, 0x01, 0x01, 0x01,\
-/*  56 */ 0x01, 0x01, 0x01, 0x23, 0x0b, 0x01, 0x01, 0x03,\
-/*  64 */ 0x03, 0x03, 0x01, 0x02, 0x02, 0x08, 0x00, 0x10,\
-/*  72 */ 0x10, 0x10, 0x10, 0x10, 0x10, 0x00, 0x10, 0x10,\
-/*  80 */ 0x00, 0x00, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00,\
-/*  88 */ 0x02, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00,\
-/*  96 */ 0x10, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00,\
-/* 104 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10,\
-/* 112 */ 0x20, 0x10, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00,\
-/* 120 */ 0x00, 0x00, 0x00, 0x10, 0x00, 0x04, 0x04, 0x00,\
-/* 128 */ 0x00, 0x10, 0x10, 0x00, 0x00, 0x10, 0x10, 0x00,\
-/* 136 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x06,\
-/* 144 */ 0x10, 0x00, 0x04, 0x1a, 0x00, 0x00, 0x00, 0x00,\
-/* 152 */ 0x10, 0x10, 0x00, 0x00, 0x00, 0x00,}
+/*  40 */ 0x03, 0x03, 0x01, 0x01, 0x09, 0x09, 0x09, 0x09,\
+/*  48 */ 0x09, 0x09, 0x09, 0x09, 0x09, 0x01, 0x01, 0x01,\
+/*  56 */ 0x01, 0x01, 0x01, 0x01, 0x01, 0x23, 0x0b, 0x01,\
+/*  64 */ 0x01, 0x03, 0x03, 0x03, 0x01, 0x02, 0x02, 0x08,\
+/*  72 */ 0x00, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00,\
+/*  80 */ 0x10, 0x10, 0x00, 0x00, 0x10, 0x10, 0x00, 0x00,\
+/*  88 */ 0x00, 0x00, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00,\
+/*  96 */ 0x00, 0x00, 0x10, 0x00, 0x00, 0x10, 0x00, 0x00,\
+/* 104 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,\
+/* 112 */ 0x00, 0x00, 0x00, 0x10, 0x10, 0x20, 0x10, 0x10,\
+/* 120 */ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10,\
+/* 128 */ 0x00, 0x04, 0x04, 0x00, 0x00, 0x10, 0x10, 0x00,\
+/* 136 */ 0x00, 0x10, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00,\
+/* 144 */ 0x00, 0x00, 0x00, 0x06, 0x10, 0x00, 0x04, 0x1a,\
+/* 152 */ 0x00, 0x00, 0x00, 0x00, 0x10, 0x10, 0x00, 0x00,\
+/* 160 */ 0x00, 0x00,}
 
 /* The sqlite3P2Values() routine is able to run faster if it knows
 ** the value of the largest JUMP opcode.  The smaller the maximum
@@ -197,4 +202,4 @@
 ** generated this include file strives to group all JUMP opcodes
 ** together near the beginning of the list.
 */
-#define SQLITE_MX_JUMP_OPCODE  66  /* Maximum JUMP opcode */
+#define SQLITE_MX_JUMP_OPCODE  68  /* Maximum JUMP opcode */
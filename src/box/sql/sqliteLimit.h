@@ -232,6 +232,15 @@ enum {
 #define SQLITE_MAX_TRIGGER_DEPTH 1000
 #endif
 
+/*
+ * Maximum number of bytes of memory a hash table built for a hash
+ * join may take.  A bigger hash table is dropped and the join falls
+ * back to a nested loop.
+ */
+#ifndef SQLITE_MAX_HASH_JOIN_SIZE
+#define SQLITE_MAX_HASH_JOIN_SIZE (256 * 1024 * 1024)
+#endif
+
 /*
  * Tarantool: gh-2550: Fiber stack is 64KB by default, so maximum
  * number of entities (in chain of compiling trigger programs) should be less than
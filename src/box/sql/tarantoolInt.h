@@ -70,6 +70,18 @@ int tarantoolSqlite3Insert(BtCursor * pCur, const BtreePayload * pX);
 int tarantoolSqlite3Delete(BtCursor * pCur, u8 flags);
 int tarantoolSqlite3ClearTable(int iTable);
 
+/*
+ * Ephemeral tables backed by memtx spaces.
+ * Check that a transient index with the given key info can be
+ * stored in a memtx space (there are no DESC key parts).
+ */
+int tarantoolSqlite3EphemeralIsSupported(const KeyInfo * pKeyInfo);
+/* Initialize a write cursor on a new empty ephemeral table. */
+void tarantoolSqlite3EphemeralOpen(BtCursor * pCur, Btree * pBtree,
+				   KeyInfo * pKeyInfo);
+/* Delete all records of an ephemeral table. */
+int tarantoolSqlite3EphemeralClear(BtCursor * pCur);
+
 /* Rename table pTab with zNewName by inserting new tuple to _space.
  * SQL statement, which creates table with new name is saved in pzSqlStmt.
  */
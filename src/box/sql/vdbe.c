@@ -2514,6 +2514,9 @@ case OP_Column: {
 				sqlite3VdbeMemSetNull(pDest);
 				goto op_column_out;
 			}
+		} else if (pC->eCurType==CURTYPE_HASH) {
+			pC->aRow = sqlite3VdbeHashRowData(pC, &avail);
+			pC->payloadSize = pC->szRow = avail;
 		} else {
 			pCrsr = pC->uc.pCursor;
 			assert(pC->eCurType==CURTYPE_BTREE);
@@ -3387,7 +3390,8 @@ case OP_OpenWrite:
  * P2 is the number of columns in the ephemeral table.
  * The cursor points to a BTree table if P4==0 and to a BTree index
  * if P4 is not 0.  If P4 is not NULL, it points to a KeyInfo structure
- * that defines the format of keys in the index.
+ * that defines the format of keys in the index. Such an index is
+ * stored in a memtx space unless some of its key parts are DESC.
  *
  * The P5 parameter can be a mask of the BTREE_* flags defined
  * in btree.h.  These flags control aspects of the operation of
@@ -3420,6 +3424,17 @@ case OP_OpenEphemeral: {
 	if (pCx==0) goto no_mem;
 	pCx->nullRow = 1;
 	pCx->isEphemeral = 1;
+	pKeyInfo = pOp->p4.pKeyInfo;
+	if (pKeyInfo!=0 && tarantoolSqlite3EphemeralIsSupported(pKeyInfo)) {
+		assert(pOp->p4type==P4_KEYINFO);
+		assert(pKeyInfo->db==db);
+		pCx->pKeyInfo = pKeyInfo;
+		tarantoolSqlite3EphemeralOpen(pCx->uc.pCursor, db->mdb.pBt,
+					      pKeyInfo);
+		pCx->isTable = 0;
+		pCx->isOrdered = (pOp->p5!=BTREE_UNORDERED);
+		break;
+	}
 	rc = sqlite3BtreeOpen(db->pVfs, 0, db, &pCx->pBtx,
 			      BTREE_OMIT_JOURNAL | BTREE_SINGLE | pOp->p5, vfsFlags);
 	if (rc==SQLITE_OK) {
@@ -3525,6 +3540,107 @@ case OP_OpenPseudo: {
 	break;
 }
 
+/* Opcode: HashOpen P1 P2 P3 P4 P5
+ * Synopsis: P3 key columns, P2 columns
+ *
+ * Open a new cursor P1 on an empty in-memory hash table.  Rows are
+ * added to the table with OP_HashInsert and looked up with
+ * OP_HashSeek and OP_HashNext.  The rows have P2 columns which can
+ * be read with OP_Column, P3 of them form the key.
+ *
+ * The hash table is used to implement hash joins: it is built once
+ * from the smaller side of the join and then probed for every row
+ * of the other side.  P5 is the cursor on the table the rows come
+ * from and P4 is an integer array with the numbers of the key
+ * columns in it.  If the hash table grows too big, it is dropped
+ * and lookups scan the table with cursor P5 instead.
+ */
+case OP_HashOpen: {
+	VdbeCursor *pCx;
+
+	assert(pOp->p1>=0);
+	assert(pOp->p2>=0);
+	assert(pOp->p3>0);
+	assert(pOp->p4type==P4_INTARRAY && pOp->p4.ai[0]==pOp->p3);
+	assert(pOp->p5<p->nCursor && p->apCsr[pOp->p5]!=0);
+	pCx = allocateCursor(p, pOp->p1, pOp->p2, CURTYPE_HASH);
+	if (pCx==0) goto no_mem;
+	pCx->nullRow = 1;
+	rc = sqlite3VdbeHashOpen(db, pCx, pOp->p3, pOp->p4.ai + 1,
+				 p->apCsr[pOp->p5]);
+	if (rc) goto abort_due_to_error;
+	break;
+}
+
+/* Opcode: HashInsert P1 P2 P3 * *
+ * Synopsis: key=r[P2@..] data=r[P3]
+ *
+ * Add the row stored as a blob in register P3 to the hash table of
+ * cursor P1.  The values of the key columns are in registers
+ * starting with P2.  Rows with a NULL key are not added since they
+ * can not match any key.
+ */
+case OP_HashInsert: {
+	VdbeCursor *pC;
+
+	assert(pOp->p1>=0 && pOp->p1<p->nCursor);
+	pC = p->apCsr[pOp->p1];
+	assert(pC!=0);
+	assert(pC->eCurType==CURTYPE_HASH);
+	pIn3 = &aMem[pOp->p3];
+	assert(pIn3->flags & MEM_Blob);
+	rc = sqlite3VdbeHashInsert(pC, &aMem[pOp->p2], pIn3);
+	if (rc) goto abort_due_to_error;
+	break;
+}
+
+/* Opcode: HashSeek P1 P2 P3 * *
+ * Synopsis: key=r[P3@..]
+ *
+ * Position cursor P1 on the first row of its hash table whose key
+ * is equal to the values in registers starting with P3.  If there
+ * is no such row, jump to P2.
+ */
+case OP_HashSeek: {       /* jump */
+	VdbeCursor *pC;
+	int res;
+
+	assert(pOp->p1>=0 && pOp->p1<p->nCursor);
+	pC = p->apCsr[pOp->p1];
+	assert(pC!=0);
+	assert(pC->eCurType==CURTYPE_HASH);
+	rc = sqlite3VdbeHashSeek(pC, &aMem[pOp->p3], &res);
+	if (rc) goto abort_due_to_error;
+	pC->nullRow = (u8)res;
+	pC->cacheStatus = CACHE_STALE;
+	VdbeBranchTaken(res!=0,2);
+	if (res) goto jump_to_p2;
+	break;
+}
+
+/* Opcode: HashNext P1 P2 * * *
+ *
+ * Advance cursor P1 to the next row of its hash table with the same
+ * key as the current one and jump to P2.  If there are no more such
+ * rows, fall through to the following instruction.
+ */
+case OP_HashNext: {       /* jump */
+	VdbeCursor *pC;
+	int res;
+
+	assert(pOp->p1>=0 && pOp->p1<p->nCursor);
+	pC = p->apCsr[pOp->p1];
+	assert(pC!=0);
+	assert(pC->eCurType==CURTYPE_HASH);
+	rc = sqlite3VdbeHashNext(pC, &res);
+	if (rc) goto abort_due_to_error;
+	pC->nullRow = (u8)res;
+	pC->cacheStatus = CACHE_STALE;
+	VdbeBranchTaken(res==0,2);
+	if (res==0) goto jump_to_p2_and_check_for_interrupt;
+	goto check_for_interrupt;
+}
+
 /* Opcode: Close P1 * * * *
  *
  * Close a cursor previously opened as P1.  If P1 is not
@@ -5343,7 +5459,10 @@ case OP_ResetSorter: {
 	} else {
 		assert(pC->eCurType==CURTYPE_BTREE);
 		assert(pC->isEphemeral);
-		rc = sqlite3BtreeClearTableOfCursor(pC->uc.pCursor);
+		if (pC->uc.pCursor->curFlags & BTCF_TEphemCursor)
+			rc = tarantoolSqlite3EphemeralClear(pC->uc.pCursor);
+		else
+			rc = sqlite3BtreeClearTableOfCursor(pC->uc.pCursor);
 		if (rc) goto abort_due_to_error;
 	}
 	break;
@@ -73,6 +73,9 @@ typedef unsigned Bool;
 /* Opaque type used by code in vdbesort.c */
 typedef struct VdbeSorter VdbeSorter;
 
+/* Opaque type used by code in vdbehash.c */
+typedef struct VdbeHash VdbeHash;
+
 /* Elements of the linked list at Vdbe.pAuxData */
 typedef struct AuxData AuxData;
 
@@ -80,6 +83,7 @@ typedef struct AuxData AuxData;
 #define CURTYPE_BTREE       0
 #define CURTYPE_SORTER      1
 #define CURTYPE_PSEUDO      3
+#define CURTYPE_HASH        4
 
 /*
  * A VdbeCursor is an superclass (a wrapper) for various cursor objects:
@@ -89,6 +93,7 @@ typedef struct AuxData AuxData;
  *          -  On either an index or a table
  *      * A sorter
  *      * A one-row "pseudotable" stored in a single register
+ *      * An in-memory hash table built for a hash join
  */
 typedef struct VdbeCursor VdbeCursor;
 struct VdbeCursor {
@@ -129,6 +134,7 @@ struct VdbeCursor {
 		BtCursor *pCursor;	/* CURTYPE_BTREE.  Btree cursor */
 		int pseudoTableReg;	/* CURTYPE_PSEUDO. Reg holding content. */
 		VdbeSorter *pSorter;	/* CURTYPE_SORTER. Sorter object */
+		VdbeHash *pHash;	/* CURTYPE_HASH. Hash table */
 	} uc;
 	KeyInfo *pKeyInfo;	/* Info about index keys needed by index cursors */
 	u32 iHdrOffset;		/* Offset to next unparsed byte of the header */
@@ -562,6 +568,14 @@ int sqlite3VdbeSorterRewind(const VdbeCursor *, int *);
 int sqlite3VdbeSorterWrite(const VdbeCursor *, Mem *);
 int sqlite3VdbeSorterCompare(const VdbeCursor *, Mem *, int, int *);
 
+int sqlite3VdbeHashOpen(sqlite3 *, VdbeCursor *, int, const int *,
+			const VdbeCursor *);
+void sqlite3VdbeHashClose(sqlite3 *, VdbeCursor *);
+int sqlite3VdbeHashInsert(const VdbeCursor *, Mem *, const Mem *);
+int sqlite3VdbeHashSeek(const VdbeCursor *, Mem *, int *);
+int sqlite3VdbeHashNext(const VdbeCursor *, int *);
+const u8 *sqlite3VdbeHashRowData(const VdbeCursor *, u32 *);
+
 #if !defined(SQLITE_OMIT_SHARED_CACHE)
 void sqlite3VdbeEnter(Vdbe *);
 #else
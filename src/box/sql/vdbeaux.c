@@ -2333,6 +2333,10 @@ sqlite3VdbeFreeCursor(Vdbe * p, VdbeCursor * pCx)
 			sqlite3VdbeSorterClose(p->db, pCx);
 			break;
 		}
+	case CURTYPE_HASH:{
+			sqlite3VdbeHashClose(p->db, pCx);
+			break;
+		}
 	case CURTYPE_BTREE:{
 			if (pCx->pBtx) {
 				sqlite3BtreeClose(pCx->pBtx);
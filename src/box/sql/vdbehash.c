@@ -0,0 +1,495 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/*
+ * This file contains code for the VdbeHash object, used in concert
+ * with a VdbeCursor to implement hash joins.
+ *
+ * The build side of a join is scanned once and every row is inserted
+ * into an in-memory hash table keyed by the join columns.  Then for
+ * every row of the probe side the table is searched with
+ * sqlite3VdbeHashSeek() and all rows with an equal key are visited
+ * with sqlite3VdbeHashNext().
+ *
+ * Entries are allocated from a region on the cord slab cache and
+ * are never freed one by one: the whole region is released when
+ * the cursor is closed.  Each entry holds the key encoded as a
+ * MsgPack array followed by the full row of the build side, so the
+ * cursor can serve OP_Column exactly like the table cursor it
+ * replaces.
+ *
+ * Keys are compared with sqlite3MemCompare() and the binary
+ * collation, so the hash function must give equal values equal
+ * hashes: an integral REAL is hashed as the INTEGER it is equal to.
+ * A key containing NULL never matches anything and is not stored.
+ *
+ * The planner only builds hash tables on tables it estimates to be
+ * small enough, but the estimate may be wrong.  If the hash table
+ * grows bigger than SQLITE_MAX_HASH_JOIN_SIZE bytes, it is dropped
+ * and the cursor falls back to a nested loop: every seek scans the
+ * hashed table with its own cursor and returns the rows whose key
+ * columns are equal to the probe key.
+ */
+#include "sqliteInt.h"
+#include "vdbeInt.h"
+#include "fiber.h"
+#include "errinj.h"
+#include "msgpuck/msgpuck.h"
+#include "third_party/PMurHash.h"
+
+/* Initial number of buckets. Must be a power of two. */
+#define HASH_MIN_BUCKETS 64
+
+typedef struct VdbeHashEntry VdbeHashEntry;
+
+struct VdbeHashEntry {
+	VdbeHashEntry *pNext;	/* Next entry in the same bucket */
+	u32 iHash;		/* Hash of the key */
+	u32 nKey;		/* Size of the encoded key in bytes */
+	u32 nRow;		/* Size of the row in bytes */
+	/* The encoded key and the row follow. */
+};
+
+struct VdbeHash {
+	struct region region;	/* Memory for the entries */
+	VdbeHashEntry **aBucket;	/* Hash buckets */
+	u32 nBucket;		/* Number of buckets, a power of two */
+	u32 nEntry;		/* Number of entries in the table */
+	int nKey;		/* Number of key columns */
+	VdbeHashEntry *pCurrent;	/* Entry the cursor points at */
+	Mem *aMatch;		/* Decoded key of the current entry */
+	/* Fields used after a fall back to a nested loop */
+	bool bOverflow;		/* The table is too big to be hashed */
+	BtCursor *pTabCrsr;	/* Cursor on the hashed table */
+	const int *aiColumn;	/* Key columns of the hashed table */
+	Mem *aRowKey;		/* Key columns of a row of the table */
+	u8 *aProbe;		/* Encoded probe key, aMatch points here */
+	u32 nProbeAlloc;	/* Bytes allocated for aProbe */
+	const u8 *pRow;		/* Row the cursor points at */
+	u32 nRow;		/* Size of pRow in bytes */
+};
+
+static inline const u8 *
+vdbeHashEntryKey(const VdbeHashEntry * pEntry)
+{
+	return (const u8 *)&pEntry[1];
+}
+
+static inline const u8 *
+vdbeHashEntryRow(const VdbeHashEntry * pEntry)
+{
+	return vdbeHashEntryKey(pEntry) + pEntry->nKey;
+}
+
+/*
+ * Compute the hash of nKey values in aKey.  Return 0 and set
+ * *piHash on success, or return -1 if one of the values can not
+ * be compared for equality (e.g. NULL).
+ */
+static int
+vdbeHashKey(const Mem * aKey, int nKey, u32 * piHash)
+{
+	u32 h = 13;
+	for (int i = 0; i < nKey; i++) {
+		const Mem *pMem = &aKey[i];
+		if (pMem->flags & MEM_Int) {
+			i64 v = pMem->u.i;
+			h = PMurHash32(h, &v, sizeof(v));
+		} else if (pMem->flags & MEM_Real) {
+			double r = pMem->u.r;
+			if (r >= -9223372036854775808.0 &&
+			    r < 9223372036854775808.0 && (double)(i64) r == r) {
+				i64 v = (i64) r;
+				h = PMurHash32(h, &v, sizeof(v));
+			} else {
+				h = PMurHash32(h, &r, sizeof(r));
+			}
+		} else if ((pMem->flags & (MEM_Str | MEM_Blob)) != 0 &&
+			   (pMem->flags & MEM_Zero) == 0) {
+			h = PMurHash32(h, pMem->z, pMem->n);
+		} else {
+			return -1;
+		}
+	}
+	*piHash = h;
+	return 0;
+}
+
+/*
+ * Return true if the encoded key of pEntry is equal to the nKey
+ * values in aKey.
+ */
+static bool
+vdbeHashKeyIsEqual(const VdbeHashEntry * pEntry, const Mem * aKey, int nKey)
+{
+	const char *zKey = (const char *)vdbeHashEntryKey(pEntry);
+	uint32_t n = mp_decode_array(&zKey);
+	assert((int)n == nKey);
+	(void)n;
+	for (int i = 0; i < nKey; i++) {
+		Mem mem;
+		zKey += sqlite3VdbeMsgpackGet((const unsigned char *)zKey,
+					      &mem);
+		if (sqlite3MemCompare(&mem, &aKey[i], NULL) != 0)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * Double the number of buckets.  On OOM the table keeps working
+ * with longer chains, so errors are ignored.
+ */
+static void
+vdbeHashGrow(VdbeHash * pHash)
+{
+	u32 nBucket = pHash->nBucket * 2;
+	VdbeHashEntry **aBucket =
+	    sqlite3MallocZero(nBucket * sizeof(VdbeHashEntry *));
+	if (aBucket == NULL)
+		return;
+	for (u32 i = 0; i < pHash->nBucket; i++) {
+		VdbeHashEntry *pEntry = pHash->aBucket[i];
+		while (pEntry != NULL) {
+			VdbeHashEntry *pNext = pEntry->pNext;
+			u32 j = pEntry->iHash & (nBucket - 1);
+			pEntry->pNext = aBucket[j];
+			aBucket[j] = pEntry;
+			pEntry = pNext;
+		}
+	}
+	sqlite3_free(pHash->aBucket);
+	pHash->aBucket = aBucket;
+	pHash->nBucket = nBucket;
+}
+
+/*
+ * Return the max size of a hash table, in bytes.  Tests lower
+ * it to force the fall back to a nested loop.
+ */
+static size_t
+vdbeHashMaxSize(void)
+{
+	struct errinj *inj = errinj(ERRINJ_SQL_HASH_JOIN_SIZE, ERRINJ_INT);
+	if (inj != NULL && inj->iparam >= 0)
+		return inj->iparam;
+	return SQLITE_MAX_HASH_JOIN_SIZE;
+}
+
+/*
+ * Drop all entries of a hash table that has grown too big and
+ * switch the cursor to scanning the hashed table.
+ */
+static void
+vdbeHashOverflow(VdbeHash * pHash)
+{
+	region_free(&pHash->region);
+	sqlite3_free(pHash->aBucket);
+	pHash->aBucket = NULL;
+	pHash->nBucket = 0;
+	pHash->nEntry = 0;
+	pHash->bOverflow = true;
+}
+
+/*
+ * Initialize the hash table of cursor pCsr.  nKey is the number
+ * of key columns passed to every Insert() and Seek() call.
+ * aiColumn are the numbers of the key columns in the hashed table
+ * and pTabCsr is a cursor on it, which is used to look up rows if
+ * the hash table grows too big.
+ */
+int
+sqlite3VdbeHashOpen(sqlite3 * db, VdbeCursor * pCsr, int nKey,
+		    const int *aiColumn, const VdbeCursor * pTabCsr)
+{
+	assert(pCsr->eCurType == CURTYPE_HASH);
+	assert(pTabCsr->eCurType == CURTYPE_BTREE);
+	assert(nKey > 0);
+	VdbeHash *pHash = sqlite3DbMallocZero(db, sizeof(VdbeHash) +
+					      2 * nKey * sizeof(Mem));
+	if (pHash == NULL)
+		return SQLITE_NOMEM_BKPT;
+	pHash->aBucket =
+	    sqlite3MallocZero(HASH_MIN_BUCKETS * sizeof(VdbeHashEntry *));
+	if (pHash->aBucket == NULL) {
+		sqlite3DbFree(db, pHash);
+		return SQLITE_NOMEM_BKPT;
+	}
+	region_create(&pHash->region, cord_slab_cache());
+	pHash->nBucket = HASH_MIN_BUCKETS;
+	pHash->nKey = nKey;
+	pHash->aMatch = (Mem *)&pHash[1];
+	pHash->aRowKey = &pHash->aMatch[nKey];
+	pHash->aiColumn = aiColumn;
+	pHash->pTabCrsr = pTabCsr->uc.pCursor;
+	pCsr->uc.pHash = pHash;
+	return SQLITE_OK;
+}
+
+/*
+ * Free the hash table of cursor pCsr and all its entries.
+ */
+void
+sqlite3VdbeHashClose(sqlite3 * db, VdbeCursor * pCsr)
+{
+	assert(pCsr->eCurType == CURTYPE_HASH);
+	VdbeHash *pHash = pCsr->uc.pHash;
+	if (pHash == NULL)
+		return;
+	region_destroy(&pHash->region);
+	sqlite3_free(pHash->aBucket);
+	sqlite3_free(pHash->aProbe);
+	sqlite3DbFree(db, pHash);
+	pCsr->uc.pHash = NULL;
+}
+
+/*
+ * Add a row to the hash table of cursor pCsr.  aKey holds the
+ * values of the key columns, pRow is a blob with the row itself.
+ * Rows with a NULL in the key are silently skipped since they
+ * can not match anything.  So are all rows once the table has
+ * overflowed.
+ */
+int
+sqlite3VdbeHashInsert(const VdbeCursor * pCsr, Mem * aKey, const Mem * pRow)
+{
+	assert(pCsr->eCurType == CURTYPE_HASH);
+	assert(pRow->flags & MEM_Blob);
+	VdbeHash *pHash = pCsr->uc.pHash;
+	u32 iHash;
+	if (pHash->bOverflow ||
+	    vdbeHashKey(aKey, pHash->nKey, &iHash) != 0)
+		return SQLITE_OK;
+	i64 nKey = sqlite3VdbeMsgpackRecordLen(aKey, pHash->nKey);
+	size_t size = sizeof(VdbeHashEntry) + nKey + pRow->n;
+	VdbeHashEntry *pEntry = region_aligned_alloc(&pHash->region, size,
+						     alignof(VdbeHashEntry));
+	if (pEntry == NULL)
+		return SQLITE_NOMEM_BKPT;
+	pEntry->iHash = iHash;
+	pEntry->nKey = sqlite3VdbeMsgpackRecordPut((u8 *)&pEntry[1], aKey,
+						   pHash->nKey);
+	pEntry->nRow = pRow->n;
+	memcpy((u8 *)vdbeHashEntryRow(pEntry), pRow->z, pRow->n);
+	if (pHash->nEntry >= pHash->nBucket)
+		vdbeHashGrow(pHash);
+	u32 i = iHash & (pHash->nBucket - 1);
+	pEntry->pNext = pHash->aBucket[i];
+	pHash->aBucket[i] = pEntry;
+	pHash->nEntry++;
+	size = region_used(&pHash->region) +
+	       pHash->nBucket * sizeof(VdbeHashEntry *);
+	if (size > vdbeHashMaxSize())
+		vdbeHashOverflow(pHash);
+	return SQLITE_OK;
+}
+
+/*
+ * Decode the key columns of a row of the hashed table into
+ * aRowKey.  Return -1 if the row doesn't have all of them.
+ */
+static int
+vdbeHashRowKey(VdbeHash * pHash, const u8 * pRow)
+{
+	const char *zRow = (const char *)pRow;
+	u32 nCol = mp_decode_array(&zRow);
+	for (int i = 0; i < pHash->nKey; i++) {
+		u32 iCol = pHash->aiColumn[i];
+		if (iCol >= nCol)
+			return -1;
+		const char *zField = zRow;
+		for (u32 j = 0; j < iCol; j++)
+			mp_next(&zField);
+		sqlite3VdbeMsgpackGet((const u8 *)zField, &pHash->aRowKey[i]);
+	}
+	return 0;
+}
+
+/*
+ * Starting with the row the table cursor points at, find the
+ * first row whose key is equal to aMatch.  res is the result of
+ * the last cursor move: non-zero if the cursor is at EOF.
+ */
+static int
+vdbeHashScan(VdbeHash * pHash, int res, int *pRes)
+{
+	while (res == 0) {
+		u32 nRow;
+		const u8 *pRow = sqlite3BtreePayloadFetch(pHash->pTabCrsr,
+							  &nRow);
+		if (vdbeHashRowKey(pHash, pRow) == 0) {
+			int i = 0;
+			while (i < pHash->nKey &&
+			       sqlite3MemCompare(&pHash->aRowKey[i],
+						 &pHash->aMatch[i], NULL) == 0)
+				i++;
+			if (i == pHash->nKey) {
+				pHash->pRow = pRow;
+				pHash->nRow = nRow;
+				*pRes = 0;
+				return SQLITE_OK;
+			}
+		}
+		int rc = sqlite3BtreeNext(pHash->pTabCrsr, &res);
+		if (rc != SQLITE_OK)
+			return rc;
+	}
+	pHash->pRow = NULL;
+	*pRes = 1;
+	return SQLITE_OK;
+}
+
+/*
+ * Position the cursor of an overflowed table at the first row
+ * with the given key, see sqlite3VdbeHashSeek().
+ */
+static int
+vdbeHashSeekOverflow(VdbeHash * pHash, Mem * aKey, int *pRes)
+{
+	/*
+	 * Make a copy of the probe key: the registers may be
+	 * overwritten before Next() is called.
+	 */
+	i64 nProbe = sqlite3VdbeMsgpackRecordLen(aKey, pHash->nKey);
+	if (nProbe > pHash->nProbeAlloc) {
+		u8 *aProbe = sqlite3_realloc64(pHash->aProbe, nProbe);
+		if (aProbe == NULL)
+			return SQLITE_NOMEM_BKPT;
+		pHash->aProbe = aProbe;
+		pHash->nProbeAlloc = nProbe;
+	}
+	sqlite3VdbeMsgpackRecordPut(pHash->aProbe, aKey, pHash->nKey);
+	const char *zKey = (const char *)pHash->aProbe;
+	mp_decode_array(&zKey);
+	for (int i = 0; i < pHash->nKey; i++) {
+		zKey += sqlite3VdbeMsgpackGet((const unsigned char *)zKey,
+					      &pHash->aMatch[i]);
+	}
+	int res;
+	int rc = sqlite3BtreeFirst(pHash->pTabCrsr, &res);
+	if (rc != SQLITE_OK)
+		return rc;
+	return vdbeHashScan(pHash, res, pRes);
+}
+
+/*
+ * Position the cursor at the first row whose key is equal to the
+ * values in aKey.  Set *pRes to 0 if such a row is found, or to 1
+ * otherwise.
+ */
+int
+sqlite3VdbeHashSeek(const VdbeCursor * pCsr, Mem * aKey, int *pRes)
+{
+	assert(pCsr->eCurType == CURTYPE_HASH);
+	VdbeHash *pHash = pCsr->uc.pHash;
+	u32 iHash;
+	pHash->pCurrent = NULL;
+	pHash->pRow = NULL;
+	*pRes = 1;
+	if (vdbeHashKey(aKey, pHash->nKey, &iHash) != 0)
+		return SQLITE_OK;
+	if (pHash->bOverflow)
+		return vdbeHashSeekOverflow(pHash, aKey, pRes);
+	VdbeHashEntry *pEntry = pHash->aBucket[iHash & (pHash->nBucket - 1)];
+	for (; pEntry != NULL; pEntry = pEntry->pNext) {
+		if (pEntry->iHash == iHash &&
+		    vdbeHashKeyIsEqual(pEntry, aKey, pHash->nKey))
+			break;
+	}
+	if (pEntry == NULL)
+		return SQLITE_OK;
+	/*
+	 * Remember the key of the match: the probe registers
+	 * may be overwritten before Next() is called.
+	 */
+	const char *zKey = (const char *)vdbeHashEntryKey(pEntry);
+	mp_decode_array(&zKey);
+	for (int i = 0; i < pHash->nKey; i++) {
+		zKey += sqlite3VdbeMsgpackGet((const unsigned char *)zKey,
+					      &pHash->aMatch[i]);
+	}
+	pHash->pCurrent = pEntry;
+	*pRes = 0;
+	return SQLITE_OK;
+}
+
+/*
+ * Advance the cursor to the next row with the same key.  Set *pRes
+ * to 0 on success, or to 1 if there are no more such rows.
+ */
+int
+sqlite3VdbeHashNext(const VdbeCursor * pCsr, int *pRes)
+{
+	assert(pCsr->eCurType == CURTYPE_HASH);
+	VdbeHash *pHash = pCsr->uc.pHash;
+	VdbeHashEntry *pCurrent = pHash->pCurrent;
+	*pRes = 1;
+	if (pHash->bOverflow) {
+		if (pHash->pRow == NULL)
+			return SQLITE_OK;
+		int res;
+		int rc = sqlite3BtreeNext(pHash->pTabCrsr, &res);
+		if (rc != SQLITE_OK)
+			return rc;
+		return vdbeHashScan(pHash, res, pRes);
+	}
+	if (pCurrent == NULL)
+		return SQLITE_OK;
+	VdbeHashEntry *pEntry = pCurrent->pNext;
+	for (; pEntry != NULL; pEntry = pEntry->pNext) {
+		if (pEntry->iHash == pCurrent->iHash &&
+		    vdbeHashKeyIsEqual(pEntry, pHash->aMatch, pHash->nKey))
+			break;
+	}
+	pHash->pCurrent = pEntry;
+	if (pEntry != NULL)
+		*pRes = 0;
+	return SQLITE_OK;
+}
+
+/*
+ * Return the row the cursor points at and store its size in
+ * *pnRow.
+ */
+const u8 *
+sqlite3VdbeHashRowData(const VdbeCursor * pCsr, u32 * pnRow)
+{
+	assert(pCsr->eCurType == CURTYPE_HASH);
+	VdbeHash *pHash = pCsr->uc.pHash;
+	if (pHash->bOverflow) {
+		assert(pHash->pRow != NULL);
+		*pnRow = pHash->nRow;
+		return pHash->pRow;
+	}
+	assert(pHash->pCurrent != NULL);
+	*pnRow = pHash->pCurrent->nRow;
+	return vdbeHashEntryRow(pHash->pCurrent);
+}
@@ -659,6 +659,37 @@ termCanDriveIndex(WhereTerm * pTerm,	/* WHERE clause term to check */
 	testcase(pTerm->pExpr->op == TK_IS);
 	return 1;
 }
+
+/*
+ * LogEst of the largest number of rows in a table a hash join
+ * can be built on (10M).  The hash table is kept in memory, so
+ * bigger tables are joined with nested loops instead.  Since the
+ * estimate may be wrong, the size of the hash table is also
+ * limited at run time, see SQLITE_MAX_HASH_JOIN_SIZE.
+ */
+#define WHERE_HASH_JOIN_MAX_ROWS 232
+
+/*
+ * Return TRUE if the WHERE clause term pTerm can be used as the
+ * key of a hash table built on pSrc.  The hash table compares
+ * keys for plain equality, so IS and non-binary collations are
+ * not supported.
+ */
+static int
+termCanDriveHashJoin(Parse * pParse,	/* Parsing context */
+		     WhereTerm * pTerm,	/* WHERE clause term to check */
+		     struct SrcList_item *pSrc,	/* Table we are trying to access */
+		     Bitmask notReady	/* Tables in outer loops of the join */
+    )
+{
+	Expr *pX = pTerm->pExpr;
+	if ((pTerm->eOperator & WO_IS) != 0)
+		return 0;
+	if (!termCanDriveIndex(pTerm, pSrc, notReady))
+		return 0;
+	return sqlite3BinaryCompareCollSeq(pParse, pX->pLeft,
+					   pX->pRight) == NULL;
+}
 #endif
 
 #ifndef SQLITE_OMIT_AUTOMATIC_INDEX
@@ -886,6 +917,122 @@ constructAutomaticIndex(Parse * pParse,			/* The parsing context */
  end_auto_index_create:
 	sqlite3ExprDelete(pParse->db, pPartial);
 }
+
+/*
+ * Generate code to build the hash table of a hash join on the table
+ * of pLevel and set up the WhereLevel object pLevel so that the code
+ * generator probes the hash table instead of scanning the table.
+ *
+ * The hash table keeps complete rows, so, like an automatic index,
+ * it covers all the columns of the table.
+ */
+static void
+constructHashJoin(Parse * pParse,			/* The parsing context */
+		  WhereClause * pWC,			/* The WHERE clause */
+		  struct SrcList_item *pSrc,		/* The FROM clause term to hash */
+		  Bitmask notReady,			/* Mask of cursors that are not available */
+		  WhereLevel * pLevel)			/* Write new index here */
+{
+	int nKeyCol;		/* Number of key columns of the hash table */
+	WhereTerm *pTerm;	/* A single term of the WHERE clause */
+	WhereTerm *pWCEnd;	/* End of pWC->a[] */
+	Index *pIdx;		/* Object describing the hash key */
+	Vdbe *v;		/* Prepared statement under construction */
+	int addrInit;		/* Address of the initialization bypass jump */
+	Table *pTable;		/* The table being hashed */
+	int addrTop;		/* Top of the hash table fill loop */
+	int regKey;		/* First register of the key */
+	int regRow;		/* Register holding a table row */
+	int i;			/* Loop counter */
+	WhereLoop *pLoop;	/* The Loop object */
+	char *zNotUsed;		/* Extra space on the end of pIdx */
+	Bitmask idxCols;	/* Bitmap of columns used as the key */
+	int *aiColumn;		/* Key columns, P4 of OP_HashOpen */
+
+	/* Generate code to skip over the creation and filling of the
+	 * hash table on 2nd and subsequent iterations of the loop.
+	 */
+	v = pParse->pVdbe;
+	assert(v != 0);
+	addrInit = sqlite3VdbeAddOp0(v, OP_Once);
+	VdbeCoverage(v);
+
+	/* Collect the equality terms which form the key */
+	nKeyCol = 0;
+	pTable = pSrc->pTab;
+	pWCEnd = &pWC->a[pWC->nTerm];
+	pLoop = pLevel->pWLoop;
+	idxCols = 0;
+	for (pTerm = pWC->a; pTerm < pWCEnd; pTerm++) {
+		if (termCanDriveHashJoin(pParse, pTerm, pSrc, notReady)) {
+			int iCol = pTerm->u.leftColumn;
+			Bitmask cMask =
+			    iCol >= BMS ? MASKBIT(BMS - 1) : MASKBIT(iCol);
+			if ((idxCols & cMask) == 0) {
+				if (whereLoopResize
+				    (pParse->db, pLoop, nKeyCol + 1)) {
+					return;
+				}
+				pLoop->aLTerm[nKeyCol++] = pTerm;
+				idxCols |= cMask;
+			}
+		}
+	}
+	assert(nKeyCol > 0);
+	pLoop->nEq = pLoop->nLTerm = nKeyCol;
+	pLoop->wsFlags = WHERE_COLUMN_EQ | WHERE_IDX_ONLY | WHERE_INDEXED
+	    | WHERE_AUTO_INDEX | WHERE_HASH_JOIN;
+
+	/* Construct the Index object to describe the key */
+	pIdx = sqlite3AllocateIndexObject(pParse->db, nKeyCol, 0, &zNotUsed);
+	if (pIdx == 0)
+		return;
+	pLoop->pIndex = pIdx;
+	pIdx->zName = "hash-join";
+	pIdx->pTable = pTable;
+	pIdx->bUnordered = 1;
+	for (i = 0; i < nKeyCol; i++) {
+		pIdx->aiColumn[i] = pLoop->aLTerm[i]->u.leftColumn;
+		pIdx->azColl[i] = sqlite3StrBINARY;
+	}
+
+	/* Create the hash table */
+	aiColumn = sqlite3DbMallocRawNN(pParse->db,
+					(nKeyCol + 1) * sizeof(int));
+	if (aiColumn == 0)
+		return;
+	aiColumn[0] = nKeyCol;
+	for (i = 0; i < nKeyCol; i++)
+		aiColumn[i + 1] = pIdx->aiColumn[i];
+	pLevel->iIdxCur = pParse->nTab++;
+	sqlite3VdbeAddOp4(v, OP_HashOpen, pLevel->iIdxCur, pTable->nCol,
+			  nKeyCol, (char *)aiColumn, P4_INTARRAY);
+	sqlite3VdbeChangeP5(v, (u16)pLevel->iTabCur);
+	VdbeComment((v, "for %s", pTable->zName));
+
+	/* Fill the hash table with the rows of the table */
+	sqlite3ExprCachePush(pParse);
+	regKey = sqlite3GetTempRange(pParse, nKeyCol);
+	regRow = sqlite3GetTempReg(pParse);
+	addrTop = sqlite3VdbeAddOp1(v, OP_Rewind, pLevel->iTabCur);
+	VdbeCoverage(v);
+	sqlite3VdbeAddOp2(v, OP_RowData, pLevel->iTabCur, regRow);
+	for (i = 0; i < nKeyCol; i++) {
+		sqlite3VdbeAddOp3(v, OP_Column, pLevel->iTabCur,
+				  pIdx->aiColumn[i], regKey + i);
+	}
+	sqlite3VdbeAddOp3(v, OP_HashInsert, pLevel->iIdxCur, regKey, regRow);
+	sqlite3VdbeAddOp2(v, OP_Next, pLevel->iTabCur, addrTop + 1);
+	VdbeCoverage(v);
+	sqlite3VdbeChangeP5(v, SQLITE_STMTSTATUS_AUTOINDEX);
+	sqlite3VdbeJumpHere(v, addrTop);
+	sqlite3ReleaseTempReg(pParse, regRow);
+	sqlite3ReleaseTempRange(pParse, regKey, nKeyCol);
+	sqlite3ExprCachePop(pParse);
+
+	/* Jump here when skipping the initialization */
+	sqlite3VdbeJumpHere(v, addrInit);
+}
 #endif				/* SQLITE_OMIT_AUTOMATIC_INDEX */
 
 /*
@@ -2883,6 +3030,55 @@ whereLoopAddBtree(WhereLoopBuilder * pBuilder,	/* WHERE clause information */
 			}
 		}
 	}
+
+	/* Hash joins */
+	if (!pBuilder->pOrSet	/* Not part of an OR optimization */
+	    && (pWInfo->wctrlFlags & WHERE_OR_SUBCLAUSE) == 0
+	    && (user_session->sql_flags & SQLITE_AutoIndex) != 0
+	    && pSrc->pIBIndex == 0	/* Has no INDEXED BY clause */
+	    && !pSrc->fg.notIndexed	/* Has no NOT INDEXED clause */
+	    && !HasRowid(pTab)	/* A Tarantool space */
+	    && pTab->pSelect == 0 && (pTab->tabFlags & TF_Ephemeral) == 0
+	    && !pSrc->fg.isCorrelated	/* Not a correlated subquery */
+	    && !pSrc->fg.isRecursive	/* Not a recursive common table expression. */
+	    && rSize <= WHERE_HASH_JOIN_MAX_ROWS) {
+		/* Generate hash join WhereLoops */
+		WhereTerm *pTerm;
+		WhereTerm *pWCEnd = pWC->a + pWC->nTerm;
+		for (pTerm = pWC->a; rc == SQLITE_OK && pTerm < pWCEnd; pTerm++) {
+			if (pTerm->prereqRight & pNew->maskSelf)
+				continue;
+			if (termCanDriveHashJoin(pWInfo->pParse,
+						 pTerm, pSrc, 0)) {
+				pNew->nEq = 1;
+				pNew->nSkip = 0;
+				pNew->pIndex = 0;
+				pNew->nLTerm = 1;
+				pNew->aLTerm[0] = pTerm;
+				/* TUNING: The hash table is built with a single
+				 * pass over the table, so the one-time cost is
+				 * about twice the cost of a full scan: N rows
+				 * read plus N inserts, without the log(N)
+				 * factor of an automatic index.
+				 */
+				pNew->rSetup = rSize + 10;
+				ApplyCostMultiplier(pNew->rSetup,
+						    pTab->costMult);
+				if (pNew->rSetup < 0)
+					pNew->rSetup = 0;
+				/* TUNING: A probe is a constant-time lookup
+				 * yielding the same 20 rows guessed for an
+				 * automatic index.
+				 */
+				pNew->nOut = 43;
+				assert(43 == sqlite3LogEst(20));
+				pNew->rRun = sqlite3LogEstAdd(10, pNew->nOut);
+				pNew->wsFlags = WHERE_AUTO_INDEX | WHERE_HASH_JOIN;
+				pNew->prereq = mPrereq | pTerm->prereqRight;
+				rc = whereLoopInsert(pBuilder, pNew);
+			}
+		}
+	}
 #endif				/* SQLITE_OMIT_AUTOMATIC_INDEX */
 
 	/* Loop over all indices
@@ -4724,7 +4920,13 @@ sqlite3WhereBegin(Parse * pParse,	/* The parser context */
 		pLevel = &pWInfo->a[ii];
 		wsFlags = pLevel->pWLoop->wsFlags;
 #ifndef SQLITE_OMIT_AUTOMATIC_INDEX
-		if ((pLevel->pWLoop->wsFlags & WHERE_AUTO_INDEX) != 0) {
+		if ((pLevel->pWLoop->wsFlags & WHERE_HASH_JOIN) != 0) {
+			constructHashJoin(pParse, &pWInfo->sWC,
+					  &pTabList->a[pLevel->iFrom],
+					  notReady, pLevel);
+			if (db->mallocFailed)
+				goto whereBeginError;
+		} else if ((pLevel->pWLoop->wsFlags & WHERE_AUTO_INDEX) != 0) {
 			constructAutomaticIndex(pParse, &pWInfo->sWC,
 						&pTabList->a[pLevel->iFrom],
 						notReady, pLevel);
@@ -540,3 +540,4 @@ void sqlite3WhereTabFuncArgs(Parse *, struct SrcList_item *, WhereClause *);
 #define WHERE_SKIPSCAN     0x00008000	/* Uses the skip-scan algorithm */
 #define WHERE_UNQ_WANTED   0x00010000	/* WHERE_ONEROW would have been helpful */
 #define WHERE_PARTIALIDX   0x00020000	/* The automatic index is partial */
+#define WHERE_HASH_JOIN    0x00040000	/* Uses an in-memory hash table */
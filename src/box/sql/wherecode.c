@@ -215,6 +215,8 @@ sqlite3WhereExplainOneScan(Parse * pParse,	/* Parse context */
 				if (isSearch) {
 					zFmt = "PRIMARY KEY";
 				}
+			} else if (flags & WHERE_HASH_JOIN) {
+				zFmt = "HASH JOIN";
 			} else if (flags & WHERE_PARTIALIDX) {
 				zFmt = "AUTOMATIC PARTIAL COVERING INDEX";
 			} else if (flags & WHERE_AUTO_INDEX) {
@@ -1372,6 +1374,30 @@ sqlite3WhereCodeOneLoopStart(WhereInfo * pWInfo,	/* Complete information about t
 					    SQLITE_AFF_NUMERIC |
 					    SQLITE_JUMPIFNULL);
 		}
+	} else if (pLoop->wsFlags & WHERE_HASH_JOIN) {
+		/* Case 4a: A lookup in the hash table of a hash join.
+		 *
+		 *          The hash table has been filled with the rows of
+		 *          the table by constructHashJoin().  Its key is made
+		 *          of the columns of the == constraints, so all of
+		 *          them are coded and the rows with an equal key are
+		 *          visited.
+		 */
+		int iIdxCur = pLevel->iIdxCur;	/* The hash table cursor */
+		int regBase;	/* Base register holding the key values */
+		char *zAff;	/* Affinity string to apply to the key */
+
+		assert(omitTable);
+		assert(pLoop->nSkip == 0);
+		regBase = codeAllEqualityTerms(pParse, pLevel, 0, 0, &zAff);
+		addrNxt = pLevel->addrNxt;
+		codeApplyAffinity(pParse, regBase, pLoop->nEq, zAff);
+		sqlite3DbFree(db, zAff);
+		sqlite3VdbeAddOp3(v, OP_HashSeek, iIdxCur, addrNxt, regBase);
+		VdbeCoverage(v);
+		pLevel->p2 = sqlite3VdbeCurrentAddr(v);
+		pLevel->op = OP_HashNext;
+		pLevel->p1 = iIdxCur;
 	} else if (pLoop->wsFlags & WHERE_INDEXED) {
 		/* Case 4: A scan using an index.
 		 *
@@ -0,0 +1,322 @@
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "sql_stmt_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <trivia/util.h>
+
+#include "sql/sqlite3.h"
+#include "assoc.h"
+#include "diag.h"
+#include "errcode.h"
+#include "info.h"
+#include "schema.h"
+
+/** Global statement cache. */
+static struct {
+	/** mhash table (id -> statement) */
+	struct mh_i32ptr_t *by_id;
+	/** mhash table (text, len -> statement) */
+	struct mh_strnptr_t *by_text;
+	/** All cached statements, the most recently used first. */
+	struct rlist lru;
+	/** Number of cached statements. */
+	uint32_t count;
+	/** Maximal number of cached statements. */
+	uint32_t size;
+	/** Id of the next cached statement. */
+	uint32_t next_id;
+	/** Number of statements found ready for execution. */
+	int64_t hits;
+	/** Number of statements which had to be prepared. */
+	int64_t misses;
+} cache;
+
+int
+sql_stmt_cache_init(void)
+{
+	cache.by_id = mh_i32ptr_new();
+	if (cache.by_id == NULL) {
+		diag_set(OutOfMemory, sizeof(*cache.by_id), "malloc",
+			 "sql_stmt_cache_id");
+		return -1;
+	}
+	cache.by_text = mh_strnptr_new();
+	if (cache.by_text == NULL) {
+		diag_set(OutOfMemory, sizeof(*cache.by_text), "malloc",
+			 "sql_stmt_cache_text");
+		mh_i32ptr_delete(cache.by_id);
+		return -1;
+	}
+	rlist_create(&cache.lru);
+	cache.next_id = 1;
+	return 0;
+}
+
+/**
+ * Prepare a VDBE program for the statement text.
+ * @retval NULL Parse error, diag is set.
+ */
+static struct sqlite3_stmt *
+sql_stmt_compile(struct sqlite3 *db, const char *sql, uint32_t len)
+{
+	struct sqlite3_stmt *vdbe;
+	if (sqlite3_prepare_v2(db, sql, len, &vdbe, NULL) != SQLITE_OK) {
+		diag_set(ClientError, ER_SQL_EXECUTE, sqlite3_errmsg(db));
+		return NULL;
+	}
+	assert(vdbe != NULL);
+	return vdbe;
+}
+
+/**
+ * Prepare a statement not registered in the cache. The text
+ * is copied, so the statement outlives the request. The new
+ * statement is busy.
+ */
+static struct sql_stmt *
+sql_stmt_new(struct sqlite3 *db, const char *sql, uint32_t len)
+{
+	struct sql_stmt *stmt = malloc(sizeof(*stmt) + len);
+	if (stmt == NULL) {
+		diag_set(OutOfMemory, sizeof(*stmt) + len, "malloc", "stmt");
+		return NULL;
+	}
+	stmt->vdbe = sql_stmt_compile(db, sql, len);
+	if (stmt->vdbe == NULL) {
+		free(stmt);
+		return NULL;
+	}
+	char *text = (char *) (stmt + 1);
+	memcpy(text, sql, len);
+	stmt->sql = text;
+	stmt->sql_len = len;
+	stmt->id = 0;
+	stmt->schema_version = schema_version;
+	stmt->is_busy = true;
+	stmt->is_cached = false;
+	rlist_create(&stmt->in_lru);
+	return stmt;
+}
+
+static void
+sql_stmt_delete(struct sql_stmt *stmt)
+{
+	sqlite3_finalize(stmt->vdbe);
+	free(stmt);
+}
+
+/** Remove a statement from the cache, but do not delete it. */
+static void
+sql_stmt_cache_remove(struct sql_stmt *stmt)
+{
+	assert(stmt->is_cached);
+	mh_int_t pos = mh_i32ptr_find(cache.by_id, stmt->id, NULL);
+	assert(pos != mh_end(cache.by_id));
+	mh_i32ptr_del(cache.by_id, pos, NULL);
+	pos = mh_strnptr_find_inp(cache.by_text, stmt->sql, stmt->sql_len);
+	assert(pos != mh_end(cache.by_text));
+	mh_strnptr_del(cache.by_text, pos, NULL);
+	rlist_del_entry(stmt, in_lru);
+	stmt->is_cached = false;
+	cache.count--;
+}
+
+/** Remove a statement from the cache and delete it, unless busy. */
+static void
+sql_stmt_cache_evict(struct sql_stmt *stmt)
+{
+	sql_stmt_cache_remove(stmt);
+	/* A busy statement is deleted on release. */
+	if (!stmt->is_busy)
+		sql_stmt_delete(stmt);
+}
+
+/**
+ * Evict the least recently used statements above the limit.
+ * The most recent statement is never evicted.
+ */
+static void
+sql_stmt_cache_trim(void)
+{
+	while (cache.count > MAX(cache.size, 1)) {
+		struct sql_stmt *stmt = rlist_last_entry(&cache.lru,
+							 struct sql_stmt,
+							 in_lru);
+		sql_stmt_cache_evict(stmt);
+	}
+}
+
+/**
+ * Register a new statement in the cache.
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+static int
+sql_stmt_cache_insert(struct sql_stmt *stmt)
+{
+	/* Skip 0, which is never a valid id, and ids in use. */
+	while (cache.next_id == 0 ||
+	       mh_i32ptr_find(cache.by_id, cache.next_id,
+			      NULL) != mh_end(cache.by_id))
+		cache.next_id++;
+	stmt->id = cache.next_id++;
+	const struct mh_i32ptr_node_t id_node = {stmt->id, stmt};
+	if (mh_i32ptr_put(cache.by_id, &id_node, NULL, NULL) ==
+	    mh_end(cache.by_id)) {
+		diag_set(OutOfMemory, sizeof(id_node), "malloc",
+			 "sql_stmt_cache_id");
+		return -1;
+	}
+	uint32_t hash = mh_strn_hash(stmt->sql, stmt->sql_len);
+	const struct mh_strnptr_node_t text_node =
+		{stmt->sql, stmt->sql_len, hash, stmt};
+	if (mh_strnptr_put(cache.by_text, &text_node, NULL, NULL) ==
+	    mh_end(cache.by_text)) {
+		diag_set(OutOfMemory, sizeof(text_node), "malloc",
+			 "sql_stmt_cache_text");
+		mh_i32ptr_del(cache.by_id,
+			      mh_i32ptr_find(cache.by_id, stmt->id, NULL),
+			      NULL);
+		return -1;
+	}
+	rlist_add_entry(&cache.lru, stmt, in_lru);
+	stmt->is_cached = true;
+	cache.count++;
+	sql_stmt_cache_trim();
+	return 0;
+}
+
+void
+sql_stmt_cache_destroy(void)
+{
+	struct sql_stmt *stmt, *tmp;
+	rlist_foreach_entry_safe(stmt, &cache.lru, in_lru, tmp)
+		sql_stmt_cache_evict(stmt);
+	mh_i32ptr_delete(cache.by_id);
+	mh_strnptr_delete(cache.by_text);
+}
+
+void
+sql_stmt_cache_set_size(uint32_t size)
+{
+	cache.size = size;
+	if (cache.by_id != NULL)
+		sql_stmt_cache_trim();
+}
+
+/**
+ * Make a cached statement ready for execution: prepare it
+ * again if the schema has changed since it was prepared.
+ * A fiber which finds the statement busy gets a private copy.
+ */
+static struct sql_stmt *
+sql_stmt_cache_use(struct sqlite3 *db, struct sql_stmt *stmt)
+{
+	if (stmt->is_busy) {
+		cache.misses++;
+		struct sql_stmt *copy = sql_stmt_new(db, stmt->sql,
+						     stmt->sql_len);
+		if (copy != NULL)
+			copy->id = stmt->id;
+		return copy;
+	}
+	if (stmt->schema_version != schema_version) {
+		cache.misses++;
+		struct sqlite3_stmt *vdbe =
+			sql_stmt_compile(db, stmt->sql, stmt->sql_len);
+		if (vdbe == NULL) {
+			sql_stmt_cache_evict(stmt);
+			return NULL;
+		}
+		sqlite3_finalize(stmt->vdbe);
+		stmt->vdbe = vdbe;
+		stmt->schema_version = schema_version;
+	} else {
+		cache.hits++;
+	}
+	rlist_move_entry(&cache.lru, stmt, in_lru);
+	stmt->is_busy = true;
+	return stmt;
+}
+
+struct sql_stmt *
+sql_stmt_cache_acquire(struct sqlite3 *db, const char *sql, uint32_t len)
+{
+	mh_int_t pos = mh_strnptr_find_inp(cache.by_text, sql, len);
+	if (pos != mh_end(cache.by_text))
+		return sql_stmt_cache_use(db, mh_strnptr_node(cache.by_text,
+							      pos)->val);
+	cache.misses++;
+	struct sql_stmt *stmt = sql_stmt_new(db, sql, len);
+	if (stmt == NULL)
+		return NULL;
+	if (sql_stmt_cache_insert(stmt) != 0) {
+		sql_stmt_delete(stmt);
+		return NULL;
+	}
+	return stmt;
+}
+
+struct sql_stmt *
+sql_stmt_cache_acquire_by_id(struct sqlite3 *db, uint32_t id)
+{
+	mh_int_t pos = mh_i32ptr_find(cache.by_id, id, NULL);
+	if (pos == mh_end(cache.by_id)) {
+		diag_set(ClientError, ER_SQL_STMT_NOT_FOUND, id);
+		return NULL;
+	}
+	return sql_stmt_cache_use(db, mh_i32ptr_node(cache.by_id, pos)->val);
+}
+
+void
+sql_stmt_cache_release(struct sql_stmt *stmt)
+{
+	assert(stmt->is_busy);
+	stmt->is_busy = false;
+	if (!stmt->is_cached) {
+		sql_stmt_delete(stmt);
+		return;
+	}
+	sqlite3_reset(stmt->vdbe);
+	sqlite3_clear_bindings(stmt->vdbe);
+}
+
+void
+sql_stmt_cache_stat(struct info_handler *h)
+{
+	info_begin(h);
+	info_append_int(h, "cache_size", cache.count);
+	info_append_int(h, "cache_hits", cache.hits);
+	info_append_int(h, "cache_misses", cache.misses);
+	info_end(h);
+}
@@ -0,0 +1,137 @@
+#ifndef TARANTOOL_BOX_SQL_STMT_CACHE_H_INCLUDED
+#define TARANTOOL_BOX_SQL_STMT_CACHE_H_INCLUDED
+/*
+ * Copyright 2010-2017, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "small/rlist.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct sqlite3;
+struct sqlite3_stmt;
+struct info_handler;
+
+/**
+ * A prepared SQL statement, cached by its text. Parsing and
+ * planning of a statement is done once, and then the VDBE
+ * program is reset and reused by each execution, until the
+ * schema changes or the statement is evicted.
+ */
+struct sql_stmt {
+	/** Unique id used to execute a prepared statement. */
+	uint32_t id;
+	/** Statement text, not 0-terminated. */
+	const char *sql;
+	/** Length of the @sql. */
+	uint32_t sql_len;
+	/** Prepared VDBE program. */
+	struct sqlite3_stmt *vdbe;
+	/** Value of schema_version the @vdbe was prepared at. */
+	uint32_t schema_version;
+	/**
+	 * True if the statement is being executed. A busy
+	 * statement is never handed out twice: a fiber which
+	 * needs the same text gets a private copy.
+	 */
+	bool is_busy;
+	/** True if the statement is registered in the cache. */
+	bool is_cached;
+	/** Link in the LRU list, the most recent first. */
+	struct rlist in_lru;
+};
+
+/**
+ * Create global hash tables.
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+sql_stmt_cache_init(void);
+
+/** Delete all cached statements and the hash tables. */
+void
+sql_stmt_cache_destroy(void);
+
+/**
+ * Set the maximal number of cached statements. Evicts the
+ * least recently used statements if there are more.
+ */
+void
+sql_stmt_cache_set_size(uint32_t size);
+
+/**
+ * Find a statement by its text, or prepare it and put it in the
+ * cache. A statement prepared at an older schema version is
+ * prepared again. The statement is marked busy until it is
+ * returned with sql_stmt_cache_release().
+ * @param db SQLite engine.
+ * @param sql Statement text.
+ * @param len Length of @sql.
+ *
+ * @retval NULL Parse or memory error, diag is set.
+ * @retval not NULL Prepared statement.
+ */
+struct sql_stmt *
+sql_stmt_cache_acquire(struct sqlite3 *db, const char *sql, uint32_t len);
+
+/**
+ * Find a statement by id, returned earlier by
+ * sql_stmt_cache_acquire(). Otherwise the same as
+ * sql_stmt_cache_acquire().
+ *
+ * @retval NULL The statement is not in the cache or can't be
+ *         prepared again, diag is set.
+ * @retval not NULL Prepared statement.
+ */
+struct sql_stmt *
+sql_stmt_cache_acquire_by_id(struct sqlite3 *db, uint32_t id);
+
+/**
+ * Reset the statement for the next execution and make it
+ * available to other fibers. A statement evicted while busy
+ * is deleted.
+ */
+void
+sql_stmt_cache_release(struct sql_stmt *stmt);
+
+/** Cache hit/miss statistics, for box.stat.sql(). */
+void
+sql_stmt_cache_stat(struct info_handler *h);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_SQL_STMT_CACHE_H_INCLUDED */
@@ -32,6 +32,7 @@
 #include "tuple.h"
 #include "trivia/util.h" /* NOINLINE */
 #include <math.h>
+#include <limits.h>
 #include "coll_def.h"
 
 /* {{{ tuple_compare */
@@ -1153,6 +1154,89 @@ tuple_compare_with_key_create(const struct key_def *def)
 
 /* }}} tuple_compare_with_key */
 
+/* {{{ tuple_hint */
+
+/**
+ * Map a field value to a 64-bit integer preserving its order
+ * in terms of the key part type. Only a prefix of the value is
+ * taken into account, so equal hints don't imply equal values.
+ */
+static inline uint64_t
+field_hint(const char *field, enum field_type type, struct coll *coll)
+{
+	switch (type) {
+	case FIELD_TYPE_UNSIGNED:
+		return mp_decode_uint(&field);
+	case FIELD_TYPE_INTEGER:
+		if (mp_typeof(*field) == MP_INT) {
+			int64_t value = mp_decode_int(&field);
+			return (uint64_t)value - (uint64_t)INT64_MIN;
+		} else {
+			uint64_t value = mp_decode_uint(&field);
+			if (value > INT64_MAX)
+				return UINT64_MAX;
+			return value - (uint64_t)INT64_MIN;
+		}
+	case FIELD_TYPE_STRING: {
+		uint32_t len;
+		const char *s = mp_decode_str(&field, &len);
+		if (coll != NULL)
+			return coll->hint(s, len, coll);
+		const unsigned char *str = (const unsigned char *)s;
+		uint64_t result = 0;
+		for (uint32_t i = 0; i < sizeof(result); i++) {
+			result <<= CHAR_BIT;
+			if (i < len)
+				result |= str[i];
+		}
+		return result;
+	}
+	default:
+		unreachable();
+	}
+	return HINT_NONE;
+}
+
+bool
+key_def_has_hint(const struct key_def *key_def)
+{
+	const struct key_part *part = &key_def->parts[0];
+	if (part->is_nullable)
+		return false;
+	switch (part->type) {
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_INTEGER:
+		return true;
+	case FIELD_TYPE_STRING:
+		return true;
+	default:
+		return false;
+	}
+}
+
+uint64_t
+tuple_hint(const struct tuple *tuple, const struct key_def *key_def)
+{
+	if (!key_def_has_hint(key_def))
+		return HINT_NONE;
+	const struct key_part *part = &key_def->parts[0];
+	const char *field = tuple_field(tuple, part->fieldno);
+	assert(field != NULL);
+	return field_hint(field, part->type, part->coll);
+}
+
+uint64_t
+key_hint(const char *key, uint32_t part_count,
+	 const struct key_def *key_def)
+{
+	if (part_count == 0 || !key_def_has_hint(key_def))
+		return HINT_NONE;
+	const struct key_part *part = &key_def->parts[0];
+	return field_hint(key, part->type, part->coll);
+}
+
+/* }}} tuple_hint */
+
 int
 box_tuple_compare(const box_tuple_t *tuple_a, const box_tuple_t *tuple_b,
 		  const box_key_def_t *key_def)
@@ -106,6 +106,44 @@ tuple_compare_with_key(const struct tuple *tuple, const char *key,
 	return key_def->tuple_compare_with_key(tuple, key, part_count, key_def);
 }
 
+/**
+ * Hint of a tuple or a key that doesn't carry any information
+ * about the value. Returned for key definitions that don't
+ * support hints.
+ */
+enum { HINT_NONE = 0 };
+
+/**
+ * Check if hints can be calculated for the key definition.
+ * A hint is built of the first key part, which must be of
+ * type 'unsigned', 'integer' or 'string' and must not be
+ * nullable. For a string part with a collation the hint is
+ * a prefix of the collation sort key, see coll->hint.
+ */
+bool
+key_def_has_hint(const struct key_def *key_def);
+
+/**
+ * Calculate a hint of a tuple: a 64-bit integer such that
+ * hint(a) < hint(b) implies that tuple a is less than tuple b
+ * in terms of @a key_def. Equal hints imply nothing, in which
+ * case the tuples must be compared with tuple_compare().
+ * @param tuple tuple
+ * @param key_def key definition
+ * @retval HINT_NONE if the key definition doesn't support hints
+ */
+uint64_t
+tuple_hint(const struct tuple *tuple, const struct key_def *key_def);
+
+/**
+ * @copydoc tuple_hint()
+ * @param key key parts without MessagePack array header
+ * @param part_count the number of parts in @a key
+ */
+uint64_t
+key_hint(const char *key, uint32_t part_count,
+	 const struct key_def *key_def);
+
 /** \cond public */
 
 /**
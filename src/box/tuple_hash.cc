@@ -336,3 +336,36 @@ key_hash_slowpath(const char *key, const struct key_def *key_def)
 
 	return PMurHash32_Result(h, carry, total_size);
 }
+
+void
+tuple_hash_prefixes(const struct tuple *tuple, const struct key_def *key_def,
+		    uint32_t part_count, uint32_t *hashes)
+{
+	assert(part_count <= key_def->part_count);
+	uint32_t h = HASH_SEED;
+	uint32_t carry = 0;
+	uint32_t total_size = 0;
+	for (uint32_t part_id = 0; part_id < part_count; part_id++) {
+		const struct key_part *part = &key_def->parts[part_id];
+		const char *field = tuple_field(tuple, part->fieldno);
+		total_size += tuple_hash_field(&h, &carry, &field, part->coll);
+		hashes[part_id] = PMurHash32_Result(h, carry, total_size);
+	}
+}
+
+uint32_t
+key_hash_prefix(const char *key, const struct key_def *key_def,
+		uint32_t part_count)
+{
+	assert(part_count <= key_def->part_count);
+	uint32_t h = HASH_SEED;
+	uint32_t carry = 0;
+	uint32_t total_size = 0;
+
+	for (const struct key_part *part = key_def->parts;
+	     part < key_def->parts + part_count; part++) {
+		total_size += tuple_hash_field(&h, &carry, &key, part->coll);
+	}
+
+	return PMurHash32_Result(h, carry, total_size);
+}
@@ -167,6 +167,24 @@ vclock_sum(const struct vclock *vclock)
 int64_t
 vclock_follow(struct vclock *vclock, uint32_t replica_id, int64_t lsn);
 
+/**
+ * Set a vclock component to the given lsn. Unlike vclock_follow()
+ * the lsn may be less than the current one, which is needed to
+ * undo promotions done for a transaction that failed.
+ */
+static inline void
+vclock_reset(struct vclock *vclock, uint32_t replica_id, int64_t lsn)
+{
+	assert(lsn >= 0);
+	assert(replica_id < VCLOCK_MAX);
+	vclock->signature += lsn - vclock->lsn[replica_id];
+	vclock->lsn[replica_id] = lsn;
+	if (lsn == 0)
+		vclock->map &= ~(1 << replica_id);
+	else
+		vclock->map |= 1 << replica_id;
+}
+
 /**
  * \brief Format vclock to YAML-compatible string representation:
  * { replica_id: lsn, replica_id:lsn })
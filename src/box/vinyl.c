@@ -169,6 +169,8 @@ struct vy_env {
 	int read_threads;
 	/** Max number of threads used for writing. */
 	int write_threads;
+	/** Read run files with direct I/O if set. */
+	bool direct_io;
 	/** Try to recover corrupted data if set. */
 	bool force_recovery;
 };
@@ -326,6 +328,23 @@ vy_info_append_cache(struct vy_env *env, struct info_handler *h)
 	info_table_end(h);
 }
 
+static void
+vy_info_append_page_cache(struct vy_env *env, struct info_handler *h)
+{
+	struct vy_page_cache *c = &env->run_env.page_cache;
+
+	info_table_begin(h, "page_cache");
+
+	info_append_int(h, "used", c->mem_used);
+	info_append_int(h, "limit", c->mem_quota);
+	info_append_int(h, "pages", c->page_count);
+	info_append_int(h, "hit", c->hit);
+	info_append_int(h, "miss", c->miss);
+	info_append_int(h, "evict", c->evict);
+
+	info_table_end(h);
+}
+
 static void
 vy_info_append_tx(struct vy_env *env, struct info_handler *h)
 {
@@ -358,6 +377,7 @@ vinyl_engine_info(struct vinyl_engine *vinyl, struct info_handler *h)
 	info_begin(h);
 	vy_info_append_quota(env, h);
 	vy_info_append_cache(env, h);
+	vy_info_append_page_cache(env, h);
 	vy_info_append_tx(env, h);
 	info_end(h);
 }
@@ -399,6 +419,47 @@ vy_info_append_compact_stat(struct info_handler *h, const char *name,
 	info_table_end(h);
 }
 
+/**
+ * Append amplification factors of an index, 0 if not defined:
+ * - read: average number of runs per range, i.e. the number
+ *   of runs a lookup may need to check;
+ * - write: bytes written by dump and compaction per byte dumped;
+ * - space: size of all runs relative to the size of the oldest
+ *   run of each range, which stores most of the data.
+ */
+static void
+vy_info_append_amplification(struct info_handler *h,
+			     struct vy_index *index)
+{
+	struct vy_index_stat *stat = &index->stat;
+	int64_t slice_count = 0;
+	int64_t total_bytes = 0;
+	int64_t last_level_bytes = 0;
+	for (struct vy_range *range = vy_range_tree_first(index->tree);
+	     range != NULL; range = vy_range_tree_next(index->tree, range)) {
+		struct vy_slice *slice;
+		rlist_foreach_entry(slice, &range->slices, in_range)
+			total_bytes += slice->count.bytes;
+		slice_count += range->slice_count;
+		if (rlist_empty(&range->slices))
+			continue;
+		slice = rlist_last_entry(&range->slices,
+					 struct vy_slice, in_range);
+		last_level_bytes += slice->count.bytes;
+	}
+	int64_t dumped = stat->disk.dump.out.bytes;
+	int64_t written = dumped + stat->disk.compact.out.bytes;
+
+	info_table_begin(h, "amplification");
+	info_append_double(h, "read", index->range_count == 0 ? 0 :
+			   (double)slice_count / index->range_count);
+	info_append_double(h, "write", dumped == 0 ? 0 :
+			   (double)written / dumped);
+	info_append_double(h, "space", last_level_bytes == 0 ? 0 :
+			   (double)total_bytes / last_level_bytes);
+	info_table_end(h);
+}
+
 static void
 vinyl_index_info(struct index *base, struct info_handler *h)
 {
@@ -437,6 +498,7 @@ vinyl_index_info(struct index *base, struct info_handler *h)
 	info_append_int(h, "lookup", stat->disk.iterator.lookup);
 	vy_info_append_stmt_counter(h, "get", &stat->disk.iterator.get);
 	vy_info_append_disk_stmt_counter(h, "read", &stat->disk.iterator.read);
+	info_append_int(h, "read_ahead", stat->disk.iterator.read_ahead);
 	info_table_begin(h, "bloom");
 	info_append_int(h, "hit", stat->disk.iterator.bloom_hit);
 	info_append_int(h, "miss", stat->disk.iterator.bloom_miss);
@@ -468,6 +530,7 @@ vinyl_index_info(struct index *base, struct info_handler *h)
 	info_append_int(h, "run_avg", index->run_count / index->range_count);
 	histogram_snprint(buf, sizeof(buf), index->run_hist);
 	info_append_str(h, "run_histogram", buf);
+	vy_info_append_amplification(h, index);
 
 	info_end(h);
 }
@@ -684,7 +747,8 @@ vy_index_open(struct vy_env *env, struct vy_index *index)
 		if (rc == 0) {
 			/* Make sure reader threads are up and running. */
 			vy_run_env_enable_coio(&env->run_env,
-					       env->read_threads);
+					       env->read_threads,
+					       env->direct_io);
 		}
 		break;
 	case VINYL_INITIAL_RECOVERY_REMOTE:
@@ -1006,12 +1070,6 @@ vinyl_space_prepare_alter(struct space *old_space, struct space *new_space)
 	if (space_def_check_compatibility(old_space->def, new_space->def,
 					  false) != 0)
 		return -1;
-	if (old_space->index_count < new_space->index_count) {
-		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
-			 "adding an index to a non-empty space");
-		return -1;
-	}
-
 	if (old_space->index_count == new_space->index_count) {
 		/* Check index_defs to be unchanged. */
 		for (uint32_t i = 0; i < old_space->index_count; ++i) {
@@ -1035,7 +1093,10 @@ vinyl_space_prepare_alter(struct space *old_space, struct space *new_space)
 			}
 		}
 	}
-	/* Drop index or a change in index options. */
+	/*
+	 * Create, drop index or a change in index options.
+	 * A new index is built by vy_build_index().
+	 */
 	return 0;
 }
 
@@ -1142,35 +1203,53 @@ vinyl_space_drop_primary_key(struct space *space)
 	(void)space;
 }
 
+static int
+vy_build_index(struct vy_env *env, struct space *old_space,
+	       struct space *new_space, struct index *new_index,
+	       bool is_online);
+
 static int
 vinyl_space_build_secondary_key(struct space *old_space,
 				struct space *new_space,
 				struct index *new_index)
 {
-	(void)old_space;
-	(void)new_space;
-	/*
-	 * Unlike Memtx, Vinyl does not need building of a secondary index.
-	 * This is true because of two things:
-	 * 1) Vinyl does not support alter of non-empty spaces
-	 * 2) During recovery a Vinyl index already has all needed data on disk.
-	 * And there are 3 cases:
-	 * I. The secondary index is added in snapshot. Then Vinyl was
-	 * snapshotted too and all necessary for that moment data is on disk.
-	 * II. The secondary index is added in WAL. That means that vinyl
-	 * space had no data at that point and had nothing to build. The
-	 * index actually could contain recovered data, but it will handle it
-	 * by itself during WAL recovery.
-	 * III. Vinyl is online. The space is definitely empty and there's
-	 * nothing to build.
-	 *
-	 * When we start to implement alter of non-empty vinyl spaces, it
-	 *  seems that we should call here:
-	 *   Engine::buildSecondaryKey(old_space, new_space, new_index_arg);
-	 *  but aware of three cases mentioned above.
-	 */
-	return vy_index_open(vy_env(new_index->engine),
-			     vy_index(new_index));
+	struct vy_env *env = vy_env(new_index->engine);
+	struct vy_index *index = vy_index(new_index);
+	if (vy_index_open(env, index) != 0)
+		return -1;
+	switch (env->status) {
+	case VINYL_ONLINE:
+		return vy_build_index(env, old_space, new_space,
+				      new_index, true);
+	case VINYL_INITIAL_RECOVERY_LOCAL:
+		/*
+		 * The index was created before the last checkpoint
+		 * and so all its data has already been dumped.
+		 */
+		return 0;
+	case VINYL_FINAL_RECOVERY_LOCAL:
+		/*
+		 * The index is created in WAL. If it was dumped
+		 * after creation, its data is on disk. Otherwise
+		 * the index data existed only in memory and has
+		 * to be rebuilt. Note, since the primary key is
+		 * dumped last, it can't have been dumped after
+		 * the index was created in the latter case, so
+		 * it is in the same state it was in when the
+		 * index was built.
+		 */
+		if (index->dump_lsn >= 0 || index->is_dropped)
+			return 0;
+		return vy_build_index(env, old_space, new_space,
+				      new_index, false);
+	default:
+		/*
+		 * Remote recovery. Rows are applied one by one
+		 * so there can't be concurrent changes.
+		 */
+		return vy_build_index(env, old_space, new_space,
+				      new_index, false);
+	}
 }
 
 static size_t
@@ -2179,8 +2258,13 @@ vy_upsert(struct vy_env *env, struct vy_tx *tx, struct txn_stmt *stmt,
 		diag_log();
 		/*
 		 * Upsert is skipped, to match the semantics of
-		 * vy_index_upsert().
+		 * vy_index_upsert(). Don't pass the tuples to
+		 * on_replace triggers since nothing has changed.
 		 */
+		tuple_unref(stmt->old_tuple);
+		tuple_unref(stmt->new_tuple);
+		stmt->old_tuple = NULL;
+		stmt->new_tuple = NULL;
 		return 0;
 	}
 	if (vy_tx_set(tx, pk, stmt->new_tuple))
@@ -2505,6 +2589,335 @@ vinyl_engine_rollback_statement(struct engine *engine, struct txn *txn,
 
 /* }}} Public API of transaction control */
 
+/* {{{ Secondary index build */
+
+/** Context of a secondary index build. */
+struct vy_build_ctx {
+	/** Vinyl environment. */
+	struct vy_env *env;
+	/** Primary index of the space. */
+	struct vy_index *pk;
+	/** Index being built. */
+	struct vy_index *index;
+	/** Format of the new space. */
+	struct tuple_format *format;
+	/** Name of the space, for error messages. */
+	const char *space_name;
+	/** Name of the new index, for error messages. */
+	const char *index_name;
+	/**
+	 * Set if a change forwarded to the new index failed,
+	 * e.g. violated the new unique constraint. Since
+	 * on_replace triggers can't fail the statement, the
+	 * build is aborted instead.
+	 */
+	bool is_failed;
+	/** The error that made the build fail. */
+	struct diag diag;
+};
+
+/**
+ * Check that no tuple other than @stmt has the same key in
+ * the unique index being built.
+ * @param ctx  Build context.
+ * @param tx   Transaction to look up the key in or NULL to
+ *             look up among all prepared statements.
+ * @param stmt Statement to check.
+ *
+ * @retval  0 Success, no duplicates.
+ * @retval -1 Memory or read error or a duplicate is found.
+ */
+static int
+vy_build_check_unique(struct vy_build_ctx *ctx, struct vy_tx *tx,
+		      struct tuple *stmt)
+{
+	struct vy_env *env = ctx->env;
+	struct vy_index *index = ctx->index;
+	if (!index->opts.is_unique ||
+	    (index->key_def->is_nullable &&
+	     vy_tuple_key_contains_null(stmt, index->key_def)))
+		return 0;
+	const char *key = tuple_extract_key(stmt, index->key_def, NULL);
+	if (key == NULL)
+		return -1;
+	uint32_t part_count = mp_decode_array(&key);
+	struct tuple *vykey = vy_stmt_new_select(index->env->key_format,
+						 key, part_count);
+	if (vykey == NULL)
+		return -1;
+	const struct vy_read_view **p_read_view;
+	if (tx != NULL) {
+		p_read_view = (const struct vy_read_view **) &tx->read_view;
+	} else {
+		p_read_view = &env->xm->p_global_read_view;
+	}
+	/*
+	 * The key may be found more than once: the statement
+	 * itself may have already been inserted by the build
+	 * or forwarded by a concurrent transaction.
+	 */
+	struct vy_read_iterator itr;
+	vy_read_iterator_open(&itr, &env->run_env, index, tx, ITER_EQ, vykey,
+			      p_read_view, env->too_long_threshold);
+	struct tuple *found;
+	int rc;
+	while ((rc = vy_read_iterator_next(&itr, &found)) == 0 &&
+	       found != NULL) {
+		if (vy_tuple_compare(found, stmt, ctx->pk->key_def) != 0) {
+			diag_set(ClientError, ER_TUPLE_FOUND,
+				 ctx->index_name, ctx->space_name);
+			rc = -1;
+			break;
+		}
+	}
+	vy_read_iterator_close(&itr);
+	tuple_unref(vykey);
+	return rc;
+}
+
+/**
+ * on_replace trigger installed on the space while a secondary
+ * index is being built. Forwards changes done by transactions
+ * to the new index.
+ */
+static void
+vy_build_on_replace(struct trigger *trigger, void *event)
+{
+	struct txn *txn = event;
+	struct txn_stmt *stmt = txn_current_stmt(txn);
+	struct vy_build_ctx *ctx = trigger->data;
+	struct vy_index *index = ctx->index;
+	struct vy_tx *tx = txn->engine_tx;
+	assert(tx != NULL);
+
+	if (ctx->is_failed)
+		return; /* already failed, nothing to do */
+
+	if (stmt->new_tuple != NULL &&
+	    tuple_validate(ctx->format, stmt->new_tuple) != 0)
+		goto err;
+	/* Delete goes first, see vy_replace_impl(). */
+	if (stmt->old_tuple != NULL) {
+		struct tuple *delete =
+			vy_stmt_new_surrogate_delete(index->mem_format,
+						     stmt->old_tuple);
+		if (delete == NULL)
+			goto err;
+		int rc = vy_tx_set(tx, index, delete);
+		tuple_unref(delete);
+		if (rc != 0)
+			goto err;
+	}
+	if (stmt->new_tuple != NULL) {
+		uint32_t size;
+		const char *data = tuple_data_range(stmt->new_tuple, &size);
+		struct tuple *replace =
+			vy_stmt_new_replace(index->mem_format,
+					    data, data + size);
+		if (replace == NULL)
+			goto err;
+		int rc = vy_build_check_unique(ctx, tx, replace);
+		if (rc == 0)
+			rc = vy_tx_set(tx, index, replace);
+		tuple_unref(replace);
+		if (rc != 0)
+			goto err;
+	}
+	return;
+err:
+	diag_move(diag_get(), &ctx->diag);
+	ctx->is_failed = true;
+}
+
+/**
+ * Insert a tuple read from the primary key into the index
+ * being built, bypassing transactions. The statement retains
+ * the LSN of the tuple, so that it is overwritten by changes
+ * forwarded by vy_build_on_replace() whichever is inserted
+ * first.
+ */
+static int
+vy_build_insert_tuple(struct vy_build_ctx *ctx, struct vy_mem *mem,
+		      struct tuple *tuple, bool is_online)
+{
+	struct vy_env *env = ctx->env;
+	struct vy_index *index = ctx->index;
+
+	if (tuple_validate(ctx->format, tuple) != 0)
+		return -1;
+	uint32_t size;
+	const char *data = tuple_data_range(tuple, &size);
+	struct tuple *stmt = vy_stmt_new_replace(index->mem_format,
+						 data, data + size);
+	if (stmt == NULL)
+		return -1;
+	vy_stmt_set_lsn(stmt, vy_stmt_lsn(tuple));
+
+	int rc = -1;
+	/* Throttle the build if there's not enough memory. */
+	size_t reserved = 0;
+	if (is_online) {
+		reserved = tuple_size(stmt);
+		if (vy_quota_use(&env->quota, reserved, env->timeout) != 0) {
+			diag_set(ClientError, ER_VY_QUOTA_TIMEOUT);
+			goto out;
+		}
+	}
+	size_t mem_used_before = lsregion_used(&env->stmt_env.allocator);
+	const struct tuple *region_stmt = NULL;
+	rc = vy_index_set(index, mem, stmt, &region_stmt);
+	size_t mem_used_after = lsregion_used(&env->stmt_env.allocator);
+	assert(mem_used_after >= mem_used_before);
+	size_t used = mem_used_after - mem_used_before;
+	if (used >= reserved)
+		vy_quota_force_use(&env->quota, used - reserved);
+	else
+		vy_quota_release(&env->quota, reserved - used);
+	if (rc != 0)
+		goto out;
+	vy_index_commit_stmt(index, mem, region_stmt);
+	if (!is_online)
+		goto out;
+	/*
+	 * The unique constraint is checked after insertion so
+	 * that a concurrent transaction can't miss the tuple:
+	 * those that have already looked up the key are sent
+	 * to read view, those that have already been prepared
+	 * are seen by the check.
+	 */
+	if (index->opts.is_unique) {
+		rc = tx_manager_abort_readers(env->xm, index, stmt);
+		if (rc == 0)
+			rc = vy_build_check_unique(ctx, NULL, stmt);
+	}
+out:
+	tuple_unref(stmt);
+	return rc;
+}
+
+/**
+ * Build a secondary index of a non-empty space: scan the
+ * primary key and insert all tuples into the in-memory tree
+ * of the new index, which is then dumped to disk by the
+ * scheduler once the index is committed.
+ *
+ * If @is_online is set, the build yields periodically, and
+ * changes done to the space while it is in progress are
+ * forwarded to the new index by an on_replace trigger.
+ */
+static int
+vy_build_index(struct vy_env *env, struct space *old_space,
+	       struct space *new_space, struct index *new_index,
+	       bool is_online)
+{
+	struct vy_index *pk = vy_index(old_space->index[0]);
+	struct vy_index *index = vy_index(new_index);
+
+	/*
+	 * The new index is kept in memory until the build is
+	 * committed, so refuse to build an index that won't fit
+	 * in the memory quota rather than fail half way through,
+	 * having throttled all other writers. Statements of the
+	 * new index store full tuples, so its size is estimated
+	 * as the size of the primary key. The estimate may be
+	 * too high if the primary key has not been compacted.
+	 */
+	size_t size = pk->stat.disk.count.bytes +
+		      pk->stat.memory.count.bytes;
+	if (is_online && size > env->quota.limit) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+			 "building an index larger than vinyl_memory");
+		return -1;
+	}
+
+	struct vy_build_ctx ctx;
+	ctx.env = env;
+	ctx.pk = pk;
+	ctx.index = index;
+	ctx.format = new_space->format;
+	ctx.space_name = space_name(old_space);
+	ctx.index_name = new_index->def->name;
+	ctx.is_failed = false;
+	diag_create(&ctx.diag);
+
+	struct trigger on_replace;
+	trigger_create(&on_replace, vy_build_on_replace, &ctx, NULL);
+
+	/*
+	 * A concurrent transaction may rotate the in-memory tree
+	 * of the new index. Since statements read from the primary
+	 * key are older than forwarded ones, always insert them
+	 * into the tree that was active when the build started.
+	 */
+	struct vy_mem *mem = index->mem;
+	vy_mem_pin(mem);
+
+	int rc = -1;
+	struct tuple *key = vy_stmt_new_select(pk->env->key_format, NULL, 0);
+	if (key == NULL)
+		goto out;
+
+	if (is_online) {
+		trigger_add(&old_space->on_replace, &on_replace);
+		/*
+		 * Changes done before the trigger was installed
+		 * are not forwarded to the new index, so abort
+		 * active transactions that have written to the
+		 * space and wait for prepared ones to complete.
+		 */
+		if (tx_manager_abort_writers(env->xm, pk) != 0)
+			goto out;
+		struct vclock vclock;
+		if (env->xm->last_prepared_tx != NULL &&
+		    wal_checkpoint(&vclock, false) != 0) {
+			diag_set(ClientError, ER_TRANSACTION_CONFLICT);
+			goto out;
+		}
+	}
+
+	struct vy_read_iterator itr;
+	vy_read_iterator_open(&itr, &env->run_env, pk, NULL, ITER_ALL, key,
+			      &env->xm->p_committed_read_view,
+			      env->too_long_threshold);
+	int loops = 0;
+	struct tuple *tuple;
+	while ((rc = vy_read_iterator_next(&itr, &tuple)) == 0 &&
+	       tuple != NULL) {
+		/* The insertion may yield. */
+		tuple_ref(tuple);
+		size_t region_svp = region_used(&fiber()->gc);
+		rc = vy_build_insert_tuple(&ctx, mem, tuple, is_online);
+		region_truncate(&fiber()->gc, region_svp);
+		tuple_unref(tuple);
+		if (rc != 0)
+			break;
+		if (is_online && ++loops % VY_YIELD_LOOPS == 0) {
+			fiber_sleep(0);
+			if (fiber_is_cancelled()) {
+				diag_set(FiberIsCancelled);
+				rc = -1;
+				break;
+			}
+		}
+		if (ctx.is_failed)
+			break;
+	}
+	vy_read_iterator_close(&itr);
+	if (ctx.is_failed) {
+		diag_move(&ctx.diag, diag_get());
+		rc = -1;
+	}
+out:
+	trigger_clear(&on_replace);
+	vy_mem_unpin(mem);
+	if (key != NULL)
+		tuple_unref(key);
+	diag_destroy(&ctx.diag);
+	return rc;
+}
+
+/* }}} Secondary index build */
+
 /** {{{ Environment */
 
 static void
@@ -2606,7 +3019,8 @@ vy_squash_schedule(struct vy_index *index, struct tuple *stmt,
 
 static struct vy_env *
 vy_env_new(const char *path, size_t memory, size_t cache,
-	   int read_threads, int write_threads, bool force_recovery)
+	   int read_threads, int write_threads, bool direct_io,
+	   bool force_recovery)
 {
 	enum { KB = 1000, MB = 1000 * 1000 };
 	static int64_t dump_bandwidth_buckets[] = {
@@ -2635,6 +3049,7 @@ vy_env_new(const char *path, size_t memory, size_t cache,
 	e->too_long_threshold = TIMEOUT_INFINITY;
 	e->read_threads = read_threads;
 	e->write_threads = write_threads;
+	e->direct_io = direct_io;
 	e->force_recovery = force_recovery;
 	e->path = strdup(path);
 	if (e->path == NULL) {
@@ -2725,7 +3140,8 @@ vy_env_delete(struct vy_env *e)
 
 struct vinyl_engine *
 vinyl_engine_new(const char *dir, size_t memory, size_t cache,
-		 int read_threads, int write_threads, bool force_recovery)
+		 int read_threads, int write_threads, bool direct_io,
+		 bool force_recovery)
 {
 	struct vinyl_engine *vinyl = calloc(1, sizeof(*vinyl));
 	if (vinyl == NULL) {
@@ -2735,7 +3151,7 @@ vinyl_engine_new(const char *dir, size_t memory, size_t cache,
 	}
 
 	vinyl->env = vy_env_new(dir, memory, cache, read_threads,
-				write_threads, force_recovery);
+				write_threads, direct_io, force_recovery);
 	if (vinyl->env == NULL) {
 		free(vinyl);
 		return NULL;
@@ -2774,6 +3190,12 @@ vinyl_engine_set_too_long_threshold(struct vinyl_engine *vinyl,
 	vinyl->env->too_long_threshold = too_long_threshold;
 }
 
+void
+vinyl_engine_set_page_cache(struct vinyl_engine *vinyl, size_t quota)
+{
+	vy_run_env_set_page_cache_quota(&vinyl->env->run_env, quota);
+}
+
 /** }}} Environment */
 
 /* {{{ Checkpoint */
@@ -2914,7 +3336,8 @@ vinyl_engine_end_recovery(struct engine *engine)
 	 * the first index creation, see vy_index_open().
 	 */
 	if (e->index_env.index_count > 0)
-		vy_run_env_enable_coio(&e->run_env, e->read_threads);
+		vy_run_env_enable_coio(&e->run_env, e->read_threads,
+				       e->direct_io);
 	return 0;
 }
 
@@ -3502,6 +3925,8 @@ struct vy_squash_queue {
 	struct fiber_cond cond;
 	/** Queue of vy_squash objects to be processed. */
 	struct stailq queue;
+	/** Request being processed by the fiber, or NULL. */
+	struct vy_squash *current;
 	/** Mempool for struct vy_squash. */
 	struct mempool pool;
 };
@@ -3578,6 +4003,8 @@ vy_squash_process(struct vy_squash *squash)
 	};
 	struct vy_mem_tree_iterator mem_itr =
 		vy_mem_tree_lower_bound(&mem->tree, &tree_key, NULL);
+	const struct tuple *mem_stmt;
+	int64_t stmt_lsn;
 	if (vy_mem_tree_iterator_is_invalid(&mem_itr)) {
 		/*
 		 * The in-memory tree we are squashing an upsert
@@ -3586,6 +4013,21 @@ vy_squash_process(struct vy_squash *squash)
 		tuple_unref(result);
 		return 0;
 	}
+	/*
+	 * The resulting REPLACE takes the place of the newest
+	 * committed statement, so the latter must be an UPSERT
+	 * stored in this in-memory tree. Otherwise the tree the
+	 * chain ended in was dumped or the key has already been
+	 * squashed.
+	 */
+	mem_stmt = *vy_mem_tree_iterator_get_elem(&mem->tree, &mem_itr);
+	if (vy_tuple_compare(result, mem_stmt, def) != 0 ||
+	    vy_stmt_lsn(mem_stmt) != vy_stmt_lsn(result) ||
+	    vy_stmt_type(mem_stmt) != IPROTO_UPSERT) {
+		tuple_unref(result);
+		return 0;
+	}
+	stmt_lsn = vy_stmt_lsn(mem_stmt);
 	/**
 	 * Algorithm of the squashing.
 	 * Assume, during building the non-UPSERT statement
@@ -3623,8 +4065,6 @@ vy_squash_process(struct vy_squash *squash)
 	 *    -------------------------------------+
 	 */
 	vy_mem_tree_iterator_prev(&mem->tree, &mem_itr);
-	const struct tuple *mem_stmt;
-	int64_t stmt_lsn;
 	/*
 	 * According to the described algorithm, squash the
 	 * commited UPSERTs at first.
@@ -3725,6 +4165,7 @@ vy_squash_queue_new(void)
 	sq->fiber = NULL;
 	fiber_cond_create(&sq->cond);
 	stailq_create(&sq->queue);
+	sq->current = NULL;
 	mempool_create(&sq->pool, cord_slab_cache(),
 		       sizeof(struct vy_squash));
 	return sq;
@@ -3755,13 +4196,35 @@ vy_squash_queue_f(va_list va)
 		}
 		struct vy_squash *squash;
 		squash = stailq_shift_entry(&sq->queue, struct vy_squash, next);
+		sq->current = squash;
 		if (vy_squash_process(squash) != 0)
 			diag_log();
+		sq->current = NULL;
 		vy_squash_delete(&sq->pool, squash);
 	}
 	return 0;
 }
 
+/**
+ * Return true if squashing of the given key has already been
+ * requested and not completed yet.
+ */
+static bool
+vy_squash_queue_has(struct vy_squash_queue *sq, struct vy_index *index,
+		    const struct tuple *stmt)
+{
+	struct vy_squash *squash = sq->current;
+	if (squash != NULL && squash->index == index &&
+	    vy_tuple_compare(squash->stmt, stmt, index->cmp_def) == 0)
+		return true;
+	stailq_foreach_entry(squash, &sq->queue, next) {
+		if (squash->index == index &&
+		    vy_tuple_compare(squash->stmt, stmt, index->cmp_def) == 0)
+			return true;
+	}
+	return false;
+}
+
 /*
  * For a given UPSERT statement, insert the resulting REPLACE
  * statement after it. Done in a background fiber.
@@ -3772,6 +4235,13 @@ vy_squash_schedule(struct vy_index *index, struct tuple *stmt, void *arg)
 	struct vy_env *env = arg;
 	struct vy_squash_queue *sq = env->squash_queue;
 
+	/*
+	 * A hot key may be read many times before the request
+	 * is processed, don't queue it more than once.
+	 */
+	if (vy_squash_queue_has(sq, index, stmt))
+		return;
+
 	say_debug("optimize upsert slow: %"PRIu32"/%"PRIu32": %s",
 		  index->space_id, index->id, vy_stmt_str(stmt));
 
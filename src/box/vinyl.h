@@ -43,7 +43,8 @@ struct vinyl_engine;
 
 struct vinyl_engine *
 vinyl_engine_new(const char *dir, size_t memory, size_t cache,
-		 int read_threads, int write_threads, bool force_recovery);
+		 int read_threads, int write_threads, bool direct_io,
+		 bool force_recovery);
 
 /**
  * Engine introspection (box.info.vinyl())
@@ -70,6 +71,12 @@ void
 vinyl_engine_set_too_long_threshold(struct vinyl_engine *vinyl,
 				    double too_long_threshold);
 
+/**
+ * Update the max size of the shared page cache.
+ */
+void
+vinyl_engine_set_page_cache(struct vinyl_engine *vinyl, size_t quota);
+
 #ifdef __cplusplus
 } /* extern "C" */
 
@@ -77,11 +84,12 @@ vinyl_engine_set_too_long_threshold(struct vinyl_engine *vinyl,
 
 static inline struct vinyl_engine *
 vinyl_engine_new_xc(const char *dir, size_t memory, size_t cache,
-		    int read_threads, int write_threads, bool force_recovery)
+		    int read_threads, int write_threads, bool direct_io,
+		    bool force_recovery)
 {
 	struct vinyl_engine *vinyl;
 	vinyl = vinyl_engine_new(dir, memory, cache, read_threads,
-				 write_threads, force_recovery);
+				 write_threads, direct_io, force_recovery);
 	if (vinyl == NULL)
 		diag_raise();
 	return vinyl;
@@ -947,37 +947,80 @@ vy_index_rollback_stmt(struct vy_index *index, struct vy_mem *mem,
 	vy_cache_on_write(&index->cache, stmt, NULL);
 }
 
+void
+vy_index_check_upsert_chain(struct vy_index *index, struct tuple *stmt,
+			    int n_upserts)
+{
+	if (n_upserts < VY_UPSERT_READ_THRESHOLD ||
+	    index->env->upsert_thresh_cb == NULL)
+		return;
+	/* Upserts enabled only in the primary index. */
+	assert(index->id == 0);
+	/*
+	 * The squashing task replaces the newest UPSERT with
+	 * the resulting REPLACE so it can only be done if the
+	 * former is stored in the active in-memory tree. Chains
+	 * that have been dumped entirely are merged by compaction.
+	 */
+	struct vy_mem *mem = index->mem;
+	struct tree_mem_key tree_key = {
+		.stmt = stmt,
+		.lsn = MAX_LSN - 1,
+	};
+	struct vy_mem_tree_iterator itr =
+		vy_mem_tree_lower_bound(&mem->tree, &tree_key, NULL);
+	if (vy_mem_tree_iterator_is_invalid(&itr))
+		return;
+	const struct tuple *newest =
+		*vy_mem_tree_iterator_get_elem(&mem->tree, &itr);
+	if (vy_stmt_compare(newest, stmt, index->cmp_def) != 0 ||
+	    vy_stmt_type(newest) != IPROTO_UPSERT)
+		return;
+	index->env->upsert_thresh_cb(index, stmt,
+				     index->env->upsert_thresh_arg);
+}
+
 bool
-vy_index_split_range(struct vy_index *index, struct vy_range *range)
+vy_index_split_range(struct vy_index *index, struct vy_range *range,
+		     int max_parts)
 {
 	struct tuple_format *key_format = index->env->key_format;
 
-	const char *split_key_raw;
-	if (!vy_range_needs_split(range, &index->opts, &split_key_raw))
+	const char *split_keys_raw[VY_RANGE_SPLIT_PARTS_MAX - 1];
+	int n_keys;
+	max_parts = MIN(max_parts, VY_RANGE_SPLIT_PARTS_MAX);
+	if (vy_range_needs_split(range, &index->opts, &split_keys_raw[0]))
+		n_keys = 1;
+	else
+		n_keys = vy_range_needs_parallel_split(range, &index->opts,
+						       max_parts,
+						       split_keys_raw);
+	if (n_keys == 0)
 		return false;
 
-	/* Split a range in two parts. */
-	const int n_parts = 2;
+	/* Split a range in n_keys + 1 parts. */
+	const int n_parts = n_keys + 1;
+
+	struct vy_slice *slice, *new_slice;
+	struct vy_range *part, *parts[VY_RANGE_SPLIT_PARTS_MAX] = {NULL, };
 
 	/*
 	 * Determine new ranges' boundaries.
 	 */
-	struct tuple *split_key = vy_key_from_msgpack(key_format,
-						      split_key_raw);
-	if (split_key == NULL)
-		goto fail;
-
-	struct tuple *keys[3];
+	struct tuple *keys[VY_RANGE_SPLIT_PARTS_MAX + 1] = {NULL, };
 	keys[0] = range->begin;
-	keys[1] = split_key;
-	keys[2] = range->end;
+	keys[n_parts] = range->end;
+	for (int i = 0; i < n_keys; i++) {
+		keys[i + 1] = vy_key_from_msgpack(key_format,
+						  split_keys_raw[i]);
+		if (keys[i + 1] == NULL)
+			goto fail;
+	}
 
 	/*
 	 * Allocate new ranges and create slices of
 	 * the old range's runs for them.
 	 */
-	struct vy_slice *slice, *new_slice;
-	struct vy_range *part, *parts[2] = {NULL, };
 	for (int i = 0; i < n_parts; i++) {
 		part = vy_range_new(vy_log_next_id(), keys[i], keys[i + 1],
 				    index->cmp_def);
@@ -1033,21 +1076,29 @@ vy_index_split_range(struct vy_index *index, struct vy_range *range)
 	}
 	index->range_tree_version++;
 
-	say_info("%s: split range %s by key %s", vy_index_name(index),
-		 vy_range_str(range), tuple_str(split_key));
+	if (n_keys == 1) {
+		say_info("%s: split range %s by key %s", vy_index_name(index),
+			 vy_range_str(range), tuple_str(keys[1]));
+	} else {
+		say_info("%s: split range %s in %d parts for compaction",
+			 vy_index_name(index), vy_range_str(range), n_parts);
+	}
 
 	rlist_foreach_entry(slice, &range->slices, in_range)
 		vy_slice_wait_pinned(slice);
 	vy_range_delete(range);
-	tuple_unref(split_key);
+	for (int i = 1; i < n_parts; i++)
+		tuple_unref(keys[i]);
 	return true;
 fail:
 	for (int i = 0; i < n_parts; i++) {
 		if (parts[i] != NULL)
 			vy_range_delete(parts[i]);
 	}
-	if (split_key != NULL)
-		tuple_unref(split_key);
+	for (int i = 1; i < n_parts; i++) {
+		if (keys[i] != NULL)
+			tuple_unref(keys[i]);
+	}
 	assert(!diag_is_empty(diag_get()));
 	say_error("%s: failed to split range %s: %s",
 		  vy_index_name(index), vy_range_str(range),
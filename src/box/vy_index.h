@@ -75,7 +75,9 @@ struct vy_index_env {
 	struct tuple *empty_key;
 	/**
 	 * Callback invoked when the number of upserts for
-	 * the same key exceeds VY_UPSERT_THRESHOLD.
+	 * the same key exceeds VY_UPSERT_THRESHOLD or a read
+	 * has to apply more than VY_UPSERT_READ_THRESHOLD
+	 * upserts to get the key's value.
 	 */
 	vy_upsert_thresh_cb upsert_thresh_cb;
 	/** Argument passed to upsert_thresh_cb. */
@@ -430,9 +432,14 @@ vy_index_delete_mem(struct vy_index *index, struct vy_mem *mem);
  * by the original range, adding them to new ranges, and reflecting
  * the change in the metadata log, i.e. it doesn't involve heavy
  * operations, like writing a run file, and is done immediately.
+ *
+ * A range that has never been compacted may be split in up to
+ * @max_parts parts at once so that they can be compacted in
+ * parallel, see vy_range_needs_parallel_split().
  */
 bool
-vy_index_split_range(struct vy_index *index, struct vy_range *range);
+vy_index_split_range(struct vy_index *index, struct vy_range *range,
+		     int max_parts);
 
 /**
  * Coalesce a range with one or more its neighbors if it is too small,
@@ -489,6 +496,21 @@ void
 vy_index_rollback_stmt(struct vy_index *index, struct vy_mem *mem,
 		       const struct tuple *stmt);
 
+/**
+ * Called by read iterators after applying @n_upserts UPSERT
+ * statements to get @stmt. If the chain is too long and its
+ * newest statement is a committed UPSERT stored in the active
+ * in-memory tree, schedule background squashing of the key
+ * so that subsequent reads don't have to replay the chain.
+ *
+ * @param index     Index the statement was read from.
+ * @param stmt      Result of applying the UPSERT chain.
+ * @param n_upserts Number of applied UPSERT statements.
+ */
+void
+vy_index_check_upsert_chain(struct vy_index *index, struct tuple *stmt,
+			    int n_upserts);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
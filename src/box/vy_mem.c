@@ -227,9 +227,14 @@ vy_mem_commit_stmt(struct vy_mem *mem, const struct tuple *stmt)
 	/* The statement must be from a lsregion. */
 	assert(!vy_stmt_is_refable(stmt));
 	int64_t lsn = vy_stmt_lsn(stmt);
-	if (mem->min_lsn == INT64_MAX)
+	/*
+	 * Statements are normally committed in the LSN order,
+	 * but a secondary index build inserts old statements
+	 * read from the primary key after newer ones forwarded
+	 * by concurrent transactions.
+	 */
+	if (mem->min_lsn > lsn)
 		mem->min_lsn = lsn;
-	assert(mem->min_lsn <= lsn);
 	if (mem->max_lsn < lsn)
 		mem->max_lsn = lsn;
 }
@@ -263,7 +263,7 @@ vy_point_iterator_scan_slice(struct vy_point_iterator *itr,
 			     itr->run_env, slice, ITER_EQ, itr->key,
 			     itr->p_read_view, index->cmp_def,
 			     index->key_def, index->disk_format,
-			     index->upsert_format, index->id == 0);
+			     index->upsert_format, index->id == 0, 0);
 	struct tuple *stmt;
 	rc = vy_run_iterator_next_key(&run_itr, &stmt);
 	while (rc == 0 && stmt != NULL) {
@@ -351,6 +351,7 @@ vy_point_iterator_apply_history(struct vy_point_iterator *itr,
 		}
 		node = rlist_prev_entry_safe(node, history, link);
 	}
+	int n_upserts = 0;
 	while (node != NULL) {
 		assert(vy_stmt_type(node->stmt) == IPROTO_UPSERT);
 		/* We could not read the data that is invisible now */
@@ -368,8 +369,12 @@ vy_point_iterator_apply_history(struct vy_point_iterator *itr,
 		if (itr->curr_stmt)
 			tuple_unref(itr->curr_stmt);
 		itr->curr_stmt = stmt;
+		n_upserts++;
 		node = rlist_prev_entry_safe(node, history, link);
 	}
+	if (n_upserts > 0)
+		vy_index_check_upsert_chain(itr->index, itr->curr_stmt,
+					    n_upserts);
 	if (itr->curr_stmt) {
 		vy_stmt_counter_acct_tuple(&itr->index->stat.get,
 					   itr->curr_stmt);
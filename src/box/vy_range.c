@@ -286,9 +286,9 @@ vy_range_remove_slice(struct vy_range *range, struct vy_slice *slice)
  * to be compacted and sets @compact_priority to the number of runs in
  * this level and all preceding levels.
  */
-void
-vy_range_update_compact_priority(struct vy_range *range,
-				 const struct index_opts *opts)
+static void
+vy_range_update_compact_priority_tiered(struct vy_range *range,
+					const struct index_opts *opts)
 {
 	assert(opts->run_count_per_level > 0);
 	assert(opts->run_size_ratio > 1);
@@ -365,6 +365,67 @@ vy_range_update_compact_priority(struct vy_range *range,
 	}
 }
 
+/**
+ * Leveled compaction keeps a single run per level in a range,
+ * each run_size_ratio times larger than the run at the previous
+ * level. Since ranges don't overlap, a level of the whole index
+ * is a set of non-overlapping runs then. A run is merged into
+ * the next level as soon as it, together with all newer runs,
+ * exceeds 1/run_size_ratio of the size of the next level run.
+ * Compared to the tiered policy, this bounds read amplification
+ * by the number of levels and space amplification by about
+ * 1 + 1/(run_size_ratio - 1) at the cost of higher write
+ * amplification. run_count_per_level is ignored.
+ *
+ * Given a range, this function sets @compact_priority to the
+ * number of the newest runs that need to be merged.
+ */
+static void
+vy_range_update_compact_priority_leveled(struct vy_range *range,
+					 const struct index_opts *opts)
+{
+	assert(opts->run_size_ratio > 1);
+
+	range->compact_priority = 0;
+
+	/* Total number of checked runs. */
+	uint32_t total_run_count = 0;
+	/* The total size of runs checked so far. */
+	uint64_t total_size = 0;
+
+	struct vy_slice *slice;
+	rlist_foreach_entry(slice, &range->slices, in_range) {
+		uint64_t size = slice->count.bytes_compressed;
+		/*
+		 * If the newer runs are too big for the level
+		 * above this one, merge them into this run.
+		 * Since total_size accounts the runs scheduled
+		 * for compaction, the result is checked against
+		 * the next level right away, which prevents
+		 * cascading compaction.
+		 */
+		if (total_run_count > 0 &&
+		    total_size * opts->run_size_ratio >= size)
+			range->compact_priority = total_run_count + 1;
+		total_size += size;
+		total_run_count++;
+	}
+}
+
+void
+vy_range_update_compact_priority(struct vy_range *range,
+				 const struct index_opts *opts)
+{
+	switch (opts->compaction_policy) {
+	case COMPACTION_POLICY_LEVELED:
+		vy_range_update_compact_priority_leveled(range, opts);
+		break;
+	default:
+		vy_range_update_compact_priority_tiered(range, opts);
+		break;
+	}
+}
+
 /**
  * Return true and set split_key accordingly if the range needs to be
  * split in two.
@@ -439,6 +500,79 @@ vy_range_needs_split(struct vy_range *range, const struct index_opts *opts,
 	return true;
 }
 
+/**
+ * A range that was never compacted may be arbitrarily large,
+ * for instance if a lot of data was dumped at once. Compacting
+ * it in one go takes one worker thread for a long time while the
+ * others may be idle, so we split such a range into parts of at
+ * least range_size, using the page index of its biggest run to
+ * find split keys. The parts are then compacted independently.
+ */
+int
+vy_range_needs_parallel_split(struct vy_range *range,
+			      const struct index_opts *opts,
+			      int max_parts, const char **split_keys)
+{
+	assert(max_parts <= VY_RANGE_SPLIT_PARTS_MAX);
+
+	/* Compacted ranges are split in two by vy_range_needs_split(). */
+	if (range->n_compactions > 0)
+		return 0;
+
+	int64_t n_parts = range->count.bytes_compressed /
+			  MAX(opts->range_size, 1);
+	n_parts = MIN(n_parts, max_parts);
+	if (n_parts < 2)
+		return 0;
+
+	/* Find the biggest run. */
+	struct vy_slice *slice, *biggest = NULL;
+	rlist_foreach_entry(slice, &range->slices, in_range) {
+		if (biggest == NULL || slice->count.bytes_compressed >
+				       biggest->count.bytes_compressed)
+			biggest = slice;
+	}
+	if (biggest == NULL)
+		return 0;
+
+	/*
+	 * Take min keys of the pages dividing the run into
+	 * n_parts equal parts. Skip keys that are out of the
+	 * range or the slice boundaries, see the comment in
+	 * vy_range_needs_split().
+	 */
+	uint32_t page_count = biggest->last_page_no -
+			      biggest->first_page_no + 1;
+	const char *prev_key = NULL;
+	int n_keys = 0;
+	for (int i = 1; i < n_parts; i++) {
+		uint32_t page_no = biggest->first_page_no +
+				   page_count * i / n_parts;
+		if (page_no == biggest->first_page_no)
+			continue;
+		const char *key = vy_run_page_info(biggest->run,
+						   page_no)->min_key;
+		if (prev_key != NULL &&
+		    key_compare(key, prev_key, range->cmp_def) <= 0)
+			continue;
+		if (biggest->begin != NULL && key_compare(key,
+				tuple_data(biggest->begin), range->cmp_def) <= 0)
+			continue;
+		if (range->begin != NULL && key_compare(key,
+				tuple_data(range->begin), range->cmp_def) <= 0)
+			continue;
+		if (biggest->end != NULL && key_compare(key,
+				tuple_data(biggest->end), range->cmp_def) >= 0)
+			break;
+		if (range->end != NULL && key_compare(key,
+				tuple_data(range->end), range->cmp_def) >= 0)
+			break;
+		split_keys[n_keys++] = key;
+		prev_key = key;
+	}
+	return n_keys;
+}
+
 /**
  * Check if a range should be coalesced with one or more its neighbors.
  * If it should, return true and set @p_first and @p_last to the first
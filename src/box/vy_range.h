@@ -223,7 +223,8 @@ void
 vy_range_remove_slice(struct vy_range *range, struct vy_slice *slice);
 
 /**
- * Update compaction priority of a range.
+ * Update compaction priority of a range according to
+ * the compaction policy of the index.
  *
  * @param range     The range.
  * @param opts      Index options.
@@ -245,6 +246,30 @@ bool
 vy_range_needs_split(struct vy_range *range, const struct index_opts *opts,
 		     const char **p_split_key);
 
+/** Max number of parts a range can be split into at once. */
+enum { VY_RANGE_SPLIT_PARTS_MAX = 16 };
+
+/**
+ * Check if a range that has never been compacted, e.g. after
+ * a bulk load, is so big that it should be split into several
+ * parts before compaction, so that the parts can be compacted
+ * in parallel by different worker threads.
+ *
+ * @param range             The range.
+ * @param opts              Index options.
+ * @param max_parts         Max number of parts to split the range
+ *                          into, at most VY_RANGE_SPLIT_PARTS_MAX.
+ * @param[out] split_keys   Keys to split the range by, sorted
+ *                          in ascending order.
+ *
+ * @retval Number of split keys, 0 if the range doesn't need
+ *         to be split.
+ */
+int
+vy_range_needs_parallel_split(struct vy_range *range,
+			      const struct index_opts *opts,
+			      int max_parts, const char **split_keys);
+
 /**
  * Check if a range needs to be coalesced with adjacent
  * ranges in a range tree.
@@ -655,6 +655,7 @@ vy_read_iterator_squash_upsert(struct vy_read_iterator *itr,
 	/* Upserts enabled only in the primary index. */
 	assert(vy_stmt_type(t) != IPROTO_UPSERT || index->id == 0);
 	tuple_ref(t);
+	int n_upserts = 0;
 	while (vy_stmt_type(t) == IPROTO_UPSERT) {
 		struct tuple *next;
 		int rc = vy_read_iterator_next_lsn(itr, &next);
@@ -670,9 +671,12 @@ vy_read_iterator_squash_upsert(struct vy_read_iterator *itr,
 		if (applied == NULL)
 			return -1;
 		t = applied;
+		n_upserts++;
 		if (next == NULL)
 			break;
 	}
+	if (n_upserts > 0)
+		vy_index_check_upsert_chain(index, t, n_upserts);
 	*ret = t;
 	return 0;
 }
@@ -730,8 +734,11 @@ static void
 vy_read_iterator_add_disk(struct vy_read_iterator *itr)
 {
 	assert(itr->curr_range != NULL);
-	enum iterator_type iterator_type = (itr->iterator_type != ITER_REQ ?
-					    itr->iterator_type : ITER_LE);
+	/*
+	 * Unlike other sources, run iterators accept ITER_REQ
+	 * so that they can check it against bloom filters.
+	 */
+	enum iterator_type iterator_type = itr->iterator_type;
 	struct vy_index *index = itr->index;
 	struct vy_slice *slice;
 	/*
@@ -760,7 +767,8 @@ vy_read_iterator_add_disk(struct vy_read_iterator *itr)
 				     iterator_type, itr->key,
 				     itr->read_view, index->cmp_def,
 				     index->key_def, index->disk_format,
-				     index->upsert_format, index->id == 0);
+				     index->upsert_format, index->id == 0,
+				     index->opts.read_ahead);
 	}
 }
 
@@ -836,8 +844,9 @@ vy_read_iterator_open(struct vy_read_iterator *itr, struct vy_run_env *run_env,
 	if (iterator_type == ITER_REQ) {
 		/*
 		 * Source iterators cannot handle ITER_REQ and
-		 * use ITER_LE instead, so we need to enable EQ
-		 * check in this case.
+		 * use ITER_LE instead (run iterators do it
+		 * internally), so we need to enable EQ check
+		 * in this case.
 		 *
 		 * See vy_read_iterator_add_{tx,cache,mem,run}.
 		 */
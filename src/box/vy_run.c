@@ -30,7 +30,9 @@
  */
 #include "vy_run.h"
 
+#include <fcntl.h>
 #include <zstd.h>
+#include <pmatomic.h>
 
 #include "fiber.h"
 #include "fiber_cond.h"
@@ -80,8 +82,27 @@ struct vy_run_reader {
 	struct cpipe reader_pipe;
 	/** Pipe from the reader thread to tx. */
 	struct cpipe tx_pipe;
+	/**
+	 * Buffer for direct I/O aligned by VY_DIRECT_IO_ALIGN.
+	 * Used only by the reader thread, grown on demand.
+	 */
+	char *dio_buf;
+	/** Size of dio_buf. */
+	size_t dio_buf_size;
 };
 
+/**
+ * Alignment of file offsets, sizes and memory buffers used
+ * for direct I/O. Large enough for any block device.
+ */
+enum { VY_DIRECT_IO_ALIGN = 4096 };
+
+/**
+ * Max number of pages read ahead with a single message
+ * and so a single read from the disk.
+ */
+enum { VY_READ_AHEAD_BATCH_MAX = 16 };
+
 /** Cbus task for vinyl page read. */
 struct vy_page_read_task {
 	/** parent */
@@ -92,8 +113,56 @@ struct vy_page_read_task {
 	struct vy_slice *slice;
 	/** vy_run_env - contains environment with task mempool */
 	struct vy_run_env *run_env;
+	/** Reader thread the task is posted to. */
+	struct vy_run_reader *reader;
+	/** [out] resulting vinyl page */
+	struct vy_page *page;
+};
+
+/** A page read ahead of a run iterator. */
+struct vy_page_read_ahead {
+	/** vinyl page metadata */
+	struct vy_page_info page_info;
+	/** Number of the page to read. */
+	uint32_t page_no;
 	/** [out] resulting vinyl page */
 	struct vy_page *page;
+	/** [out] vy_page_read() return code */
+	int rc;
+	/** Set when the page read task is back in tx. */
+	bool done;
+	/** Signaled when the page read task is back in tx. */
+	struct fiber_cond done_cond;
+	/** Iterator that requested the page, NULL if abandoned. */
+	struct vy_run_iterator *itr;
+	/** Link in vy_run_iterator::read_ahead_queue. */
+	struct rlist in_queue;
+};
+
+/**
+ * Cbus message for reading pages ahead of a run iterator.
+ * Unlike vy_page_read_task, it is posted asynchronously: the
+ * pages are read by a reader thread, then the message is routed
+ * back to tx where the iterator picks the pages up. Pages the
+ * iterator skipped or was closed before reaching are freed on
+ * return to tx. Since the pages follow each other in the run
+ * file, they are read from the disk at once.
+ */
+struct vy_page_read_ahead_task {
+	/** parent */
+	struct cmsg base;
+	/** Reader thread, then tx. */
+	struct cmsg_hop route[2];
+	/** vy_run with fd - ref. counted */
+	struct vy_run *run;
+	/** vy_run_env - contains the thread-local ZSTD context */
+	struct vy_run_env *run_env;
+	/** Reader thread the task is posted to. */
+	struct vy_run_reader *reader;
+	/** Number of pages to read. */
+	int page_count;
+	/** Pages to read, in the scan order. */
+	struct vy_page_read_ahead *pages[VY_READ_AHEAD_BATCH_MAX];
 };
 
 /** Destructor for env->zdctx_key thread-local variable */
@@ -117,6 +186,7 @@ vy_run_reader_f(va_list ap)
 	cbus_loop(&endpoint);
 	cbus_endpoint_destroy(&endpoint, cbus_process);
 	cpipe_destroy(&reader->tx_pipe);
+	free(reader->dio_buf);
 	return 0;
 }
 
@@ -171,8 +241,12 @@ vy_run_env_create(struct vy_run_env *env)
 	tt_pthread_key_create(&env->zdctx_key, vy_free_zdctx);
 	mempool_create(&env->read_task_pool, cord_slab_cache(),
 		       sizeof(struct vy_page_read_task));
+	rlist_create(&env->page_cache.lru);
 }
 
+static void
+vy_page_cache_destroy(struct vy_page_cache *cache);
+
 /**
  * Destroy vinyl run environment
  */
@@ -181,6 +255,7 @@ vy_run_env_destroy(struct vy_run_env *env)
 {
 	if (env->reader_pool != NULL)
 		vy_run_env_stop_readers(env);
+	vy_page_cache_destroy(&env->page_cache);
 	mempool_destroy(&env->read_task_pool);
 	tt_pthread_key_delete(env->zdctx_key);
 }
@@ -189,10 +264,11 @@ vy_run_env_destroy(struct vy_run_env *env)
  * Enable coio reads for a vinyl run environment.
  */
 void
-vy_run_env_enable_coio(struct vy_run_env *env, int threads)
+vy_run_env_enable_coio(struct vy_run_env *env, int threads, bool direct_io)
 {
 	if (env->reader_pool != NULL)
 		return; /* already enabled */
+	env->direct_io = direct_io;
 	vy_run_env_start_readers(env, threads);
 }
 
@@ -235,6 +311,7 @@ vy_run_new(int64_t id)
 	run->id = id;
 	run->dump_lsn = -1;
 	run->fd = -1;
+	run->direct_fd = -1;
 	run->refs = 1;
 	rlist_create(&run->in_index);
 	rlist_create(&run->in_unused);
@@ -256,18 +333,37 @@ vy_run_clear(struct vy_run *run)
 	if (run->info.has_bloom)
 		bloom_destroy(&run->info.bloom, runtime.quota);
 	run->info.has_bloom = false;
+	for (uint32_t i = 0; i < run->info.prefix_bloom_count; i++)
+		bloom_destroy(&run->info.prefix_bloom[i], runtime.quota);
+	free(run->info.prefix_bloom);
+	run->info.prefix_bloom = NULL;
+	run->info.prefix_bloom_count = 0;
 	free(run->info.min_key);
 	run->info.min_key = NULL;
 	free(run->info.max_key);
 	run->info.max_key = NULL;
 }
 
+static void
+vy_page_cache_evict(struct vy_page_cache *cache, struct vy_page *page);
+
 void
 vy_run_delete(struct vy_run *run)
 {
 	assert(run->refs == 0);
+	if (run->direct_fd >= 0 && run->direct_fd != run->fd &&
+	    close(run->direct_fd) < 0)
+		say_syserror("close failed");
 	if (run->fd >= 0 && close(run->fd) < 0)
 		say_syserror("close failed");
+	if (run->cached_pages != NULL) {
+		for (uint32_t i = 0; i < run->info.page_count; i++) {
+			struct vy_page *page = run->cached_pages[i];
+			if (page != NULL)
+				vy_page_cache_evict(run->page_cache, page);
+		}
+		free(run->cached_pages);
+	}
 	vy_run_clear(run);
 	TRASH(run);
 	free(run);
@@ -579,6 +675,37 @@ vy_run_bloom_decode(struct bloom *bloom, const char **buffer,
 	return 0;
 }
 
+/**
+ * Read prefix bloom filters from given buffer.
+ * On failure the filters decoded so far are left in
+ * @a run_info and released along with the run.
+ * @param run_info - run info to store the filters in.
+ * @param buffer[in/out] - a buffer to read from.
+ * @param filename Filename for error reporting.
+ * @return - 0 on success or -1 on format/memory error
+ */
+static int
+vy_run_prefix_bloom_decode(struct vy_run_info *run_info,
+			   const char **buffer, const char *filename)
+{
+	uint32_t count = mp_decode_array(buffer);
+	if (count == 0)
+		return 0;
+	run_info->prefix_bloom = calloc(count, sizeof(struct bloom));
+	if (run_info->prefix_bloom == NULL) {
+		diag_set(OutOfMemory, count * sizeof(struct bloom),
+			 "calloc", "prefix bloom");
+		return -1;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		if (vy_run_bloom_decode(&run_info->prefix_bloom[i], buffer,
+					filename) != 0)
+			return -1;
+		run_info->prefix_bloom_count++;
+	}
+	return 0;
+}
+
 /**
  * Decode the run metadata from xrow.
  *
@@ -637,6 +764,11 @@ vy_run_info_decode(struct vy_run_info *run_info,
 			else
 				return -1;
 			break;
+		case VY_RUN_INFO_PREFIX_BLOOM:
+			if (vy_run_prefix_bloom_decode(run_info, &pos,
+						       filename) != 0)
+				return -1;
+			break;
 		default:
 			diag_set(ClientError, ER_INVALID_INDEX_FILE, filename,
 				"Can't decode run info: unknown key %u",
@@ -682,6 +814,9 @@ vy_page_new(const struct vy_page_info *page_info)
 		free(page);
 		return NULL;
 	}
+	page->refs = 1;
+	page->run = NULL;
+	rlist_create(&page->in_lru);
 	return page;
 }
 
@@ -700,6 +835,150 @@ vy_page_delete(struct vy_page *page)
 	free(page);
 }
 
+static inline void
+vy_page_ref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	page->refs++;
+}
+
+static inline void
+vy_page_unref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	if (--page->refs == 0)
+		vy_page_delete(page);
+}
+
+/* {{{ vy_page_cache */
+
+/** Amount of memory accounted to a page stored in the cache. */
+static inline size_t
+vy_page_cache_sizeof(const struct vy_page *page)
+{
+	return sizeof(*page) + page->unpacked_size +
+	       page->row_count * sizeof(uint32_t);
+}
+
+/** Remove a page from the cache and drop the cache reference. */
+static void
+vy_page_cache_evict(struct vy_page_cache *cache, struct vy_page *page)
+{
+	struct vy_run *run = page->run;
+	assert(run != NULL && run->page_cache == cache);
+	assert(run->cached_pages[page->page_no] == page);
+	run->cached_pages[page->page_no] = NULL;
+	page->run = NULL;
+	rlist_del_entry(page, in_lru);
+	assert(cache->mem_used >= vy_page_cache_sizeof(page));
+	cache->mem_used -= vy_page_cache_sizeof(page);
+	cache->page_count--;
+	vy_page_unref(page);
+}
+
+/** Evict least recently used pages until the cache fits in quota. */
+static void
+vy_page_cache_trim(struct vy_page_cache *cache)
+{
+	while (cache->mem_used > cache->mem_quota) {
+		assert(!rlist_empty(&cache->lru));
+		struct vy_page *page = rlist_last_entry(&cache->lru,
+						struct vy_page, in_lru);
+		vy_page_cache_evict(cache, page);
+		cache->evict++;
+	}
+}
+
+static void
+vy_page_cache_destroy(struct vy_page_cache *cache)
+{
+	struct vy_page *page, *tmp;
+	rlist_foreach_entry_safe(page, &cache->lru, in_lru, tmp)
+		vy_page_cache_evict(cache, page);
+}
+
+/**
+ * Look up a page in the cache. The returned page is referenced
+ * by the cache only, the caller must take its own reference to
+ * keep it.
+ * @retval page if found
+ * @retval NULL otherwise
+ */
+static struct vy_page *
+vy_page_cache_get(struct vy_page_cache *cache, struct vy_run *run,
+		  uint32_t page_no)
+{
+	if (cache->mem_quota == 0)
+		return NULL;
+	struct vy_page *page = NULL;
+	if (run->cached_pages != NULL)
+		page = run->cached_pages[page_no];
+	if (page == NULL) {
+		cache->miss++;
+		return NULL;
+	}
+	cache->hit++;
+	rlist_move_entry(&cache->lru, page, in_lru);
+	return page;
+}
+
+/**
+ * Check if a page is cached without updating the LRU list
+ * and statistics.
+ */
+static inline bool
+vy_page_cache_contains(struct vy_page_cache *cache, struct vy_run *run,
+		       uint32_t page_no)
+{
+	return cache->mem_quota > 0 && run->cached_pages != NULL &&
+	       run->cached_pages[page_no] != NULL;
+}
+
+/**
+ * Store a page just read from disk in the cache.
+ * Failure to allocate the run page map isn't critical:
+ * the page is just not cached then.
+ */
+static void
+vy_page_cache_put(struct vy_page_cache *cache, struct vy_run *run,
+		  struct vy_page *page)
+{
+	size_t size = vy_page_cache_sizeof(page);
+	if (size > cache->mem_quota)
+		return;
+	assert(page->run == NULL);
+	if (run->cached_pages == NULL) {
+		run->cached_pages = calloc(run->info.page_count,
+					   sizeof(*run->cached_pages));
+		if (run->cached_pages == NULL)
+			return;
+		run->page_cache = cache;
+	}
+	assert(run->page_cache == cache);
+	/*
+	 * The page may have been read and cached by another
+	 * fiber while this one was waiting for disk.
+	 */
+	if (run->cached_pages[page->page_no] != NULL)
+		return;
+	run->cached_pages[page->page_no] = page;
+	page->run = run;
+	vy_page_ref(page);
+	rlist_add_entry(&cache->lru, page, in_lru);
+	cache->mem_used += size;
+	cache->page_count++;
+	vy_page_cache_trim(cache);
+}
+
+void
+vy_run_env_set_page_cache_quota(struct vy_run_env *env, size_t quota)
+{
+	env->page_cache.mem_quota = quota;
+	vy_page_cache_trim(&env->page_cache);
+}
+
+/* }}} vy_page_cache */
+
 static int
 vy_page_xrow(struct vy_page *page, uint32_t stmt_no,
 	     struct xrow_header *xrow)
@@ -782,7 +1061,7 @@ vy_run_iterator_cache_put(struct vy_run_iterator *itr, struct vy_page *page,
 			  uint32_t page_no)
 {
 	if (itr->prev_page != NULL)
-		vy_page_delete(itr->prev_page);
+		vy_page_unref(itr->prev_page);
 	itr->prev_page = itr->curr_page;
 	itr->curr_page = page;
 	page->page_no = page_no;
@@ -800,9 +1079,9 @@ vy_run_iterator_cache_clean(struct vy_run_iterator *itr)
 		itr->curr_stmt_pos.page_no = UINT32_MAX;
 	}
 	if (itr->curr_page != NULL) {
-		vy_page_delete(itr->curr_page);
+		vy_page_unref(itr->curr_page);
 		if (itr->prev_page != NULL)
-			vy_page_delete(itr->prev_page);
+			vy_page_unref(itr->prev_page);
 		itr->curr_page = itr->prev_page = NULL;
 	}
 }
@@ -841,71 +1120,129 @@ vy_row_index_decode(uint32_t *row_index, uint32_t row_count,
 }
 
 /**
- * Read a page requests from vinyl xlog data file.
+ * Read a range of a run data file. With direct I/O, the range is
+ * extended to VY_DIRECT_IO_ALIGN boundaries and read into the
+ * aligned buffer of the reader thread, otherwise the data is
+ * allocated on the fiber region.
  *
- * @retval 0 on success
- * @retval -1 on error, check diag
+ * @retval pointer to the data on success
+ * @retval NULL on error, check diag
  */
-static int
-vy_page_read(struct vy_page *page, const struct vy_page_info *page_info, int fd,
-	     ZSTD_DStream *zdctx)
-{
-	/* read xlog tx from xlog file */
-	size_t region_svp = region_used(&fiber()->gc);
-	char *data = (char *)region_alloc(&fiber()->gc, page_info->size);
-	if (data == NULL) {
-		diag_set(OutOfMemory, page_info->size, "region gc", "page");
-		return -1;
+static const char *
+vy_run_read_range(int fd, uint64_t offset, size_t size,
+		  struct vy_run_reader *reader, bool direct_io)
+{
+	char *buf;
+	size_t skip = 0;
+	size_t count = size;
+	if (direct_io) {
+		assert(reader != NULL);
+		skip = offset % VY_DIRECT_IO_ALIGN;
+		offset -= skip;
+		count = (skip + size + VY_DIRECT_IO_ALIGN - 1) &
+			~((size_t)VY_DIRECT_IO_ALIGN - 1);
+		if (reader->dio_buf_size < count) {
+			free(reader->dio_buf);
+			reader->dio_buf = NULL;
+			reader->dio_buf_size = 0;
+			void *ptr;
+			if (posix_memalign(&ptr, VY_DIRECT_IO_ALIGN,
+					   count) != 0) {
+				diag_set(OutOfMemory, count, "posix_memalign",
+					 "direct I/O buffer");
+				return NULL;
+			}
+			reader->dio_buf = ptr;
+			reader->dio_buf_size = count;
+		}
+		buf = reader->dio_buf;
+	} else {
+		buf = region_alloc(&fiber()->gc, size);
+		if (buf == NULL) {
+			diag_set(OutOfMemory, size, "region gc", "page");
+			return NULL;
+		}
 	}
-	ssize_t readen = fio_pread(fd, data, page_info->size,
-				   page_info->offset);
+	ssize_t readen = fio_pread(fd, buf, count, offset);
 	ERROR_INJECT(ERRINJ_VYRUN_DATA_READ, {
 		readen = -1;
 		errno = EIO;});
 	if (readen < 0) {
 		/* TODO: report filename */
 		diag_set(SystemError, "failed to read from file");
-		goto error;
+		return NULL;
 	}
-	if (readen != (ssize_t)page_info->size) {
+	/* An aligned read may stop short at the end of file. */
+	if ((size_t)readen < skip + size) {
 		/* TODO: replace with XlogError, report filename */
 		diag_set(ClientError, ER_INVALID_RUN_FILE,
 			 "Unexpected end of file");
-		goto error;
+		return NULL;
 	}
 	ERROR_INJECT(ERRINJ_VY_READ_PAGE_TIMEOUT, {usleep(50000);});
+	return buf + skip;
+}
 
+/**
+ * Decode a page read from vinyl xlog data file.
+ * @data points to page_info->size bytes of the page.
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_decode(struct vy_page *page, const struct vy_page_info *page_info,
+	       const char *data, ZSTD_DStream *zdctx)
+{
 	/* decode xlog tx */
 	const char *data_pos = data;
-	const char *data_end = data + readen;
+	const char *data_end = data + page_info->size;
 	char *rows = page->data;
 	char *rows_end = rows + page_info->unpacked_size;
 	if (xlog_tx_decode(data, data_end, rows, rows_end, zdctx) != 0)
-		goto error;
+		return -1;
 
 	struct xrow_header xrow;
 	data_pos = page->data + page_info->row_index_offset;
 	data_end = page->data + page_info->unpacked_size;
 	if (xrow_header_decode(&xrow, &data_pos, data_end) == -1)
-		goto error;
+		return -1;
 	if (xrow.type != VY_RUN_ROW_INDEX) {
 		/* TODO: report filename */
 		diag_set(ClientError, ER_INVALID_RUN_FILE,
 			 tt_sprintf("Wrong row index type "
 				    "(expected %d, got %u)",
 				    VY_RUN_ROW_INDEX, (unsigned)xrow.type));
-		goto error;
+		return -1;
 	}
 	if (vy_row_index_decode(page->row_index, page->row_count, &xrow) != 0)
-		goto error;
-	region_truncate(&fiber()->gc, region_svp);
+		return -1;
 	ERROR_INJECT(ERRINJ_VY_READ_PAGE, {
 		diag_set(ClientError, ER_INJECTION, "vinyl page read");
 		return -1;});
 	return 0;
-	error:
+}
+
+/**
+ * Read a page requests from vinyl xlog data file.
+ * @reader and @direct_io are passed to vy_run_read_range().
+ *
+ * @retval 0 on success
+ * @retval -1 on error, check diag
+ */
+static int
+vy_page_read(struct vy_page *page, const struct vy_page_info *page_info, int fd,
+	     struct vy_run_reader *reader, bool direct_io, ZSTD_DStream *zdctx)
+{
+	size_t region_svp = region_used(&fiber()->gc);
+	const char *data = vy_run_read_range(fd, page_info->offset,
+					     page_info->size, reader,
+					     direct_io);
+	int rc = -1;
+	if (data != NULL)
+		rc = vy_page_decode(page, page_info, data, zdctx);
 	region_truncate(&fiber()->gc, region_svp);
-	return -1;
+	return rc;
 }
 
 /**
@@ -927,6 +1264,48 @@ vy_env_get_zdctx(struct vy_run_env *env)
 	return zdctx;
 }
 
+/**
+ * Return the file descriptor to read pages of a run from.
+ * Called in a reader thread. If direct I/O is enabled, the run
+ * file is reopened with O_DIRECT on the first call, so that
+ * buffered reads done by dump and compaction are not affected,
+ * and open() doesn't block tx. If that fails, buffered I/O is
+ * used.
+ */
+static int
+vy_run_get_read_fd(struct vy_run_env *env, struct vy_run *run,
+		   bool *direct_io)
+{
+	*direct_io = false;
+	if (!env->direct_io)
+		return run->fd;
+#ifdef O_DIRECT
+	int fd = pm_atomic_load(&run->direct_fd);
+	if (fd < 0) {
+		char path[PATH_MAX];
+		snprintf(path, sizeof(path), "/proc/self/fd/%d", run->fd);
+		fd = open(path, O_RDONLY | O_DIRECT);
+		if (fd < 0) {
+			say_syserror("failed to open run %lld for direct I/O",
+				     (long long)run->id);
+			fd = run->fd;
+		}
+		int old_fd = -1;
+		if (!pm_atomic_compare_exchange_strong(&run->direct_fd,
+						       &old_fd, fd)) {
+			/* Opened by another reader thread. */
+			if (fd != run->fd)
+				close(fd);
+			fd = old_fd;
+		}
+	}
+	*direct_io = fd != run->fd;
+	return fd;
+#else
+	return run->fd;
+#endif
+}
+
 /**
  * vinyl read task callback
  */
@@ -937,8 +1316,11 @@ vy_page_read_cb(struct cbus_call_msg *base)
 	ZSTD_DStream *zdctx = vy_env_get_zdctx(task->run_env);
 	if (zdctx == NULL)
 		return -1;
-	return vy_page_read(task->page, &task->page_info,
-			    task->slice->run->fd, zdctx);
+	bool direct_io;
+	int fd = vy_run_get_read_fd(task->run_env, task->slice->run,
+				    &direct_io);
+	return vy_page_read(task->page, &task->page_info, fd,
+			    task->reader, direct_io, zdctx);
 }
 
 /**
@@ -953,6 +1335,270 @@ vy_page_read_cb_free(struct cbus_call_msg *base)
 	return 0;
 }
 
+
+/** Read pages ahead of a run iterator, called in a reader thread. */
+static void
+vy_page_read_ahead_f(struct cmsg *base)
+{
+	struct vy_page_read_ahead_task *task =
+		(struct vy_page_read_ahead_task *)base;
+	/* The pages are adjacent, read them at once. */
+	uint64_t begin = UINT64_MAX, end = 0;
+	for (int i = 0; i < task->page_count; i++) {
+		struct vy_page_info *info = &task->pages[i]->page_info;
+		begin = MIN(begin, info->offset);
+		end = MAX(end, info->offset + info->size);
+	}
+	size_t region_svp = region_used(&fiber()->gc);
+	const char *data = NULL;
+	ZSTD_DStream *zdctx = vy_env_get_zdctx(task->run_env);
+	if (zdctx != NULL) {
+		bool direct_io;
+		int fd = vy_run_get_read_fd(task->run_env, task->run,
+					    &direct_io);
+		data = vy_run_read_range(fd, begin, end - begin,
+					 task->reader, direct_io);
+	}
+	for (int i = 0; i < task->page_count; i++) {
+		struct vy_page_read_ahead *ra = task->pages[i];
+		if (data == NULL ||
+		    vy_page_decode(ra->page, &ra->page_info,
+				   data + ra->page_info.offset - begin,
+				   zdctx) != 0)
+			ra->rc = -1;
+	}
+	region_truncate(&fiber()->gc, region_svp);
+	/*
+	 * The iterator will reread failed pages synchronously
+	 * and report the error, if they are still needed.
+	 */
+	diag_clear(diag_get());
+}
+
+static void
+vy_page_read_ahead_delete(struct vy_page_read_ahead *ra)
+{
+	if (ra->page != NULL)
+		vy_page_delete(ra->page);
+	fiber_cond_destroy(&ra->done_cond);
+	free(ra);
+}
+
+/** Complete a read-ahead task, called in tx. */
+static void
+vy_page_read_ahead_complete_f(struct cmsg *base)
+{
+	struct vy_page_read_ahead_task *task =
+		(struct vy_page_read_ahead_task *)base;
+	for (int i = 0; i < task->page_count; i++) {
+		struct vy_page_read_ahead *ra = task->pages[i];
+		ra->done = true;
+		if (ra->itr == NULL) {
+			/* The page isn't needed anymore. */
+			vy_page_read_ahead_delete(ra);
+			continue;
+		}
+		fiber_cond_broadcast(&ra->done_cond);
+	}
+	vy_run_unref(task->run);
+	free(task);
+}
+
+/**
+ * Remove a page from the read-ahead queue of an iterator.
+ * If the page hasn't been read yet, it is freed when its read
+ * task gets back to tx.
+ */
+static void
+vy_run_iterator_read_ahead_discard(struct vy_run_iterator *itr,
+				   struct vy_page_read_ahead *ra)
+{
+	assert(ra->itr == itr);
+	rlist_del_entry(ra, in_queue);
+	assert(itr->read_ahead_queue_len > 0);
+	itr->read_ahead_queue_len--;
+	if (ra->done)
+		vy_page_read_ahead_delete(ra);
+	else
+		ra->itr = NULL;
+}
+
+/** Drop all pages read ahead by an iterator. */
+static void
+vy_run_iterator_read_ahead_clean(struct vy_run_iterator *itr)
+{
+	struct vy_page_read_ahead *ra, *tmp;
+	rlist_foreach_entry_safe(ra, &itr->read_ahead_queue, in_queue, tmp)
+		vy_run_iterator_read_ahead_discard(itr, ra);
+	assert(itr->read_ahead_queue_len == 0);
+}
+
+/**
+ * Send a read-ahead task to its reader thread, or free it
+ * if it has no pages to read.
+ */
+static void
+vy_run_iterator_read_ahead_post(struct vy_page_read_ahead_task *task)
+{
+	if (task->page_count == 0) {
+		vy_run_unref(task->run);
+		free(task);
+		return;
+	}
+	cpipe_push(&task->reader->reader_pipe, &task->base);
+}
+
+/**
+ * Post asynchronous reads of the pages following @page_no in
+ * the scan direction until the read-ahead window is full.
+ * Adjacent pages are batched in one task, up to
+ * VY_READ_AHEAD_BATCH_MAX pages per task. Read-ahead is
+ * best effort, so errors are ignored.
+ */
+static void
+vy_run_iterator_read_ahead(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	struct vy_run_env *env = itr->run_env;
+	struct vy_slice *slice = itr->slice;
+	struct vy_run *run = slice->run;
+	int dir = iterator_direction(itr->iterator_type);
+
+	/* Continue after the last page queued. */
+	if (!rlist_empty(&itr->read_ahead_queue)) {
+		struct vy_page_read_ahead *last;
+		last = rlist_last_entry(&itr->read_ahead_queue,
+					struct vy_page_read_ahead, in_queue);
+		page_no = last->page_no;
+	}
+	struct vy_page_read_ahead_task *task = NULL;
+	while (itr->read_ahead_queue_len < itr->read_ahead_window) {
+		if (dir > 0 ? page_no >= slice->last_page_no :
+			      page_no <= slice->first_page_no)
+			break;
+		page_no += dir;
+		if (vy_page_cache_contains(&env->page_cache, run, page_no)) {
+			/* Pages of a task must be adjacent. */
+			if (task != NULL)
+				vy_run_iterator_read_ahead_post(task);
+			task = NULL;
+			continue;
+		}
+		if (task == NULL) {
+			task = malloc(sizeof(*task));
+			if (task == NULL)
+				break;
+			/* Pick a reader thread. */
+			struct vy_run_reader *reader;
+			reader = &env->reader_pool[env->next_reader++];
+			env->next_reader %= env->reader_pool_size;
+
+			task->run = run;
+			vy_run_ref(run);
+			task->run_env = env;
+			task->reader = reader;
+			task->page_count = 0;
+			task->route[0].f = vy_page_read_ahead_f;
+			task->route[0].pipe = &reader->tx_pipe;
+			task->route[1].f = vy_page_read_ahead_complete_f;
+			task->route[1].pipe = NULL;
+			cmsg_init(&task->base, task->route);
+		}
+
+		struct vy_page_info *page_info = vy_run_page_info(run, page_no);
+		struct vy_page_read_ahead *ra = malloc(sizeof(*ra));
+		if (ra == NULL)
+			break;
+		ra->page = vy_page_new(page_info);
+		if (ra->page == NULL) {
+			free(ra);
+			break;
+		}
+		ra->page->page_no = page_no;
+		ra->page_no = page_no;
+		ra->page_info = *page_info;
+		ra->rc = 0;
+		ra->done = false;
+		fiber_cond_create(&ra->done_cond);
+		ra->itr = itr;
+		rlist_add_tail_entry(&itr->read_ahead_queue, ra, in_queue);
+		itr->read_ahead_queue_len++;
+
+		task->pages[task->page_count++] = ra;
+		if (task->page_count == VY_READ_AHEAD_BATCH_MAX) {
+			vy_run_iterator_read_ahead_post(task);
+			task = NULL;
+		}
+	}
+	if (task != NULL)
+		vy_run_iterator_read_ahead_post(task);
+}
+
+/**
+ * Look up a page in the read-ahead queue of an iterator and
+ * wait for it to be read. Pages queued before it are dropped,
+ * because the iterator has skipped them. If the page isn't
+ * queued, the whole queue is dropped.
+ *
+ * @retval 0 success, *result is NULL if the page isn't available
+ * @retval -1 the fiber was cancelled while waiting, diag is set
+ */
+static NODISCARD int
+vy_run_iterator_read_ahead_get(struct vy_run_iterator *itr, uint32_t page_no,
+			       struct vy_page **result)
+{
+	*result = NULL;
+	struct vy_page_read_ahead *ra, *skipped, *next;
+	rlist_foreach_entry(ra, &itr->read_ahead_queue, in_queue) {
+		if (ra->page_no == page_no)
+			break;
+	}
+	rlist_foreach_entry_safe(skipped, &itr->read_ahead_queue,
+				 in_queue, next) {
+		if (skipped == ra)
+			break;
+		vy_run_iterator_read_ahead_discard(itr, skipped);
+	}
+	if (rlist_empty(&itr->read_ahead_queue))
+		return 0;
+	assert(ra->page_no == page_no);
+	while (!ra->done) {
+		fiber_cond_wait(&ra->done_cond);
+		if (fiber_is_cancelled()) {
+			diag_set(FiberIsCancelled);
+			return -1;
+		}
+	}
+	if (ra->rc == 0) {
+		*result = ra->page;
+		ra->page = NULL;
+	}
+	vy_run_iterator_read_ahead_discard(itr, ra);
+	return 0;
+}
+
+/**
+ * Detect a sequential scan and read pages ahead if so.
+ * Called every time a page is loaded by an iterator.
+ */
+static void
+vy_run_iterator_read_ahead_update(struct vy_run_iterator *itr,
+				  uint32_t page_no)
+{
+	if (itr->read_ahead == 0 || itr->run_env->reader_pool == NULL)
+		return;
+	int dir = iterator_direction(itr->iterator_type);
+	if (itr->last_page_no != UINT32_MAX &&
+	    (int64_t)page_no == (int64_t)itr->last_page_no + dir) {
+		itr->read_ahead_window = MAX(itr->read_ahead_window * 2, 1);
+		itr->read_ahead_window = MIN(itr->read_ahead_window,
+					     itr->read_ahead);
+		vy_run_iterator_read_ahead(itr, page_no);
+	} else {
+		itr->read_ahead_window = 0;
+	}
+	itr->last_page_no = page_no;
+}
+
 /**
  * Get a page by the given number the cache or load it from the disk.
  *
@@ -971,11 +1617,32 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	if (*result != NULL)
 		return 0;
 
-	/* Allocate buffers */
+	/* Check the page cache shared by all iterators */
+	struct vy_page *page = vy_page_cache_get(&env->page_cache,
+						 slice->run, page_no);
+	if (page != NULL) {
+		vy_page_ref(page);
+		vy_run_iterator_cache_put(itr, page, page_no);
+		vy_run_iterator_read_ahead_update(itr, page_no);
+		*result = page;
+		return 0;
+	}
+
 	struct vy_page_info *page_info = vy_run_page_info(slice->run, page_no);
-	struct vy_page *page = vy_page_new(page_info);
+
+	/* Check pages read ahead */
+	if (vy_run_iterator_read_ahead_get(itr, page_no, &page) != 0)
+		return -1;
+	if (page != NULL) {
+		itr->stat->read_ahead++;
+		goto done;
+	}
+
+	/* Allocate buffers */
+	page = vy_page_new(page_info);
 	if (page == NULL)
 		return -1;
+	page->page_no = page_no;
 
 	/* Read page data from the disk */
 	int rc;
@@ -998,6 +1665,7 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		task->slice = slice;
 		task->page_info = *page_info;
 		task->run_env = env;
+		task->reader = reader;
 		task->page = page;
 
 		/* Post task to the reader thread. */
@@ -1024,17 +1692,19 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 			vy_page_delete(page);
 			return -1;
 		}
-		if (vy_page_read(page, page_info, slice->run->fd, zdctx) != 0) {
+		if (vy_page_read(page, page_info, slice->run->fd,
+				 NULL, false, zdctx) != 0) {
 			vy_page_delete(page);
 			return -1;
 		}
 	}
-
+done:
 	/* Iterator is never used from multiple fibers */
 	assert(vy_run_iterator_cache_get(itr, page_no) == NULL);
 
 	/* Update cache */
 	vy_run_iterator_cache_put(itr, page, page_no);
+	vy_page_cache_put(&env->page_cache, slice->run, page);
 
 	/* Update read statistics. */
 	itr->stat->read.rows += page_info->row_count;
@@ -1042,6 +1712,7 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	itr->stat->read.bytes_compressed += page_info->size;
 	itr->stat->read.pages++;
 
+	vy_run_iterator_read_ahead_update(itr, page_no);
 	*result = page;
 	return 0;
 }
@@ -1304,18 +1975,24 @@ vy_run_iterator_find_lsn(struct vy_run_iterator *itr,
 	return 0;
 }
 
-static NODISCARD int
-vy_run_iterator_do_seek(struct vy_run_iterator *itr,
-			enum iterator_type iterator_type,
-			const struct tuple *key, struct tuple **ret)
+/**
+ * Look up a search key in the run bloom filters.
+ * A full key is checked against the bloom filter of whole keys,
+ * a partial one against the prefix bloom filter of the same
+ * length, if the run has it.
+ *
+ * @retval  1 the run may contain the key
+ * @retval  0 the run definitely doesn't contain the key
+ * @retval -1 there is no bloom filter for the key
+ */
+static int
+vy_run_bloom_check(const struct vy_run_info *info, const struct tuple *key,
+		   const struct key_def *key_def)
 {
-	struct vy_run *run = itr->slice->run;
-
-	*ret = NULL;
-
-	const struct key_def *key_def = itr->key_def;
-	bool is_full_key = (tuple_field_count(key) >= key_def->part_count);
-	if (run->info.has_bloom && iterator_type == ITER_EQ && is_full_key) {
+	uint32_t part_count = tuple_field_count(key);
+	if (part_count >= key_def->part_count) {
+		if (!info->has_bloom)
+			return -1;
 		uint32_t hash;
 		if (vy_stmt_type(key) == IPROTO_SELECT) {
 			const char *data = tuple_data(key);
@@ -1324,7 +2001,37 @@ vy_run_iterator_do_seek(struct vy_run_iterator *itr,
 		} else {
 			hash = tuple_hash(key, key_def);
 		}
-		if (!bloom_possible_has(&run->info.bloom, hash)) {
+		return bloom_possible_has(&info->bloom, hash);
+	}
+	if (part_count == 0 || part_count > info->prefix_bloom_count)
+		return -1;
+	/* Partial keys are only used for lookups. */
+	assert(vy_stmt_type(key) == IPROTO_SELECT);
+	const char *data = tuple_data(key);
+	mp_decode_array(&data);
+	uint32_t hash = key_hash_prefix(data, key_def, part_count);
+	return bloom_possible_has(&info->prefix_bloom[part_count - 1], hash);
+}
+
+static NODISCARD int
+vy_run_iterator_do_seek(struct vy_run_iterator *itr,
+			enum iterator_type iterator_type,
+			const struct tuple *key, struct tuple **ret)
+{
+	struct vy_run *run = itr->slice->run;
+
+	*ret = NULL;
+
+	/*
+	 * REQ is converted to LE, which is also limited to
+	 * keys equal to the search key, so bloom filters work
+	 * for it as well as for EQ.
+	 */
+	int bloom_rc = -1;
+	if (iterator_type == ITER_EQ ||
+	    (itr->is_req && iterator_type == ITER_LE)) {
+		bloom_rc = vy_run_bloom_check(&run->info, key, itr->key_def);
+		if (bloom_rc == 0) {
 			itr->search_ended = true;
 			itr->stat->bloom_hit++;
 			return 0;
@@ -1370,7 +2077,7 @@ vy_run_iterator_do_seek(struct vy_run_iterator *itr,
 	if (iterator_type == ITER_EQ && !equal_found) {
 		vy_run_iterator_cache_clean(itr);
 		itr->search_ended = true;
-		if (run->info.has_bloom && is_full_key)
+		if (bloom_rc > 0)
 			itr->stat->bloom_miss++;
 		return 0;
 	}
@@ -1388,7 +2095,12 @@ vy_run_iterator_do_seek(struct vy_run_iterator *itr,
 		 * given (special branch of code in vy_run_iterator_search),
 		 * so we need to make a step on previous key
 		 */
-		return vy_run_iterator_next_key(itr, ret);
+		rc = vy_run_iterator_next_key(itr, ret);
+		if (rc == 0 && bloom_rc > 0 &&
+		    (*ret == NULL ||
+		     vy_stmt_compare(*ret, key, itr->cmp_def) != 0))
+			itr->stat->bloom_miss++;
+		return rc;
 	} else {
 		assert(iterator_type == ITER_GE || iterator_type == ITER_GT ||
 		       iterator_type == ITER_EQ);
@@ -1480,7 +2192,7 @@ vy_run_iterator_open(struct vy_run_iterator *itr,
 		     const struct key_def *key_def,
 		     struct tuple_format *format,
 		     struct tuple_format *upsert_format,
-		     bool is_primary)
+		     bool is_primary, uint32_t read_ahead)
 {
 	itr->stat = stat;
 	itr->cmp_def = cmp_def;
@@ -1491,6 +2203,16 @@ vy_run_iterator_open(struct vy_run_iterator *itr,
 	itr->run_env = run_env;
 	itr->slice = slice;
 
+	itr->is_req = false;
+	if (iterator_type == ITER_REQ) {
+		/*
+		 * Reverse iteration over equal keys is LE
+		 * stopped by the caller at the first key that
+		 * doesn't match.
+		 */
+		iterator_type = ITER_LE;
+		itr->is_req = true;
+	}
 	itr->iterator_type = iterator_type;
 	itr->key = key;
 	itr->read_view = rv;
@@ -1501,6 +2223,12 @@ vy_run_iterator_open(struct vy_run_iterator *itr,
 	itr->curr_page = NULL;
 	itr->prev_page = NULL;
 
+	itr->read_ahead = read_ahead;
+	itr->read_ahead_window = 0;
+	itr->last_page_no = UINT32_MAX;
+	rlist_create(&itr->read_ahead_queue);
+	itr->read_ahead_queue_len = 0;
+
 	itr->search_started = false;
 	itr->search_ended = false;
 }
@@ -1731,6 +2459,7 @@ vy_run_iterator_skip(struct vy_run_iterator *itr,
 void
 vy_run_iterator_close(struct vy_run_iterator *itr)
 {
+	vy_run_iterator_read_ahead_clean(itr);
 	vy_run_iterator_cache_clean(itr);
 	TRASH(itr);
 }
@@ -1954,6 +2683,125 @@ vy_run_alloc_page_info(struct vy_run *run, uint32_t *page_info_capacity)
 	return 0;
 }
 
+/**
+ * Bloom filters filled while a run is written: one for full
+ * keys and, optionally, one per key prefix.
+ */
+struct vy_bloom_builder {
+	/** Bloom spectrum of full keys. */
+	struct bloom_spectrum bs;
+	/** Number of prefix bloom spectrums. */
+	uint32_t prefix_count;
+	/** Bloom spectrums of key prefixes, shortest first. */
+	struct bloom_spectrum *prefix_bs;
+	/**
+	 * Prefix bloom filters chosen from the spectrums,
+	 * allocated in advance so that choosing can't fail.
+	 */
+	struct bloom *prefix_bloom;
+	/** Prefix hashes of the last added statement. */
+	uint32_t *last_hash;
+	/** Prefix hashes of the statement being added. */
+	uint32_t *hash;
+	/** Set if last_hash is valid. */
+	bool has_last_hash;
+};
+
+static void
+vy_bloom_builder_destroy(struct vy_bloom_builder *builder)
+{
+	bloom_spectrum_destroy(&builder->bs, runtime.quota);
+	for (uint32_t i = 0; i < builder->prefix_count; i++)
+		bloom_spectrum_destroy(&builder->prefix_bs[i], runtime.quota);
+	free(builder->prefix_bs);
+	free(builder->prefix_bloom);
+	free(builder->last_hash);
+}
+
+static int
+vy_bloom_builder_create(struct vy_bloom_builder *builder,
+			uint32_t max_count, double fpr, uint32_t prefix_count)
+{
+	memset(builder, 0, sizeof(*builder));
+	if (bloom_spectrum_create(&builder->bs, max_count,
+				  fpr, runtime.quota) != 0) {
+		diag_set(OutOfMemory, 0,
+			 "bloom_spectrum_create", "bloom_spectrum");
+		return -1;
+	}
+	if (prefix_count == 0)
+		return 0;
+	builder->prefix_bs = calloc(prefix_count, sizeof(struct bloom_spectrum));
+	builder->prefix_bloom = calloc(prefix_count, sizeof(struct bloom));
+	builder->last_hash = calloc(2 * prefix_count, sizeof(uint32_t));
+	if (builder->prefix_bs == NULL || builder->prefix_bloom == NULL ||
+	    builder->last_hash == NULL) {
+		diag_set(OutOfMemory, prefix_count * sizeof(struct bloom_spectrum),
+			 "calloc", "prefix bloom");
+		goto fail;
+	}
+	builder->hash = builder->last_hash + prefix_count;
+	for (uint32_t i = 0; i < prefix_count; i++) {
+		if (bloom_spectrum_create(&builder->prefix_bs[i], max_count,
+					  fpr, runtime.quota) != 0) {
+			diag_set(OutOfMemory, 0,
+				 "bloom_spectrum_create", "bloom_spectrum");
+			goto fail;
+		}
+		builder->prefix_count++;
+	}
+	return 0;
+fail:
+	vy_bloom_builder_destroy(builder);
+	return -1;
+}
+
+static void
+vy_bloom_builder_add(struct vy_bloom_builder *builder,
+		     const struct tuple *stmt, const struct key_def *key_def)
+{
+	bloom_spectrum_add(&builder->bs, tuple_hash(stmt, key_def));
+	if (builder->prefix_count == 0)
+		return;
+	tuple_hash_prefixes(stmt, key_def, builder->prefix_count,
+			    builder->hash);
+	for (uint32_t i = 0; i < builder->prefix_count; i++) {
+		/*
+		 * Statements come sorted, so statements sharing
+		 * a prefix are adjacent. Adding the prefix only
+		 * once keeps the count of values small, so that
+		 * a smaller filter is chosen from the spectrum.
+		 */
+		if (builder->has_last_hash &&
+		    builder->hash[i] == builder->last_hash[i])
+			continue;
+		bloom_spectrum_add(&builder->prefix_bs[i], builder->hash[i]);
+	}
+	uint32_t *tmp = builder->last_hash;
+	builder->last_hash = builder->hash;
+	builder->hash = tmp;
+	builder->has_last_hash = true;
+}
+
+/**
+ * Move the chosen bloom filters to the run info.
+ */
+static void
+vy_bloom_builder_choose(struct vy_bloom_builder *builder,
+			struct vy_run_info *info)
+{
+	bloom_spectrum_choose(&builder->bs, &info->bloom);
+	info->has_bloom = true;
+	if (builder->prefix_count == 0)
+		return;
+	for (uint32_t i = 0; i < builder->prefix_count; i++)
+		bloom_spectrum_choose(&builder->prefix_bs[i],
+				      &builder->prefix_bloom[i]);
+	info->prefix_bloom = builder->prefix_bloom;
+	info->prefix_bloom_count = builder->prefix_count;
+	builder->prefix_bloom = NULL;
+}
+
 /**
  * Write statements from the iterator to a new page in the run,
  * update page and run statistics.
@@ -1965,7 +2813,7 @@ vy_run_alloc_page_info(struct vy_run *run, uint32_t *page_info_capacity)
 static int
 vy_run_write_page(struct vy_run *run, struct xlog *data_xlog,
 		  struct vy_stmt_stream *wi, struct tuple **curr_stmt,
-		  uint64_t page_size, struct bloom_spectrum *bs,
+		  uint64_t page_size, struct vy_bloom_builder *bloom,
 		  const struct key_def *cmp_def,
 		  const struct key_def *key_def, bool is_primary,
 		  uint32_t *page_info_capacity)
@@ -2019,7 +2867,7 @@ vy_run_write_page(struct vy_run *run, struct xlog *data_xlog,
 				     cmp_def, is_primary) != 0)
 			goto error_rollback;
 
-		bloom_spectrum_add(bs, tuple_hash(*curr_stmt, key_def));
+		vy_bloom_builder_add(bloom, *curr_stmt, key_def);
 
 		int64_t lsn = vy_stmt_lsn(*curr_stmt);
 		run->info.min_lsn = MIN(run->info.min_lsn, lsn);
@@ -2113,7 +2961,8 @@ vy_run_write_data(struct vy_run *run, const char *dirpath,
 		  struct vy_stmt_stream *wi, uint64_t page_size,
 		  const struct key_def *cmp_def,
 		  const struct key_def *key_def,
-		  size_t max_output_count, double bloom_fpr)
+		  size_t max_output_count, double bloom_fpr,
+		  bool bloom_prefixes)
 {
 	struct tuple *stmt;
 
@@ -2127,13 +2976,11 @@ vy_run_write_data(struct vy_run *run, const char *dirpath,
 	if (stmt == NULL)
 		goto done;
 
-	struct bloom_spectrum bs;
-	if (bloom_spectrum_create(&bs, max_output_count,
-				  bloom_fpr, runtime.quota) != 0) {
-		diag_set(OutOfMemory, 0,
-			 "bloom_spectrum_create", "bloom_spectrum");
+	struct vy_bloom_builder bloom;
+	if (vy_bloom_builder_create(&bloom, max_output_count, bloom_fpr,
+				    bloom_prefixes ?
+				    key_def->part_count - 1 : 0) != 0)
 		goto err;
-	}
 
 	char path[PATH_MAX];
 	vy_run_snprint_path(path, sizeof(path), dirpath,
@@ -2154,7 +3001,7 @@ vy_run_write_data(struct vy_run *run, const char *dirpath,
 	int rc;
 	do {
 		rc = vy_run_write_page(run, &data_xlog, wi, &stmt,
-				       page_size, &bs, cmp_def, key_def,
+				       page_size, &bloom, cmp_def, key_def,
 				       iid == 0, &page_info_capacity);
 		if (rc < 0)
 			goto err_close_xlog;
@@ -2170,9 +3017,8 @@ vy_run_write_data(struct vy_run *run, const char *dirpath,
 	xlog_close(&data_xlog, true);
 	fiber_gc();
 
-	bloom_spectrum_choose(&bs, &run->info.bloom);
-	run->info.has_bloom = true;
-	bloom_spectrum_destroy(&bs, runtime.quota);
+	vy_bloom_builder_choose(&bloom, &run->info);
+	vy_bloom_builder_destroy(&bloom);
 	done:
 	wi->iface->stop(wi);
 	return 0;
@@ -2181,7 +3027,7 @@ vy_run_write_data(struct vy_run *run, const char *dirpath,
 	xlog_close(&data_xlog, false);
 	fiber_gc();
 	err_free_bloom:
-	bloom_spectrum_destroy(&bs, runtime.quota);
+	vy_bloom_builder_destroy(&bloom);
 	err:
 	wi->iface->stop(wi);
 	return -1;
@@ -2321,7 +3167,10 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	size_t max_key_size = tmp - run_info->max_key;
 
 	assert(run_info->has_bloom);
-	size_t size = mp_sizeof_map(6);
+	uint32_t map_size = 6;
+	if (run_info->prefix_bloom_count > 0)
+		map_size++;
+	size_t size = mp_sizeof_map(map_size);
 	size += mp_sizeof_uint(VY_RUN_INFO_MIN_KEY) + min_key_size;
 	size += mp_sizeof_uint(VY_RUN_INFO_MAX_KEY) + max_key_size;
 	size += mp_sizeof_uint(VY_RUN_INFO_MIN_LSN) +
@@ -2332,6 +3181,13 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 		mp_sizeof_uint(run_info->page_count);
 	size += mp_sizeof_uint(VY_RUN_INFO_BLOOM) +
 		vy_run_bloom_encode_size(&run_info->bloom);
+	if (run_info->prefix_bloom_count > 0) {
+		size += mp_sizeof_uint(VY_RUN_INFO_PREFIX_BLOOM) +
+			mp_sizeof_array(run_info->prefix_bloom_count);
+		for (uint32_t i = 0; i < run_info->prefix_bloom_count; i++)
+			size += vy_run_bloom_encode_size(
+					&run_info->prefix_bloom[i]);
+	}
 
 	char *pos = region_alloc(&fiber()->gc, size);
 	if (pos == NULL) {
@@ -2341,7 +3197,7 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	memset(xrow, 0, sizeof(*xrow));
 	xrow->body->iov_base = pos;
 	/* encode values */
-	pos = mp_encode_map(pos, 6);
+	pos = mp_encode_map(pos, map_size);
 	pos = mp_encode_uint(pos, VY_RUN_INFO_MIN_KEY);
 	memcpy(pos, run_info->min_key, min_key_size);
 	pos += min_key_size;
@@ -2356,6 +3212,13 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	pos = mp_encode_uint(pos, run_info->page_count);
 	pos = mp_encode_uint(pos, VY_RUN_INFO_BLOOM);
 	pos = vy_run_bloom_encode(&run_info->bloom, pos);
+	if (run_info->prefix_bloom_count > 0) {
+		pos = mp_encode_uint(pos, VY_RUN_INFO_PREFIX_BLOOM);
+		pos = mp_encode_array(pos, run_info->prefix_bloom_count);
+		for (uint32_t i = 0; i < run_info->prefix_bloom_count; i++)
+			pos = vy_run_bloom_encode(&run_info->prefix_bloom[i],
+						  pos);
+	}
 	xrow->body->iov_len = (void *)pos - xrow->body->iov_base;
 	xrow->bodycnt = 1;
 	xrow->type = VY_INDEX_RUN_INFO;
@@ -2427,7 +3290,8 @@ vy_run_write(struct vy_run *run, const char *dirpath,
 	     struct vy_stmt_stream *wi, uint64_t page_size,
 	     const struct key_def *cmp_def,
 	     const struct key_def *key_def,
-	     size_t max_output_count, double bloom_fpr)
+	     size_t max_output_count, double bloom_fpr,
+	     bool bloom_prefixes)
 {
 	ERROR_INJECT(ERRINJ_VY_RUN_WRITE,
 		     {diag_set(ClientError, ER_INJECTION,
@@ -2439,7 +3303,8 @@ vy_run_write(struct vy_run *run, const char *dirpath,
 
 	if (vy_run_write_data(run, dirpath, space_id, iid,
 			      wi, page_size, cmp_def, key_def,
-			      max_output_count, bloom_fpr) != 0)
+			      max_output_count, bloom_fpr,
+			      bloom_prefixes) != 0)
 		return -1;
 
 	if (vy_run_is_empty(run))
@@ -2549,6 +3414,33 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 			 "bloom_create", "bloom");
 		goto close_err;
 	}
+	uint32_t prefix_count = opts->bloom_prefixes ?
+				key_def->part_count - 1 : 0;
+	uint32_t *prefix_hash = NULL;
+	if (prefix_count > 0) {
+		size_t size = prefix_count * sizeof(struct bloom);
+		run->info.prefix_bloom = calloc(1, size);
+		if (run->info.prefix_bloom == NULL) {
+			diag_set(OutOfMemory, size, "calloc", "prefix bloom");
+			goto close_err;
+		}
+		for (uint32_t i = 0; i < prefix_count; i++) {
+			if (bloom_create(&run->info.prefix_bloom[i],
+					 run_row_count, opts->bloom_fpr,
+					 runtime.quota) != 0) {
+				diag_set(OutOfMemory, 0,
+					 "bloom_create", "bloom");
+				goto close_err;
+			}
+			run->info.prefix_bloom_count++;
+		}
+		size = prefix_count * sizeof(*prefix_hash);
+		prefix_hash = region_alloc(region, size);
+		if (prefix_hash == NULL) {
+			diag_set(OutOfMemory, size, "region", "prefix hash");
+			goto close_err;
+		}
+	}
 	struct xrow_header xrow;
 	while ((rc = xlog_cursor_next(&cursor, &xrow, false)) == 0) {
 		if (xrow.type == VY_RUN_ROW_INDEX)
@@ -2559,6 +3451,11 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		if (tuple == NULL)
 			goto close_err;
 		bloom_add(&run->info.bloom, tuple_hash(tuple, key_def));
+		if (prefix_count == 0)
+			continue;
+		tuple_hash_prefixes(tuple, key_def, prefix_count, prefix_hash);
+		for (uint32_t i = 0; i < prefix_count; i++)
+			bloom_add(&run->info.prefix_bloom[i], prefix_hash[i]);
 	}
 	run->info.has_bloom = true;
 
@@ -2604,7 +3501,7 @@ vy_slice_stream_read_page(struct vy_slice_stream *stream)
 		return -1;
 
 	if (vy_page_read(stream->page, page_info,
-			 stream->slice->run->fd, zdctx) != 0) {
+			 stream->slice->run->fd, NULL, false, zdctx) != 0) {
 		vy_page_delete(stream->page);
 		stream->page = NULL;
 		return -1;
@@ -51,6 +51,30 @@ extern "C" {
 
 struct vy_run_reader;
 
+/**
+ * Cache of decompressed run pages, shared by all run iterators
+ * of all indexes. Helps hot pages that don't fit in the tuple
+ * cache avoid pread() and decompression on every lookup.
+ * Pages are evicted in the LRU order when the cache size
+ * exceeds the configured limit. Used only in the tx thread.
+ */
+struct vy_page_cache {
+	/** List of cached pages, most recently used first. */
+	struct rlist lru;
+	/** Memory used by cached pages, in bytes. */
+	size_t mem_used;
+	/** Max memory cached pages may use, 0 disables the cache. */
+	size_t mem_quota;
+	/** Number of cached pages. */
+	int64_t page_count;
+	/** Number of lookups that found a page in the cache. */
+	int64_t hit;
+	/** Number of lookups that had to read a page from disk. */
+	int64_t miss;
+	/** Number of pages evicted from the cache. */
+	int64_t evict;
+};
+
 /** Part of vinyl environment for run read/write */
 struct vy_run_env {
 	/** Mempool for struct vy_page_read_task */
@@ -66,6 +90,10 @@ struct vy_run_env {
 	 * processing the next read request.
 	 */
 	int next_reader;
+	/** Shared cache of decompressed pages. */
+	struct vy_page_cache page_cache;
+	/** Set if reader threads use direct I/O. */
+	bool direct_io;
 };
 
 /**
@@ -86,6 +114,17 @@ struct vy_run_info {
 	bool has_bloom;
 	/** Bloom filter of all tuples in run */
 	struct bloom bloom;
+	/**
+	 * Number of prefix bloom filters, either 0 or
+	 * key_def->part_count - 1.
+	 */
+	uint32_t prefix_bloom_count;
+	/**
+	 * Bloom filters of key prefixes: prefix_bloom[i] is
+	 * built over the first i + 1 key parts. Used to skip
+	 * the run on EQ/REQ lookups by a partial key.
+	 */
+	struct bloom *prefix_bloom;
 };
 
 /**
@@ -116,6 +155,13 @@ struct vy_run {
 	struct vy_page_info *page_info;
 	/** Run data file. */
 	int fd;
+	/**
+	 * Run data file opened with O_DIRECT, used by reader
+	 * threads if direct I/O is enabled. Opened on demand by
+	 * a reader thread, -1 if not opened, equals fd if failed
+	 * to open.
+	 */
+	int direct_fd;
 	/** Unique ID of this run. */
 	int64_t id;
 	/** Number of statements in this run. */
@@ -141,6 +187,13 @@ struct vy_run {
 	struct rlist in_unused;
 	/** Link in vy_index::runs list. */
 	struct rlist in_index;
+	/**
+	 * Pages of this run stored in the page cache, indexed
+	 * by page number. Allocated on the first cache insert.
+	 */
+	struct vy_page **cached_pages;
+	/** The page cache the pages above are stored in. */
+	struct vy_page_cache *page_cache;
 };
 
 /**
@@ -234,6 +287,12 @@ struct vy_run_iterator {
 	 * GE, LT to LE for beauty.
 	 */
 	enum iterator_type iterator_type;
+	/**
+	 * Set if the iterator was opened for REQ and so is
+	 * LE limited to the keys equal to the search key,
+	 * which lets it use bloom filters.
+	 */
+	bool is_req;
 	/** Key to search. */
 	const struct tuple *key;
 	/* LSN visibility, iterator shows values with lsn <= vlsn */
@@ -253,6 +312,26 @@ struct vy_run_iterator {
 	/** LRU cache of two active pages (two pages is enough). */
 	struct vy_page *curr_page;
 	struct vy_page *prev_page;
+	/**
+	 * Max number of pages to read ahead when the iterator
+	 * scans the run sequentially, 0 disables read-ahead.
+	 */
+	uint32_t read_ahead;
+	/**
+	 * Current read-ahead window. It is doubled on each
+	 * sequential page load up to read_ahead and reset on
+	 * a random one.
+	 */
+	uint32_t read_ahead_window;
+	/** Number of the last page loaded by the iterator. */
+	uint32_t last_page_no;
+	/**
+	 * Pages being read ahead, in the scan order. Linked by
+	 * vy_page_read_ahead::in_queue.
+	 */
+	struct rlist read_ahead_queue;
+	/** Number of entries in read_ahead_queue. */
+	uint32_t read_ahead_queue_len;
 	/** Is false until first .._get or .._next_.. method is called */
 	bool search_started;
 	/** Search is finished, you will not get more values from iterator */
@@ -273,6 +352,16 @@ struct vy_page {
 	uint32_t *row_index;
 	/** Pointer to the page data. */
 	char *data;
+	/**
+	 * Reference counter. A page may be shared by the page
+	 * cache and run iterators, it is freed when the last
+	 * reference is dropped.
+	 */
+	int refs;
+	/** The run this page belongs to, if cached. */
+	struct vy_run *run;
+	/** Link in vy_page_cache::lru. */
+	struct rlist in_lru;
 };
 
 /**
@@ -293,11 +382,21 @@ vy_run_env_destroy(struct vy_run_env *env);
  * This function starts @threads reader threads and makes
  * the run iterator hand disk reads over to them rather than
  * read run files directly blocking the current fiber.
+ * If @direct_io is set, reader threads bypass the OS page
+ * cache by reading run files opened with O_DIRECT.
  *
  * Subsequent calls to this function will silently return.
  */
 void
-vy_run_env_enable_coio(struct vy_run_env *env, int threads);
+vy_run_env_enable_coio(struct vy_run_env *env, int threads, bool direct_io);
+
+/**
+ * Set the max amount of memory the page cache may use.
+ * Evicts pages if the cache is over the new limit.
+ * Zero disables the cache.
+ */
+void
+vy_run_env_set_page_cache_quota(struct vy_run_env *env, size_t quota);
 
 static inline struct vy_page_info *
 vy_run_page_info(struct vy_run *run, uint32_t pos)
@@ -399,7 +498,8 @@ vy_run_write(struct vy_run *run, const char *dirpath,
 	     struct vy_stmt_stream *wi, uint64_t page_size,
 	     const struct key_def *cmp_def,
 	     const struct key_def *key_def,
-	     size_t max_output_count, double bloom_fpr);
+	     size_t max_output_count, double bloom_fpr,
+	     bool bloom_prefixes);
 
 /**
  * Allocate a new run slice.
@@ -466,6 +566,9 @@ vy_slice_cut(struct vy_slice *slice, int64_t id,
 /**
  * Open an iterator over on-disk run.
  *
+ * If @read_ahead is not 0, the iterator reads up to @read_ahead
+ * pages ahead asynchronously once it detects a sequential scan.
+ *
  * Note, it is the caller's responsibility to make sure the slice
  * is not compacted while the iterator is reading it.
  */
@@ -478,7 +581,7 @@ vy_run_iterator_open(struct vy_run_iterator *itr,
 		     const struct key_def *key_def,
 		     struct tuple_format *format,
 		     struct tuple_format *upsert_format,
-		     bool is_primary);
+		     bool is_primary, uint32_t read_ahead);
 
 /**
  * Advance a run iterator to the newest statement for the next key.
@@ -142,6 +142,7 @@ struct vy_task {
 	 * from another thread.
 	 */
 	double bloom_fpr;
+	bool bloom_prefixes;
 	int64_t page_size;
 };
 
@@ -635,7 +636,7 @@ vy_task_dump_execute(struct vy_task *task)
 			    index->space_id, index->id, task->wi,
 			    task->page_size, index->cmp_def,
 			    index->key_def, task->max_output_count,
-			    task->bloom_fpr);
+			    task->bloom_fpr, task->bloom_prefixes);
 }
 
 static int
@@ -959,6 +960,7 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_index *index,
 	task->wi = wi;
 	task->max_output_count = max_output_count;
 	task->bloom_fpr = index->opts.bloom_fpr;
+	task->bloom_prefixes = index->opts.bloom_prefixes;
 	task->page_size = index->opts.page_size;
 
 	index->is_dumping = true;
@@ -1003,7 +1005,7 @@ vy_task_compact_execute(struct vy_task *task)
 			    index->space_id, index->id, task->wi,
 			    task->page_size, index->cmp_def,
 			    index->key_def, task->max_output_count,
-			    task->bloom_fpr);
+			    task->bloom_fpr, task->bloom_prefixes);
 }
 
 static int
@@ -1189,7 +1191,13 @@ vy_task_compact_new(struct vy_scheduler *scheduler, struct vy_index *index,
 	range = container_of(range_node, struct vy_range, heap_node);
 	assert(range->compact_priority > 1);
 
-	if (vy_index_split_range(index, range) ||
+	/*
+	 * A huge range is split in as many parts as there are
+	 * idle workers (one is reserved for dumps, see vy_schedule())
+	 * so that the parts get compacted in parallel.
+	 */
+	int max_parts = scheduler->workers_available - 1;
+	if (vy_index_split_range(index, range, max_parts) ||
 	    vy_index_coalesce_range(index, range)) {
 		vy_scheduler_update_index(scheduler, index);
 		return 0;
@@ -1238,6 +1246,7 @@ vy_task_compact_new(struct vy_scheduler *scheduler, struct vy_index *index,
 	task->new_run = new_run;
 	task->wi = wi;
 	task->bloom_fpr = index->opts.bloom_fpr;
+	task->bloom_prefixes = index->opts.bloom_prefixes;
 	task->page_size = index->opts.page_size;
 
 	/*
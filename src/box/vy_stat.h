@@ -91,6 +91,11 @@ struct vy_run_iterator_stat {
 	 * of disk reads.
 	 */
 	struct vy_disk_stmt_counter read;
+	/**
+	 * Number of pages read ahead by the iterator and then
+	 * used by it, included in read.pages.
+	 */
+	int64_t read_ahead;
 };
 
 /** TX write set iterator statistics. */
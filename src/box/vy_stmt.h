@@ -65,6 +65,12 @@ static_assert(VY_UPSERT_THRESHOLD <= UINT8_MAX, "n_upserts max value");
 static_assert(VY_UPSERT_INF == VY_UPSERT_THRESHOLD + 1,
 	      "inf must be threshold + 1");
 
+/**
+ * Number of UPSERT statements a read may apply to get a single
+ * key's value before the key is scheduled for squashing.
+ */
+enum { VY_UPSERT_READ_THRESHOLD = 32 };
+
 /** Vinyl statement vtable. */
 extern struct tuple_format_vtab vy_tuple_format_vtab;
 
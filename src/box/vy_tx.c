@@ -106,6 +106,7 @@ tx_manager_new(void)
 	}
 
 	rlist_create(&xm->read_views);
+	rlist_create(&xm->writers);
 	vy_global_read_view_create((struct vy_read_view *)&xm->global_read_view,
 				   INT64_MAX);
 	xm->p_global_read_view = &xm->global_read_view;
@@ -289,6 +290,7 @@ vy_tx_create(struct tx_manager *xm, struct vy_tx *tx)
 	vy_tx_read_set_new(&tx->read_set);
 	tx->psn = 0;
 	rlist_create(&tx->on_destroy);
+	rlist_create(&tx->in_writers);
 }
 
 void
@@ -296,6 +298,7 @@ vy_tx_destroy(struct vy_tx *tx)
 {
 	trigger_run(&tx->on_destroy, NULL);
 	trigger_destroy(&tx->on_destroy);
+	rlist_del_entry(tx, in_writers);
 
 	tx_manager_destroy_read_view(tx->xm, tx->read_view);
 
@@ -324,14 +327,15 @@ vy_tx_is_in_read_view(struct vy_tx *tx)
 }
 
 /**
- * Send to read view all transactions that are reading key @v
- * modified by transaction @tx.
+ * Send to read view all transactions except @tx that are
+ * reading the key of @stmt in @index.
  */
 static int
-vy_tx_send_to_read_view(struct vy_tx *tx, struct txv *v)
+vy_tx_send_to_read_view(struct tx_manager *xm, struct vy_tx *tx,
+			struct vy_index *index, const struct tuple *stmt)
 {
 	struct vy_tx_conflict_iterator it;
-	vy_tx_conflict_iterator_init(&it, &v->index->read_set, v->stmt);
+	vy_tx_conflict_iterator_init(&it, &index->read_set, stmt);
 	struct vy_tx *abort;
 	while ((abort = vy_tx_conflict_iterator_next(&it)) != NULL) {
 		/* Don't abort self. */
@@ -343,7 +347,7 @@ vy_tx_send_to_read_view(struct vy_tx *tx, struct txv *v)
 		/* already in (earlier) read view */
 		if (vy_tx_is_in_read_view(abort))
 			continue;
-		struct vy_read_view *rv = tx_manager_read_view(tx->xm);
+		struct vy_read_view *rv = tx_manager_read_view(xm);
 		if (rv == NULL)
 			return -1;
 		abort->read_view = rv;
@@ -372,6 +376,37 @@ vy_tx_abort_readers(struct vy_tx *tx, struct txv *v)
 	}
 }
 
+int
+tx_manager_abort_writers(struct tx_manager *xm, struct vy_index *index)
+{
+	struct vy_tx *tx;
+	rlist_foreach_entry(tx, &xm->writers, in_writers) {
+		/* Prepared TXs can't be aborted. */
+		if (tx->state != VINYL_TX_READY)
+			continue;
+		if (vy_tx_is_in_read_view(tx))
+			continue;
+		struct txv *v;
+		stailq_foreach_entry(v, &tx->log, next_in_log) {
+			if (v->index != index)
+				continue;
+			struct vy_read_view *rv = tx_manager_read_view(xm);
+			if (rv == NULL)
+				return -1;
+			tx->read_view = rv;
+			break;
+		}
+	}
+	return 0;
+}
+
+int
+tx_manager_abort_readers(struct tx_manager *xm, struct vy_index *index,
+			 const struct tuple *stmt)
+{
+	return vy_tx_send_to_read_view(xm, NULL, index, stmt);
+}
+
 struct vy_tx *
 vy_tx_begin(struct tx_manager *xm)
 {
@@ -499,7 +534,7 @@ vy_tx_prepare(struct vy_tx *tx)
 	struct write_set_iterator it;
 	write_set_ifirst(&tx->write_set, &it);
 	while ((v = write_set_inext(&it)) != NULL) {
-		if (vy_tx_send_to_read_view(tx, v))
+		if (vy_tx_send_to_read_view(xm, tx, v->index, v->stmt))
 			return -1;
 	}
 
@@ -533,6 +568,14 @@ vy_tx_prepare(struct vy_tx *tx)
 		enum iproto_type type = vy_stmt_type(v->stmt);
 		const struct tuple **region_stmt =
 			(type == IPROTO_DELETE) ? &delete : &repsert;
+		/*
+		 * A statement forwarded to an index being built
+		 * has the format of the new space and so can't
+		 * share the lsregion copy with the other indexes.
+		 */
+		if (*region_stmt != NULL &&
+		    (*region_stmt)->format_id != v->stmt->format_id)
+			*region_stmt = NULL;
 		if (vy_tx_write(index, v->mem, v->stmt, region_stmt) != 0)
 			return -1;
 		v->region_stmt = *region_stmt;
@@ -835,6 +878,8 @@ vy_tx_set(struct vy_tx *tx, struct vy_index *index, struct tuple *stmt)
 	write_set_insert(&tx->write_set, v);
 	tx->write_set_version++;
 	tx->write_size += tuple_size(stmt);
+	if (rlist_empty(&tx->in_writers))
+		rlist_add_tail_entry(&tx->xm->writers, tx, in_writers);
 	vy_stmt_counter_acct_tuple(&index->stat.txw.count, stmt);
 	stailq_add_tail_entry(&tx->log, v, next_in_log);
 	return 0;
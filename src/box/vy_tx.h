@@ -173,6 +173,11 @@ struct vy_tx {
 	int64_t psn;
 	/* List of triggers invoked when this transaction ends. */
 	struct rlist on_destroy;
+	/**
+	 * Link in tx_manager::writers. Added on the first
+	 * write, removed when the transaction ends.
+	 */
+	struct rlist in_writers;
 };
 
 /** Transaction manager object. */
@@ -198,6 +203,12 @@ struct tx_manager {
 	 * The list of TXs with a read view in order of vlsn.
 	 */
 	struct rlist read_views;
+	/**
+	 * List of transactions that have written something,
+	 * linked by vy_tx::in_writers. Used to abort writers
+	 * that can't be seen by an index build.
+	 */
+	struct rlist writers;
 	/**
 	 * Global read view - all prepared transactions are
 	 * visible in this view. The global read view
@@ -256,6 +267,25 @@ tx_manager_delete(struct tx_manager *xm);
 int64_t
 tx_manager_vlsn(struct tx_manager *xm);
 
+/**
+ * Send to read view all active transactions that have written
+ * to the given index, so that they fail with a conflict on
+ * commit. Used by a secondary index build, which can't forward
+ * changes made before it started to the new index.
+ */
+int
+tx_manager_abort_writers(struct tx_manager *xm, struct vy_index *index);
+
+/**
+ * Send to read view all active transactions that have read
+ * the key of @stmt from the given index. Used when a statement
+ * is inserted into an index bypassing transactions, e.g. by
+ * a secondary index build.
+ */
+int
+tx_manager_abort_readers(struct tx_manager *xm, struct vy_index *index,
+			 const struct tuple *stmt);
+
 /** Initialize a tx object. */
 void
 vy_tx_create(struct tx_manager *xm, struct vy_tx *tx);
@@ -41,6 +41,11 @@
 #include "cbus.h"
 #include "coio_task.h"
 #include "replication.h"
+#include "histogram.h"
+#include "info.h"
+#include "xstream.h"
+#include "tt_pthread.h"
+#include "scoped_guard.h"
 
 
 const char *wal_mode_STRS[] = { "none", "write", "fsync", NULL };
@@ -63,6 +68,52 @@ struct wal_thread {
 	struct cpipe tx_pipe;
 };
 
+/**
+ * Header of a row stored in the WAL ring.
+ */
+struct wal_ring_record {
+	/** Size of the encoded row following the header. */
+	uint32_t size;
+	/** Replica id of the row. */
+	uint32_t replica_id;
+	/** LSN of the row. */
+	int64_t lsn;
+};
+
+/**
+ * In-memory ring of rows recently written to the WAL.
+ *
+ * Replication relays read new rows from here rather than
+ * from xlog files, as long as they keep up with the WAL.
+ * Rows are appended by the WAL thread, the oldest rows are
+ * evicted when the ring is full. A row is stored as
+ * struct wal_ring_record followed by the row encoded the same
+ * way it is written to xlog; it may wrap around the end of
+ * the buffer.
+ *
+ * Offsets of rows grow monotonically and are mapped to the
+ * buffer modulo its size, so that a reader can tell if its
+ * position has been overwritten.
+ */
+struct wal_ring {
+	/** Protects the ring from concurrent readers. */
+	pthread_mutex_t mutex;
+	/** The buffer, NULL if the ring is disabled. */
+	char *buf;
+	/** Size of the buffer. */
+	uint64_t size;
+	/** Offset of the oldest row in the ring. */
+	uint64_t begin;
+	/** Offset following the newest row in the ring. */
+	uint64_t end;
+	/**
+	 * WAL vclock preceding the oldest row in the ring:
+	 * a reader at this vclock or ahead of it may read
+	 * the ring from the beginning.
+	 */
+	struct vclock vclock;
+};
+
 /*
  * WAL writer - maintain a Write Ahead Log for every change
  * in the data state.
@@ -89,6 +140,42 @@ struct wal_writer
 	int64_t wal_max_size;
 	/** Another one - wal_mode */
 	enum wal_mode wal_mode;
+	/** wal_compress_level, see xlog::compress_level. */
+	int wal_compress_level;
+	/** wal_compress_threshold, see xlog::compress_threshold. */
+	int64_t wal_compress_threshold;
+	/**
+	 * wal_group_commit_window: how long, in seconds, a write
+	 * may wait for other writes to share its fsync() with.
+	 * Zero disables group commit.
+	 */
+	double group_commit_window;
+	/**
+	 * wal_group_commit_max_size: the group is synced
+	 * as soon as this many bytes are written.
+	 */
+	int64_t group_commit_max_size;
+	/**
+	 * Write batches written to the current WAL but not
+	 * synced yet. They are returned to tx after fsync().
+	 */
+	struct stailq group;
+	/** Number of batches in the group. */
+	int group_len;
+	/** Number of bytes written by the group. */
+	int64_t group_size;
+	/** Number of rows written by the group. */
+	int64_t group_rows;
+	/** Syncs the group when the window expires. */
+	struct ev_timer group_timer;
+	/** Number of batches written, for box.stat.wal(). */
+	int64_t write_count;
+	/** Number of fsync() calls made by group commit. */
+	int64_t fsync_count;
+	/** Number of rows per written batch. */
+	struct histogram *write_rows_hist;
+	/** Number of batches per fsync() call. */
+	struct histogram *fsync_writes_hist;
 	/** wal_dir, from the configuration file. */
 	struct xdir wal_dir;
 	/**
@@ -117,6 +204,8 @@ struct wal_writer
 	 * Used for replication relays.
 	 */
 	struct rlist watchers;
+	/** Rows recently written to the WAL, for relays. */
+	struct wal_ring ring;
 };
 
 struct wal_msg: public cmsg {
@@ -153,8 +242,16 @@ wal_write_to_disk(struct cmsg *msg);
 static void
 tx_schedule_commit(struct cmsg *msg);
 
+static void
+wal_group_commit(struct wal_writer *writer);
+
+/*
+ * The first hop has no pipe: a batch is returned to tx
+ * by wal_group_commit(), possibly after a few more batches
+ * are written, see wal_write_to_disk().
+ */
 static struct cmsg_hop wal_request_route[] = {
-	{wal_write_to_disk, &wal_thread.tx_pipe},
+	{wal_write_to_disk, NULL},
 	{tx_schedule_commit, NULL},
 };
 
@@ -254,6 +351,219 @@ tx_schedule_rollback(struct cmsg *msg)
 	stailq_create(&writer->rollback);
 }
 
+/** Copy @a size bytes to the ring at offset @a pos. */
+static void
+wal_ring_copy_in(struct wal_ring *ring, uint64_t pos,
+		 const void *src, size_t size)
+{
+	size_t offset = pos % ring->size;
+	size_t n = MIN(size, ring->size - offset);
+	memcpy(ring->buf + offset, src, n);
+	memcpy(ring->buf, (const char *)src + n, size - n);
+}
+
+/** Copy @a size bytes from the ring at offset @a pos. */
+static void
+wal_ring_copy_out(struct wal_ring *ring, uint64_t pos,
+		  void *dst, size_t size)
+{
+	size_t offset = pos % ring->size;
+	size_t n = MIN(size, ring->size - offset);
+	memcpy(dst, ring->buf + offset, n);
+	memcpy((char *)dst + n, ring->buf, size - n);
+}
+
+static int
+wal_ring_create(struct wal_ring *ring, int64_t size,
+		const struct vclock *vclock)
+{
+	ring->buf = NULL;
+	ring->size = 0;
+	if (size > 0) {
+		ring->buf = (char *)malloc(size);
+		if (ring->buf == NULL) {
+			diag_set(OutOfMemory, size, "malloc", "WAL ring");
+			return -1;
+		}
+		ring->size = size;
+	}
+	ring->begin = ring->end = 0;
+	vclock_copy(&ring->vclock, vclock);
+	tt_pthread_mutex_init(&ring->mutex, NULL);
+	return 0;
+}
+
+static void
+wal_ring_destroy(struct wal_ring *ring)
+{
+	tt_pthread_mutex_destroy(&ring->mutex);
+	free(ring->buf);
+}
+
+/** Evict the oldest row from the ring. */
+static void
+wal_ring_evict(struct wal_ring *ring)
+{
+	assert(ring->begin < ring->end);
+	struct wal_ring_record record;
+	wal_ring_copy_out(ring, ring->begin, &record, sizeof(record));
+	vclock_follow(&ring->vclock, record.replica_id, record.lsn);
+	ring->begin += sizeof(record) + record.size;
+}
+
+/**
+ * Append a written row to the ring. If the row can't be stored,
+ * the ring is emptied so that all positioned readers fall back
+ * on xlog files.
+ */
+static void
+wal_ring_append(struct wal_ring *ring, struct xrow_header *row)
+{
+	struct iovec iov[XROW_IOVMAX];
+	int iovcnt = xrow_header_encode(row, 0, iov, 0);
+	struct wal_ring_record record;
+	record.size = 0;
+	record.replica_id = row->replica_id;
+	record.lsn = row->lsn;
+	for (int i = 0; i < iovcnt; i++)
+		record.size += iov[i].iov_len;
+	uint64_t size = sizeof(record) + record.size;
+	if (iovcnt < 0 || size > ring->size) {
+		if (iovcnt < 0) {
+			diag_log();
+			diag_clear(diag_get());
+		}
+		while (ring->begin < ring->end)
+			wal_ring_evict(ring);
+		vclock_follow(&ring->vclock, record.replica_id, record.lsn);
+		/*
+		 * Move the empty ring past the offsets of readers
+		 * that haven't seen the row.
+		 */
+		ring->begin = ++ring->end;
+		return;
+	}
+	while (ring->end + size - ring->begin > ring->size)
+		wal_ring_evict(ring);
+	uint64_t pos = ring->end;
+	wal_ring_copy_in(ring, pos, &record, sizeof(record));
+	pos += sizeof(record);
+	for (int i = 0; i < iovcnt; i++) {
+		wal_ring_copy_in(ring, pos, iov[i].iov_base, iov[i].iov_len);
+		pos += iov[i].iov_len;
+	}
+	ring->end = pos;
+}
+
+/** Append rows of a group of written batches to the ring. */
+static void
+wal_ring_append_group(struct wal_ring *ring, struct stailq *group)
+{
+	if (ring->buf == NULL)
+		return;
+	struct region *region = &fiber()->gc;
+	size_t used = region_used(region);
+	tt_pthread_mutex_lock(&ring->mutex);
+	struct cmsg *msg;
+	stailq_foreach_entry(msg, group, fifo) {
+		struct wal_msg *batch = (struct wal_msg *) msg;
+		struct journal_entry *entry;
+		stailq_foreach_entry(entry, &batch->commit, fifo) {
+			for (int i = 0; i < entry->n_rows; i++)
+				wal_ring_append(ring, entry->rows[i]);
+		}
+	}
+	tt_pthread_mutex_unlock(&ring->mutex);
+	region_truncate(region, used);
+}
+
+/**
+ * Max amount of data a reader copies out of the ring at once,
+ * unless a single row is bigger.
+ */
+enum { WAL_RING_READ_MAX = 256 * 1024 };
+
+int
+wal_ring_read(struct wal_ring_cursor *cursor, struct vclock *vclock,
+	      struct xstream *stream)
+{
+	struct wal_ring *ring = &wal_writer_singleton.ring;
+	if (ring->buf == NULL)
+		return -1;
+	char *buf = NULL;
+	size_t buf_size = 0;
+	auto guard = make_scoped_guard([&]{ free(buf); });
+	while (true) {
+		tt_pthread_mutex_lock(&ring->mutex);
+		if (!cursor->is_positioned) {
+			int cmp = vclock_compare(&ring->vclock, vclock);
+			if (cmp == 0 || cmp == -1) {
+				cursor->is_positioned = true;
+				cursor->pos = ring->begin;
+			}
+		}
+		if (!cursor->is_positioned || cursor->pos < ring->begin) {
+			tt_pthread_mutex_unlock(&ring->mutex);
+			wal_ring_cursor_create(cursor);
+			return -1;
+		}
+		/* Find out how many whole rows to copy. */
+		uint64_t end = cursor->pos;
+		while (end < ring->end &&
+		       (end == cursor->pos ||
+			end - cursor->pos < WAL_RING_READ_MAX)) {
+			struct wal_ring_record record;
+			wal_ring_copy_out(ring, end, &record, sizeof(record));
+			end += sizeof(record) + record.size;
+		}
+		size_t size = end - cursor->pos;
+		if (size > buf_size) {
+			char *new_buf = (char *)realloc(buf, size);
+			if (new_buf == NULL) {
+				tt_pthread_mutex_unlock(&ring->mutex);
+				tnt_raise(OutOfMemory, size, "realloc",
+					  "WAL ring read buffer");
+			}
+			buf = new_buf;
+			buf_size = size;
+		}
+		wal_ring_copy_out(ring, cursor->pos, buf, size);
+		tt_pthread_mutex_unlock(&ring->mutex);
+		if (size == 0)
+			return 0;
+		/* Send the rows without holding the lock. */
+		const char *pos = buf;
+		const char *buf_end = buf + size;
+		while (pos < buf_end) {
+			struct wal_ring_record record;
+			memcpy(&record, pos, sizeof(record));
+			pos += sizeof(record);
+			const char *row_end = pos + record.size;
+			cursor->pos += sizeof(record) + record.size;
+			if (record.lsn <= vclock_get(vclock, record.replica_id)) {
+				/* Already sent, skip. */
+				pos = row_end;
+				continue;
+			}
+			struct xrow_header row;
+			xrow_header_decode_xc(&row, &pos, row_end);
+			assert(pos == row_end);
+			vclock_follow(vclock, row.replica_id, row.lsn);
+			xstream_write_xc(stream, &row);
+		}
+	}
+}
+
+static inline bool
+wal_group_commit_is_enabled(struct wal_writer *writer)
+{
+	return writer->wal_mode == WAL_FSYNC &&
+	       writer->group_commit_window > 0;
+}
+
+static void
+wal_group_commit_timer_cb(ev_loop *loop, ev_timer *timer, int events);
+
 /**
  * Initialize WAL writer context. Even though it's a singleton,
  * encapsulate the details just in case we may use
@@ -263,19 +573,66 @@ static void
 wal_writer_create(struct wal_writer *writer, enum wal_mode wal_mode,
 		  const char *wal_dirname, const struct tt_uuid *instance_uuid,
 		  struct vclock *vclock, int64_t wal_max_rows,
-		  int64_t wal_max_size)
+		  int64_t wal_max_size, int wal_compress_level,
+		  int64_t wal_compress_threshold,
+		  double wal_group_commit_window,
+		  int64_t wal_group_commit_max_size, int64_t wal_ring_size)
 {
+	static int64_t write_rows_buckets[] = {
+		1, 2, 3, 4, 5, 10, 20, 50, 100, 200, 500,
+		1000, 2000, 5000, 10000,
+	};
+	static int64_t fsync_writes_buckets[] = {
+		1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 15, 20, 25, 50, 100,
+	};
+	writer->write_rows_hist = histogram_new(write_rows_buckets,
+					lengthof(write_rows_buckets));
+	if (writer->write_rows_hist == NULL)
+		tnt_raise(OutOfMemory, 0, "histogram_new",
+			  "WAL write histogram");
+	writer->fsync_writes_hist = histogram_new(fsync_writes_buckets,
+					lengthof(fsync_writes_buckets));
+	if (writer->fsync_writes_hist == NULL) {
+		histogram_delete(writer->write_rows_hist);
+		tnt_raise(OutOfMemory, 0, "histogram_new",
+			  "WAL fsync histogram");
+	}
+	/* There are no rows to keep if nothing is written. */
+	if (wal_ring_create(&writer->ring, wal_mode == WAL_NONE ? 0 :
+			    wal_ring_size, vclock) != 0) {
+		histogram_delete(writer->write_rows_hist);
+		histogram_delete(writer->fsync_writes_hist);
+		diag_raise();
+	}
+	writer->write_count = 0;
+	writer->fsync_count = 0;
+
 	writer->wal_mode = wal_mode;
 	writer->wal_max_rows = wal_max_rows;
 	writer->wal_max_size = wal_max_size;
+	writer->wal_compress_level = wal_compress_level;
+	writer->wal_compress_threshold = wal_compress_threshold;
+	writer->group_commit_window = wal_group_commit_window;
+	writer->group_commit_max_size = wal_group_commit_max_size;
 	journal_create(&writer->base, wal_mode == WAL_NONE ?
 		       wal_write_in_wal_mode_none : wal_write, NULL);
 
 	xdir_create(&writer->wal_dir, wal_dirname, XLOG, instance_uuid);
 	xlog_clear(&writer->current_wal);
-	if (wal_mode == WAL_FSYNC)
+	/*
+	 * With group commit, the WAL is synced explicitly
+	 * once per group rather than on each write.
+	 */
+	if (wal_mode == WAL_FSYNC && !wal_group_commit_is_enabled(writer))
 		writer->wal_dir.open_wflags |= O_SYNC;
 
+	stailq_create(&writer->group);
+	writer->group_len = 0;
+	writer->group_size = 0;
+	writer->group_rows = 0;
+	ev_timer_init(&writer->group_timer, wal_group_commit_timer_cb,
+		      0, 0);
+
 	stailq_create(&writer->rollback);
 	cmsg_init(&writer->in_rollback, NULL);
 
@@ -291,6 +648,9 @@ static void
 wal_writer_destroy(struct wal_writer *writer)
 {
 	xdir_destroy(&writer->wal_dir);
+	wal_ring_destroy(&writer->ring);
+	histogram_delete(writer->write_rows_hist);
+	histogram_delete(writer->fsync_writes_hist);
 }
 
 /** WAL thread routine. */
@@ -319,14 +679,20 @@ wal_thread_start()
 void
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
 	 const struct tt_uuid *instance_uuid, struct vclock *vclock,
-	 int64_t wal_max_rows, int64_t wal_max_size)
+	 int64_t wal_max_rows, int64_t wal_max_size,
+	 int wal_compress_level, int64_t wal_compress_threshold,
+	 double wal_group_commit_window, int64_t wal_group_commit_max_size,
+	 int64_t wal_ring_size)
 {
 	assert(wal_max_rows > 1);
 
 	struct wal_writer *writer = &wal_writer_singleton;
 
 	wal_writer_create(writer, wal_mode, wal_dirname, instance_uuid,
-			  vclock, wal_max_rows, wal_max_size);
+			  vclock, wal_max_rows, wal_max_size,
+			  wal_compress_level, wal_compress_threshold,
+			  wal_group_commit_window, wal_group_commit_max_size,
+			  wal_ring_size);
 
 	xdir_scan_xc(&writer->wal_dir);
 
@@ -369,6 +735,11 @@ wal_checkpoint_f(struct cmsg *data)
 		msg->res = -1;
 		return;
 	}
+	/*
+	 * Make sure all rows covered by the returned vclock
+	 * are synced and committed in tx before the checkpoint.
+	 */
+	wal_group_commit(writer);
 	/*
 	 * Avoid closing the current WAL if it has no rows (empty).
 	 */
@@ -458,6 +829,53 @@ wal_collect_garbage(int64_t lsn)
 	fiber_set_cancellable(cancellable);
 }
 
+struct wal_stat_msg: public cbus_call_msg
+{
+	int64_t write_count;
+	int64_t fsync_count;
+	char write_rows_hist[1024];
+	char fsync_writes_hist[1024];
+};
+
+static int
+wal_stat_f(struct cbus_call_msg *data)
+{
+	struct wal_stat_msg *msg = (struct wal_stat_msg *) data;
+	struct wal_writer *writer = &wal_writer_singleton;
+	msg->write_count = writer->write_count;
+	msg->fsync_count = writer->fsync_count;
+	histogram_snprint(msg->write_rows_hist, sizeof(msg->write_rows_hist),
+			  writer->write_rows_hist);
+	histogram_snprint(msg->fsync_writes_hist,
+			  sizeof(msg->fsync_writes_hist),
+			  writer->fsync_writes_hist);
+	return 0;
+}
+
+void
+wal_stat(struct info_handler *h)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	struct wal_stat_msg msg;
+	msg.write_count = 0;
+	msg.fsync_count = 0;
+	msg.write_rows_hist[0] = '\0';
+	msg.fsync_writes_hist[0] = '\0';
+	if (journal_is_initialized(&writer->base) &&
+	    writer->wal_mode != WAL_NONE) {
+		bool cancellable = fiber_set_cancellable(false);
+		cbus_call(&wal_thread.wal_pipe, &wal_thread.tx_pipe, &msg,
+			  wal_stat_f, NULL, TIMEOUT_INFINITY);
+		fiber_set_cancellable(cancellable);
+	}
+	info_begin(h);
+	info_append_int(h, "writes", msg.write_count);
+	info_append_int(h, "fsyncs", msg.fsync_count);
+	info_append_str(h, "rows_per_write", msg.write_rows_hist);
+	info_append_str(h, "writes_per_fsync", msg.fsync_writes_hist);
+	info_end(h);
+}
+
 static void
 wal_notify_watchers(struct wal_writer *writer, unsigned events);
 
@@ -485,6 +903,8 @@ wal_opt_rotate(struct wal_writer *writer)
 	if (xlog_is_open(&writer->current_wal) &&
 	    (writer->current_wal.rows >= writer->wal_max_rows ||
 	     writer->current_wal.offset >= writer->wal_max_size)) {
+		/* The group must be synced to the file it's in. */
+		wal_group_commit(writer);
 		/*
 		 * We can not handle xlog_close()
 		 * failure in any reasonable way.
@@ -511,6 +931,19 @@ wal_opt_rotate(struct wal_writer *writer)
 		free(vclock);
 		return -1;
 	}
+	/*
+	 * Compress big batches in the background, so that
+	 * the WAL thread only has to write them out.
+	 */
+	writer->current_wal.compress_level = writer->wal_compress_level;
+	writer->current_wal.compress_threshold =
+		writer->wal_compress_threshold;
+	if (xlog_set_compress_async(&writer->current_wal) != 0) {
+		diag_log();
+		xlog_close(&writer->current_wal, false);
+		free(vclock);
+		return -1;
+	}
 	xdir_add_vclock(&writer->wal_dir, vclock);
 
 	wal_notify_watchers(writer, WAL_EVENT_ROTATE);
@@ -581,12 +1014,13 @@ wal_assign_lsn(struct wal_writer *writer, struct xrow_header **row,
 	}
 }
 
+/**
+ * Write a batch of requests to the current WAL. Requests that
+ * failed to be written are moved to the batch rollback list.
+ */
 static void
-wal_write_to_disk(struct cmsg *msg)
+wal_write_batch(struct wal_writer *writer, struct wal_msg *wal_msg)
 {
-	struct wal_writer *writer = &wal_writer_singleton;
-	struct wal_msg *wal_msg = (struct wal_msg *) msg;
-
 	struct errinj *inj = errinj(ERRINJ_WAL_DELAY, ERRINJ_BOOL);
 	while (inj != NULL && inj->bparam)
 		usleep(10);
@@ -625,6 +1059,8 @@ wal_write_to_disk(struct cmsg *msg)
 	 */
 
 	struct xlog *l = &writer->current_wal;
+	off_t old_offset = l->offset;
+	int64_t old_rows = l->rows;
 
 	/*
 	 * Iterate over requests (transactions)
@@ -676,10 +1112,118 @@ done:
 			      &wal_msg->rollback);
 		wal_writer_begin_rollback(writer);
 	}
+	writer->group_size += l->offset - old_offset;
+	writer->group_rows += l->rows - old_rows;
+	writer->write_count++;
+	histogram_collect(writer->write_rows_hist, l->rows - old_rows);
 	fiber_gc();
+}
+
+/**
+ * Roll back a group of batches that failed to sync: drop
+ * their rows from the WAL and return all their requests
+ * to tx for rollback.
+ */
+static void
+wal_group_rollback(struct wal_writer *writer)
+{
+	struct xlog *l = &writer->current_wal;
+	xlog_truncate(l, l->offset - writer->group_size,
+		      l->rows - writer->group_rows);
+	struct cmsg *msg;
+	stailq_foreach_entry(msg, &writer->group, fifo) {
+		struct wal_msg *batch = (struct wal_msg *) msg;
+		struct journal_entry *entry;
+		stailq_foreach_entry(entry, &batch->commit, fifo)
+			entry->res = -1;
+		/* Preserve the request order: commit list goes first. */
+		stailq_concat(&batch->commit, &batch->rollback);
+		stailq_concat(&batch->rollback, &batch->commit);
+	}
+	if (writer->in_rollback.route == NULL)
+		wal_writer_begin_rollback(writer);
+}
+
+/**
+ * Sync the batches written since the last group commit,
+ * if necessary, and return them to tx.
+ */
+static void
+wal_group_commit(struct wal_writer *writer)
+{
+	ev_timer_stop(loop(), &writer->group_timer);
+	if (stailq_empty(&writer->group))
+		return;
+	if (wal_group_commit_is_enabled(writer) && writer->group_size > 0) {
+		writer->fsync_count++;
+		histogram_collect(writer->fsync_writes_hist,
+				  writer->group_len);
+		int rc = xlog_sync(&writer->current_wal);
+		ERROR_INJECT(ERRINJ_WAL_SYNC, rc = -1);
+		if (rc != 0)
+			wal_group_rollback(writer);
+	}
+	/*
+	 * Make the rows available to relays before notifying
+	 * them, see wal_ring_read().
+	 */
+	wal_ring_append_group(&writer->ring, &writer->group);
+	struct cmsg *msg, *next;
+	stailq_foreach_entry_safe(msg, next, &writer->group, fifo) {
+		/*
+		 * The first hop of wal_request_route has no pipe,
+		 * so advance the message to tx manually.
+		 */
+		msg->hop++;
+		cpipe_push(&wal_thread.tx_pipe, msg);
+	}
+	stailq_create(&writer->group);
+	writer->group_len = 0;
+	writer->group_size = 0;
+	writer->group_rows = 0;
 	wal_notify_watchers(writer, WAL_EVENT_WRITE);
 }
 
+static void
+wal_group_commit_timer_cb(ev_loop *loop, ev_timer *timer, int events)
+{
+	(void) loop;
+	(void) timer;
+	(void) events;
+	wal_group_commit(&wal_writer_singleton);
+}
+
+static void
+wal_write_to_disk(struct cmsg *msg)
+{
+	struct wal_writer *writer = &wal_writer_singleton;
+	struct wal_msg *wal_msg = (struct wal_msg *) msg;
+
+	wal_write_batch(writer, wal_msg);
+
+	stailq_add_tail_entry(&writer->group, msg, fifo);
+	writer->group_len++;
+	/*
+	 * Without group commit, the batch is returned to tx
+	 * right away. Otherwise it waits for more batches to
+	 * share fsync() with, until the group commit window
+	 * expires or the group grows big enough. A failed
+	 * batch is returned immediately, to stop the writes
+	 * that depend on it as soon as possible.
+	 */
+	if (!wal_group_commit_is_enabled(writer) ||
+	    !stailq_empty(&wal_msg->rollback) ||
+	    writer->group_size >= writer->group_commit_max_size) {
+		wal_group_commit(writer);
+		return;
+	}
+	if (!ev_is_active(&writer->group_timer)) {
+		ev_timer_set(&writer->group_timer,
+			     writer->group_commit_window, 0);
+		ev_timer_start(loop(), &writer->group_timer);
+	}
+}
+
 /** WAL thread main loop.  */
 static int
 wal_thread_f(va_list ap)
@@ -702,12 +1246,16 @@ wal_thread_f(va_list ap)
 
 	struct wal_writer *writer = &wal_writer_singleton;
 
+	wal_group_commit(writer);
 	if (xlog_is_open(&writer->current_wal))
 		xlog_close(&writer->current_wal, false);
 
 	if (xlog_is_open(&vy_log_writer.xlog))
 		xlog_close(&vy_log_writer.xlog, false);
 
+	/* WAL files are compressed in the background. */
+	xlog_compress_thread_stop();
+
 	cpipe_destroy(&wal_thread.tx_pipe);
 	return 0;
 }
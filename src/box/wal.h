@@ -39,6 +39,8 @@
 struct fiber;
 struct vclock;
 struct wal_writer;
+struct info_handler;
+struct xstream;
 
 enum wal_mode { WAL_NONE = 0, WAL_WRITE, WAL_FSYNC, WAL_MODE_MAX };
 
@@ -55,7 +57,10 @@ wal_thread_start();
 void
 wal_init(enum wal_mode wal_mode, const char *wal_dirname,
 	 const struct tt_uuid *instance_uuid, struct vclock *vclock,
-	 int64_t wal_max_rows, int64_t wal_max_size);
+	 int64_t wal_max_rows, int64_t wal_max_size,
+	 int wal_compress_level, int64_t wal_compress_threshold,
+	 double wal_group_commit_window, int64_t wal_group_commit_max_size,
+	 int64_t wal_ring_size);
 
 void
 wal_thread_stop();
@@ -135,6 +140,48 @@ void
 wal_clear_watcher(struct wal_watcher *watcher,
 		  void (*process_cb)(struct cbus_endpoint *));
 
+/**
+ * Position of a reader in the WAL ring, see wal_ring_read().
+ */
+struct wal_ring_cursor {
+	/** Set if the cursor points to a row in the ring. */
+	bool is_positioned;
+	/** Offset of the next row to read. */
+	uint64_t pos;
+};
+
+static inline void
+wal_ring_cursor_create(struct wal_ring_cursor *cursor)
+{
+	cursor->is_positioned = false;
+	cursor->pos = 0;
+}
+
+/**
+ * Read rows written to the WAL from the in-memory ring of
+ * recently written rows, bypassing xlog files.
+ *
+ * The WAL thread appends rows to the ring once they are
+ * written and before watchers are notified, so a reader may
+ * call this function from a WAL watcher callback.
+ *
+ * Rows not covered by @a vclock are passed to @a stream,
+ * @a vclock is promoted accordingly. An unpositioned cursor
+ * is positioned at the beginning of the ring provided that
+ * the ring has all rows following @a vclock.
+ *
+ * @retval  0 the reader is up to date with the WAL.
+ * @retval -1 the ring is disabled or the rows the reader
+ *            needs have been evicted from the ring, the
+ *            reader must read xlog files. The cursor is
+ *            reset in this case.
+ *
+ * Throws an exception if @a stream fails.
+ */
+int
+wal_ring_read(struct wal_ring_cursor *cursor, struct vclock *vclock,
+	      struct xstream *stream);
+
 void
 wal_atfork();
 
@@ -154,6 +201,15 @@ wal_mode();
 int
 wal_checkpoint(struct vclock *vclock, bool rotate);
 
+/**
+ * Report WAL writer statistics, see box.stat.wal():
+ * the number of write batches and fsync() calls made
+ * by group commit, and histograms of rows per write and
+ * writes per fsync().
+ */
+void
+wal_stat(struct info_handler *h);
+
 /**
  * Remove WAL files that are not needed to recover
  * from snapshot with @lsn or newer.
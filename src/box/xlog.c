@@ -34,6 +34,7 @@
 #include <ctype.h>
 
 #include "fiber.h"
+#include "tt_pthread.h"
 #include "exception.h"
 #include "crc32.h"
 #include "fio.h"
@@ -73,10 +74,12 @@ enum {
 	 * Compress output buffer before dumping it to
 	 * disk if it is at least this big. On smaller
 	 * sizes compression takes up CPU but doesn't
-	 * yield seizable gains.
-	 * Maybe this should be a configuration option.
+	 * yield seizable gains. The default for
+	 * xlog::compress_threshold.
 	 */
 	XLOG_TX_COMPRESS_THRESHOLD = 2 * 1024,
+	/** The default for xlog::compress_level. */
+	XLOG_TX_COMPRESS_LEVEL = 3,
 };
 
 /* {{{ struct xlog_meta */
@@ -94,6 +97,7 @@ enum {
 #define INSTANCE_UUID_KEY_V12 "Server"
 #define VCLOCK_KEY "VClock"
 #define VERSION_KEY "Version"
+#define SEGMENTS_KEY "Segments"
 
 static const char v13[] = "0.13";
 static const char v12[] = "0.12";
@@ -117,13 +121,20 @@ xlog_meta_format(const struct xlog_meta *meta, char *buf, int size)
 	if (vstr == NULL)
 		return -1;
 	char *instance_uuid = tt_uuid_str(&meta->instance_uuid);
+	char segments[32] = "";
+	if (meta->segment_count > 0) {
+		snprintf(segments, sizeof(segments), SEGMENTS_KEY ": %u\n",
+			 (unsigned)meta->segment_count);
+	}
 	int total = snprintf(buf, size,
 		"%s\n"
 		"%s\n"
 		VERSION_KEY ": %s\n"
 		INSTANCE_UUID_KEY ": %s\n"
-		VCLOCK_KEY ": %s\n\n",
-		meta->filetype, v13, PACKAGE_VERSION, instance_uuid, vstr);
+		VCLOCK_KEY ": %s\n"
+		"%s\n",
+		meta->filetype, v13, PACKAGE_VERSION, instance_uuid, vstr,
+		segments);
 	assert(total > 0);
 	free(vstr);
 	return total;
@@ -239,6 +250,17 @@ xlog_meta_parse(struct xlog_meta *meta, const char **data,
 					  "offset %zd", off);
 				return -1;
 			}
+		} else if (memcmp(key, SEGMENTS_KEY, key_end - key) == 0) {
+			/*
+			 * Segments: <count>
+			 */
+			char *count_end;
+			unsigned long count = strtoul(val, &count_end, 10);
+			if (count_end != val_end || count > UINT32_MAX) {
+				diag_set(XlogError, "can't parse segment count");
+				return -1;
+			}
+			meta->segment_count = count;
 		} else if (memcmp(key, VERSION_KEY, key_end - key) == 0) {
 			/* Ignore Version: for now */
 		} else {
@@ -660,6 +682,8 @@ xlog_init(struct xlog *xlog)
 	xlog->sync_interval = SNAP_SYNC_INTERVAL;
 	xlog->sync_time = ev_monotonic_time();
 	xlog->is_autocommit = true;
+	xlog->compress_level = XLOG_TX_COMPRESS_LEVEL;
+	xlog->compress_threshold = XLOG_TX_COMPRESS_THRESHOLD;
 	obuf_create(&xlog->obuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
 	obuf_create(&xlog->zbuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
 	xlog->zctx = ZSTD_createCCtx();
@@ -678,11 +702,16 @@ xlog_clear(struct xlog *l)
 	l->fd = -1;
 }
 
+static void
+xlog_zjob_delete(struct xlog_zjob *job);
+
 static void
 xlog_destroy(struct xlog *xlog)
 {
 	obuf_destroy(&xlog->obuf);
 	obuf_destroy(&xlog->zbuf);
+	if (xlog->zjob != NULL)
+		xlog_zjob_delete(xlog->zjob);
 	ZSTD_freeCCtx(xlog->zctx);
 	TRASH(xlog);
 	xlog->fd = -1;
@@ -865,6 +894,7 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	snprintf(meta.filetype, sizeof(meta.filetype), "%s", dir->filetype);
 	meta.instance_uuid = *dir->instance_uuid;
 	vclock_copy(&meta.vclock, vclock);
+	meta.segment_count = 0;
 
 	if (xlog_create(xlog, filename, dir->open_wflags, &meta) != 0)
 		return -1;
@@ -886,6 +916,33 @@ xdir_create_xlog(struct xdir *dir, struct xlog *xlog,
 	return 0;
 }
 
+/**
+ * Encode the fixheader of a block of @a len bytes (fixheader
+ * size excluded) with checksum @a crc32c.
+ */
+static void
+xlog_encode_fixheader(char *fixheader, log_magic_t magic, size_t len,
+		      uint32_t crc32c)
+{
+	*(log_magic_t *)fixheader = magic;
+	char *data = fixheader + sizeof(log_magic_t);
+	data = mp_encode_uint(data, len);
+	/* Encode crc32 for previous row */
+	data = mp_encode_uint(data, 0);
+	/* Encode crc32 for current row */
+	data = mp_encode_uint(data, crc32c);
+	/*
+	 * Encode a padding, to ensure the resulting
+	 * fixheader always has the same size.
+	 */
+	ssize_t padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
+	if (padding > 0) {
+		data = mp_encode_strl(data, padding - 1);
+		if (padding > 1)
+			memset(data, 0, padding - 1);
+	}
+}
+
 /**
  * Write a sequence of uncompressed xrow objects.
  *
@@ -899,15 +956,6 @@ xlog_tx_write_plain(struct xlog *log)
 	 * We created an obuf savepoint at start of xlog_tx,
 	 * now populate it with data.
 	 */
-	char *fixheader = (char *)log->obuf.iov[0].iov_base;
-	*(log_magic_t *)fixheader = row_marker;
-	char *data = fixheader + sizeof(log_magic_t);
-
-	data = mp_encode_uint(data,
-			      obuf_size(&log->obuf) - XLOG_FIXHEADER_SIZE);
-	/* Encode crc32 for previous row */
-	data = mp_encode_uint(data, 0);
-	/* Encode crc32 for current row */
 	uint32_t crc32c = 0;
 	struct iovec *iov;
 	size_t offset = XLOG_FIXHEADER_SIZE;
@@ -917,19 +965,9 @@ xlog_tx_write_plain(struct xlog *log)
 				    iov->iov_len - offset);
 		offset = 0;
 	}
-	data = mp_encode_uint(data, crc32c);
-	/*
-	 * Encode a padding, to ensure the resulting
-	 * fixheader always has the same size.
-	 */
-	ssize_t padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
-	if (padding > 0) {
-		data = mp_encode_strl(data, padding - 1);
-		if (padding > 1) {
-			memset(data, 0, padding - 1);
-			data += padding - 1;
-		}
-	}
+	xlog_encode_fixheader((char *)log->obuf.iov[0].iov_base, row_marker,
+			      obuf_size(&log->obuf) - XLOG_FIXHEADER_SIZE,
+			      crc32c);
 
 	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
 		diag_set(ClientError, ER_INJECTION, "xlog write injection");
@@ -946,98 +984,141 @@ xlog_tx_write_plain(struct xlog *log)
 }
 
 /**
- * Write a compressed block of xrow objects.
- * @retval -1  error
- * @retval >= 0 the number of bytes written
+ * Estimate the max size of xrow objects stored in @a obuf
+ * after compression.
  */
-static off_t
-xlog_tx_write_zstd(struct xlog *log)
+static size_t
+xlog_compress_bound(struct obuf *obuf)
 {
-	char *fixheader = (char *)obuf_alloc(&log->zbuf,
-					     XLOG_FIXHEADER_SIZE);
+	size_t bound = 0;
+	struct iovec *iov;
+	size_t offset = XLOG_FIXHEADER_SIZE;
+	for (iov = obuf->iov; iov->iov_len; ++iov) {
+		bound += ZSTD_compressBound(iov->iov_len - offset);
+		offset = 0;
+	}
+	return bound;
+}
 
-	uint32_t crc32c = 0;
+/**
+ * Compress xrow objects stored in @a obuf into a single zstd
+ * frame. Neither allocates memory nor sets diag, so can be
+ * called from the compression thread.
+ *
+ * @param zdst the destination buffer, must be at least
+ *             xlog_compress_bound() bytes long.
+ * @param[out] crc32c the checksum of compressed data.
+ * @return the size of compressed data or a zstd error code,
+ *         check with ZSTD_isError().
+ */
+static size_t
+xlog_compress(ZSTD_CCtx *zctx, int level, struct obuf *obuf,
+	      char *zdst, uint32_t *crc32c)
+{
+	size_t zsize = ZSTD_compressBegin(zctx, level);
+	if (ZSTD_isError(zsize))
+		return zsize;
+	char *zpos = zdst;
+	*crc32c = 0;
 	struct iovec *iov;
-	/* 3 is compression level. */
-	ZSTD_compressBegin(log->zctx, 3);
 	size_t offset = XLOG_FIXHEADER_SIZE;
-	for (iov = log->obuf.iov; iov->iov_len; ++iov) {
-		/* Estimate max output buffer size. */
+	for (iov = obuf->iov; iov->iov_len; ++iov) {
 		size_t zmax_size = ZSTD_compressBound(iov->iov_len - offset);
-		/* Allocate a destination buffer. */
-		void *zdst = obuf_reserve(&log->zbuf, zmax_size);
-		if (!zdst) {
-			diag_set(OutOfMemory, zmax_size, "runtime arena",
-				  "compression buffer");
-			goto error;
-		}
 		size_t (*fcompress)(ZSTD_CCtx *, void *, size_t,
 				    const void *, size_t);
 		/*
 		 * If it's the last iov or the last
 		 * log has 0 bytes, end the stream.
 		 */
-		if (iov == log->obuf.iov + log->obuf.pos ||
+		if (iov == obuf->iov + obuf->pos ||
 		    !(iov + 1)->iov_len) {
 			fcompress = ZSTD_compressEnd;
 		} else {
 			fcompress = ZSTD_compressContinue;
 		}
-		size_t zsize = fcompress(log->zctx, zdst, zmax_size,
-					 (char *)iov->iov_base + offset,
-					 iov->iov_len - offset);
-		if (ZSTD_isError(zsize)) {
-			diag_set(ClientError, ER_COMPRESSION,
-				 ZSTD_getErrorName(zsize));
-			goto error;
-		}
-		/* Advance output buffer to the end of compressed data. */
-		obuf_alloc(&log->zbuf, zsize);
+		zsize = fcompress(zctx, zpos, zmax_size,
+				  (char *)iov->iov_base + offset,
+				  iov->iov_len - offset);
+		if (ZSTD_isError(zsize))
+			return zsize;
 		/* Update crc32c */
-		crc32c = crc32_calc(crc32c, (char *)zdst, zsize);
+		*crc32c = crc32_calc(*crc32c, zpos, zsize);
+		zpos += zsize;
 		/* Discount fixheader size for all iovs after first. */
 		offset = 0;
 	}
+	return zpos - zdst;
+}
 
-	*(log_magic_t *)fixheader = zrow_marker;
-	char *data;
-	data = fixheader + sizeof(log_magic_t);
-	data = mp_encode_uint(data,
-			      obuf_size(&log->zbuf) - XLOG_FIXHEADER_SIZE);
-	/* Encode crc32 for previous row */
-	data = mp_encode_uint(data, 0);
-	/* Encode crc32 for current row */
-	data = mp_encode_uint(data, crc32c);
-	/* Encode padding */
-	ssize_t padding;
-	padding = XLOG_FIXHEADER_SIZE - (data - fixheader);
-	if (padding > 0) {
-		data = mp_encode_strl(data, padding - 1);
-		if (padding > 1) {
-			memset(data, 0, padding - 1);
-			data += padding - 1;
-		}
+/**
+ * Reserve a contiguous chunk in @a zbuf big enough for
+ * a fixheader followed by compressed contents of @a obuf.
+ * @retval NULL out of memory, check diag.
+ */
+static char *
+xlog_zbuf_reserve(struct obuf *zbuf, struct obuf *obuf)
+{
+	size_t size = XLOG_FIXHEADER_SIZE + xlog_compress_bound(obuf);
+	char *fixheader = (char *)obuf_reserve(zbuf, size);
+	if (fixheader == NULL) {
+		diag_set(OutOfMemory, size, "runtime arena",
+			 "compression buffer");
 	}
+	return fixheader;
+}
+
+/**
+ * Write a block compressed into a chunk reserved with
+ * xlog_zbuf_reserve() and reset @a zbuf.
+ * @retval -1  error
+ * @retval >= 0 the number of bytes written
+ */
+static ssize_t
+xlog_tx_write_zbuf(struct xlog *log, struct obuf *zbuf,
+		   size_t zsize, uint32_t crc32c)
+{
+	char *fixheader = (char *)obuf_alloc(zbuf,
+					     XLOG_FIXHEADER_SIZE + zsize);
+	assert(fixheader != NULL);
+	xlog_encode_fixheader(fixheader, zrow_marker, zsize, crc32c);
 
 	ERROR_INJECT(ERRINJ_WAL_WRITE_DISK, {
 		diag_set(ClientError, ER_INJECTION, "xlog write injection");
-		obuf_reset(&log->zbuf);
-		goto error;
+		obuf_reset(zbuf);
+		return -1;
 	});
 
-	ssize_t written;
-	written = fio_writevn(log->fd, log->zbuf.iov,
-			      log->zbuf.pos + 1);
+	ssize_t written = fio_writevn(log->fd, zbuf->iov, zbuf->pos + 1);
+	obuf_reset(zbuf);
 	if (written < 0) {
 		diag_set(SystemError, "failed to write to '%s' file",
 			 log->filename);
-		goto error;
+		return -1;
 	}
-	obuf_reset(&log->zbuf);
 	return written;
-error:
-	obuf_reset(&log->zbuf);
-	return -1;
+}
+
+/**
+ * Write a compressed block of xrow objects.
+ * @retval -1  error
+ * @retval >= 0 the number of bytes written
+ */
+static off_t
+xlog_tx_write_zstd(struct xlog *log)
+{
+	char *fixheader = xlog_zbuf_reserve(&log->zbuf, &log->obuf);
+	if (fixheader == NULL)
+		return -1;
+	uint32_t crc32c;
+	size_t zsize = xlog_compress(log->zctx, log->compress_level,
+				     &log->obuf,
+				     fixheader + XLOG_FIXHEADER_SIZE, &crc32c);
+	if (ZSTD_isError(zsize)) {
+		diag_set(ClientError, ER_COMPRESSION,
+			 ZSTD_getErrorName(zsize));
+		return -1;
+	}
+	return xlog_tx_write_zbuf(log, &log->zbuf, zsize, crc32c);
 }
 
 /* file syncing and posix_fadvise() should be rounded by a page boundary */
@@ -1045,41 +1126,189 @@ error:
 #define SYNC_ROUND_DOWN(size)	((size) & ~(4096 - 1))
 #define SYNC_ROUND_UP(size)	(SYNC_ROUND_DOWN(size + SYNC_MASK))
 
+/** Background compression, see xlog_set_compress_async(). */
+struct xlog_zjob {
+	/** Link in xlog_zthread::queue. */
+	struct stailq_entry in_queue;
+	/** Compression context and level of the xlog. */
+	ZSTD_CCtx *zctx;
+	int level;
+	/** The block being compressed, swapped with xlog::obuf. */
+	struct obuf obuf;
+	/** The number of rows in the block. */
+	int64_t rows;
+	/** Output buffer, see xlog_zbuf_reserve(). */
+	struct obuf zbuf;
+	/** Where to put compressed data, inside zbuf. */
+	char *zdst;
+	/** xlog_compress() results. */
+	size_t zsize;
+	uint32_t crc32c;
+	/** True if the block is in the pipeline. */
+	bool is_pending;
+	/** Set by the compression thread when it's done. */
+	bool is_done;
+	/**
+	 * Size and number of rows of the blocks written by
+	 * the pipeline but not reported to the caller yet.
+	 * They are truncated on write error, since the caller
+	 * will roll back the transactions they contain.
+	 */
+	off_t written;
+	int64_t written_rows;
+};
+
+/** The thread compressing blocks of all asynchronous xlogs. */
+static struct {
+	struct cord cord;
+	pthread_mutex_t mutex;
+	/** Signalled when a job is queued. */
+	pthread_cond_t job_cond;
+	/** Signalled when a job is done. */
+	pthread_cond_t done_cond;
+	/** Jobs waiting for the thread, linked by in_queue. */
+	struct stailq queue;
+	/** Set if the thread has been started. */
+	bool is_running;
+	/** Set to make the thread exit once the queue is empty. */
+	bool is_stopping;
+} xlog_zthread;
+
+static void *
+xlog_zthread_f(void *arg)
+{
+	(void)arg;
+	tt_pthread_mutex_lock(&xlog_zthread.mutex);
+	while (true) {
+		while (stailq_empty(&xlog_zthread.queue) &&
+		       !xlog_zthread.is_stopping) {
+			tt_pthread_cond_wait(&xlog_zthread.job_cond,
+					     &xlog_zthread.mutex);
+		}
+		if (stailq_empty(&xlog_zthread.queue))
+			break;
+		struct xlog_zjob *job =
+			stailq_shift_entry(&xlog_zthread.queue,
+					   struct xlog_zjob, in_queue);
+		tt_pthread_mutex_unlock(&xlog_zthread.mutex);
+		job->zsize = xlog_compress(job->zctx, job->level,
+					   &job->obuf, job->zdst,
+					   &job->crc32c);
+		tt_pthread_mutex_lock(&xlog_zthread.mutex);
+		job->is_done = true;
+		tt_pthread_cond_broadcast(&xlog_zthread.done_cond);
+	}
+	tt_pthread_mutex_unlock(&xlog_zthread.mutex);
+	return NULL;
+}
+
+static void
+xlog_zthread_start(void)
+{
+	assert(!xlog_zthread.is_running);
+	tt_pthread_mutex_init(&xlog_zthread.mutex, NULL);
+	tt_pthread_cond_init(&xlog_zthread.job_cond, NULL);
+	tt_pthread_cond_init(&xlog_zthread.done_cond, NULL);
+	stailq_create(&xlog_zthread.queue);
+	xlog_zthread.is_stopping = false;
+	if (cord_start(&xlog_zthread.cord, "xlog_zstd",
+		       xlog_zthread_f, NULL) != 0)
+		panic("failed to start xlog compression thread");
+	xlog_zthread.is_running = true;
+}
+
+void
+xlog_compress_thread_stop(void)
+{
+	if (!xlog_zthread.is_running)
+		return;
+	tt_pthread_mutex_lock(&xlog_zthread.mutex);
+	xlog_zthread.is_stopping = true;
+	tt_pthread_cond_signal(&xlog_zthread.job_cond);
+	tt_pthread_mutex_unlock(&xlog_zthread.mutex);
+	if (cord_join(&xlog_zthread.cord) != 0)
+		panic_syserror("failed to join xlog compression thread");
+	tt_pthread_cond_destroy(&xlog_zthread.done_cond);
+	tt_pthread_cond_destroy(&xlog_zthread.job_cond);
+	tt_pthread_mutex_destroy(&xlog_zthread.mutex);
+	xlog_zthread.is_running = false;
+}
+
 /**
- * Writes xlog batch to file
+ * Block the writer until the compression thread is done
+ * with @a job. The writer thread doesn't yield, so as not
+ * to let other fibers write to the xlog meanwhile.
  */
-static ssize_t
-xlog_tx_write(struct xlog *log)
+static void
+xlog_zjob_wait(struct xlog_zjob *job)
 {
-	if (obuf_size(&log->obuf) == XLOG_FIXHEADER_SIZE)
-		return 0;
-	ssize_t written;
+	assert(job->is_pending);
+	tt_pthread_mutex_lock(&xlog_zthread.mutex);
+	while (!job->is_done) {
+		tt_pthread_cond_wait(&xlog_zthread.done_cond,
+				     &xlog_zthread.mutex);
+	}
+	tt_pthread_mutex_unlock(&xlog_zthread.mutex);
+	job->is_pending = false;
+	obuf_reset(&job->obuf);
+}
 
-	if (obuf_size(&log->obuf) >= XLOG_TX_COMPRESS_THRESHOLD) {
-		written = xlog_tx_write_zstd(log);
-	} else {
-		written = xlog_tx_write_plain(log);
+int
+xlog_set_compress_async(struct xlog *log)
+{
+	assert(log->zjob == NULL);
+	struct xlog_zjob *job = (struct xlog_zjob *)calloc(1, sizeof(*job));
+	if (job == NULL) {
+		diag_set(OutOfMemory, sizeof(*job), "calloc",
+			 "struct xlog_zjob");
+		return -1;
 	}
-	ERROR_INJECT(ERRINJ_WAL_WRITE, {
-		diag_set(ClientError, ER_INJECTION, "xlog write injection");
-		written = -1;
-	});
+	if (!xlog_zthread.is_running)
+		xlog_zthread_start();
+	obuf_create(&job->obuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
+	obuf_create(&job->zbuf, &cord()->slabc, XLOG_TX_AUTOCOMMIT_THRESHOLD);
+	log->zjob = job;
+	return 0;
+}
 
-	obuf_reset(&log->obuf);
+static void
+xlog_zjob_delete(struct xlog_zjob *job)
+{
+	if (job->is_pending)
+		xlog_zjob_wait(job);
+	obuf_destroy(&job->obuf);
+	obuf_destroy(&job->zbuf);
+	free(job);
+}
+
+/**
+ * Account a block written to the file.
+ *
+ * @param written the size of the block, -1 on error
+ * @param rows the number of rows in the block
+ */
+static ssize_t
+xlog_tx_write_done(struct xlog *log, ssize_t written, int64_t rows)
+{
 	/*
 	 * Simplify recovery after a temporary write failure:
 	 * truncate the file to the best known good write
 	 * position.
 	 */
 	if (written < 0) {
+		if (log->zjob != NULL) {
+			log->offset -= log->zjob->written;
+			log->rows -= log->zjob->written_rows;
+			log->zjob->written = 0;
+			log->zjob->written_rows = 0;
+		}
 		if (lseek(log->fd, log->offset, SEEK_SET) < 0 ||
 		    ftruncate(log->fd, log->offset) != 0)
 			panic_syserror("failed to truncate xlog after write error");
 		return -1;
 	}
 	log->offset += written;
-	log->rows += log->tx_rows;
-	log->tx_rows = 0;
+	log->rows += rows;
 	if ((log->sync_interval && log->offset >=
 	    (off_t)(log->synced_size + log->sync_interval)) ||
 	    (log->rate_limit && log->offset >=
@@ -1121,6 +1350,131 @@ xlog_tx_write(struct xlog *log)
 	return written;
 }
 
+/**
+ * Wait for the block being compressed in the background,
+ * if any, and write it to the file.
+ */
+static ssize_t
+xlog_tx_write_zjob(struct xlog *log)
+{
+	struct xlog_zjob *job = log->zjob;
+	if (job == NULL || !job->is_pending)
+		return 0;
+	xlog_zjob_wait(job);
+	ssize_t written;
+	if (ZSTD_isError(job->zsize)) {
+		diag_set(ClientError, ER_COMPRESSION,
+			 ZSTD_getErrorName(job->zsize));
+		obuf_reset(&job->zbuf);
+		written = -1;
+	} else {
+		written = xlog_tx_write_zbuf(log, &job->zbuf,
+					     job->zsize, job->crc32c);
+	}
+	written = xlog_tx_write_done(log, written, job->rows);
+	if (written >= 0) {
+		job->written += written;
+		job->written_rows += job->rows;
+	}
+	return written;
+}
+
+/**
+ * Writes xlog batch to file
+ */
+static ssize_t
+xlog_tx_write(struct xlog *log)
+{
+	/* Blocks must get to the file in order. */
+	if (xlog_tx_write_zjob(log) < 0) {
+		obuf_reset(&log->obuf);
+		return -1;
+	}
+	ssize_t written = 0;
+	if (obuf_size(&log->obuf) > XLOG_FIXHEADER_SIZE) {
+		if (log->compress_level > 0 &&
+		    obuf_size(&log->obuf) >= log->compress_threshold) {
+			written = xlog_tx_write_zstd(log);
+		} else {
+			written = xlog_tx_write_plain(log);
+		}
+		ERROR_INJECT(ERRINJ_WAL_WRITE, {
+			diag_set(ClientError, ER_INJECTION,
+				 "xlog write injection");
+			written = -1;
+		});
+
+		obuf_reset(&log->obuf);
+		written = xlog_tx_write_done(log, written, log->tx_rows);
+		if (written < 0)
+			return -1;
+		log->tx_rows = 0;
+	}
+	if (log->zjob != NULL) {
+		/* Blocks written ahead are reported from now on. */
+		written += log->zjob->written;
+		log->zjob->written = 0;
+		log->zjob->written_rows = 0;
+	}
+	return written;
+}
+
+/**
+ * Pass the accumulated block to the compression thread,
+ * after writing the previous one, and go on buffering rows
+ * while it's being compressed. The blocks written here are
+ * reported as written only by the next xlog_tx_write().
+ *
+ * @retval -1  error
+ * @retval 0   the block is in the pipeline
+ */
+static ssize_t
+xlog_tx_write_async(struct xlog *log)
+{
+	struct xlog_zjob *job = log->zjob;
+	if (log->compress_level == 0 ||
+	    obuf_size(&log->obuf) < log->compress_threshold)
+		return xlog_tx_write(log);
+	if (xlog_tx_write_zjob(log) < 0)
+		goto error;
+	char *fixheader = xlog_zbuf_reserve(&job->zbuf, &log->obuf);
+	if (fixheader == NULL) {
+		xlog_tx_write_done(log, -1, 0);
+		goto error;
+	}
+	struct obuf obuf = job->obuf;
+	job->obuf = log->obuf;
+	log->obuf = obuf;
+	job->rows = log->tx_rows;
+	log->tx_rows = 0;
+	job->zctx = log->zctx;
+	job->level = log->compress_level;
+	job->zdst = fixheader + XLOG_FIXHEADER_SIZE;
+	job->is_pending = true;
+	job->is_done = false;
+	tt_pthread_mutex_lock(&xlog_zthread.mutex);
+	stailq_add_tail_entry(&xlog_zthread.queue, job, in_queue);
+	tt_pthread_cond_signal(&xlog_zthread.job_cond);
+	tt_pthread_mutex_unlock(&xlog_zthread.mutex);
+	return 0;
+error:
+	obuf_reset(&log->obuf);
+	return -1;
+}
+
+/**
+ * Flush the output buffer once it is big enough.
+ */
+static ssize_t
+xlog_tx_write_auto(struct xlog *log)
+{
+	if (obuf_size(&log->obuf) < XLOG_TX_AUTOCOMMIT_THRESHOLD)
+		return 0;
+	if (log->zjob != NULL)
+		return xlog_tx_write_async(log);
+	return xlog_tx_write(log);
+}
+
 /*
  * Add a row to a log and possibly flush the log.
  *
@@ -1175,9 +1529,7 @@ xlog_write_row(struct xlog *log, const struct xrow_header *packet)
 	log->tx_rows++;
 
 	size_t row_size = obuf_size(&log->obuf) - page_offset;
-	if (log->is_autocommit &&
-	    obuf_size(&log->obuf) >= XLOG_TX_AUTOCOMMIT_THRESHOLD &&
-	    xlog_tx_write(log) < 0)
+	if (log->is_autocommit && xlog_tx_write_auto(log) < 0)
 		return -1;
 
 	return row_size;
@@ -1206,10 +1558,7 @@ ssize_t
 xlog_tx_commit(struct xlog *log)
 {
 	log->is_autocommit = true;
-	if (obuf_size(&log->obuf) >= XLOG_TX_AUTOCOMMIT_THRESHOLD) {
-		return xlog_tx_write(log);
-	}
-	return 0;
+	return xlog_tx_write_auto(log);
 }
 
 /*
@@ -1231,7 +1580,8 @@ ssize_t
 xlog_flush(struct xlog *log)
 {
 	assert(log->is_autocommit);
-	if (log->obuf.used == 0)
+	if (log->obuf.used == 0 &&
+	    (log->zjob == NULL || !log->zjob->is_pending))
 		return 0;
 	return xlog_tx_write(log);
 }
@@ -1267,6 +1617,21 @@ xlog_sync(struct xlog *l)
 	return 0;
 }
 
+void
+xlog_truncate(struct xlog *log, off_t offset, int64_t rows)
+{
+	assert(log->obuf.used == 0);
+	assert(log->zjob == NULL || !log->zjob->is_pending);
+	assert(offset <= log->offset && rows <= log->rows);
+	if (lseek(log->fd, offset, SEEK_SET) < 0 ||
+	    ftruncate(log->fd, offset) != 0)
+		panic_syserror("failed to truncate xlog");
+	log->offset = offset;
+	log->rows = rows;
+	if ((off_t)log->synced_size > offset)
+		log->synced_size = offset;
+}
+
 static int
 xlog_write_eof(struct xlog *l)
 {
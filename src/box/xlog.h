@@ -44,6 +44,7 @@
 
 struct iovec;
 struct xrow_header;
+struct xlog_zjob;
 
 #if defined(__cplusplus)
 extern "C" {
@@ -229,6 +230,12 @@ struct xlog_meta {
 	 * is vector clock *at the time the snapshot is taken*.
 	 */
 	struct vclock vclock;
+	/**
+	 * Text file header: the number of files a snapshot
+	 * written in parallel is split into, including this
+	 * one. Zero if the log is stored in a single file.
+	 */
+	uint32_t segment_count;
 };
 
 /* }}} */
@@ -284,10 +291,28 @@ struct xlog {
 	struct obuf obuf;
 	/** The context of zstd compression */
 	ZSTD_CCtx *zctx;
+	/**
+	 * zstd compression level, 0 means that
+	 * blocks are written uncompressed.
+	 *
+	 * This and compress_threshold are set by xlog_init()
+	 * to the defaults. Only WAL files override them, with
+	 * box.cfg.wal_compress_level and wal_compress_threshold.
+	 * Snapshots, vinyl runs and the vinyl metadata log
+	 * always use the defaults.
+	 */
+	int compress_level;
+	/** Blocks smaller than this are written uncompressed. */
+	size_t compress_threshold;
 	/**
 	 * Compressed output buffer
 	 */
 	struct obuf zbuf;
+	/**
+	 * Background compression state, NULL unless
+	 * xlog_set_compress_async() was called.
+	 */
+	struct xlog_zjob *zjob;
 	/**
 	 * Sync interval in bytes.
 	 * xlog file will be synced every sync_interval bytes,
@@ -397,6 +422,38 @@ xlog_is_open(struct xlog *l)
 int
 xlog_rename(struct xlog *l);
 
+/**
+ * Compress blocks of this xlog in a background thread.
+ * Once the output buffer of a committed transaction grows
+ * big enough to be flushed, it is passed to the thread,
+ * and the writer goes on buffering rows, only writing
+ * compressed blocks to the file as they are ready. All
+ * outstanding blocks are written by xlog_flush().
+ * Note, xlog_tx_commit() doesn't report blocks passed to
+ * the thread as written, and they are truncated if a write
+ * fails before the next xlog_flush().
+ *
+ * The writer is blocked while it waits for the background
+ * thread, so this mode is intended for a dedicated thread,
+ * like WAL. The compression thread is started on the first
+ * call, all calls must be made from the same thread.
+ *
+ * @retval 0 for ok
+ * @retval -1 for error
+ */
+int
+xlog_set_compress_async(struct xlog *xlog);
+
+/**
+ * Stop the compression thread started by
+ * xlog_set_compress_async() and wait until it exits.
+ * Must be called by the thread that started it, after
+ * all xlogs using background compression are closed.
+ * Does nothing if the thread isn't running.
+ */
+void
+xlog_compress_thread_stop(void);
+
 /**
  * Write a row to xlog, 
  *
@@ -446,6 +503,15 @@ xlog_flush(struct xlog *log);
 int
 xlog_sync(struct xlog *l);
 
+/**
+ * Truncate a log file to @a offset, which must be a block
+ * boundary, and set the number of rows written to @a rows.
+ * Used to drop blocks that failed to sync. All buffered
+ * rows must have been flushed. Panics on failure.
+ */
+void
+xlog_truncate(struct xlog *log, off_t offset, int64_t rows);
+
 /**
  * Close the log file and free xlog object.
  *
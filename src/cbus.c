@@ -31,9 +31,19 @@
 #include "cbus.h"
 
 #include <limits.h>
+#include <pmatomic.h>
 #include "fiber.h"
 #include "trigger.h"
 
+enum {
+	/**
+	 * Bounds of the number of times the consumer polls
+	 * for new messages before going to sleep.
+	 */
+	CBUS_SPIN_MIN = 16,
+	CBUS_SPIN_MAX = 1024,
+};
+
 /**
  * Cord interconnect.
  */
@@ -87,6 +97,48 @@ static void
 cpipe_flush_cb(ev_loop * /* loop */, struct ev_async *watcher,
 	       int /* events */);
 
+/**
+ * Push a list of messages to the endpoint. Lock-free, can be
+ * called from any cord.
+ * @retval true if the endpoint had no pending messages, i.e.
+ *         the consumer needs to be notified.
+ */
+static bool
+cbus_endpoint_push(struct cbus_endpoint *endpoint, struct stailq *input)
+{
+	assert(!stailq_empty(input));
+	/* Pending messages are stored in the reverse order. */
+	stailq_reverse(input);
+	struct stailq_entry *first = stailq_first(input);
+	struct stailq_entry *last = stailq_last(input);
+	struct stailq_entry *head = pm_atomic_load_explicit(&endpoint->output,
+						pm_memory_order_relaxed);
+	do {
+		last->next = head;
+	} while (!pm_atomic_compare_exchange_weak(&endpoint->output,
+						  &head, first));
+	stailq_create(input);
+	return head == NULL;
+}
+
+void
+cbus_endpoint_fetch(struct cbus_endpoint *endpoint, struct stailq *output)
+{
+	struct stailq_entry *item = pm_atomic_exchange(&endpoint->output,
+						       NULL);
+	if (item == NULL)
+		return;
+	/* Restore the order in which messages were pushed. */
+	struct stailq fetched;
+	stailq_create(&fetched);
+	while (item != NULL) {
+		struct stailq_entry *next = item->next;
+		stailq_add(&fetched, item);
+		item = next;
+	}
+	stailq_concat(output, &fetched);
+}
+
 void
 cpipe_create(struct cpipe *pipe, const char *consumer)
 {
@@ -149,11 +201,11 @@ cpipe_destroy(struct cpipe *pipe)
 	 * delivered.
 	 */
 	tt_pthread_mutex_lock(&endpoint->mutex);
+	/* Add the pipe shutdown message as the last one. */
+	stailq_add_tail_entry(&pipe->input, poison, msg.fifo);
 	/* Flush input */
-	stailq_concat(&endpoint->output, &pipe->input);
+	cbus_endpoint_push(endpoint, &pipe->input);
 	pipe->n_input = 0;
-	/* Add the pipe shutdown message as the last one. */
-	stailq_add_tail_entry(&endpoint->output, poison, msg.fifo);
 	/* Count statistics */
 	rmean_collect(cbus.stats, CBUS_STAT_EVENTS, 1);
 	/*
@@ -218,7 +270,8 @@ cbus_endpoint_create(struct cbus_endpoint *endpoint, const char *name,
 	endpoint->n_pipes = 0;
 	fiber_cond_create(&endpoint->cond);
 	tt_pthread_mutex_init(&endpoint->mutex, NULL);
-	stailq_create(&endpoint->output);
+	endpoint->output = NULL;
+	endpoint->spin_count = CBUS_SPIN_MIN;
 	ev_async_init(&endpoint->async,
 		      (void (*)(ev_loop *, struct ev_async *, int)) fetch_cb);
 	endpoint->async.data = fetch_data;
@@ -252,7 +305,8 @@ cbus_endpoint_destroy(struct cbus_endpoint *endpoint,
 	while (true) {
 		if (process_cb)
 			process_cb(endpoint);
-		if (endpoint->n_pipes == 0 && stailq_empty(&endpoint->output))
+		if (endpoint->n_pipes == 0 &&
+		    pm_atomic_load(&endpoint->output) == NULL)
 			break;
 		 fiber_cond_wait(&endpoint->cond);
 	}
@@ -281,16 +335,10 @@ cpipe_flush_cb(ev_loop *loop, struct ev_async *watcher, int events)
 		return;
 
 	trigger_run(&pipe->on_flush, pipe);
-	/* Trigger task processing when the queue becomes non-empty. */
-	bool output_was_empty;
-
-	tt_pthread_mutex_lock(&endpoint->mutex);
-	output_was_empty = stailq_empty(&endpoint->output);
 	/** Flush input */
-	stailq_concat(&endpoint->output, &pipe->input);
-	tt_pthread_mutex_unlock(&endpoint->mutex);
-
+	bool output_was_empty = cbus_endpoint_push(endpoint, &pipe->input);
 	pipe->n_input = 0;
+	/* Trigger task processing when the queue becomes non-empty. */
 	if (output_was_empty) {
 		/* Count statistics */
 		rmean_collect(cbus.stats, CBUS_STAT_EVENTS, 1);
@@ -635,6 +683,41 @@ cbus_process(struct cbus_endpoint *endpoint)
 		cmsg_deliver(msg);
 }
 
+/** Hint the CPU that the thread is busy waiting. */
+static inline void
+cbus_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__asm__ __volatile__("pause");
+#elif defined(__aarch64__)
+	__asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * Poll the endpoint for new messages for a while. Waking up
+ * a sleeping cord costs a syscall on both sides, which is more
+ * expensive than a short busy wait when messages come often.
+ * The number of polls is doubled if a message arrives and
+ * halved otherwise, so a cord that is mostly idle barely spins.
+ * @retval true if there are new messages
+ */
+static bool
+cbus_endpoint_spin(struct cbus_endpoint *endpoint)
+{
+	for (int i = 0; i < endpoint->spin_count; i++) {
+		if (pm_atomic_load_explicit(&endpoint->output,
+					    pm_memory_order_relaxed) != NULL) {
+			endpoint->spin_count = MIN(endpoint->spin_count * 2,
+						   CBUS_SPIN_MAX);
+			return true;
+		}
+		cbus_cpu_relax();
+	}
+	endpoint->spin_count = MAX(endpoint->spin_count / 2, CBUS_SPIN_MIN);
+	return false;
+}
+
 void
 cbus_loop(struct cbus_endpoint *endpoint)
 {
@@ -642,7 +725,14 @@ cbus_loop(struct cbus_endpoint *endpoint)
 		cbus_process(endpoint);
 		if (fiber_is_cancelled())
 			break;
-		fiber_yield();
+		/*
+		 * Let other fibers and the event loop run, but
+		 * don't let the loop sleep if messages arrived.
+		 */
+		if (cbus_endpoint_spin(endpoint))
+			fiber_reschedule();
+		else
+			fiber_yield();
 	}
 }
 
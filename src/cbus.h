@@ -251,10 +251,25 @@ struct cbus_endpoint {
 	char name[FIBER_NAME_MAX];
 	/** Member of cbus->endpoints */
 	struct rlist in_cbus;
-	/** The lock around the pipe. */
+	/**
+	 * The lock serializing the last message of a destroyed
+	 * pipe with the endpoint destruction.
+	 */
 	pthread_mutex_t mutex;
-	/** A queue with incoming messages. */
-	struct stailq output;
+	/**
+	 * Incoming messages linked through cmsg::fifo in the
+	 * reverse order, i.e. the last pushed message first.
+	 * Producers push messages with compare-and-swap, the
+	 * consumer takes all of them at once with an exchange,
+	 * so no lock is taken on the message path.
+	 */
+	struct stailq_entry *output;
+	/**
+	 * How many times the consumer polls for new messages
+	 * before going to sleep, see cbus_loop(). Adjusted
+	 * according to the message rate.
+	 */
+	int spin_count;
 	/** Consumer cord loop */
 	ev_loop *consumer;
 	/** Async to notify the consumer */
@@ -268,13 +283,8 @@ struct cbus_endpoint {
 /**
  * Fetch incomming messages to output
  */
-static inline void
-cbus_endpoint_fetch(struct cbus_endpoint *endpoint, struct stailq *output)
-{
-	tt_pthread_mutex_lock(&endpoint->mutex);
-	stailq_concat(output, &endpoint->output);
-	tt_pthread_mutex_unlock(&endpoint->mutex);
-}
+void
+cbus_endpoint_fetch(struct cbus_endpoint *endpoint, struct stailq *output);
 
 /** Initialize the global singleton bus. */
 void
@@ -40,6 +40,17 @@
 
 #include <trivia/util.h>
 
+/*
+ * SO_REUSEPORT distributes incoming connections among the
+ * sockets bound to the same address only on Linux, other
+ * systems hand them all to one of the sockets.
+ */
+#if defined(__linux__) && defined(SO_REUSEPORT)
+#define EVIO_HAVE_REUSEPORT 1
+#else
+#define EVIO_HAVE_REUSEPORT 0
+#endif
+
 static void
 evio_setsockopt_server(int fd, int family, int type);
 
@@ -237,6 +248,13 @@ evio_service_bind_addr(struct evio_service *service)
 	auto fd_guard = make_scoped_guard([=]{ close(fd); });
 
 	evio_setsockopt_server(fd, service->addr.sa_family, SOCK_STREAM);
+#if EVIO_HAVE_REUSEPORT
+	if (service->reuseport && service->addr.sa_family != AF_UNIX) {
+		int on = 1;
+		sio_setsockopt(fd, SOL_SOCKET, SO_REUSEPORT,
+			       &on, sizeof(on));
+	}
+#endif
 
 	if (sio_bind(fd, &service->addr, service->addr_len)) {
 		assert(errno == EADDRINUSE);
@@ -356,6 +374,36 @@ evio_service_bind(struct evio_service *service, const char *uri)
 		  evio_service_name(service));
 }
 
+void
+evio_service_attach(struct evio_service *dst,
+		    const struct evio_service *src)
+{
+	assert(! ev_is_active(&dst->ev));
+	assert(evio_service_is_active((struct evio_service *) src));
+	snprintf(dst->host, sizeof(dst->host), "%s", src->host);
+	snprintf(dst->serv, sizeof(dst->serv), "%s", src->serv);
+	if (EVIO_HAVE_REUSEPORT && src->reuseport &&
+	    src->addr.sa_family != AF_UNIX) {
+		/*
+		 * Bind to the address the source socket is
+		 * actually bound to: the configured port may be
+		 * 0, i.e. chosen by the kernel.
+		 */
+		dst->addr_len = sizeof(dst->addrstorage);
+		if (getsockname(src->ev.fd, &dst->addr, &dst->addr_len) != 0)
+			tnt_raise(SocketError, src->ev.fd, "getsockname");
+		dst->reuseport = true;
+		evio_service_bind_addr(dst);
+		return;
+	}
+	int fd = dup(src->ev.fd);
+	if (fd < 0)
+		tnt_raise(SocketError, src->ev.fd, "dup");
+	memcpy(&dst->addrstorage, &src->addrstorage, sizeof(src->addrstorage));
+	dst->addr_len = src->addr_len;
+	ev_io_set(&dst->ev, fd, EV_READ);
+}
+
 /** It's safe to stop a service which is not started yet. */
 void
 evio_service_stop(struct evio_service *service)
@@ -76,6 +76,12 @@ struct evio_service
 		struct sockaddr_storage addrstorage;
 	};
 	socklen_t addr_len;
+	/**
+	 * Set SO_REUSEPORT on the TCP socket before binding it,
+	 * so that services of other threads can bind their own
+	 * sockets to the same address, see evio_service_attach().
+	 */
+	bool reuseport;
 
 	/**
 	 * A callback invoked on every accepted client socket.
@@ -104,6 +110,26 @@ evio_service_init(ev_loop *loop,
 void
 evio_service_bind(struct evio_service *service, const char *uri);
 
+/**
+ * Make the service accept connections on the address bound by
+ * another service, possibly in another thread.
+ *
+ * For a TCP address a new socket is bound to it with
+ * SO_REUSEPORT, which the source service must have been bound
+ * with too, so the kernel spreads incoming connections among
+ * the services and only one of them is woken up for each. UNIX
+ * sockets can't be shared this way, and neither can TCP ones on
+ * systems where SO_REUSEPORT doesn't balance the load, so the
+ * socket of the source service is duplicated instead: all
+ * services are woken up for a connection and one of them
+ * accepts it.
+ *
+ * Either way the services can be stopped independently.
+ */
+void
+evio_service_attach(struct evio_service *dst,
+		    const struct evio_service *src);
+
 /**
  * Listen on bounded socket
  *
@@ -158,6 +158,12 @@
  * struct bps_tree_iterator bps_tree_lower_bound_elem(tree, elem, exact);
  * struct bps_tree_iterator bps_tree_upper_bound_elem(tree, elem, exact);
  * size_t bps_tree_approxiamte_count(tree, key);
+ * // with BPS_TREE_CHILD_COUNTS defined:
+ * struct bps_tree_iterator bps_tree_lower_bound_get_offset(tree, key, exact,
+ *                                                          offset);
+ * struct bps_tree_iterator bps_tree_upper_bound_get_offset(tree, key, exact,
+ *                                                          offset);
+ * struct bps_tree_iterator bps_tree_iterator_at(tree, offset);
  * bps_tree_elem_t *bps_tree_iterator_get_elem(tree, itr);
  * bool bps_tree_iterator_next(tree, itr);
  * bool bps_tree_iterator_prev(tree, itr);
@@ -283,6 +289,16 @@
  * #define BPS_BLOCK_LINEAR_SEARCH
  */
 
+/**
+ * A switch that makes every inner block store the number of
+ * elements in each of its child subtrees. It costs some fanout of
+ * inner blocks and a few more writes per insertion and deletion,
+ * but allows to find the position (offset) of a key in the tree
+ * and to position an iterator at a given offset in logarithmic
+ * time. To turn it on
+ * #define BPS_TREE_CHILD_COUNTS
+ */
+
 /**
  * A switch that enables collection of executions of different
  * branches of code. Used only for debug purposes, I hope you
@@ -365,6 +381,9 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_lower_bound_elem _api_name(lower_bound_elem)
 #define bps_tree_upper_bound_elem _api_name(upper_bound_elem)
 #define bps_tree_approximate_count _api_name(approximate_count)
+#define bps_tree_lower_bound_get_offset _api_name(lower_bound_get_offset)
+#define bps_tree_upper_bound_get_offset _api_name(upper_bound_get_offset)
+#define bps_tree_iterator_at _api_name(iterator_at)
 #define bps_tree_iterator_get_elem _api_name(iterator_get_elem)
 #define bps_tree_iterator_next _api_name(iterator_next)
 #define bps_tree_iterator_prev _api_name(iterator_prev)
@@ -404,8 +423,14 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_collect_path _bps_tree(collect_path)
 #define bps_tree_touch_leaf_path_max_elem _bps_tree(touch_leaf_path_max_elem)
 #define bps_tree_touch_path _bps_tree(touch_path_max_elem)
+#define bps_tree_inner_count _bps_tree(inner_count)
+#define bps_tree_add_path_count _bps_tree(add_path_count)
+#define bps_tree_update_counts_leaf _bps_tree(update_counts_leaf)
+#define bps_tree_update_counts_inner _bps_tree(update_counts_inner)
 #define bps_tree_process_replace _bps_tree(process_replace)
 #define bps_tree_debug_memmove _bps_tree(debug_memmove)
+#define bps_tree_move_children _bps_tree(move_children)
+#define bps_tree_set_child _bps_tree(set_child)
 #define bps_tree_insert_into_leaf _bps_tree(insert_into_leaf)
 #define bps_tree_insert_into_inner _bps_tree(insert_into_inner)
 #define bps_tree_delete_from_leaf _bps_tree(delete_from_leaf)
@@ -780,6 +805,52 @@ bps_tree_upper_bound_elem(const struct bps_tree *tree, bps_tree_elem_t key,
 static inline size_t
 bps_tree_approximate_count(const struct bps_tree *tree, bps_tree_key_t key);
 
+#ifdef BPS_TREE_CHILD_COUNTS
+/**
+ * @brief Same as bps_tree_lower_bound, but also calculates the
+ * offset of the found position, i.e. the number of elements in
+ * the tree that are less than the key.
+ * Available only if BPS_TREE_CHILD_COUNTS is defined.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param exact - see bps_tree_lower_bound. Pass NULL if not needed.
+ * @param offset - the offset of the lower bound is stored here.
+ * @return - Lower-bound iterator.
+ */
+static inline struct bps_tree_iterator
+bps_tree_lower_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset);
+
+/**
+ * @brief Same as bps_tree_upper_bound, but also calculates the
+ * offset of the found position, i.e. the number of elements in
+ * the tree that are less than or equal to the key.
+ * Available only if BPS_TREE_CHILD_COUNTS is defined.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param exact - see bps_tree_upper_bound. Pass NULL if not needed.
+ * @param offset - the offset of the upper bound is stored here.
+ * @return - Upper-bound iterator.
+ */
+static inline struct bps_tree_iterator
+bps_tree_upper_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset);
+
+/**
+ * @brief Get an iterator to the element with the given offset,
+ * i.e. to the element that has exactly @a offset elements before
+ * it in the tree. Has logarithmic complexity.
+ * Available only if BPS_TREE_CHILD_COUNTS is defined.
+ * @param tree - pointer to a tree
+ * @param offset - offset of the element
+ * @return - Iterator. Invalid if offset >= size of the tree.
+ */
+static inline struct bps_tree_iterator
+bps_tree_iterator_at(const struct bps_tree *tree, size_t offset);
+#endif /* BPS_TREE_CHILD_COUNTS */
+
 /**
  * @brief Get a pointer to the element pointed by iterator.
  *  If iterator is detected as broken, it is invalidated and NULL returned.
@@ -912,9 +983,18 @@ enum bps_tree_max_sizes {
 		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block)
 		 - 2 * sizeof(bps_tree_block_id_t) )
 		/ sizeof(bps_tree_elem_t),
+#ifdef BPS_TREE_CHILD_COUNTS
+	/* Reserve size_t for alignment of bps_inner::child_counts */
+	BPS_TREE_MAX_COUNT_IN_INNER =
+		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block)
+		 - sizeof(size_t))
+		/ (sizeof(bps_tree_elem_t) + sizeof(bps_tree_block_id_t)
+		   + sizeof(size_t)),
+#else
 	BPS_TREE_MAX_COUNT_IN_INNER =
 		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block))
 		/ (sizeof(bps_tree_elem_t) + sizeof(bps_tree_block_id_t)),
+#endif
 	BPS_TREE_MAX_DEPTH = 16
 };
 
@@ -956,6 +1036,10 @@ CT_ASSERT_G(sizeof(struct bps_leaf) <= BPS_TREE_BLOCK_SIZE);
 struct bps_inner {
 	/* Block header */
 	struct bps_block header;
+#ifdef BPS_TREE_CHILD_COUNTS
+	/* Numbers of elements in the corresponding child subtrees */
+	size_t child_counts[BPS_TREE_MAX_COUNT_IN_INNER];
+#endif
 	/* Ordered array of elements. Note -1 in size. See struct descr. */
 	bps_tree_elem_t elems[BPS_TREE_MAX_COUNT_IN_INNER - 1];
 	/* Corresponding child IDs */
@@ -1170,6 +1254,9 @@ bps_tree_build(struct bps_tree *tree, bps_tree_elem_t *sorted_array,
 			}
 			parents[i]->child_ids[parents[i]->header.size] =
 				insert_id;
+#ifdef BPS_TREE_CHILD_COUNTS
+			parents[i]->child_counts[parents[i]->header.size] = 0;
+#endif
 			if (new_id == (bps_tree_block_id_t)-1)
 				break;
 			if (i == depth - 2) {
@@ -1178,6 +1265,11 @@ bps_tree_build(struct bps_tree *tree, bps_tree_elem_t *sorted_array,
 				insert_id = new_id;
 			}
 		}
+#ifdef BPS_TREE_CHILD_COUNTS
+		for (bps_tree_block_id_t i = 0; i < depth - 1; i++)
+			parents[i]->child_counts[parents[i]->header.size] +=
+				leaf->header.size;
+#endif
 
 		bps_tree_elem_t insert_value = current[leaf->header.size - 1];
 		for (bps_tree_block_id_t i = 0; i < depth - 1; i++) {
@@ -1948,6 +2040,149 @@ bps_tree_approximate_count(const struct bps_tree *tree, bps_tree_key_t key)
 	return result;
 }
 
+#ifdef BPS_TREE_CHILD_COUNTS
+/**
+ * @brief Same as bps_tree_lower_bound, but also calculates the
+ * offset of the found position.
+ * @sa declaration for details.
+ */
+static inline struct bps_tree_iterator
+bps_tree_lower_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset)
+{
+	struct bps_tree_iterator res;
+	matras_head_read_view(&res.view);
+	bool local_result;
+	if (!exact)
+		exact = &local_result;
+	*exact = false;
+	*offset = 0;
+	if (tree->root_id == (bps_tree_block_id_t)(-1)) {
+		res.block_id = (bps_tree_block_id_t)(-1);
+		res.pos = 0;
+		return res;
+	}
+	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_block_id_t block_id = tree->root_id;
+	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos;
+		pos = bps_tree_find_ins_point_key(tree, inner->elems,
+						  inner->header.size - 1,
+						  key, exact);
+		for (bps_tree_pos_t j = 0; j < pos; j++)
+			*offset += inner->child_counts[j];
+		block_id = inner->child_ids[pos];
+		block = bps_tree_restore_block(tree, block_id);
+	}
+
+	struct bps_leaf *leaf = (struct bps_leaf *)block;
+	bps_tree_pos_t pos;
+	pos = bps_tree_find_ins_point_key(tree, leaf->elems, leaf->header.size,
+					  key, exact);
+	*offset += pos;
+	if (pos >= leaf->header.size) {
+		res.block_id = leaf->next_id;
+		res.pos = 0;
+	} else {
+		res.block_id = block_id;
+		res.pos = pos;
+	}
+	return res;
+}
+
+/**
+ * @brief Same as bps_tree_upper_bound, but also calculates the
+ * offset of the found position.
+ * @sa declaration for details.
+ */
+static inline struct bps_tree_iterator
+bps_tree_upper_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset)
+{
+	struct bps_tree_iterator res;
+	matras_head_read_view(&res.view);
+	bool local_result;
+	if (!exact)
+		exact = &local_result;
+	*exact = false;
+	*offset = 0;
+	bool exact_test;
+	if (tree->root_id == (bps_tree_block_id_t)(-1)) {
+		res.block_id = (bps_tree_block_id_t)(-1);
+		res.pos = 0;
+		return res;
+	}
+	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_block_id_t block_id = tree->root_id;
+	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos;
+		pos = bps_tree_find_after_ins_point_key(tree, inner->elems,
+							inner->header.size - 1,
+							key, &exact_test);
+		if (exact_test)
+			*exact = true;
+		for (bps_tree_pos_t j = 0; j < pos; j++)
+			*offset += inner->child_counts[j];
+		block_id = inner->child_ids[pos];
+		block = bps_tree_restore_block(tree, block_id);
+	}
+
+	struct bps_leaf *leaf = (struct bps_leaf *)block;
+	bps_tree_pos_t pos;
+	pos = bps_tree_find_after_ins_point_key(tree, leaf->elems,
+						leaf->header.size,
+						key, &exact_test);
+	if (exact_test)
+		*exact = true;
+	*offset += pos;
+	if (pos >= leaf->header.size) {
+		res.block_id = leaf->next_id;
+		res.pos = 0;
+	} else {
+		res.block_id = block_id;
+		res.pos = pos;
+	}
+	return res;
+}
+
+/**
+ * @brief Get an iterator to the element with the given offset.
+ * @sa declaration for details.
+ */
+static inline struct bps_tree_iterator
+bps_tree_iterator_at(const struct bps_tree *tree, size_t offset)
+{
+	struct bps_tree_iterator res;
+	matras_head_read_view(&res.view);
+	if (offset >= tree->size) {
+		res.block_id = (bps_tree_block_id_t)(-1);
+		res.pos = 0;
+		return res;
+	}
+	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_block_id_t block_id = tree->root_id;
+	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos = 0;
+		while (offset >= inner->child_counts[pos]) {
+			offset -= inner->child_counts[pos];
+			pos++;
+			assert(pos < inner->header.size);
+		}
+		block_id = inner->child_ids[pos];
+		block = bps_tree_restore_block(tree, block_id);
+	}
+	assert(offset < (size_t)block->size);
+	res.block_id = block_id;
+	res.pos = (bps_tree_pos_t)offset;
+	return res;
+}
+#endif /* BPS_TREE_CHILD_COUNTS */
+
 /**
  * @brief Get a pointer to the element pointed by iterator.
  *  If iterator is detected as broken, it is invalidated and NULL returned.
@@ -2325,6 +2560,112 @@ bps_tree_touch_path(struct bps_tree *tree,
 	}
 }
 
+/**
+ * @brief Get the number of elements in the subtree of an inner block
+ */
+static inline size_t
+bps_tree_inner_count(const struct bps_inner *inner)
+{
+	size_t count = 0;
+#ifdef BPS_TREE_CHILD_COUNTS
+	for (bps_tree_pos_t i = 0; i < inner->header.size; i++)
+		count += inner->child_counts[i];
+#else
+	(void)inner;
+#endif
+	return count;
+}
+
+/**
+ * @brief Add delta to subtree counts of all blocks along the path.
+ * Insertion and deletion of an element change the number of
+ * elements in each subtree on the path by 1. Moving elements
+ * between neighbour blocks doesn't change the total count of
+ * their parent, so after rebalancing it is enough to recalculate
+ * the counts of the involved blocks in their parent
+ * (@sa bps_tree_update_counts_leaf and bps_tree_update_counts_inner).
+ */
+static inline void
+bps_tree_add_path_count(struct bps_tree *tree,
+			struct bps_leaf_path_elem *leaf_path_elem, int delta)
+{
+#ifdef BPS_TREE_CHILD_COUNTS
+	for (struct bps_inner_path_elem *path = leaf_path_elem->parent;
+	     path; path = path->parent) {
+		path->block = (struct bps_inner *)
+			bps_tree_touch_block(tree, path->block_id);
+		path->block->child_counts[path->insertion_point] += delta;
+	}
+#else
+	(void)tree;
+	(void)leaf_path_elem;
+	(void)delta;
+#endif
+}
+
+/**
+ * @brief Recalculate subtree counts of a leaf and its neighbours
+ * (up to two on each side) in their parent after rebalancing.
+ * Must be called before a new leaf is inserted into the parent.
+ */
+static inline void
+bps_tree_update_counts_leaf(struct bps_tree *tree,
+			    struct bps_leaf_path_elem *leaf_path_elem)
+{
+#ifdef BPS_TREE_CHILD_COUNTS
+	struct bps_inner_path_elem *parent = leaf_path_elem->parent;
+	if (!parent)
+		return;
+	struct bps_inner *inner = parent->block;
+	bps_tree_pos_t begin = leaf_path_elem->pos_in_parent - 2;
+	bps_tree_pos_t end = leaf_path_elem->pos_in_parent + 3;
+	if (begin < 0)
+		begin = 0;
+	if (end > inner->header.size)
+		end = inner->header.size;
+	for (bps_tree_pos_t i = begin; i < end; i++) {
+		struct bps_block *block =
+			bps_tree_restore_block(tree, inner->child_ids[i]);
+		inner->child_counts[i] = block->size;
+	}
+#else
+	(void)tree;
+	(void)leaf_path_elem;
+#endif
+}
+
+/**
+ * @brief Recalculate subtree counts of an inner block and its
+ * neighbours (up to two on each side) in their parent after
+ * rebalancing. Must be called before a new inner block is
+ * inserted into the parent.
+ */
+static inline void
+bps_tree_update_counts_inner(struct bps_tree *tree,
+			     struct bps_inner_path_elem *inner_path_elem)
+{
+#ifdef BPS_TREE_CHILD_COUNTS
+	struct bps_inner_path_elem *parent = inner_path_elem->parent;
+	if (!parent)
+		return;
+	struct bps_inner *inner = parent->block;
+	bps_tree_pos_t begin = inner_path_elem->pos_in_parent - 2;
+	bps_tree_pos_t end = inner_path_elem->pos_in_parent + 3;
+	if (begin < 0)
+		begin = 0;
+	if (end > inner->header.size)
+		end = inner->header.size;
+	for (bps_tree_pos_t i = begin; i < end; i++) {
+		struct bps_inner *child = (struct bps_inner *)
+			bps_tree_restore_block(tree, inner->child_ids[i]);
+		inner->child_counts[i] = bps_tree_inner_count(child);
+	}
+#else
+	(void)tree;
+	(void)inner_path_elem;
+#endif
+}
+
 /**
  * @brief Replace element by it's path and fill the *replaced argument
  */
@@ -2397,6 +2738,17 @@ bps_tree_debug_memmove(void *dst_arg, void *src_arg, size_t num,
 					      dst_block_arg;
 		struct bps_inner *src_inner = (struct bps_inner *)
 					      src_block_arg;
+#ifdef BPS_TREE_CHILD_COUNTS
+		char *dst_counts = (char *)dst_inner->child_counts;
+		char *src_counts = (char *)src_inner->child_counts;
+		size_t counts_size = BPS_TREE_MAX_COUNT_IN_INNER *
+				     sizeof(size_t);
+		if (dst >= dst_counts && dst + num <= dst_counts + counts_size &&
+		    src >= src_counts && src + num <= src_counts + counts_size) {
+			memmove(dst, src, num);
+			return;
+		}
+#endif
 		if (num) {
 			if (dst >= ((char *)dst_inner->elems) && dst <
 			    ((char *)dst_inner->elems) +
@@ -2447,6 +2799,39 @@ bps_tree_debug_memmove(void *dst_arg, void *src_arg, size_t num,
 }
 #endif
 
+/**
+ * @brief Move a number of children (IDs and, if enabled, subtree
+ * counts) from one inner block to another or within a block.
+ */
+static inline void
+bps_tree_move_children(struct bps_inner *dst, bps_tree_pos_t dst_pos,
+		       struct bps_inner *src, bps_tree_pos_t src_pos,
+		       bps_tree_pos_t num)
+{
+	BPS_TREE_DATAMOVE(dst->child_ids + dst_pos, src->child_ids + src_pos,
+			  num, dst, src);
+#ifdef BPS_TREE_CHILD_COUNTS
+	BPS_TREE_DATAMOVE(dst->child_counts + dst_pos,
+			  src->child_counts + src_pos, num, dst, src);
+#endif
+}
+
+/**
+ * @brief Set a child (ID and, if enabled, subtree count) of an
+ * inner block.
+ */
+static inline void
+bps_tree_set_child(struct bps_inner *inner, bps_tree_pos_t pos,
+		   bps_tree_block_id_t block_id, size_t count)
+{
+	inner->child_ids[pos] = block_id;
+#ifdef BPS_TREE_CHILD_COUNTS
+	inner->child_counts[pos] = count;
+#else
+	(void)count;
+#endif
+}
+
 /**
  * @breif Insert an element into leaf block. There must be enough space.
  */
@@ -2485,7 +2870,7 @@ static inline void
 bps_tree_insert_into_inner(struct bps_tree *tree,
 			   struct bps_inner_path_elem *inner_path_elem,
 			   bps_tree_block_id_t block_id, bps_tree_pos_t pos,
-			   bps_tree_elem_t max_elem)
+			   bps_tree_elem_t max_elem, size_t count)
 {
 	/* exclusive behaviuor for debug checks */
 	if (tree->root_id != (bps_tree_block_id_t) -1)
@@ -2501,15 +2886,14 @@ bps_tree_insert_into_inner(struct bps_tree *tree,
 		BPS_TREE_DATAMOVE(inner->elems + pos + 1, inner->elems + pos,
 				  inner->header.size - pos - 1, inner, inner);
 		inner->elems[pos] = max_elem;
-		BPS_TREE_DATAMOVE(inner->child_ids + pos + 1,
-				  inner->child_ids + pos,
-				  inner->header.size - pos, inner, inner);
+		bps_tree_move_children(inner, pos + 1, inner, pos,
+				       inner->header.size - pos);
 	} else {
 		if (pos > 0)
 			inner->elems[pos - 1] = *inner_path_elem->max_elem_copy;
 		*inner_path_elem->max_elem_copy = max_elem;
 	}
-	inner->child_ids[pos] = block_id;
+	bps_tree_set_child(inner, pos, block_id, count);
 
 	inner->header.size++;
 }
@@ -2565,9 +2949,8 @@ bps_tree_delete_from_inner(struct bps_tree *tree,
 	if (pos < inner->header.size - 1) {
 		BPS_TREE_DATAMOVE(inner->elems + pos, inner->elems + pos + 1,
 				  inner->header.size - 2 - pos, inner, inner);
-		BPS_TREE_DATAMOVE(inner->child_ids + pos,
-				  inner->child_ids + pos + 1,
-				  inner->header.size - 1 - pos, inner, inner);
+		bps_tree_move_children(inner, pos, inner, pos + 1,
+				       inner->header.size - 1 - pos);
 	} else if (pos > 0) {
 		*inner_path_elem->max_elem_copy = inner->elems[pos - 1];
 	}
@@ -2637,10 +3020,8 @@ bps_tree_move_elems_to_right_inner(struct bps_tree *tree,
 	assert(a->header.size >= num);
 	assert(b->header.size + num <= BPS_TREE_MAX_COUNT_IN_INNER);
 
-	BPS_TREE_DATAMOVE(b->child_ids + num, b->child_ids,
-			  b->header.size, b, b);
-	BPS_TREE_DATAMOVE(b->child_ids, a->child_ids + a->header.size - num,
-			  num, b, a);
+	bps_tree_move_children(b, num, b, 0, b->header.size);
+	bps_tree_move_children(b, 0, a, a->header.size - num, num);
 
 	if (!move_to_empty)
 		BPS_TREE_DATAMOVE(b->elems + num, b->elems,
@@ -2717,10 +3098,8 @@ bps_tree_move_elems_to_left_inner(struct bps_tree *tree,
 	assert(b->header.size >= num);
 	assert(a->header.size + num <= BPS_TREE_MAX_COUNT_IN_INNER);
 
-	BPS_TREE_DATAMOVE(a->child_ids + a->header.size, b->child_ids,
-			  num, a, b);
-	BPS_TREE_DATAMOVE(b->child_ids, b->child_ids + num,
-			  b->header.size - num, b, b);
+	bps_tree_move_children(a, a->header.size, b, 0, num);
+	bps_tree_move_children(b, 0, b, num, b->header.size - num);
 
 	if (!move_to_empty)
 		a->elems[a->header.size - 1] =
@@ -2820,7 +3199,7 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 		struct bps_inner_path_elem *a_inner_path_elem,
 		struct bps_inner_path_elem *b_inner_path_elem,
 		bps_tree_pos_t num, bps_tree_block_id_t block_id,
-		bps_tree_pos_t pos, bps_tree_elem_t max_elem)
+		bps_tree_pos_t pos, bps_tree_elem_t max_elem, size_t count)
 {
 	/* exclusive behaviuor for debug checks */
 	if (tree->root_id != (bps_tree_block_id_t) -1) {
@@ -2841,8 +3220,7 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 	assert(pos >= 0);
 
 	if (!move_to_empty) {
-		BPS_TREE_DATAMOVE(b->child_ids + num, b->child_ids,
-				  b->header.size, b, b);
+		bps_tree_move_children(b, num, b, 0, b->header.size);
 		BPS_TREE_DATAMOVE(b->elems + num, b->elems,
 				  b->header.size - 1, b, b);
 	}
@@ -2850,12 +3228,9 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 	bps_tree_pos_t mid_part_size = a->header.size - pos;
 	if (mid_part_size > num) {
 		/* In fact insert to 'a' block, to the internal position */
-		BPS_TREE_DATAMOVE(b->child_ids,
-				  a->child_ids + a->header.size - num,
-				  num, b, a);
-		BPS_TREE_DATAMOVE(a->child_ids + pos + 1, a->child_ids + pos,
-				  mid_part_size - num, a, a);
-		a->child_ids[pos] = block_id;
+		bps_tree_move_children(b, 0, a, a->header.size - num, num);
+		bps_tree_move_children(a, pos + 1, a, pos, mid_part_size - num);
+		bps_tree_set_child(a, pos, block_id, count);
 
 		BPS_TREE_DATAMOVE(b->elems, a->elems + a->header.size - num,
 				  num - 1, b, a);
@@ -2872,12 +3247,9 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 		a->elems[pos] = max_elem;
 	} else if (mid_part_size == num) {
 		/* In fact insert to 'a' block, to the last position */
-		BPS_TREE_DATAMOVE(b->child_ids,
-				  a->child_ids + a->header.size - num,
-				  num, b, a);
-		BPS_TREE_DATAMOVE(a->child_ids + pos + 1, a->child_ids + pos,
-				  mid_part_size - num, a, a);
-		a->child_ids[pos] = block_id;
+		bps_tree_move_children(b, 0, a, a->header.size - num, num);
+		bps_tree_move_children(a, pos + 1, a, pos, mid_part_size - num);
+		bps_tree_set_child(a, pos, block_id, count);
 
 		BPS_TREE_DATAMOVE(b->elems, a->elems + a->header.size - num,
 				  num - 1, b, a);
@@ -2891,12 +3263,10 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 	} else {
 		/* In fact insert to 'b' block */
 		bps_tree_pos_t new_pos = num - mid_part_size - 1;/* Can be 0 */
-		BPS_TREE_DATAMOVE(b->child_ids,
-				  a->child_ids + a->header.size - num + 1,
-				  new_pos, b, a);
-		b->child_ids[new_pos] = block_id;
-		BPS_TREE_DATAMOVE(b->child_ids + new_pos + 1,
-				  a->child_ids + pos, mid_part_size, b, a);
+		bps_tree_move_children(b, 0, a, a->header.size - num + 1,
+				       new_pos);
+		bps_tree_set_child(b, new_pos, block_id, count);
+		bps_tree_move_children(b, new_pos + 1, a, pos, mid_part_size);
 
 		if (pos == a->header.size) {
 			/* +1 */
@@ -3023,7 +3393,7 @@ bps_tree_insert_and_move_elems_to_left_inner(struct bps_tree *tree,
 		struct bps_inner_path_elem *a_inner_path_elem,
 		struct bps_inner_path_elem *b_inner_path_elem, bps_tree_pos_t num,
 		bps_tree_block_id_t block_id, bps_tree_pos_t pos,
-		bps_tree_elem_t max_elem)
+		bps_tree_elem_t max_elem, size_t count)
 {
 	/* exclusive behaviuor for debug checks */
 	if (tree->root_id != (bps_tree_block_id_t) -1) {
@@ -3046,14 +3416,11 @@ bps_tree_insert_and_move_elems_to_left_inner(struct bps_tree *tree,
 	if (pos >= num) {
 		/* In fact insert to 'b' block */
 		bps_tree_pos_t new_pos = pos - num; /* Can be 0 */
-		BPS_TREE_DATAMOVE(a->child_ids + a->header.size, b->child_ids,
-				  num, a, b);
-		BPS_TREE_DATAMOVE(b->child_ids, b->child_ids + num,
-				  new_pos, b, b);
-		b->child_ids[new_pos] = block_id;
-		BPS_TREE_DATAMOVE(b->child_ids + new_pos + 1,
-				  b->child_ids + pos,
-				  b->header.size - pos, b, b);
+		bps_tree_move_children(a, a->header.size, b, 0, num);
+		bps_tree_move_children(b, 0, b, num, new_pos);
+		bps_tree_set_child(b, new_pos, block_id, count);
+		bps_tree_move_children(b, new_pos + 1, b, pos,
+				       b->header.size - pos);
 
 		if (!move_to_empty)
 			a->elems[a->header.size - 1] =
@@ -3087,14 +3454,12 @@ bps_tree_insert_and_move_elems_to_left_inner(struct bps_tree *tree,
 	} else {
 		/* In fact insert to 'a' block */
 		bps_tree_pos_t new_pos = a->header.size + pos; /* Can be 0 */
-		BPS_TREE_DATAMOVE(a->child_ids + a->header.size,
-				  b->child_ids, pos, a, b);
-		a->child_ids[new_pos] = block_id;
-		BPS_TREE_DATAMOVE(a->child_ids + new_pos + 1,
-				  b->child_ids + pos, num - 1 - pos, a, b);
+		bps_tree_move_children(a, a->header.size, b, 0, pos);
+		bps_tree_set_child(a, new_pos, block_id, count);
+		bps_tree_move_children(a, new_pos + 1, b, pos, num - 1 - pos);
 		if (!move_all)
-			BPS_TREE_DATAMOVE(b->child_ids, b->child_ids + num - 1,
-					  b->header.size - num + 1, b, b);
+			bps_tree_move_children(b, 0, b, num - 1,
+					       b->header.size - num + 1);
 
 		if (!move_to_empty)
 			a->elems[a->header.size - 1] =
@@ -3332,7 +3697,7 @@ static int
 bps_tree_process_insert_inner(struct bps_tree *tree,
 			      struct bps_inner_path_elem *inner_path_elem,
 			      bps_tree_block_id_t block_id, bps_tree_pos_t pos,
-			      bps_tree_elem_t max_elem);
+			      bps_tree_elem_t max_elem, size_t count);
 
 /**
  * Basic inserted into leaf, dealing with spliting, merging and moving data
@@ -3345,6 +3710,7 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 			     bps_tree_block_id_t *inserted_in_block,
 			     bps_tree_pos_t *inserted_in_pos)
 {
+	bps_tree_add_path_count(tree, leaf_path_elem, 1);
 	if (bps_tree_leaf_free_size(leaf_path_elem->block)) {
 		bps_tree_insert_into_leaf(tree, leaf_path_elem, new_elem);
 		BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x0);
@@ -3376,6 +3742,7 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 				bps_tree_insert_and_move_elems_to_left_leaf(tree,
 					&left_ext, leaf_path_elem,
 					move_count, new_elem);
+			bps_tree_update_counts_leaf(tree, leaf_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x1);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3387,6 +3754,7 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 				bps_tree_insert_and_move_elems_to_right_leaf(tree,
 					leaf_path_elem, &right_ext,
 					move_count, new_elem);
+			bps_tree_update_counts_leaf(tree, leaf_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x2);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3400,6 +3768,7 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 				bps_tree_insert_and_move_elems_to_left_leaf(tree,
 					&left_ext, leaf_path_elem,
 					move_count, new_elem);
+			bps_tree_update_counts_leaf(tree, leaf_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x3);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3419,6 +3788,7 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 				bps_tree_insert_and_move_elems_to_left_leaf(tree,
 					&left_ext, leaf_path_elem,
 					move_count, new_elem);
+			bps_tree_update_counts_leaf(tree, leaf_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x4);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3432,6 +3802,7 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 				bps_tree_insert_and_move_elems_to_right_leaf(tree,
 					leaf_path_elem, &right_ext,
 					move_count, new_elem);
+			bps_tree_update_counts_leaf(tree, leaf_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x5);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3451,6 +3822,7 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 				bps_tree_insert_and_move_elems_to_right_leaf(tree,
 					leaf_path_elem, &right_ext,
 					move_count, new_elem);
+			bps_tree_update_counts_leaf(tree, leaf_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0x6);
 			*inserted_in_block = inserted_ext->block_id;
 			*inserted_in_pos = inserted_ext->insertion_point;
@@ -3459,6 +3831,7 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 	}
 
 	if (!bps_tree_reserve_blocks(tree, tree->depth + 1)) {
+		bps_tree_add_path_count(tree, leaf_path_elem, -1);
 		return -1;
 	}
 	bps_tree_block_id_t new_block_id = (bps_tree_block_id_t)(-1);
@@ -3702,8 +4075,10 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 		struct bps_inner *new_root = bps_tree_create_inner(tree,
 				&new_root_id);
 		new_root->header.size = 2;
-		new_root->child_ids[0] = tree->root_id;
-		new_root->child_ids[1] = new_block_id;
+		bps_tree_set_child(new_root, 0, tree->root_id,
+				   leaf_path_elem->block->header.size);
+		bps_tree_set_child(new_root, 1, new_block_id,
+				   new_leaf->header.size);
 		new_root->elems[0] = tree->max_elem;
 		tree->root_id = new_root_id;
 		tree->max_elem = new_max_elem;
@@ -3717,10 +4092,11 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 	*inserted_in_block = inserted_ext->block_id;
 	*inserted_in_pos = inserted_ext->insertion_point;
 	assert(leaf_path_elem->parent);
+	bps_tree_update_counts_leaf(tree, leaf_path_elem);
 	BPS_TREE_BRANCH_TRACE(tree, insert_leaf, 1 << 0xD);
 	return bps_tree_process_insert_inner(tree, leaf_path_elem->parent,
 			new_block_id, new_path_elem.pos_in_parent,
-			new_max_elem);
+			new_max_elem, new_leaf->header.size);
 }
 
 /**
@@ -3731,11 +4107,12 @@ static inline int
 bps_tree_process_insert_inner(struct bps_tree *tree,
 			      struct bps_inner_path_elem *inner_path_elem,
 			      bps_tree_block_id_t block_id,
-			      bps_tree_pos_t pos, bps_tree_elem_t max_elem)
+			      bps_tree_pos_t pos, bps_tree_elem_t max_elem,
+			      size_t count)
 {
 	if (bps_tree_inner_free_size(inner_path_elem->block)) {
 		bps_tree_insert_into_inner(tree, inner_path_elem,
-					   block_id, pos, max_elem);
+					   block_id, pos, max_elem, count);
 		BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x0);
 		return 0;
 	}
@@ -3758,7 +4135,8 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 				bps_tree_inner_free_size(left_ext.block) / 2;
 			bps_tree_insert_and_move_elems_to_left_inner(tree,
 					&left_ext, inner_path_elem, move_count,
-					block_id, pos, max_elem);
+					block_id, pos, max_elem, count);
+			bps_tree_update_counts_inner(tree, inner_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x1);
 			return 0;
 		} else if (bps_tree_inner_free_size(right_ext.block) > 0) {
@@ -3766,7 +4144,9 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 				bps_tree_inner_free_size(right_ext.block) / 2;
 			bps_tree_insert_and_move_elems_to_right_inner(tree,
 					inner_path_elem, &right_ext,
-					move_count, block_id, pos, max_elem);
+					move_count, block_id, pos, max_elem,
+					count);
+			bps_tree_update_counts_inner(tree, inner_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x2);
 			return 0;
 		}
@@ -3776,7 +4156,9 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 				bps_tree_inner_free_size(left_ext.block) / 2;
 			bps_tree_insert_and_move_elems_to_left_inner(tree,
 					&left_ext, inner_path_elem,
-					move_count, block_id, pos, max_elem);
+					move_count, block_id, pos, max_elem,
+					count);
+			bps_tree_update_counts_inner(tree, inner_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x3);
 			return 0;
 		}
@@ -3792,7 +4174,8 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 			move_count = 1 + move_count / 2;
 			bps_tree_insert_and_move_elems_to_left_inner(tree,
 					&left_ext, inner_path_elem, move_count,
-					block_id, pos, max_elem);
+					block_id, pos, max_elem, count);
+			bps_tree_update_counts_inner(tree, inner_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x4);
 			return 0;
 		}
@@ -3802,7 +4185,9 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 				bps_tree_inner_free_size(right_ext.block) / 2;
 			bps_tree_insert_and_move_elems_to_right_inner(tree,
 					inner_path_elem, &right_ext,
-					move_count, block_id, pos, max_elem);
+					move_count, block_id, pos, max_elem,
+					count);
+			bps_tree_update_counts_inner(tree, inner_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x5);
 			return 0;
 		}
@@ -3818,7 +4203,9 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 			move_count = 1 + move_count / 2;
 			bps_tree_insert_and_move_elems_to_right_inner(tree,
 					inner_path_elem, &right_ext,
-					move_count, block_id, pos, max_elem);
+					move_count, block_id, pos, max_elem,
+					count);
+			bps_tree_update_counts_inner(tree, inner_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0x6);
 			return 0;
 		}
@@ -3858,7 +4245,7 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 
 		bps_tree_insert_and_move_elems_to_right_inner(tree,
 				inner_path_elem, &new_path_elem,
-				mc1, block_id, pos, max_elem);
+				mc1, block_id, pos, max_elem, count);
 		bps_tree_move_elems_to_right_inner(tree,
 				&left_ext, inner_path_elem, mc2);
 		bps_tree_move_elems_to_left_inner(tree,
@@ -3893,7 +4280,7 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 
 		bps_tree_insert_and_move_elems_to_right_inner(tree,
 				inner_path_elem, &new_path_elem,
-				mc1, block_id, pos, max_elem);
+				mc1, block_id, pos, max_elem, count);
 		bps_tree_move_elems_to_right_inner(tree,
 				&left_ext, inner_path_elem, mc2);
 		bps_tree_move_elems_to_right_inner(tree,
@@ -3927,7 +4314,7 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 
 		bps_tree_insert_and_move_elems_to_right_inner(tree,
 				inner_path_elem, &new_path_elem,
-				mc1, block_id, pos, max_elem);
+				mc1, block_id, pos, max_elem, count);
 		bps_tree_move_elems_to_left_inner(tree,
 				&new_path_elem, &right_ext, mc2);
 		bps_tree_move_elems_to_left_inner(tree,
@@ -3959,7 +4346,7 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 
 		bps_tree_insert_and_move_elems_to_right_inner(tree,
 				inner_path_elem, &new_path_elem,
-				mc1, block_id, pos, max_elem);
+				mc1, block_id, pos, max_elem, count);
 		bps_tree_move_elems_to_right_inner(tree,
 				&left_ext, inner_path_elem, mc2);
 
@@ -3988,7 +4375,7 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 
 		bps_tree_insert_and_move_elems_to_right_inner(tree,
 				inner_path_elem, &new_path_elem,
-				mc1, block_id, pos, max_elem);
+				mc1, block_id, pos, max_elem, count);
 		bps_tree_move_elems_to_left_inner(tree,
 				&new_path_elem, &right_ext, mc2);
 
@@ -4016,14 +4403,16 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 
 		bps_tree_insert_and_move_elems_to_right_inner(tree,
 				inner_path_elem, &new_path_elem,
-				mc1, block_id, pos, max_elem);
+				mc1, block_id, pos, max_elem, count);
 
 		bps_tree_block_id_t new_root_id = (bps_tree_block_id_t)(-1);
 		struct bps_inner *new_root =
 			bps_tree_create_inner(tree, &new_root_id);
 		new_root->header.size = 2;
-		new_root->child_ids[0] = tree->root_id;
-		new_root->child_ids[1] = new_block_id;
+		bps_tree_set_child(new_root, 0, tree->root_id,
+			bps_tree_inner_count(inner_path_elem->block));
+		bps_tree_set_child(new_root, 1, new_block_id,
+			bps_tree_inner_count(new_inner));
 		new_root->elems[0] = tree->max_elem;
 		tree->root_id = new_root_id;
 		tree->max_elem = new_max_elem;
@@ -4032,10 +4421,11 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 		return 0;
 	}
 	assert(inner_path_elem->parent);
+	bps_tree_update_counts_inner(tree, inner_path_elem);
 	BPS_TREE_BRANCH_TRACE(tree, insert_inner, 1 << 0xD);
 	return bps_tree_process_insert_inner(tree, inner_path_elem->parent,
 			new_block_id, new_path_elem.pos_in_parent,
-			new_max_elem);
+			new_max_elem, bps_tree_inner_count(new_inner));
 }
 
 /**
@@ -4053,6 +4443,7 @@ static inline void
 bps_tree_process_delete_leaf(struct bps_tree *tree,
 			     struct bps_leaf_path_elem *leaf_path_elem)
 {
+	bps_tree_add_path_count(tree, leaf_path_elem, -1);
 	bps_tree_delete_from_leaf(tree, leaf_path_elem);
 
 	if (leaf_path_elem->block->header.size >=
@@ -4082,6 +4473,7 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 				bps_tree_leaf_overmin_size(left_ext.block) / 2;
 			bps_tree_move_elems_to_right_leaf(tree, &left_ext,
 					leaf_path_elem, move_count);
+			bps_tree_update_counts_leaf(tree, leaf_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x1);
 			return;
 		} else if (bps_tree_leaf_overmin_size(right_ext.block) > 0) {
@@ -4089,6 +4481,7 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 				bps_tree_leaf_overmin_size(right_ext.block) / 2;
 			bps_tree_move_elems_to_left_leaf(tree, leaf_path_elem,
 					&right_ext, move_count);
+			bps_tree_update_counts_leaf(tree, leaf_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x2);
 			return;
 		}
@@ -4098,6 +4491,7 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 				bps_tree_leaf_overmin_size(left_ext.block) / 2;
 			bps_tree_move_elems_to_right_leaf(tree, &left_ext,
 					leaf_path_elem, move_count);
+			bps_tree_update_counts_leaf(tree, leaf_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x3);
 			return;
 		}
@@ -4113,6 +4507,7 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 					leaf_path_elem, move_count1);
 			bps_tree_move_elems_to_right_leaf(tree, &left_left_ext,
 					&left_ext, move_count2);
+			bps_tree_update_counts_leaf(tree, leaf_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x4);
 			return;
 		}
@@ -4123,6 +4518,7 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 				/ 2;
 			bps_tree_move_elems_to_left_leaf(tree, leaf_path_elem,
 					&right_ext, move_count);
+			bps_tree_update_counts_leaf(tree, leaf_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x5);
 			return;
 		}
@@ -4138,6 +4534,7 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 					&right_ext, move_count1);
 			bps_tree_move_elems_to_left_leaf(tree, &right_ext,
 					&right_right_ext, move_count2);
+			bps_tree_update_counts_leaf(tree, leaf_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, delete_leaf, 1 << 0x6);
 			return;
 		}
@@ -4208,6 +4605,7 @@ bps_tree_process_delete_leaf(struct bps_tree *tree,
 		return;
 	}
 
+	bps_tree_update_counts_leaf(tree, leaf_path_elem);
 	assert(leaf_path_elem->block->header.size == 0);
 
 	struct bps_leaf *leaf = (struct bps_leaf*)leaf_path_elem->block;
@@ -4269,6 +4667,7 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 				/ 2;
 			bps_tree_move_elems_to_right_inner(tree, &left_ext,
 					inner_path_elem, move_count);
+			bps_tree_update_counts_inner(tree, inner_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x1);
 			return;
 		} else if (bps_tree_inner_overmin_size(right_ext.block) > 0) {
@@ -4278,6 +4677,7 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 			bps_tree_move_elems_to_left_inner(tree,
 					inner_path_elem, &right_ext,
 					move_count);
+			bps_tree_update_counts_inner(tree, inner_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x2);
 			return;
 		}
@@ -4288,6 +4688,7 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 				/ 2;
 			bps_tree_move_elems_to_right_inner(tree, &left_ext,
 					inner_path_elem, move_count);
+			bps_tree_update_counts_inner(tree, inner_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x3);
 			return;
 		}
@@ -4304,6 +4705,7 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 					inner_path_elem, move_count1);
 			bps_tree_move_elems_to_right_inner(tree,
 					&left_left_ext, &left_ext, move_count2);
+			bps_tree_update_counts_inner(tree, inner_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x4);
 			return;
 		}
@@ -4315,6 +4717,7 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 			bps_tree_move_elems_to_left_inner(tree,
 					inner_path_elem, &right_ext,
 					move_count);
+			bps_tree_update_counts_inner(tree, inner_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x5);
 			return;
 		}
@@ -4331,6 +4734,7 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 					&right_ext, move_count1);
 			bps_tree_move_elems_to_left_inner(tree, &right_ext,
 					&right_right_ext, move_count2);
+			bps_tree_update_counts_inner(tree, inner_path_elem);
 			BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0x6);
 			return;
 		}
@@ -4400,6 +4804,7 @@ bps_tree_process_delete_inner(struct bps_tree *tree,
 		BPS_TREE_BRANCH_TRACE(tree, delete_inner, 1 << 0xF);
 		return;
 	}
+	bps_tree_update_counts_inner(tree, inner_path_elem);
 	assert(inner_path_elem->block->header.size == 0);
 
 	bps_tree_dispose_inner(tree, inner_path_elem->block,
@@ -4619,13 +5024,20 @@ bps_tree_debug_check_block(const struct bps_tree *tree, struct bps_block *block,
 				result |= 0x4000000;
 		}
 
-		for (bps_tree_pos_t i = 0; i < block->size; i++)
+		for (bps_tree_pos_t i = 0; i < block->size; i++) {
+			size_t prev_calc_count = *calc_count;
 			result |= bps_tree_debug_check_block(tree,
 				bps_tree_restore_block(tree,
 						       inner->child_ids[i]),
 				inner->child_ids[i], level - 1, calc_count,
 				expected_prev_id, expected_this_id,
 				check_fullness_next);
+#ifdef BPS_TREE_CHILD_COUNTS
+			if (inner->child_counts[i] !=
+			    *calc_count - prev_calc_count)
+				result |= 0x8000000;
+#endif
+		}
 		return result;
 	}
 }
@@ -5429,7 +5841,7 @@ bps_tree_debug_check_insert_into_inner(struct bps_tree *tree, bool assertme)
 
 			bps_tree_insert_into_inner(tree, &path_elem,
 				(bps_tree_block_id_t) j, (bps_tree_pos_t) j,
-				ins);
+				ins, 0);
 
 			for (unsigned int k = 0; k <= i; k++) {
 				if (bps_tree_debug_get_elem_inner(&path_elem, k)
@@ -5784,7 +6196,7 @@ bps_tree_debug_check_insert_and_move_to_right_inner(struct bps_tree *tree,
 						tree, &a_path_elem,
 						&b_path_elem,
 						(bps_tree_pos_t) u, ikk,
-						(bps_tree_pos_t) k, ins);
+						(bps_tree_pos_t) k, ins, 0);
 
 					if (a.header.size
 						!= (bps_tree_pos_t) (i - u + 1)) {
@@ -5911,7 +6323,7 @@ bps_tree_debug_check_insert_and_move_to_left_inner(struct bps_tree *tree,
 						tree, &a_path_elem,
 						&b_path_elem,
 						(bps_tree_pos_t) u, ikk,
-						(bps_tree_pos_t) k, ins);
+						(bps_tree_pos_t) k, ins, 0);
 
 					if (a.header.size
 						!= (bps_tree_pos_t) (i + u)) {
@@ -6038,6 +6450,9 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_lower_bound_elem
 #undef bps_tree_upper_bound_elem
 #undef bps_tree_approximate_count
+#undef bps_tree_lower_bound_get_offset
+#undef bps_tree_upper_bound_get_offset
+#undef bps_tree_iterator_at
 #undef bps_tree_iterator_get_elem
 #undef bps_tree_iterator_next
 #undef bps_tree_iterator_prev
@@ -6076,8 +6491,14 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_collect_path
 #undef bps_tree_touch_leaf_path_max_elem
 #undef bps_tree_touch_path
+#undef bps_tree_inner_count
+#undef bps_tree_add_path_count
+#undef bps_tree_update_counts_leaf
+#undef bps_tree_update_counts_inner
 #undef bps_tree_process_replace
 #undef bps_tree_debug_memmove
+#undef bps_tree_move_children
+#undef bps_tree_set_child
 #undef bps_tree_insert_into_leaf
 #undef bps_tree_insert_into_inner
 #undef bps_tree_delete_from_leaf
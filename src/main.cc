@@ -443,6 +443,15 @@ load_cfg()
 	if (background)
 		daemonize();
 
+	/*
+	 * The logger thread must be started after daemonizing,
+	 * because threads don't survive fork().
+	 */
+	if (cfg_geti("log_async") &&
+	    say_logger_async_start(say_overflow_by_name(
+			cfg_gets("log_async_overflow"))) != 0)
+		say_syserror("failed to start the logger thread");
+
 	/*
 	 * after (optional) daemonising to avoid confusing messages with
 	 * different pids
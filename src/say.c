@@ -29,7 +29,9 @@
  * SUCH DAMAGE.
  */
 #include "say.h"
+#include "trivia/config.h"
 #include "fiber.h"
+#include "tt_pthread.h"
 
 #include <errno.h>
 #include <stdarg.h>
@@ -42,6 +44,10 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <arpa/inet.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <pmatomic.h>
+#include <small/rlist.h>
 
 pid_t log_pid = 0;
 int log_level = S_INFO;
@@ -71,6 +77,14 @@ say_logger_syslog(int level, const char *filename, int line, const char *error,
 static enum say_logger_type logger_type = SAY_LOGGER_BOOT;
 sayfunc_t _say = say_logger_boot;
 
+/** Set if messages are written by the logger thread. */
+static bool logger_async = false;
+
+static void
+say_async_write(const char *msg, int len);
+static void
+say_async_stop(void);
+
 static const char level_chars[] = {
 	[S_FATAL] = 'F',
 	[S_SYSERROR] = '!',
@@ -434,6 +448,8 @@ say_logger_init(const char *init_str, int level, int nonblock, const char *forma
 void
 say_logger_free()
 {
+	if (logger_async)
+		say_async_stop();
 	if (logger_type == SAY_LOGGER_SYSLOG && log_fd != -1)
 		close(log_fd);
 	free(syslog_ident);
@@ -722,7 +738,14 @@ say_logger_file(int level, const char *filename, int line, const char *error,
 			unreachable();
 	}
 	assert(total >= 0);
-	(void) write(log_fd, buf, total);
+	/*
+	 * Fatal errors are followed by exit(), so they are
+	 * written directly to make sure they reach the log.
+	 */
+	if (logger_async && level != S_FATAL)
+		say_async_write(buf, total);
+	else
+		(void) write(log_fd, buf, total);
 	/* Log fatal errors to STDERR */
 	if (level == S_FATAL && log_fd != STDERR_FILENO)
 		(void) write(STDERR_FILENO, buf, total);
@@ -781,6 +804,381 @@ say_logger_syslog(int level, const char *filename, int line, const char *error,
 
 /** Loggers }}} */
 
+/** {{{ Asynchronous logger */
+
+enum {
+	/**
+	 * Size of a per-thread ring buffer, must be a power of 2
+	 * and fit the largest message (SAY_BUF_LEN_MAX).
+	 */
+	SAY_RING_SIZE = 128 * 1024,
+	/**
+	 * How long the logger thread sleeps if there's nothing
+	 * to write, in milliseconds.
+	 */
+	SAY_ASYNC_IDLE_TIMEOUT = 100,
+};
+
+/**
+ * Single producer single consumer ring buffer of formatted
+ * log messages. It is filled by the thread that owns it and
+ * drained by the logger thread. The producer publishes only
+ * whole messages, so messages of different threads are never
+ * interleaved in the log.
+ */
+struct say_ring {
+	/** Link in say_async::rings or say_async::new_rings. */
+	struct rlist in_rings;
+	/**
+	 * Number of bytes ever written to the ring. Updated
+	 * by the producer only.
+	 */
+	alignas(CACHELINE_SIZE) uint64_t head;
+	/**
+	 * Number of bytes ever written to the log from the ring.
+	 * Updated by the logger thread only.
+	 */
+	alignas(CACHELINE_SIZE) uint64_t tail;
+	/**
+	 * Set when the owner thread exits. The logger thread
+	 * frees an orphan ring as soon as it is drained.
+	 */
+	bool is_orphan;
+	/** Message data. */
+	char data[SAY_RING_SIZE];
+};
+
+static const char *say_overflow_strs[] = {
+	[SAY_OVERFLOW_DROP] = "drop",
+	[SAY_OVERFLOW_BLOCK] = "block",
+	[say_overflow_MAX] = "unknown"
+};
+
+enum say_overflow
+say_overflow_by_name(const char *name)
+{
+	return STR2ENUM(say_overflow, name);
+}
+
+static struct {
+	/** The logger thread. */
+	pthread_t thread;
+	/** Protects new_rings and is used for wakeups. */
+	pthread_mutex_t mutex;
+	/** Signalled to wake up the logger thread. */
+	pthread_cond_t cond;
+	/** Signalled when the logger thread frees space. */
+	pthread_cond_t space_cond;
+	/** Used to detect exit of a ring owner thread. */
+	pthread_key_t ring_key;
+	/** Rings created since the last logger thread pass. */
+	struct rlist new_rings;
+	/** Rings drained by the logger thread, private to it. */
+	struct rlist rings;
+	/** What to do if a ring buffer is full. */
+	enum say_overflow overflow;
+	/** Set when the logger thread waits for messages. */
+	bool is_idle;
+	/** Set to stop the logger thread. */
+	bool is_stopping;
+	/** Number of threads waiting for space in their rings. */
+	int waiters;
+	/** Number of messages dropped due to overflow. */
+	int64_t dropped;
+} say_async;
+
+/** Ring buffer of the current thread. */
+static __thread struct say_ring *say_ring;
+
+/** Thread-specific data destructor, called on thread exit. */
+static void
+say_ring_orphan(void *arg)
+{
+	struct say_ring *ring = (struct say_ring *)arg;
+	pm_atomic_store(&ring->is_orphan, true);
+}
+
+/**
+ * Get the ring buffer of the current thread, create it
+ * on the first call.
+ */
+static struct say_ring *
+say_ring_get(void)
+{
+	if (say_ring != NULL)
+		return say_ring;
+	struct say_ring *ring = (struct say_ring *)malloc(sizeof(*ring));
+	if (ring == NULL)
+		return NULL;
+	ring->head = 0;
+	ring->tail = 0;
+	ring->is_orphan = false;
+	if (pthread_setspecific(say_async.ring_key, ring) != 0) {
+		free(ring);
+		return NULL;
+	}
+	tt_pthread_mutex_lock(&say_async.mutex);
+	rlist_add_tail_entry(&say_async.new_rings, ring, in_rings);
+	tt_pthread_mutex_unlock(&say_async.mutex);
+	say_ring = ring;
+	return ring;
+}
+
+/** Wake up the logger thread if it sleeps. */
+static void
+say_async_wakeup(void)
+{
+	tt_pthread_mutex_lock(&say_async.mutex);
+	tt_pthread_cond_signal(&say_async.cond);
+	tt_pthread_mutex_unlock(&say_async.mutex);
+}
+
+/**
+ * Wait until the logger thread frees @a len bytes
+ * in the ring of the current thread.
+ */
+static void
+say_ring_wait(struct say_ring *ring, int len)
+{
+	tt_pthread_mutex_lock(&say_async.mutex);
+	pm_atomic_fetch_add(&say_async.waiters, 1);
+	tt_pthread_cond_signal(&say_async.cond);
+	while (ring->head - pm_atomic_load(&ring->tail) + len >
+	       SAY_RING_SIZE && !say_async.is_stopping)
+		tt_pthread_cond_wait(&say_async.space_cond, &say_async.mutex);
+	pm_atomic_fetch_sub(&say_async.waiters, 1);
+	tt_pthread_mutex_unlock(&say_async.mutex);
+}
+
+/** Put a formatted message to the ring of the current thread. */
+static void
+say_async_write(const char *msg, int len)
+{
+	struct say_ring *ring = say_ring_get();
+	if (ring == NULL) {
+		(void) write(log_fd, msg, len);
+		return;
+	}
+	uint64_t head = ring->head;
+	if (head - pm_atomic_load(&ring->tail) + len > SAY_RING_SIZE) {
+		if (say_async.overflow == SAY_OVERFLOW_DROP) {
+			pm_atomic_fetch_add(&say_async.dropped, 1);
+			return;
+		}
+		say_ring_wait(ring, len);
+	}
+	size_t begin = head & (SAY_RING_SIZE - 1);
+	size_t first = MIN((size_t)len, SAY_RING_SIZE - begin);
+	memcpy(ring->data + begin, msg, first);
+	memcpy(ring->data, msg + first, len - first);
+	/*
+	 * Both the head update and the idle flag check are
+	 * sequentially consistent, so either we see the logger
+	 * thread idle or it sees the new message before going
+	 * to sleep.
+	 */
+	pm_atomic_store(&ring->head, head + len);
+	if (pm_atomic_load(&say_async.is_idle))
+		say_async_wakeup();
+}
+
+/**
+ * Write all messages published in a ring to the log.
+ * @retval true if there was something to write
+ */
+static bool
+say_ring_flush(struct say_ring *ring)
+{
+	uint64_t head = pm_atomic_load(&ring->head);
+	uint64_t tail = ring->tail;
+	if (head == tail)
+		return false;
+	size_t begin = tail & (SAY_RING_SIZE - 1);
+	size_t len = head - tail;
+	struct iovec iov[2];
+	int iovcnt = 1;
+	iov[0].iov_base = ring->data + begin;
+	iov[0].iov_len = MIN(len, SAY_RING_SIZE - begin);
+	if (iov[0].iov_len < len) {
+		iov[1].iov_base = ring->data;
+		iov[1].iov_len = len - iov[0].iov_len;
+		iovcnt = 2;
+	}
+	struct iovec *iovp = iov;
+	while (iovcnt > 0) {
+		ssize_t n = writev(log_fd, iovp, iovcnt);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			/* Nothing we can do, skip the data. */
+			break;
+		}
+		while (iovcnt > 0 && (size_t)n >= iovp->iov_len) {
+			n -= iovp->iov_len;
+			iovp++;
+			iovcnt--;
+		}
+		if (iovcnt > 0) {
+			iovp->iov_base = (char *)iovp->iov_base + n;
+			iovp->iov_len -= n;
+		}
+	}
+	pm_atomic_store(&ring->tail, head);
+	return true;
+}
+
+/**
+ * Drain all rings and free the ones whose owner has exited.
+ * @retval true if anything was written
+ */
+static bool
+say_async_flush(void)
+{
+	tt_pthread_mutex_lock(&say_async.mutex);
+	rlist_splice(&say_async.rings, &say_async.new_rings);
+	tt_pthread_mutex_unlock(&say_async.mutex);
+
+	bool written = false;
+	struct say_ring *ring, *tmp;
+	rlist_foreach_entry_safe(ring, &say_async.rings, in_rings, tmp) {
+		bool is_orphan = pm_atomic_load(&ring->is_orphan);
+		if (say_ring_flush(ring))
+			written = true;
+		if (is_orphan) {
+			rlist_del_entry(ring, in_rings);
+			free(ring);
+		}
+	}
+	if (written && pm_atomic_load(&say_async.waiters) > 0) {
+		tt_pthread_mutex_lock(&say_async.mutex);
+		tt_pthread_cond_broadcast(&say_async.space_cond);
+		tt_pthread_mutex_unlock(&say_async.mutex);
+	}
+	return written;
+}
+
+/** Check if any ring has messages to write. */
+static bool
+say_async_has_data(void)
+{
+	if (!rlist_empty(&say_async.new_rings))
+		return true;
+	struct say_ring *ring;
+	rlist_foreach_entry(ring, &say_async.rings, in_rings) {
+		if (pm_atomic_load(&ring->head) != ring->tail)
+			return true;
+	}
+	return false;
+}
+
+/** Logger thread function. */
+static void *
+say_async_f(void *arg)
+{
+	(void) arg;
+	tt_pthread_setname("log");
+	while (true) {
+		bool is_stopping = pm_atomic_load(&say_async.is_stopping);
+		/*
+		 * Don't sleep while there are messages, so that
+		 * a burst is written out with the least latency.
+		 */
+		if (say_async_flush())
+			continue;
+		if (is_stopping)
+			break;
+		tt_pthread_mutex_lock(&say_async.mutex);
+		pm_atomic_store(&say_async.is_idle, true);
+		if (!say_async_has_data() && !say_async.is_stopping) {
+			struct timespec deadline;
+			clock_gettime(CLOCK_REALTIME, &deadline);
+			deadline.tv_nsec += SAY_ASYNC_IDLE_TIMEOUT * 1000000;
+			deadline.tv_sec += deadline.tv_nsec / 1000000000;
+			deadline.tv_nsec %= 1000000000;
+			tt_pthread_cond_timedwait(&say_async.cond,
+						  &say_async.mutex, &deadline);
+		}
+		pm_atomic_store(&say_async.is_idle, false);
+		tt_pthread_mutex_unlock(&say_async.mutex);
+	}
+	return NULL;
+}
+
+/**
+ * The logger thread doesn't exist in a forked child,
+ * write messages directly there.
+ */
+static void
+say_async_atfork_child(void)
+{
+	logger_async = false;
+}
+
+int
+say_logger_async_start(enum say_overflow overflow)
+{
+	assert(overflow < say_overflow_MAX);
+	assert(!logger_async);
+	if (logger_type != SAY_LOGGER_FILE && logger_type != SAY_LOGGER_PIPE)
+		return 0;
+	/*
+	 * The logger thread is the only one that writes to
+	 * the log so there's no point in non-blocking writes.
+	 */
+	logger_nonblock = 0;
+	int flags = fcntl(log_fd, F_GETFL, 0);
+	if (flags >= 0 && (flags & O_NONBLOCK) != 0)
+		(void) fcntl(log_fd, F_SETFL, flags & ~O_NONBLOCK);
+
+	say_async.overflow = overflow;
+	rlist_create(&say_async.new_rings);
+	rlist_create(&say_async.rings);
+	tt_pthread_mutex_init(&say_async.mutex, NULL);
+	tt_pthread_cond_init(&say_async.cond, NULL);
+	tt_pthread_cond_init(&say_async.space_cond, NULL);
+	if (tt_pthread_key_create(&say_async.ring_key, say_ring_orphan) != 0)
+		goto fail_key;
+	if (tt_pthread_create(&say_async.thread, NULL, say_async_f, NULL) != 0)
+		goto fail_thread;
+	static bool atfork_registered = false;
+	if (!atfork_registered) {
+		(void) tt_pthread_atfork(NULL, NULL, say_async_atfork_child);
+		atfork_registered = true;
+	}
+	logger_async = true;
+	return 0;
+fail_thread:
+	tt_pthread_key_delete(say_async.ring_key);
+fail_key:
+	tt_pthread_cond_destroy(&say_async.space_cond);
+	tt_pthread_cond_destroy(&say_async.cond);
+	tt_pthread_mutex_destroy(&say_async.mutex);
+	return -1;
+}
+
+/** Stop the logger thread after writing all pending messages. */
+static void
+say_async_stop(void)
+{
+	assert(logger_async);
+	logger_async = false;
+	tt_pthread_mutex_lock(&say_async.mutex);
+	pm_atomic_store(&say_async.is_stopping, true);
+	tt_pthread_cond_signal(&say_async.cond);
+	tt_pthread_cond_broadcast(&say_async.space_cond);
+	tt_pthread_mutex_unlock(&say_async.mutex);
+	tt_pthread_join(say_async.thread, NULL);
+	/* Rings of live threads are leaked on purpose. */
+}
+
+int64_t
+say_logger_dropped(void)
+{
+	return pm_atomic_load(&say_async.dropped);
+}
+
+/** Asynchronous logger }}} */
+
 /*
  * Init string parser(s)
  */
@@ -108,6 +108,46 @@ void say_logger_init(const char *init_str,
 void
 say_logger_free();
 
+/** Overflow policy of the asynchronous logger. */
+enum say_overflow {
+	/** Drop a message if the ring buffer is full. */
+	SAY_OVERFLOW_DROP,
+	/** Wait for the logger thread to free some space. */
+	SAY_OVERFLOW_BLOCK,
+	say_overflow_MAX
+};
+
+/**
+ * Return overflow policy by name.
+ * @retval say_overflow_MAX on error
+ */
+enum say_overflow
+say_overflow_by_name(const char *name);
+
+/**
+ * Switch the file or pipe logger to asynchronous mode. Messages
+ * are formatted by the logging thread and put to its own ring
+ * buffer, which is drained to the log by a dedicated thread,
+ * so logging never blocks on a slow disk or a stuck pipe.
+ * Does nothing for other logger types.
+ *
+ * Must be called after the logger is initialized and the
+ * process is daemonized.
+ *
+ * @param overflow what to do when a ring buffer is full
+ * @retval 0 success
+ * @retval -1 failed to start the logger thread, errno is set
+ */
+int
+say_logger_async_start(enum say_overflow overflow);
+
+/**
+ * Return the number of messages dropped by the asynchronous
+ * logger due to ring buffer overflow.
+ */
+int64_t
+say_logger_dropped(void);
+
 CFORMAT(printf, 5, 0) void
 vsay(int level, const char *filename, int line, const char *error,
      const char *format, va_list ap);
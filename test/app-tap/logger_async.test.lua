@@ -0,0 +1,60 @@
+#!/usr/bin/env tarantool
+
+local test = require('tap').test('log_async')
+test:plan(5)
+
+local fiber = require('fiber')
+local log = require('log')
+local io = require('io')
+
+local filename = "async.log"
+box.cfg{
+    log = filename,
+    log_async = true,
+    log_async_overflow = 'block',
+    memtx_memory = 107374182,
+}
+test:is(box.cfg.log_async, true, "log_async")
+test:is(box.cfg.log_async_overflow, 'block', "log_async_overflow")
+
+--
+-- Messages are written to the log by the logger thread.
+--
+local count = 10000
+for i = 1, count do
+    log.info("async message %d", i)
+end
+
+local function count_lines()
+    local file = io.open(filename)
+    local n = 0
+    local last = 0
+    for line in file:lines() do
+        local i = tonumber(line:match('async message (%d+)$'))
+        if i ~= nil then
+            n = n + 1
+            -- messages of one thread are written in order
+            if i ~= last + 1 then
+                return -1
+            end
+            last = i
+        end
+    end
+    file:close()
+    return n
+end
+
+local n = count_lines()
+local deadline = fiber.time() + 10
+while n >= 0 and n < count and fiber.time() < deadline do
+    fiber.sleep(0.01)
+    n = count_lines()
+end
+test:is(n, count, "all messages are written in order")
+test:is(box.stat.log().dropped, 0, "nothing dropped with 'block' policy")
+
+local ok = pcall(box.cfg, {log_async_overflow = 'drop'})
+test:ok(not ok, "log_async_overflow is not dynamic")
+
+test:check()
+os.exit()
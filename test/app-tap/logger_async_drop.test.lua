@@ -0,0 +1,75 @@
+#!/usr/bin/env tarantool
+
+local test = require('tap').test('log_async_drop')
+test:plan(5)
+
+local fiber = require('fiber')
+local log = require('log')
+local io = require('io')
+
+--
+-- The logger process doesn't read the pipe for a while,
+-- so the logger thread blocks and the ring buffer fills up.
+--
+local filename = "async_drop.log"
+os.remove(filename)
+box.cfg{
+    log = 'pipe: sleep 2 && exec cat > ' .. filename,
+    log_async = true,
+    memtx_memory = 107374182,
+}
+test:is(box.cfg.log_async_overflow, 'drop', "log_async_overflow")
+
+-- 1.5 MB of messages, much more than the ring and the pipe hold.
+local count = 10000
+local pad = string.rep('x', 150)
+for i = 1, count do
+    log.info("drop message %d %s", i, pad)
+end
+test:ok(box.stat.log().dropped > 0, "messages are dropped on overflow")
+
+-- Wait until the ring is drained and new messages get through.
+local function find_sentinel()
+    local file = io.open(filename)
+    if file == nil then
+        return false
+    end
+    local found = false
+    for line in file:lines() do
+        if line:match('drop sentinel$') then
+            found = true
+        end
+    end
+    file:close()
+    return found
+end
+local deadline = fiber.time() + 30
+repeat
+    log.info("drop sentinel")
+    fiber.sleep(0.1)
+until find_sentinel() or fiber.time() > deadline
+test:ok(find_sentinel(), "logging resumes after overflow")
+
+-- Messages are dropped whole and never interleave.
+local n = 0
+local last = 0
+local ok = true
+local file = io.open(filename)
+for line in file:lines() do
+    if line:match('drop message') then
+        local i, s = line:match('drop message (%d+) (x*)$')
+        i = tonumber(i)
+        if i == nil or s ~= pad or i <= last then
+            ok = false
+        else
+            last = i
+            n = n + 1
+        end
+    end
+end
+file:close()
+test:ok(ok, "written messages are whole and in order")
+test:ok(n > 0 and n < count, "some messages are written")
+
+test:check()
+os.exit()
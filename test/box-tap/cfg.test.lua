@@ -4,7 +4,7 @@ local tap = require('tap')
 local test = tap.test('cfg')
 local socket = require('socket')
 local fio = require('fio')
-test:plan(72)
+test:plan(82)
 
 --------------------------------------------------------------------------------
 -- Invalid values
@@ -22,11 +22,21 @@ invalid('memtx_min_tuple_size', 0)
 invalid('memtx_min_tuple_size', -1)
 invalid('memtx_min_tuple_size', 1048281)
 invalid('memtx_min_tuple_size', 1000000000)
+invalid('memtx_snapshot_threads', 0)
+invalid('memtx_snapshot_threads', 65)
 invalid('replication', '//guest@localhost:3301')
 invalid('replication_timeout', -1)
 invalid('replication_timeout', 0)
 invalid('wal_mode', 'invalid')
 invalid('rows_per_wal', -1)
+invalid('wal_compress_level', -1)
+invalid('wal_compress_level', 100)
+invalid('wal_compress_threshold', -1)
+invalid('wal_group_commit_window', -1)
+invalid('wal_group_commit_max_size', 0)
+invalid('wal_ring_size', -1)
+invalid('replication_apply_batch_size', 0)
+invalid('sql_stmt_cache_size', 0)
 invalid('listen', '//!')
 invalid('log', ':')
 invalid('log', 'syslog:xxx=')
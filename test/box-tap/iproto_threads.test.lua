@@ -0,0 +1,50 @@
+#!/usr/bin/env tarantool
+
+local tap = require('tap')
+local test = tap.test('iproto_threads')
+local net_box = require('net.box')
+local socket = require('socket')
+test:plan(3)
+
+box.cfg{iproto_threads = 4}
+box.schema.user.grant('guest', 'read,write,execute', 'universe')
+
+-- Open many connections at once and check they are all served.
+local function check(uri)
+    local conns = {}
+    for i = 1, 32 do
+        conns[i] = net_box.connect(uri)
+    end
+    local ok = true
+    for i = 1, 32 do
+        ok = ok and conns[i]:ping() and conns[i]:eval('return 1 + 1') == 2
+        conns[i]:close()
+    end
+    return ok
+end
+
+-- Find a free TCP port.
+local s = socket('AF_INET', 'SOCK_STREAM', 'tcp')
+s:bind('127.0.0.1', 0)
+local port = s:name().port
+s:close()
+
+-- Each net thread binds its own socket to the TCP address.
+local uri = '127.0.0.1:' .. port
+box.cfg{listen = uri}
+test:ok(check(uri), 'tcp')
+
+-- UNIX sockets are shared by all threads.
+local path = './iproto_threads.sock'
+os.remove(path)
+box.cfg{listen = 'unix/:' .. path}
+test:ok(check('unix/:' .. path), 'unix')
+
+box.cfg{listen = uri}
+test:ok(check(uri), 'tcp after rebind')
+box.cfg{listen = ''}
+os.remove(path)
+
+box.schema.user.revoke('guest', 'read,write,execute', 'universe')
+test:check()
+os.exit(0)
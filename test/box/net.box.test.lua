@@ -794,6 +794,28 @@ space.index.test_index ~= nil
 cspace.index.test_index ~= nil
 c.space.test.index.test_index ~= nil
 
+--
+-- select_multi
+--
+s = box.schema.space.create('select_multi', {id = 10000})
+_ = s:create_index('pk')
+_ = s:create_index('sk', {unique = false, parts = {2, 'unsigned'}})
+for i = 1, 6 do s:insert{i, i % 3} end
+c:reload_schema()
+cs = c.space.select_multi
+cs:select_multi({{1}, 3, {100}, {5}})
+cs:select_multi({})
+cs:select_multi({{100}, {200}})
+cs:select_multi({{2}, {4}}, {iterator = 'GE', limit = 2})
+cs:select_multi({{1}, {2}}, {offset = 1})
+cs.index.sk:select_multi({{0}, {1}, {100}})
+cs.index.sk:select_multi({{0}, {1}}, {offset = 1, limit = 1})
+cs.index.sk:select_multi({{2}}, {iterator = 'REQ'})
+cs:select_multi({{'a'}})
+cs:select_multi(1)
+s:drop()
+cs:select_multi({{1}})
+
 -- cleanup
 box.schema.user.revoke('guest','read,write,execute','universe')
 
@@ -0,0 +1,81 @@
+test_run = require('test_run').new()
+fiber = require('fiber')
+
+--
+-- A secondary tree index of a memtx space is built without
+-- blocking the space: changes done to it while the index is
+-- being built get to the new index.
+--
+test_run:cmd("setopt delimiter ';'")
+function fill(space)
+    box.begin()
+    for i = 1, 10000 do space:insert{i, i} end
+    box.commit()
+end;
+function build(space, name, func)
+    local ch = fiber.channel(1)
+    fiber.create(function()
+        local ok, err = pcall(space.create_index, space, name,
+                              {parts = {2, 'integer'}})
+        ch:put(ok or tostring(err))
+    end)
+    res = func()
+    return ch:get()
+end;
+function change(space)
+    for i = 1, 10000, 100 do
+        space:delete{i}
+        space:replace{i + 1, -i}
+        space:insert{10000 + i, 10000 + i}
+        box.begin()
+        space:replace{i + 2, 0}
+        box.rollback()
+    end
+end;
+function check(space)
+    for _, t in space.index.pk:pairs() do
+        local u = space.index.sk:get{t[2]}
+        if u == nil or u[1] ~= t[1] then
+            return false
+        end
+    end
+    return space.index.sk:count() == space.index.pk:count()
+end;
+test_run:cmd("setopt delimiter ''");
+
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+fill(s)
+build(s, 'sk', function() change(s) end)
+check(s)
+s.index.sk:count()
+s.index.sk:get{0}
+s:drop()
+
+-- a concurrent change violating the new unique index
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+fill(s)
+build(s, 'sk', function() s:replace{1, 5000} end)
+s.index.sk
+s:drop()
+
+-- a unique key moving from a scanned tuple to one not scanned yet
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+fill(s)
+build(s, 'sk', function() s:replace{1, 20001} s:replace{9000, 1} end)
+check(s)
+s.index.sk:get{1}
+s.index.sk:get{20001}
+s.index.sk:get{9000}
+s:drop()
+
+-- other DDL on the space is not allowed until the build is over
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+fill(s)
+build(s, 'sk', function() local _, err = pcall(s.truncate, s) return tostring(err) end)
+res
+check(s)
+s:drop()
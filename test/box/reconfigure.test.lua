@@ -35,6 +35,7 @@ box.cfg{log_level=5}
 -- constants
 box.cfg{wal_dir="dynamic"}
 box.cfg{memtx_dir="dynamic"}
+box.cfg{iproto_threads=2}
 box.cfg{log="new logger"}
 -- bad1
 box.cfg{memtx_memory=53687091}
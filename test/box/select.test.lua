@@ -133,3 +133,21 @@ while (true) do table.insert(lots_of_links, s:get{0}) ref_count = ref_count + 1
 ref_count
 lots_of_links = {}
 s:drop()
+
+--------------------------------------------------------------------------------
+-- select_multi tests
+--------------------------------------------------------------------------------
+
+s = box.schema.space.create('select_multi')
+_ = s:create_index('pk')
+_ = s:create_index('sk', { unique = false, parts = { 2, 'unsigned' } })
+for i = 1, 6 do s:insert{i, i % 3} end
+s:select_multi({{1}, 3, {100}, {5}})
+s:select_multi({})
+s:select_multi({{2}, {4}}, { iterator = 'GE', limit = 2 })
+s:select_multi({{1}, {2}}, { offset = 1 })
+s.index.sk:select_multi({{0}, {1}, {100}})
+s.index.sk:select_multi({{0}, {1}}, { offset = 1, limit = 1 })
+s:select_multi({{'a'}})
+s:select_multi(1)
+s:drop()
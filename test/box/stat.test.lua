@@ -38,3 +38,11 @@ box.stat.ERROR.total
 
 -- cleanup
 box.space.tweedledum:drop()
+
+-- WAL statistics
+writes = box.stat.wal().writes
+s = box.schema.space.create('test')
+box.stat.wal().writes > writes
+-- no group commit in wal_mode = 'write'
+box.stat.wal().fsyncs
+s:drop()
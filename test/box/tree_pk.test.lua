@@ -301,3 +301,67 @@ s:drop()
 
 box.internal.collation.drop('test')
 box.internal.collation.drop('test-ci')
+
+--
+-- Tree indexes compare hints of the first key part before
+-- comparing tuples, check the order is preserved.
+--
+s = box.schema.space.create('hint')
+i = s:create_index('pk', {parts = {1, 'integer'}})
+for _, v in ipairs({5, -5, 0, -9223372036854775807LL, 9223372036854775807LL, 18446744073709551615ULL, 9223372036854775808ULL}) do s:insert{v} end
+s:select{}
+s:select({0}, {iterator = 'GE'})
+s:select({9223372036854775808ULL}, {iterator = 'LT'})
+i:count({0}, {iterator = 'GT'})
+s:drop()
+
+s = box.schema.space.create('hint')
+i = s:create_index('pk', {parts = {1, 'string'}})
+for _, v in ipairs({'abcdefgi', 'abcdefgh', 'b', 'abcdefghb', '', 'abcdefgha', 'abcdefg'}) do s:insert{v} end
+s:select{}
+s:select({'abcdefgh'}, {iterator = 'GT'})
+s:select({'abcdefgha'}, {iterator = 'LE'})
+i:get{'abcdefghb'}
+s:drop()
+
+s = box.schema.space.create('hint')
+i = s:create_index('pk', {parts = {{1, 'string', collation = 'unicode_ci'}}})
+for _, v in ipairs({'zebra', 'Apple', 'banana', 'Apples', 'applesauce', 'APPLET', 'b'}) do s:insert{v} end
+s:select{}
+s:insert{'APPLE'}
+s:select({'APPLES'}, {iterator = 'GT'})
+s:select({'applet'}, {iterator = 'LT'})
+i:get{'BANANA'}
+s:drop()
+
+--
+-- Changing the type of the first part of a tree index changes
+-- hints, so the index must be rebuilt.
+--
+s = box.schema.space.create('hint')
+_ = s:create_index('pk')
+i = s:create_index('sk', {parts = {2, 'unsigned'}})
+for k, v in ipairs({3, 1, 2}) do s:insert{k, v} end
+i:alter({parts = {2, 'integer'}})
+s:insert{4, -1}
+i:select{}
+i:select({0}, {iterator = 'GT'})
+i:get{-1}
+i:get{2}
+i:alter({parts = {2, 'scalar'}})
+s:insert{5, 'a'}
+i:select{}
+i:select({2}, {iterator = 'GE'})
+i:get{'a'}
+s:drop()
+
+s = box.schema.space.create('hint')
+i = s:create_index('pk', {parts = {1, 'string'}})
+for _, v in ipairs({'b', 'a', 'c'}) do s:insert{v} end
+i:alter({parts = {1, 'scalar'}})
+s:insert{1}
+i:select{}
+i:select({'a'}, {iterator = 'LT'})
+i:get{'b'}
+i:get{1}
+s:drop()
@@ -0,0 +1,60 @@
+env = require('test_run')
+test_run = env.new()
+engine = test_run:get_cfg('engine')
+
+box.schema.user.grant('guest', 'replication')
+test_run:cmd("create server replica with rpl_master=default, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+
+test_run:cmd("switch replica")
+box.cfg{replication_apply_batch_size = 100}
+box.cfg.replication_apply_batch_size
+test_run:cmd("switch default")
+
+--
+-- Rows of different engines and DDL are applied in separate
+-- transactions.
+--
+s1 = box.schema.space.create('test1', {engine = engine})
+_ = s1:create_index('primary')
+s2 = box.schema.space.create('test2', {engine = 'memtx'})
+_ = s2:create_index('primary')
+for i = 1, 1000 do s1:replace{i} s2:replace{i} end
+s3 = box.schema.space.create('test3')
+for i = 1001, 2000 do s1:replace{i} end
+s1:count()
+s2:count()
+
+test_run:cmd("switch replica")
+fiber = require('fiber')
+while box.space.test1 == nil or box.space.test1:count() < 2000 do fiber.sleep(0.01) end
+box.space.test1:count()
+box.space.test2:count()
+box.space.test3 ~= nil
+box.info.replication[1].upstream.status
+
+--
+-- If a row of a batch fails, the preceding rows are committed.
+-- Each of them fires on_replace triggers once.
+--
+box.space.test1:insert{2500}
+replaced = 0
+_ = box.space.test1:on_replace(function() replaced = replaced + 1 end)
+test_run:cmd("switch default")
+for i = 2001, 3000 do s1:insert{i} end
+
+test_run:cmd("switch replica")
+while box.info.replication[1].upstream.status ~= 'stopped' do fiber.sleep(0.01) end
+box.info.replication[1].upstream.message
+box.space.test1:count()
+box.space.test1:get{2499}
+box.space.test1:get{2501}
+replaced
+
+test_run:cmd("switch default")
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+s1:drop()
+s2:drop()
+s3:drop()
+box.schema.user.revoke('guest', 'replication')
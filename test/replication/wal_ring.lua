@@ -0,0 +1,10 @@
+#!/usr/bin/env tarantool
+
+box.cfg({
+    listen              = os.getenv("LISTEN"),
+    memtx_memory        = 107374182,
+    wal_max_rows        = 100,
+    wal_ring_size       = 4096,
+})
+
+require('console').listen(os.getenv('ADMIN'))
@@ -0,0 +1,81 @@
+env = require('test_run')
+test_run = env.new()
+
+--
+-- A replica that lags behind the master so much that the rows
+-- it needs have been evicted from the WAL ring catches up by
+-- reading xlog files and then goes back to the ring.
+--
+test_run:cmd("create server ring_master with script='replication/wal_ring.lua'")
+test_run:cmd("start server ring_master")
+test_run:cmd("switch ring_master")
+box.cfg.wal_ring_size
+box.schema.user.grant('guest', 'replication')
+s = box.schema.space.create('test')
+_ = s:create_index('primary')
+for i = 1, 10 do s:insert{i} end
+test_run:cmd("switch default")
+
+test_run:cmd("create server replica with rpl_master=ring_master, script='replication/replica.lua'")
+test_run:cmd("start server replica")
+test_run:wait_lsn('replica', 'ring_master')
+test_run:cmd("switch replica")
+box.space.test:count()
+test_run:cmd("switch default")
+
+-- Rows written while the replica is connected.
+test_run:cmd("switch ring_master")
+for i = 11, 100 do s:insert{i, string.rep('x', 100)} end
+test_run:cmd("switch default")
+test_run:wait_lsn('replica', 'ring_master')
+test_run:cmd("switch replica")
+box.space.test:count()
+box.space.test:get{100}[2] == string.rep('x', 100)
+test_run:cmd("switch default")
+
+-- A row that doesn't fit in the ring.
+test_run:cmd("switch ring_master")
+_ = s:insert{101, string.rep('y', 8192)}
+s:insert{102}
+test_run:cmd("switch default")
+test_run:wait_lsn('replica', 'ring_master')
+test_run:cmd("switch replica")
+box.space.test:count()
+box.space.test:get{101}[2] == string.rep('y', 8192)
+box.info.replication[1].upstream.status
+test_run:cmd("switch default")
+
+-- Rows written while the replica is down span several xlog
+-- files and don't fit in the ring.
+test_run:cmd("stop server replica")
+test_run:cmd("switch ring_master")
+fio = require('fio')
+for i = 103, 1000 do s:insert{i, string.rep('z', 100)} end
+#fio.glob(fio.pathjoin(box.cfg.wal_dir, '*.xlog')) > 5
+test_run:cmd("switch default")
+test_run:cmd("start server replica")
+test_run:wait_lsn('replica', 'ring_master')
+test_run:cmd("switch replica")
+box.space.test:count()
+box.space.test:get{103}[2] == string.rep('z', 100)
+box.space.test:get{1000}[2] == string.rep('z', 100)
+box.info.replication[1].upstream.status
+test_run:cmd("switch default")
+
+-- Once the replica has caught up, it follows the master again.
+test_run:cmd("switch ring_master")
+for i = 1001, 1100 do s:replace{i} end
+s:delete{1}
+test_run:cmd("switch default")
+test_run:wait_lsn('replica', 'ring_master')
+test_run:cmd("switch replica")
+box.space.test:count()
+box.space.test:get{1}
+box.space.test:get{1100}
+box.info.replication[1].upstream.status
+test_run:cmd("switch default")
+
+test_run:cmd("stop server replica")
+test_run:cmd("cleanup server replica")
+test_run:cmd("stop server ring_master")
+test_run:cmd("cleanup server ring_master")
@@ -0,0 +1,77 @@
+#!/usr/bin/env tarantool
+test = require("sqltester")
+test:plan(6)
+
+---------------------------------------------------------------------------
+--
+-- This file implements regression tests for ephemeral tables stored
+-- in memtx spaces: DISTINCT, IN lists, compound selects and sorting
+-- indexes.
+--
+test:do_execsql_test(
+    "ephemeral-1.0",
+    [[
+        CREATE TABLE t1(id PRIMARY KEY, a, b);
+        INSERT INTO t1 VALUES(1, 1, 'one'), (2, 2, 'two'), (3, 2, 'Two'),
+                             (4, NULL, 'null'), (5, 2.0, 'two real'),
+                             (6, NULL, 'null2'), (7, 'x', 'x');
+        SELECT DISTINCT a FROM t1 ORDER BY 1;
+    ]], {
+        -- <ephemeral-1.0>
+        "", 1, 2, "x"
+        -- </ephemeral-1.0>
+    })
+
+test:do_execsql_test(
+    "ephemeral-1.1",
+    [[
+        SELECT id FROM t1 WHERE b IN ('one', 'two', 'zero') ORDER BY 1;
+    ]], {
+        -- <ephemeral-1.1>
+        1, 2
+        -- </ephemeral-1.1>
+    })
+
+test:do_execsql_test(
+    "ephemeral-1.2",
+    [[
+        SELECT a FROM t1 UNION SELECT b FROM t1 WHERE id < 3 ORDER BY 1;
+    ]], {
+        -- <ephemeral-1.2>
+        "", 1, 2, "one", "two", "x"
+        -- </ephemeral-1.2>
+    })
+
+test:do_execsql_test(
+    "ephemeral-1.3",
+    [[
+        SELECT a FROM t1 EXCEPT SELECT 2 ORDER BY 1;
+    ]], {
+        -- <ephemeral-1.3>
+        "", 1, "x"
+        -- </ephemeral-1.3>
+    })
+
+-- Collations are taken into account.
+test:do_execsql_test(
+    "ephemeral-1.4",
+    [[
+        SELECT count(DISTINCT b COLLATE "unicode_ci") FROM t1 WHERE id < 4;
+    ]], {
+        -- <ephemeral-1.4>
+        2
+        -- </ephemeral-1.4>
+    })
+
+-- Descending order.
+test:do_execsql_test(
+    "ephemeral-1.5",
+    [[
+        SELECT DISTINCT a FROM t1 ORDER BY a DESC;
+    ]], {
+        -- <ephemeral-1.5>
+        "x", 2, 1, ""
+        -- </ephemeral-1.5>
+    })
+
+test:finish_test()
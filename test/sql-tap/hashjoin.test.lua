@@ -0,0 +1,122 @@
+#!/usr/bin/env tarantool
+test = require("sqltester")
+test:plan(9)
+
+---------------------------------------------------------------------------
+--
+-- This file implements regression tests for hash joins: equi-joins
+-- on columns which are not covered by any index are executed by
+-- building an in-memory hash table on one side of the join and
+-- probing it with the rows of the other side.
+--
+test:do_execsql_test(
+    "hashjoin-1.0",
+    [[
+        CREATE TABLE t1(id PRIMARY KEY, a, b);
+        INSERT INTO t1 VALUES(1, 1, 'one'), (2, 2, 'two'), (3, 3, 'three'),
+                             (4, NULL, 'null'), (5, 2.0, 'two real');
+        CREATE TABLE t2(id PRIMARY KEY, x, y);
+        INSERT INTO t2 VALUES(1, 2, 'b'), (2, 3, 'c'), (3, 3, 'cc'),
+                             (4, NULL, 'null'), (5, 5, 'e'), (6, '3', 's');
+    ]], {
+        -- <hashjoin-1.0>
+        -- </hashjoin-1.0>
+    })
+
+test:do_eqp_test(
+    "hashjoin-1.1",
+    [[
+        SELECT * FROM t1 CROSS JOIN t2 WHERE t1.a = t2.x;
+    ]], {
+        -- <hashjoin-1.1>
+        {0, 0, 0, "SCAN TABLE T1"},
+        {0, 1, 1, "SEARCH TABLE T2 USING HASH JOIN (X=?)"}
+        -- </hashjoin-1.1>
+    })
+
+test:do_execsql_test(
+    "hashjoin-1.2",
+    [[
+        SELECT t1.b, t2.y FROM t1 CROSS JOIN t2 WHERE t1.a = t2.x
+        ORDER BY t1.id, t2.id;
+    ]], {
+        -- <hashjoin-1.2>
+        "two", "b", "three", "c", "three", "cc", "two real", "b"
+        -- </hashjoin-1.2>
+    })
+
+test:do_execsql_test(
+    "hashjoin-1.3",
+    [[
+        SELECT t1.b, t2.y FROM t1 LEFT JOIN t2 ON t1.a = t2.x
+        ORDER BY t1.id, t2.id;
+    ]], {
+        -- <hashjoin-1.3>
+        "one", "", "two", "b", "three", "c", "three", "cc", "null", "",
+        "two real", "b"
+        -- </hashjoin-1.3>
+    })
+
+-- Rows with NULL in the join key never match.
+test:do_execsql_test(
+    "hashjoin-1.4",
+    [[
+        SELECT count(*) FROM t1 CROSS JOIN t2 WHERE t1.a = t2.x;
+    ]], {
+        -- <hashjoin-1.4>
+        4
+        -- </hashjoin-1.4>
+    })
+
+-- Multi-column key.
+test:do_execsql_test(
+    "hashjoin-2.0",
+    [[
+        CREATE TABLE t3(id PRIMARY KEY, p, q);
+        INSERT INTO t3 VALUES(1, 3, 'c'), (2, 3, 'x'), (3, 2, 'b');
+        SELECT t2.id, t3.id FROM t2 CROSS JOIN t3
+        WHERE t2.x = t3.p AND t2.y = t3.q ORDER BY 1, 2;
+    ]], {
+        -- <hashjoin-2.0>
+        1, 3, 2, 1
+        -- </hashjoin-2.0>
+    })
+
+test:do_eqp_test(
+    "hashjoin-2.1",
+    [[
+        SELECT * FROM t2 CROSS JOIN t3 WHERE t2.x = t3.p AND t2.y = t3.q;
+    ]], {
+        -- <hashjoin-2.1>
+        {0, 0, 0, "SCAN TABLE T2"},
+        {0, 1, 1, "SEARCH TABLE T3 USING HASH JOIN (P=? AND Q=?)"}
+        -- </hashjoin-2.1>
+    })
+
+-- An index on the join column is preferred over a hash join.
+test:do_eqp_test(
+    "hashjoin-3.0",
+    [[
+        CREATE INDEX t2x ON t2(x);
+        SELECT * FROM t1 CROSS JOIN t2 WHERE t1.a = t2.x;
+    ]], {
+        -- <hashjoin-3.0>
+        {0, 0, 0, "SCAN TABLE T1"},
+        {0, 1, 1, "SEARCH TABLE T2 USING COVERING INDEX T2X (X=?)"}
+        -- </hashjoin-3.0>
+    })
+
+-- Non-binary collations can not be used for hashing.
+test:do_eqp_test(
+    "hashjoin-4.0",
+    [[
+        SELECT * FROM t1 CROSS JOIN t3
+        WHERE t1.b = t3.q COLLATE "unicode_ci";
+    ]], {
+        -- <hashjoin-4.0>
+        {0, 0, 0, "SCAN TABLE T1"},
+        {0, 1, 1, "SCAN TABLE T3"}
+        -- </hashjoin-4.0>
+    })
+
+test:finish_test()
@@ -24,6 +24,35 @@ while f1:status() ~= 'dead' do fiber.sleep(0) end
 insert_res
 select_res
 
+-- Hash join falls back to a nested loop when the hash table
+-- grows too big. The results must be the same.
+test_run = require('test_run').new()
+json = require('json')
+box.sql.execute("CREATE TABLE t1(id PRIMARY KEY, a, b)")
+box.sql.execute("INSERT INTO t1 VALUES(1, 1, 'one'), (2, 2, 'two'), (3, 3, 'three'), (4, NULL, 'null'), (5, 2.0, 'two real')")
+box.sql.execute("CREATE TABLE t2(id PRIMARY KEY, x, y)")
+box.sql.execute("INSERT INTO t2 VALUES(1, 2, 'b'), (2, 3, 'c'), (3, 3, 'cc'), (4, NULL, 'null'), (5, 5, 'e'), (6, '3', 's')")
+box.sql.execute("CREATE TABLE t3(id PRIMARY KEY, p, q)")
+box.sql.execute("INSERT INTO t3 VALUES(1, 3, 'c'), (2, 3, 'x'), (3, 2, 'b')")
+test_run:cmd("setopt delimiter ';'")
+function check(sql)
+    local hashed = box.sql.execute(sql)
+    errinj.set('ERRINJ_SQL_HASH_JOIN_SIZE', 0)
+    local looped = box.sql.execute(sql)
+    errinj.set('ERRINJ_SQL_HASH_JOIN_SIZE', -1)
+    return json.encode(hashed) == json.encode(looped), looped
+end;
+test_run:cmd("setopt delimiter ''");
+box.sql.execute("EXPLAIN QUERY PLAN SELECT * FROM t1 CROSS JOIN t2 WHERE t1.a = t2.x")
+check("SELECT t1.b, t2.y FROM t1 CROSS JOIN t2 WHERE t1.a = t2.x ORDER BY t1.id, t2.id")
+check("SELECT t1.b, t2.y FROM t1 LEFT JOIN t2 ON t1.a = t2.x ORDER BY t1.id, t2.id")
+check("SELECT count(*) FROM t1 CROSS JOIN t2 WHERE t1.a = t2.x")
+box.sql.execute("EXPLAIN QUERY PLAN SELECT * FROM t2 CROSS JOIN t3 WHERE t2.x = t3.p AND t2.y = t3.q")
+check("SELECT t2.id, t3.id FROM t2 CROSS JOIN t3 WHERE t2.x = t3.p AND t2.y = t3.q ORDER BY 1, 2")
+box.sql.execute("DROP TABLE t1")
+box.sql.execute("DROP TABLE t2")
+box.sql.execute("DROP TABLE t3")
+
 cn:close()
 box.schema.user.revoke('guest', 'read,write,execute', 'universe')
 box.sql.execute('drop table test')
@@ -179,6 +179,33 @@ _ = space:replace{1, 1, string.rep('a', 4 * 1024 * 1024)}
 res = cn:execute('select * from test')
 res.metadata
 
+
+--
+-- Prepared statements and the statement cache.
+--
+id = cn:prepare('select a from test where id = ?')
+id > 0
+hits = box.stat.sql().cache_hits
+cn:execute(id, {1})
+cn:execute('select a from test where id = ?', {1})
+cn:prepare('select a from test where id = ?') == id
+box.stat.sql().cache_hits - hits
+-- A statement is prepared again after a schema change.
+box.sql.execute('create table test4 (id primary key)')
+cn:reload_schema()
+misses = box.stat.sql().cache_misses
+cn:execute(id, {1})
+box.stat.sql().cache_misses - misses
+box.sql.execute('drop table test4')
+cn:reload_schema()
+cn:prepare('select a from not_existing_table')
+-- The least recently used statement is evicted.
+box.cfg{sql_stmt_cache_size = 1}
+box.stat.sql().cache_size
+cn:execute('select 1')
+ok, err = pcall(cn.execute, cn, id, {1})
+ok, err.code == box.error.SQL_STMT_NOT_FOUND
+box.cfg{sql_stmt_cache_size = 512}
 cn:close()
 box.schema.user.revoke('guest', 'read,write,execute', 'universe')
 box.sql.execute('drop table test')
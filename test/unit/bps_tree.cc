@@ -60,6 +60,27 @@ compare(type_t a, type_t b);
 #undef bps_tree_key_t
 #undef bps_tree_arg_t
 
+/* tree with subtree counts */
+#define BPS_TREE_NAME counted
+#define BPS_TREE_BLOCK_SIZE 128 /* value is to low specially for tests */
+#define BPS_TREE_EXTENT_SIZE 2048 /* value is to low specially for tests */
+#define BPS_TREE_COMPARE(a, b, arg) compare(a, b)
+#define BPS_TREE_COMPARE_KEY(a, b, arg) compare(a, b)
+#define bps_tree_elem_t type_t
+#define bps_tree_key_t type_t
+#define bps_tree_arg_t int
+#define BPS_TREE_CHILD_COUNTS
+#include "salad/bps_tree.h"
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+#undef BPS_TREE_CHILD_COUNTS
+
 /* tree for approximate_count test */
 #define BPS_TREE_NAME approx
 #define BPS_TREE_BLOCK_SIZE 128 /* value is to low specially for tests */
@@ -792,6 +813,86 @@ insert_get_iterator()
 	footer();
 }
 
+static void
+check_offsets(counted *tree, const bool *present, int elem_limit)
+{
+	size_t less = 0;
+	for (int i = 0; i < elem_limit; i++) {
+		size_t offset;
+		bool exact;
+		counted_iterator itr =
+			counted_lower_bound_get_offset(tree, i, &exact,
+						       &offset);
+		if (offset != less || exact != present[i])
+			fail("lower bound offset", "false");
+		counted_iterator itr_at = counted_iterator_at(tree, offset);
+		if (!counted_iterator_are_equal(tree, &itr, &itr_at))
+			fail("iterator at lower bound offset", "false");
+		if (present[i])
+			less++;
+		counted_upper_bound_get_offset(tree, i, &exact, &offset);
+		if (offset != less || exact != present[i])
+			fail("upper bound offset", "false");
+	}
+	if (less != counted_size(tree))
+		fail("tree size", "false");
+	counted_iterator itr = counted_iterator_at(tree, less);
+	if (!counted_iterator_is_invalid(&itr))
+		fail("iterator at size", "false");
+}
+
+static void
+child_counts_check()
+{
+	header();
+
+	counted tree;
+	counted_create(&tree, 0, extent_alloc, extent_free, &extents_count);
+
+	const int rounds = 16 * 1024;
+	const int elem_limit = 1024;
+	bool present[elem_limit];
+	memset(present, 0, sizeof(present));
+
+	counted_iterator frozen = counted_invalid_iterator();
+	for (int i = 0; i < rounds; i++) {
+		type_t rnd = rand() % elem_limit;
+		if (present[rnd])
+			counted_delete(&tree, rnd);
+		else
+			counted_insert(&tree, rnd, NULL);
+		present[rnd] = !present[rnd];
+
+		if (counted_debug_check(&tree))
+			fail("debug check nonzero", "true");
+		if (i % 256 == 0) {
+			check_offsets(&tree, present, elem_limit);
+			/* Make following modifications copy blocks. */
+			counted_iterator_destroy(&tree, &frozen);
+			frozen = counted_iterator_first(&tree);
+			counted_iterator_freeze(&tree, &frozen);
+		}
+	}
+	counted_iterator_destroy(&tree, &frozen);
+	check_offsets(&tree, present, elem_limit);
+	counted_destroy(&tree);
+
+	type_t arr[elem_limit];
+	for (int i = 0; i < elem_limit; i++) {
+		arr[i] = i * 2;
+		present[i] = i % 2 == 0 && i < elem_limit / 2;
+	}
+	counted_create(&tree, 0, extent_alloc, extent_free, &extents_count);
+	if (counted_build(&tree, arr, elem_limit / 4) != 0)
+		fail("build", "false");
+	if (counted_debug_check(&tree))
+		fail("debug check nonzero", "true");
+	check_offsets(&tree, present, elem_limit);
+	counted_destroy(&tree);
+
+	footer();
+}
+
 int
 main(void)
 {
@@ -803,6 +904,7 @@ main(void)
 	printing_test();
 	white_box_test();
 	approximate_count();
+	child_counts_check();
 	if (extents_count != 0)
 		fail("memory leak!", "true");
 	insert_get_iterator();
@@ -0,0 +1,164 @@
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "memory.h"
+#include "fiber.h"
+#include "cbus.h"
+#include "clock.h"
+#include "unit.h"
+
+/*
+ * cbus benchmark: a stream of messages is sent from the main
+ * thread to a worker thread and back. The number of messages
+ * in flight is limited by a window: a window of one measures
+ * the round trip latency, a large window measures throughput.
+ *
+ * The results are printed to stderr, so that they don't affect
+ * the test result file. In the unit test suite the benchmark is
+ * run with a small number of messages as a smoke test. To compare
+ * different cbus implementations, run the test binary directly
+ * passing the number of messages, e.g. `cbus_bench.test 1000000`.
+ */
+
+/* Total number of messages to send in each run. */
+static int message_count = 10000;
+
+/* Windows to run the benchmark with. */
+static const int windows[] = { 1, 16, 256, 4096 };
+
+struct bench_msg {
+	struct cmsg cmsg;
+};
+
+static struct cord worker;
+static struct cpipe pipe_to_worker;
+static struct cpipe pipe_to_main;
+
+/* Messages sent and received by the main thread in this run. */
+static int sent, received;
+/* Max number of messages in flight in this run. */
+static int window;
+static struct bench_msg *messages;
+
+static void
+worker_msg_f(struct cmsg *m)
+{
+	(void) m;
+}
+
+static void
+main_msg_f(struct cmsg *m);
+
+static const struct cmsg_hop bench_route[] = {
+	{ worker_msg_f, &pipe_to_main },
+	{ main_msg_f, NULL },
+};
+
+static void
+send_msg(struct bench_msg *msg)
+{
+	cmsg_init(&msg->cmsg, bench_route);
+	cpipe_push_input(&pipe_to_worker, &msg->cmsg);
+	sent++;
+}
+
+static void
+main_msg_f(struct cmsg *m)
+{
+	received++;
+	if (sent < message_count) {
+		send_msg((struct bench_msg *) m);
+		cpipe_flush_input(&pipe_to_worker);
+	}
+}
+
+static int
+worker_f(va_list ap)
+{
+	(void) ap;
+	cpipe_create(&pipe_to_main, "main");
+	struct cbus_endpoint endpoint;
+	cbus_endpoint_create(&endpoint, "worker", fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&pipe_to_main);
+	return 0;
+}
+
+static void
+bench_run(struct cbus_endpoint *endpoint, int w)
+{
+	window = w;
+	sent = received = 0;
+	double start = clock_monotonic();
+	for (int i = 0; i < MIN(window, message_count); i++)
+		send_msg(&messages[i]);
+	cpipe_flush_input(&pipe_to_worker);
+	while (true) {
+		cbus_process(endpoint);
+		if (received == message_count)
+			break;
+		fiber_yield();
+	}
+	double elapsed = clock_monotonic() - start;
+	fprintf(stderr, "window %5d: %10.0f msg/s, %8.2f us per round trip\n",
+		window, message_count / elapsed,
+		elapsed * 1e6 / message_count * window);
+	ok(sent == message_count && received == message_count,
+	   "window %d", window);
+}
+
+static int
+main_f(va_list ap)
+{
+	(void) ap;
+	int max_window = windows[lengthof(windows) - 1];
+	messages = calloc(max_window, sizeof(*messages));
+	fail_if(messages == NULL);
+
+	struct cbus_endpoint endpoint;
+	cbus_endpoint_create(&endpoint, "main", fiber_schedule_cb, fiber());
+	fail_if(cord_costart(&worker, "worker", worker_f, NULL) != 0);
+	cpipe_create(&pipe_to_worker, "worker");
+
+	plan(lengthof(windows));
+	for (unsigned i = 0; i < lengthof(windows); i++)
+		bench_run(&endpoint, windows[i]);
+	check_plan();
+
+	cbus_stop_loop(&pipe_to_worker);
+	cpipe_destroy(&pipe_to_worker);
+	fail_if(cord_join(&worker) != 0);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	free(messages);
+	ev_break(loop(), EVBREAK_ALL);
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	if (argc > 1)
+		message_count = atoi(argv[1]);
+	fail_if(message_count <= 0);
+
+	memory_init();
+	fiber_init(fiber_c_invoke);
+	cbus_init();
+
+	header();
+
+	struct fiber *f = fiber_new("main", main_f);
+	fail_if(f == NULL);
+	fiber_wakeup(f);
+	ev_run(loop(), 0);
+
+	footer();
+
+	cbus_free();
+	fiber_free();
+	memory_free();
+	return 0;
+}
@@ -165,7 +165,7 @@ test_basic()
 
 	rc = vy_run_write(run, dir_name, 0, pk->id,
 			  write_stream, 4096, pk->cmp_def, pk->key_def,
-			  100500, 0.1);
+			  100500, 0.1, false);
 	is(rc, 0, "vy_run_write");
 
 	write_stream->iface->close(write_stream);
@@ -202,7 +202,7 @@ test_basic()
 
 	rc = vy_run_write(run, dir_name, 0, pk->id,
 			  write_stream, 4096, pk->cmp_def, pk->key_def,
-			  100500, 0.1);
+			  100500, 0.1, false);
 	is(rc, 0, "vy_run_write");
 
 	write_stream->iface->close(write_stream);
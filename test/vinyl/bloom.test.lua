@@ -48,3 +48,29 @@ new_reflects() > 980
 new_seeks() < 20
 
 s:drop()
+
+--
+-- Prefix bloom filters.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {parts = {1, 'unsigned', 2, 'unsigned'}, bloom_prefixes = true})
+s.index.pk.options.bloom_prefixes
+reflects = 0
+seeks = 0
+for i = 1,1000 do s:replace{i, i} end
+box.snapshot()
+_ = new_reflects()
+_ = new_seeks()
+for i = 1,1000 do s:select{i} end
+new_reflects() == 0
+new_seeks() == 1000
+for i = 1001,2000 do s:select{i} end
+new_reflects() > 980
+new_seeks() < 20
+for i = 1001,2000 do s:select({i}, {iterator = 'req'}) end
+new_reflects() > 980
+new_seeks() < 20
+for i = 1,1000 do s:select{i, i + 1} end
+new_reflects() > 980
+new_seeks() < 20
+s:drop()
@@ -0,0 +1,142 @@
+test_run = require('test_run').new()
+fiber = require('fiber')
+txn_proxy = require('txn_proxy')
+
+--
+-- Creation of a secondary index in a non-empty space.
+--
+test_run:cmd("setopt delimiter ';'")
+function fill(space, n)
+    for i = 1, n do space:replace{i, i} end
+end;
+function build(space, name, unique, func)
+    local ch = fiber.channel(1)
+    fiber.create(function()
+        local ok, err = pcall(space.create_index, space, name,
+                              {parts = {2, 'integer'}, unique = unique})
+        ch:put(ok or tostring(err))
+    end)
+    func()
+    return ch:get()
+end;
+function change(space)
+    for i = 1, 1000, 10 do
+        space:delete{i}
+        space:replace{i + 1, -i}
+        space:insert{1000 + i, 1000 + i}
+        box.begin()
+        space:replace{i + 2, 0}
+        box.rollback()
+    end
+end;
+function check(space, name)
+    local pk = space.index.pk
+    local sk = space.index[name]
+    for _, t in pk:pairs() do
+        local found = false
+        for _, u in sk:pairs(t[2]) do
+            if u[1] == t[1] then found = true break end
+        end
+        if not found then return false end
+    end
+    return sk:count() == pk:count()
+end;
+test_run:cmd("setopt delimiter ''");
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {run_count_per_level = 10})
+fill(s, 500)
+box.snapshot()
+fill(s, 1000)
+
+-- changes done while the index is being built get to the index
+build(s, 'sk', true, function() change(s) end)
+check(s, 'sk')
+s.index.sk:count()
+s.index.sk:get{0}
+s.index.sk:get{-991}
+s.index.sk:drop()
+
+-- a non-unique index
+build(s, 'sk', false, function() s:replace{1, 1000} end)
+check(s, 'sk')
+s.index.sk:count()
+s.index.sk:select{1000}
+s.index.sk:drop()
+s:delete{1}
+
+-- a concurrent change violating the new unique index fails the build
+build(s, 'sk', true, function() s:replace{2, 500} end)
+s.index.sk
+s:replace{2, -1}
+
+-- the data in the space violates the new unique index
+s:replace{3, 500}
+s:create_index('sk', {parts = {2, 'integer'}})
+s.index.sk
+s:replace{3, 3}
+
+-- tuples must conform to the new index definition
+s:replace{4, 'x'}
+s:create_index('sk', {parts = {2, 'integer'}})
+s.index.sk
+s:replace{4, 4}
+
+-- a transaction that wrote to the space before the build
+-- started is aborted
+c = txn_proxy.new()
+c:begin()
+c('s:replace{5, 5000}')
+build(s, 'sk', false, function() end)
+c:commit()
+s:get{5}
+check(s, 'sk')
+s.index.sk:drop()
+
+_ = s:create_index('sk', {parts = {2, 'integer'}})
+check(s, 'sk')
+
+-- the index is rebuilt on recovery if it wasn't dumped
+test_run:cmd('restart server default')
+test_run = require('test_run').new()
+s = box.space.test
+test_run:cmd("setopt delimiter ';'")
+function check(space, name)
+    local pk = space.index.pk
+    local sk = space.index[name]
+    for _, t in pk:pairs() do
+        local found = false
+        for _, u in sk:pairs(t[2]) do
+            if u[1] == t[1] then found = true break end
+        end
+        if not found then return false end
+    end
+    return sk:count() == pk:count()
+end;
+test_run:cmd("setopt delimiter ''");
+check(s, 'sk')
+s.index.sk:get{-991}
+box.snapshot()
+check(s, 'sk')
+s:drop()
+
+-- building an index that doesn't fit in memory is refused
+test_run:cmd("create server test with script='vinyl/low_quota_1.lua'")
+test_run:cmd("start server test")
+test_run:cmd('switch test')
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk')
+pad = string.rep('x', 1000)
+for i = 1, 2000 do s:replace{i, i, pad} end
+box.snapshot()
+s:create_index('sk', {parts = {2, 'unsigned'}})
+s.index.sk
+box.info.vinyl().quota.used
+s:truncate()
+for i = 1, 100 do s:replace{i, i, pad} end
+_ = s:create_index('sk', {parts = {2, 'unsigned'}})
+s.index.sk:count()
+s:drop()
+test_run:cmd('switch default')
+test_run:cmd("stop server test")
+test_run:cmd("cleanup server test")
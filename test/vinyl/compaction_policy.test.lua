@@ -0,0 +1,43 @@
+test_run = require('test_run').new()
+fiber = require('fiber')
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+s:create_index('pk', {compaction_policy = 'universal'})
+
+-- The tiered policy is used by default.
+pk = s:create_index('pk', {run_count_per_level = 100})
+pk.options.compaction_policy
+
+-- Amplification is not defined for an empty index.
+amp = pk:info().amplification
+amp.read, amp.write, amp.space
+
+for i = 1, 100 do s:replace{i} end
+box.snapshot()
+for i = 101, 200 do s:replace{i} end
+box.snapshot()
+pk:info().run_count
+amp = pk:info().amplification
+amp.read, amp.write, amp.space > 1
+pk:drop()
+
+-- The leveled policy merges a run into the next level as soon
+-- as it gets comparable in size.
+pk = s:create_index('pk', {run_count_per_level = 100, compaction_policy = 'leveled'})
+pk.options.compaction_policy
+for i = 1, 100 do s:replace{i} end
+box.snapshot()
+for i = 101, 200 do s:replace{i} end
+box.snapshot()
+while pk:info().disk.compact.count < 1 do fiber.sleep(0.01) end
+pk:info().run_count
+amp = pk:info().amplification
+amp.read, amp.write > 1, amp.space
+
+-- A small run stays at its level.
+s:replace{201}
+box.snapshot()
+pk:info().run_count
+pk:info().disk.compact.count
+
+s:drop()
@@ -0,0 +1,8 @@
+#!/usr/bin/env tarantool
+
+box.cfg{
+    vinyl_direct_io = true,
+    vinyl_cache = 0,
+}
+
+require('console').listen(os.getenv('ADMIN'))
@@ -0,0 +1,32 @@
+test_run = require('test_run').new()
+
+test_run:cmd("create server test with script='vinyl/direct_io.lua'")
+test_run:cmd("start server test")
+test_run:cmd('switch test')
+
+box.cfg.vinyl_direct_io
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {page_size = 1000, read_ahead = 8})
+pad = string.rep('x', 1000)
+for i = 1, 100 do s:replace{i, pad} end
+box.snapshot()
+
+-- Page offsets and sizes are not aligned, but reads are.
+s:get(1)[1], s:get(50)[1], s:get(100)[1]
+#s:select()
+t = s:select({}, {iterator = 'LE'})
+#t, t[1][1], t[100][1]
+
+-- Runs recovered after restart are read with direct I/O too.
+test_run:cmd('switch default')
+test_run:cmd('restart server test')
+test_run:cmd('switch test')
+s = box.space.test
+#s:select()
+s:get(77)[1]
+s:drop()
+
+test_run:cmd('switch default')
+test_run:cmd("stop server test")
+test_run:cmd("cleanup server test")
@@ -68,22 +68,26 @@ end;
 -- Return index statistics.
 --
 -- Note, latency measurement is beyond the scope of this test
--- so we just filter it out.
+-- so we just filter it out. Amplification factors are checked
+-- by compaction_policy.test.lua.
 function istat()
     local st = box.space.test.index.pk:info()
     st.latency = nil
+    st.amplification = nil
     return st
 end;
 
 -- Return global statistics.
 --
 -- Note, quota watermark checking is beyond the scope of this
--- test so we just filter out related statistics.
+-- test so we just filter out related statistics. Page cache
+-- statistics are checked by page_cache.test.lua.
 function gstat()
     local st = box.info.vinyl()
     st.quota.use_rate = nil
     st.quota.dump_bandwidth = nil
     st.quota.watermark = nil
+    st.page_cache = nil
     return st
 end;
 
@@ -0,0 +1,40 @@
+test_run = require('test_run').new()
+
+-- The page cache is disabled by default.
+box.cfg.vinyl_page_cache
+box.info.vinyl().page_cache.limit
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {page_size = 1024})
+for i = 1, 100 do s:replace{i, string.rep('x', 100)} end
+box.snapshot()
+
+function pstat() return box.info.vinyl().page_cache end
+
+box.cfg{vinyl_page_cache = 1024 * 1024}
+box.info.vinyl().page_cache.limit
+st = pstat()
+
+-- The first lookup reads the page from disk.
+s:get(1) ~= nil
+pstat().miss - st.miss > 0
+pstat().pages > 0
+pstat().used > 0
+
+-- A lookup of another key in the same page hits the cache.
+st = pstat()
+s:get(2) ~= nil
+pstat().hit - st.hit > 0
+pstat().miss - st.miss
+
+-- Shrinking the cache evicts pages.
+st = pstat()
+box.cfg{vinyl_page_cache = 0}
+pstat().evict - st.evict > 0
+pstat().pages
+pstat().used
+
+-- Lookups work as usual with the cache disabled.
+s:get(3) ~= nil
+
+s:drop()
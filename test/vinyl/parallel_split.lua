@@ -0,0 +1,9 @@
+#!/usr/bin/env tarantool
+
+box.cfg{
+    -- One worker thread is reserved for dumps, so a huge range
+    -- is split in at most four parts.
+    vinyl_write_threads = 5,
+}
+
+require('console').listen(os.getenv('ADMIN'))
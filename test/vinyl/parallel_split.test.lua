@@ -0,0 +1,96 @@
+test_run = require('test_run').new()
+
+--
+-- A range that has never been compacted and is several times
+-- bigger than range_size is split in more than two parts before
+-- compaction, and the parts are compacted independently.
+--
+test_run:cmd('create server test with script = "vinyl/parallel_split.lua"')
+test_run:cmd('start server test')
+test_run:cmd('switch test')
+
+fiber = require('fiber')
+digest = require('digest')
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {page_size = 512, range_size = 16384, run_count_per_level = 1, run_size_ratio = 1000})
+
+-- Bulk load: dump a run several times bigger than range_size.
+key_count = 1500
+function pad(k) return digest.sha1_hex(tostring(k)):rep(2) end
+for k = 1, key_count do s:replace{k, pad(k)} end
+box.snapshot()
+s.index.pk:info().range_count
+s.index.pk:info().run_count
+s.index.pk:info().disk.compact.count
+
+-- Dump one more run to trigger compaction.
+for k = 1, key_count, 100 do s:replace{k, pad(k), k} end
+box.snapshot()
+
+-- Wait until all ranges have been compacted.
+test_run:cmd("setopt delimiter ';'")
+function compacted()
+    local info = s.index.pk:info()
+    return info.range_count > 1 and info.run_count == info.range_count
+end;
+while not compacted() do fiber.sleep(0.01) end;
+test_run:cmd("setopt delimiter ''");
+
+-- The range was split in more than two parts, and each part
+-- was compacted once: a range would be split in two only after
+-- its first compaction.
+range_count = s.index.pk:info().range_count
+range_count > 2
+s.index.pk:info().disk.compact.count == range_count
+
+-- Check the space content.
+test_run:cmd("setopt delimiter ';'")
+function check()
+    local k = 0
+    for _, t in s:pairs() do
+        k = k + 1
+        if t[1] ~= k or t[2] ~= pad(k) or
+           t[3] ~= (k % 100 == 1 and k or nil) then
+            return false
+        end
+    end
+    return k == key_count
+end;
+test_run:cmd("setopt delimiter ''");
+check()
+s:count() == key_count
+s:get{1001}[3]
+s:select({750}, {iterator = 'LT', limit = 1})[1][1]
+
+-- Check that the index can be recovered after the split.
+test_run:cmd('switch default')
+test_run:cmd('stop server test')
+test_run:cmd('start server test')
+test_run:cmd('switch test')
+
+test_run:cmd("setopt delimiter ';'")
+s = box.space.test
+digest = require('digest')
+function pad(k) return digest.sha1_hex(tostring(k)):rep(2) end
+function check()
+    local k = 0
+    for _, t in s:pairs() do
+        k = k + 1
+        if t[1] ~= k or t[2] ~= pad(k) or
+           t[3] ~= (k % 100 == 1 and k or nil) then
+            return false
+        end
+    end
+    return k == 1500
+end;
+test_run:cmd("setopt delimiter ''");
+s.index.pk:info().range_count > 2
+s.index.pk:info().run_count == s.index.pk:info().range_count
+check()
+
+s:drop()
+
+test_run:cmd('switch default')
+test_run:cmd('stop server test')
+test_run:cmd('cleanup server test')
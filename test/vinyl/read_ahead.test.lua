@@ -0,0 +1,42 @@
+test_run = require('test_run').new()
+
+-- Read-ahead is disabled by default.
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {page_size = 1024})
+pk.options.read_ahead
+for i = 1, 100 do s:replace{i, string.rep('x', 100)} end
+box.snapshot()
+#s:select()
+pk:info().disk.iterator.read_ahead
+s:drop()
+s = box.schema.space.create('test', {engine = 'vinyl'})
+
+-- Invalid window size.
+s:create_index('pk', {read_ahead = -1})
+
+pk = s:create_index('pk', {page_size = 1024, read_ahead = 4})
+pk.options.read_ahead
+for i = 1, 100 do s:replace{i, string.rep('x', 100)} end
+box.snapshot()
+pk:info().disk.pages > 4
+
+-- A sequential scan reads every page exactly once.
+st = pk:info().disk.iterator.read.pages
+ra = pk:info().disk.iterator.read_ahead
+#s:select()
+pk:info().disk.iterator.read.pages - st == pk:info().disk.pages
+-- All pages but the first two are read ahead.
+pk:info().disk.iterator.read_ahead - ra == pk:info().disk.pages - 2
+t = s:select({}, {iterator = 'LE'})
+#t, t[1][1], t[100][1]
+
+-- A scan stopped in the middle drops pages read ahead.
+t = s:select({}, {limit = 20})
+#t, t[20][1]
+t = s:select({50}, {iterator = 'LT', limit = 20})
+#t, t[1][1], t[20][1]
+
+-- Random lookups work as usual.
+s:get(1)[1], s:get(77)[1], s:get(33)[1]
+
+s:drop()
@@ -0,0 +1,41 @@
+test_run = require('test_run').new()
+fiber = require('fiber')
+
+--
+-- Check that a long chain of UPSERT statements that is too short
+-- to be squashed on commit is squashed in the background when
+-- a read has to apply it.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk')
+
+s:insert{1, 0}
+s:insert{2, 0}
+box.snapshot()
+
+for i = 1, 50 do s:upsert({1, 0}, {{'+', 2, 1}}) end
+for i = 1, 50 do s:upsert({2, 0}, {{'+', 2, 1}}) end
+pk:info().upsert.squashed
+
+-- point lookup
+s:get{1}
+while pk:info().upsert.squashed < 1 do fiber.sleep(0.01) end
+pk:info().upsert.squashed
+
+-- the squashed chain is not applied on read any more
+stat = pk:info()
+for i = 1, 10 do s:upsert({1, 0}, {{'+', 2, 1}}) end
+s:get{1}
+pk:info().upsert.applied - stat.upsert.applied
+
+-- range scan
+s:select()
+while pk:info().upsert.squashed < 2 do fiber.sleep(0.01) end
+pk:info().upsert.squashed
+
+-- the result survives dump
+box.snapshot()
+s:select()
+pk:info().upsert.squashed
+
+s:drop()
@@ -0,0 +1,11 @@
+#!/usr/bin/env tarantool
+
+box.cfg{
+    listen              = os.getenv("LISTEN"),
+    memtx_memory        = 107374182,
+    rows_per_wal        = 5000,
+    wal_compress_level  = 1,
+    wal_compress_threshold = 1024,
+}
+
+require('console').listen(os.getenv('ADMIN'))
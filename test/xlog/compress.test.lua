@@ -0,0 +1,76 @@
+test_run = require('test_run').new()
+fio = require('fio')
+xlog = require('xlog')
+digest = require('digest')
+
+--
+-- Big WAL batches are compressed in a background thread.
+-- Check that compressed xlogs are written across rotations
+-- and can be read back and recovered from.
+--
+test_run:cmd("create server compress with script='xlog/compress.lua'")
+test_run:cmd("start server compress")
+test_run:cmd("switch compress")
+digest = require('digest')
+box.cfg.wal_compress_level
+box.cfg.wal_compress_threshold
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+function pad(i) return digest.sha1_hex(tostring(i)):rep(5) end
+-- Every transaction is several times bigger than an xlog block.
+for j = 0, 5 do box.begin() for i = j * 2000 + 1, (j + 1) * 2000 do s:insert{i, pad(i)} end box.commit() end
+s:count()
+test_run:cmd("switch default")
+
+wal_dir = test_run:eval('compress', "return require('fio').abspath(box.cfg.wal_dir)")[1]
+space_id = test_run:eval('compress', 'return box.space.test.id')[1]
+test_run:cmd("stop server compress")
+files = fio.glob(fio.pathjoin(wal_dir, '*.xlog'))
+table.sort(files)
+#files > 1
+
+test_run:cmd("setopt delimiter ';'")
+function pad(i) return digest.sha1_hex(tostring(i)):rep(5) end;
+-- Check that an xlog file contains compressed blocks.
+function is_compressed(path)
+    local f = fio.open(path, {'O_RDONLY'})
+    local data = f:read(fio.stat(path).size)
+    f:close()
+    return data:find('\xd5\xba\x0b\xba', 1, true) ~= nil
+end;
+-- Check that the rows are written as inserted.
+function check_rows()
+    local i = 0
+    for _, path in ipairs(files) do
+        for _, row in xlog.pairs(path) do
+            if row.BODY.space_id == space_id then
+                i = i + 1
+                local t = row.BODY.tuple
+                if t[1] ~= i or t[2] ~= pad(i) then
+                    return false
+                end
+            end
+        end
+    end
+    return i == 12000
+end;
+test_run:cmd("setopt delimiter ''");
+compressed = 0
+for _, path in ipairs(files) do if is_compressed(path) then compressed = compressed + 1 end end
+compressed == #files
+check_rows()
+
+-- Recover from the compressed xlogs.
+test_run:cmd("start server compress")
+test_run:cmd("switch compress")
+digest = require('digest')
+function pad(i) return digest.sha1_hex(tostring(i)):rep(5) end
+s = box.space.test
+s:count()
+bad = 0
+for i = 1, 12000 do if s:get{i}[2] ~= pad(i) then bad = bad + 1 end end
+bad
+
+test_run:cmd("switch default")
+test_run:cmd("stop server compress")
+test_run:cmd("cleanup server compress")
@@ -41,3 +41,31 @@ errinj.set('ERRINJ_WAL_WRITE', false)
 test:drop()
 errinj = nil
 box.schema.user.revoke('guest', 'read,write,execute', 'universe')
+
+--
+-- A failed fsync() rolls back all batches of the commit group
+-- and truncates their rows from the WAL.
+--
+test_run:cmd("create server group_commit with script='xlog/group_commit.lua'")
+test_run:cmd("start server group_commit")
+test_run:cmd("switch group_commit")
+fiber = require('fiber')
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+box.begin() for i = 1, 5 do s:insert{i} end box.commit()
+box.error.injection.set('ERRINJ_WAL_SYNC', true)
+ch = fiber.channel(10)
+for i = 6, 15 do fiber.create(function() fiber.sleep((i - 6) * 0.01) ch:put((pcall(s.insert, s, {i}))) end) end
+failed = 0
+for i = 1, 10 do if not ch:get() then failed = failed + 1 end end
+failed
+box.error.injection.set('ERRINJ_WAL_SYNC', false)
+s:select()
+s:insert{16}
+test_run:cmd("switch default")
+test_run:cmd("restart server group_commit")
+test_run:cmd("switch group_commit")
+box.space.test:select()
+test_run:cmd("switch default")
+test_run:cmd("stop server group_commit")
+test_run:cmd("cleanup server group_commit")
@@ -0,0 +1,11 @@
+#!/usr/bin/env tarantool
+
+box.cfg{
+    listen              = os.getenv("LISTEN"),
+    memtx_memory        = 107374182,
+    wal_mode            = 'fsync',
+    wal_group_commit_window = 1,
+    wal_group_commit_max_size = 16384,
+}
+
+require('console').listen(os.getenv('ADMIN'))
@@ -0,0 +1,67 @@
+test_run = require('test_run').new()
+
+--
+-- With group commit, WAL writes done within the commit window
+-- share one fsync().
+--
+test_run:cmd("create server group_commit with script='xlog/group_commit.lua'")
+test_run:cmd("start server group_commit")
+test_run:cmd("switch group_commit")
+fiber = require('fiber')
+box.cfg.wal_mode
+box.cfg.wal_group_commit_window
+box.cfg.wal_group_commit_max_size
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+test_run:cmd("setopt delimiter ';'")
+function write(first, count, size)
+    local ch = fiber.channel(count)
+    for i = first, first + count - 1 do
+        fiber.create(function()
+            fiber.sleep((i - first) * 0.01)
+            ch:put((pcall(s.insert, s, {i, string.rep('x', size)})))
+        end)
+    end
+    local ok = 0
+    for i = 1, count do
+        if ch:get() then ok = ok + 1 end
+    end
+    return ok
+end;
+function is_grouped(hist)
+    for min in hist:gmatch('%[(%d+)') do
+        if tonumber(min) > 1 then return true end
+    end
+    return false
+end;
+test_run:cmd("setopt delimiter ''");
+
+-- concurrent writes are synced when the window expires
+stat = box.stat.wal()
+t = fiber.time()
+write(1, 10, 10)
+fiber.time() - t >= 0.9
+fsyncs = box.stat.wal().fsyncs - stat.fsyncs
+writes = box.stat.wal().writes - stat.writes
+fsyncs
+fsyncs < writes
+is_grouped(box.stat.wal().writes_per_fsync)
+
+-- a group exceeding wal_group_commit_max_size is synced
+-- without waiting for the window to expire
+stat = box.stat.wal()
+t = fiber.time()
+write(11, 1, 20000)
+fiber.time() - t < 0.9
+box.stat.wal().fsyncs - stat.fsyncs
+
+-- the rows are recovered
+test_run:cmd("switch default")
+test_run:cmd("restart server group_commit")
+test_run:cmd("switch group_commit")
+box.space.test:count()
+box.space.test:drop()
+
+test_run:cmd("switch default")
+test_run:cmd("stop server group_commit")
+test_run:cmd("cleanup server group_commit")
@@ -0,0 +1,121 @@
+test_run = require('test_run').new()
+
+--
+-- Recovery of a space with several secondary indexes from a
+-- snapshot. Rows are decoded by the snapshot reader thread and
+-- secondary keys are built in parallel. The build arrays are
+-- large enough to be sorted in coio threads.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('sk1', {parts = {2, 'string'}})
+_ = s:create_index('sk2', {parts = {3, 'unsigned'}, unique = false})
+_ = s:create_index('sk3', {type = 'hash', parts = {4, 'unsigned'}})
+_ = s:create_index('sk4', {parts = {3, 'unsigned', 1, 'unsigned'}})
+function row(i) return {i, string.format('%08d', i * 7919 % 70001), i % 100, i * 3} end
+box.begin() for i = 1, 70000 do s:insert(row(i)) end box.commit()
+box.snapshot()
+
+test_run:cmd('restart server default')
+test_run = require('test_run').new()
+fio = require('fio')
+s = box.space.test
+function row(i) return {i, string.format('%08d', i * 7919 % 70001), i % 100, i * 3} end
+
+test_run:cmd("setopt delimiter ';'")
+function id(t) return t ~= nil and t[1] or nil end;
+-- Check that all secondary indexes match the primary one.
+function check()
+    local count = s.index.pk:count()
+    for _, name in ipairs({'sk1', 'sk2', 'sk3', 'sk4'}) do
+        if s.index[name]:count() ~= count then
+            return false
+        end
+    end
+    for _, t in s.index.pk:pairs() do
+        if id(s.index.sk1:get{t[2]}) ~= t[1] or
+           id(s.index.sk3:get{t[4]}) ~= t[1] or
+           id(s.index.sk4:get{t[3], t[1]}) ~= t[1] then
+            return false
+        end
+    end
+    local prev = nil
+    for _, t in s.index.sk1:pairs() do
+        if prev ~= nil and prev[2] >= t[2] then
+            return false
+        end
+        prev = t
+    end
+    prev = nil
+    for _, t in s.index.sk2:pairs() do
+        if prev ~= nil and prev[3] > t[3] then
+            return false
+        end
+        prev = t
+    end
+    return true
+end;
+-- Count rows that differ from the ones written.
+function bad_rows()
+    local bad = 0
+    for _, t in s.index.pk:pairs() do
+        local r = row(t[1])
+        if t[2] ~= r[2] or t[3] ~= r[3] or t[4] ~= r[4] then
+            bad = bad + 1
+        end
+    end
+    return bad
+end;
+test_run:cmd("setopt delimiter ''");
+
+-- All rows are recovered and all indexes are consistent.
+s:count()
+bad_rows()
+check()
+s.index.sk2:count{42}
+s.index.sk1:get{row(12345)[2]}[1]
+
+--
+-- A corrupted snapshot is recovered with force_recovery.
+-- The rows of the damaged transaction are skipped, and
+-- secondary keys are built from what has been recovered.
+--
+snap = fio.glob(fio.pathjoin(box.cfg.memtx_dir, '*.snap'))
+table.sort(snap)
+snap = snap[#snap]
+f = fio.open(snap, {'O_RDWR'})
+pos = math.floor(fio.stat(snap).size * 3 / 4)
+c = f:pread(1, pos)
+f:pwrite(string.char((c:byte() + 1) % 256), pos)
+f:close()
+
+test_run:cmd('restart server default')
+test_run = require('test_run').new()
+s = box.space.test
+test_run:grep_log('default', "can't open tx") ~= nil
+s:count() > 0
+s:count() < 70000
+
+test_run:cmd("setopt delimiter ';'")
+function id(t) return t ~= nil and t[1] or nil end;
+function check()
+    local count = s.index.pk:count()
+    for _, name in ipairs({'sk1', 'sk2', 'sk3', 'sk4'}) do
+        if s.index[name]:count() ~= count then
+            return false
+        end
+    end
+    for _, t in s.index.pk:pairs() do
+        if id(s.index.sk1:get{t[2]}) ~= t[1] or
+           id(s.index.sk3:get{t[4]}) ~= t[1] or
+           id(s.index.sk4:get{t[3], t[1]}) ~= t[1] then
+            return false
+        end
+    end
+    return true
+end;
+test_run:cmd("setopt delimiter ''");
+check()
+
+s:drop()
+box.snapshot()
@@ -0,0 +1,46 @@
+env = require('test_run').new()
+fio = require('fio')
+
+--
+-- A snapshot written by several threads is split into segments,
+-- one file per thread, and is recovered from all of them.
+--
+box.cfg{memtx_snapshot_threads = 4}
+
+for i = 1, 8 do box.schema.space.create('test' .. i):create_index('pk') end
+for i = 1, 8 do for j = 1, 100 do box.space['test' .. i]:insert{j, i} end end
+box.snapshot()
+
+lsn = box.info.lsn
+pattern = fio.pathjoin(box.cfg.memtx_dir, string.format('%020d.snap*', lsn))
+#fio.glob(pattern)
+
+-- Files left by a checkpoint that didn't complete are removed
+-- on startup: .inprogress files and segments whose main
+-- snapshot file is missing.
+stray = fio.pathjoin(box.cfg.memtx_dir, string.format('%020d.snap', lsn + 100))
+for _, suffix in ipairs({'.1', '.2', '.3.inprogress', '.inprogress'}) do fio.open(stray .. suffix, {'O_CREAT', 'O_WRONLY'}, tonumber('0644', 8)):close() end
+#fio.glob(stray .. '*')
+
+env:cmd('restart server default')
+fio = require('fio')
+lsn = box.info.lsn
+pattern = fio.pathjoin(box.cfg.memtx_dir, string.format('%020d.snap*', lsn))
+#fio.glob(pattern)
+#fio.glob(fio.pathjoin(box.cfg.memtx_dir, string.format('%020d.snap*', lsn + 100)))
+
+box.cfg.memtx_snapshot_threads
+count = 0
+for i = 1, 8 do count = count + box.space['test' .. i]:count() end
+count
+
+-- Segments are removed along with the snapshot.
+for i = 1, 8 do box.space['test' .. i]:drop() end
+box.snapshot()
+box.space._schema:insert{'snap_segments'}
+box.snapshot()
+#fio.glob(pattern)
+box.space._schema:delete{'snap_segments'}
+
+box.cfg{memtx_snapshot_threads = 0}
+box.cfg{memtx_snapshot_threads = 1}